@@ -33,6 +33,59 @@
 #pragma weak plat_set_nv_ctr2
 #pragma weak plat_convert_pk
 
+#if AUTH_KEY_CACHE
+/*
+ * Public keys that have already been authenticated against a ROTPK hash. Keys
+ * and hashes larger than the entry buffers are simply not cached.
+ */
+#ifndef PLAT_AUTH_KEY_CACHE_ENTRIES
+#define PLAT_AUTH_KEY_CACHE_ENTRIES	2U
+#endif
+#ifndef PLAT_AUTH_KEY_CACHE_PK_SIZE
+#define PLAT_AUTH_KEY_CACHE_PK_SIZE	128U
+#endif
+#define AUTH_KEY_CACHE_HASH_SIZE	96U
+
+typedef struct auth_key_cache_entry {
+	unsigned int pk_len;
+	unsigned int pk_hash_len;
+	uint8_t pk[PLAT_AUTH_KEY_CACHE_PK_SIZE];
+	uint8_t pk_hash[AUTH_KEY_CACHE_HASH_SIZE];
+} auth_key_cache_entry_t;
+
+static auth_key_cache_entry_t auth_key_cache[PLAT_AUTH_KEY_CACHE_ENTRIES];
+static unsigned int auth_key_cache_next;
+#endif /* AUTH_KEY_CACHE */
+
+#if MEASURED_BOOT
+/*
+ * DigestInfo checked by the last image authenticated by hash. Measured boot
+ * reuses it rather than hashing the image again.
+ */
+#define AUTH_DIGEST_INFO_MAX_SIZE	96U
+
+static struct {
+	const void *img_ptr;
+	unsigned int img_len;
+	unsigned int len;
+	uint8_t digest_info[AUTH_DIGEST_INFO_MAX_SIZE];
+} auth_img_digest;
+#endif /* MEASURED_BOOT */
+
+#if AUTH_STATS
+/* Number of certificates parsed and of crypto operations done */
+static struct {
+	unsigned int parsed;
+	unsigned int sig_verified;
+	unsigned int hash_verified;
+	unsigned int key_cache_hits;
+} auth_stats;
+
+#define AUTH_STATS_INC(_field)	(auth_stats._field++)
+#else
+#define AUTH_STATS_INC(_field)	((void)0)
+#endif /* AUTH_STATS */
+
 
 static int cmp_auth_param_type_desc(const auth_param_type_desc_t *a,
 		const auth_param_type_desc_t *b)
@@ -68,6 +121,95 @@ static int auth_get_param(const auth_param_type_desc_t *param_type_desc,
 	return 1;
 }
 
+#if AUTH_KEY_CACHE
+/*
+ * Look for a public key already authenticated against the given ROTPK hash.
+ *
+ * Return: true if the key is known to match the hash, false otherwise
+ */
+static bool auth_key_cache_lookup(const void *pk_ptr, unsigned int pk_len,
+				  const void *pk_hash_ptr,
+				  unsigned int pk_hash_len)
+{
+	unsigned int i;
+
+	for (i = 0U; i < PLAT_AUTH_KEY_CACHE_ENTRIES; i++) {
+		const auth_key_cache_entry_t *entry = &auth_key_cache[i];
+
+		if ((entry->pk_len == pk_len) &&
+		    (entry->pk_hash_len == pk_hash_len) &&
+		    (memcmp(entry->pk, pk_ptr, pk_len) == 0) &&
+		    (memcmp(entry->pk_hash, pk_hash_ptr, pk_hash_len) == 0)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Remember a public key that has just been authenticated against the given
+ * ROTPK hash. The oldest entry is replaced when the cache is full.
+ */
+static void auth_key_cache_add(const void *pk_ptr, unsigned int pk_len,
+			       const void *pk_hash_ptr,
+			       unsigned int pk_hash_len)
+{
+	auth_key_cache_entry_t *entry;
+
+	if ((pk_len > sizeof(entry->pk)) ||
+	    (pk_hash_len > sizeof(entry->pk_hash))) {
+		return;
+	}
+
+	entry = &auth_key_cache[auth_key_cache_next];
+	auth_key_cache_next = (auth_key_cache_next + 1U) %
+			      PLAT_AUTH_KEY_CACHE_ENTRIES;
+
+	memcpy(entry->pk, pk_ptr, pk_len);
+	entry->pk_len = pk_len;
+	memcpy(entry->pk_hash, pk_hash_ptr, pk_hash_len);
+	entry->pk_hash_len = pk_hash_len;
+}
+#endif /* AUTH_KEY_CACHE */
+
+/*
+ * Authenticate a public key taken from an image against the hash of the key
+ * provided by the platform.
+ *
+ * Return: 0 = success, Otherwise = error
+ */
+static int auth_verify_pk_hash(void *pk_ptr, unsigned int pk_len,
+			       void *pk_hash_ptr, unsigned int pk_hash_len)
+{
+	void *conv_pk_ptr;
+	unsigned int conv_pk_len;
+	int rc;
+
+#if AUTH_KEY_CACHE
+	if (auth_key_cache_lookup(pk_ptr, pk_len, pk_hash_ptr, pk_hash_len)) {
+		AUTH_STATS_INC(key_cache_hits);
+		return 0;
+	}
+#endif
+
+	/* platform may store the hash of a prefixed, suffixed or modified pk */
+	rc = plat_convert_pk(pk_ptr, pk_len, &conv_pk_ptr, &conv_pk_len);
+	return_if_error(rc);
+
+	/* Ask the crypto-module to verify the key hash */
+	AUTH_STATS_INC(hash_verified);
+	rc = crypto_mod_verify_hash(conv_pk_ptr, conv_pk_len,
+				    pk_hash_ptr, pk_hash_len);
+	return_if_error(rc);
+
+#if AUTH_KEY_CACHE
+	auth_key_cache_add(pk_ptr, pk_len, pk_hash_ptr, pk_hash_len);
+#endif
+
+	return 0;
+}
+
 /*
  * Authenticate an image by matching the data hash
  *
@@ -113,9 +255,22 @@ static int auth_hash(const auth_method_param_hash_t *param,
 	return_if_error(rc);
 
 	/* Ask the crypto module to verify this hash */
+	AUTH_STATS_INC(hash_verified);
 	rc = crypto_mod_verify_hash(data_ptr, data_len,
 				    hash_der_ptr, hash_der_len);
 
+#if MEASURED_BOOT
+	/* Only keep a digest that covers the whole image */
+	if ((rc == 0) && (data_ptr == img) && (data_len == img_len) &&
+	    (hash_der_len <= sizeof(auth_img_digest.digest_info))) {
+		auth_img_digest.img_ptr = img;
+		auth_img_digest.img_len = img_len;
+		auth_img_digest.len = hash_der_len;
+		(void)memcpy(auth_img_digest.digest_info, hash_der_ptr,
+			     hash_der_len);
+	}
+#endif
+
 	return rc;
 }
 
@@ -193,6 +348,7 @@ static int auth_signature(const auth_method_param_sig_t *param,
 		return_if_error(rc);
 
 		/* Ask the crypto module to verify the signature */
+		AUTH_STATS_INC(sig_verified);
 		rc = crypto_mod_verify_signature(data_ptr, data_len,
 						 sig_ptr, sig_len,
 						 sig_alg_ptr, sig_alg_len,
@@ -203,16 +359,12 @@ static int auth_signature(const auth_method_param_sig_t *param,
 			NOTICE("ROTPK is not deployed on platform. "
 				"Skipping ROTPK verification.\n");
 		} else {
-			/* platform may store the hash of a prefixed, suffixed or modified pk */
-			rc = plat_convert_pk(pk_ptr, pk_len, &pk_ptr, &pk_len);
-			return_if_error(rc);
-
-			/* Ask the crypto-module to verify the key hash */
-			rc = crypto_mod_verify_hash(pk_ptr, pk_len,
-				    pk_hash_ptr, pk_hash_len);
+			rc = auth_verify_pk_hash(pk_ptr, pk_len,
+						 pk_hash_ptr, pk_hash_len);
 		}
 	} else {
 		/* Ask the crypto module to verify the signature */
+		AUTH_STATS_INC(sig_verified);
 		rc = crypto_mod_verify_signature(data_ptr, data_len,
 						 sig_ptr, sig_len,
 						 sig_alg_ptr, sig_alg_len,
@@ -369,6 +521,32 @@ void auth_mod_init(void)
 	img_parser_init();
 }
 
+#if MEASURED_BOOT
+/*
+ * Get the DigestInfo checked while authenticating the given image, if the last
+ * authentication was of this image and its hash covered the whole of it. The
+ * digest is handed out once.
+ *
+ * Return: 0 = success, Otherwise = no digest available
+ */
+int auth_mod_get_img_digest(const void *img_ptr, unsigned int img_len,
+			    const void **digest_info,
+			    unsigned int *digest_info_len)
+{
+	if ((auth_img_digest.len == 0U) ||
+	    (auth_img_digest.img_ptr != img_ptr) ||
+	    (auth_img_digest.img_len != img_len)) {
+		return 1;
+	}
+
+	*digest_info = auth_img_digest.digest_info;
+	*digest_info_len = auth_img_digest.len;
+	auth_img_digest.len = 0U;
+
+	return 0;
+}
+#endif /* MEASURED_BOOT */
+
 /*
  * Authenticate a certificate/image
  *
@@ -391,7 +569,12 @@ int auth_mod_verify_img(unsigned int img_id,
 	/* Get the image descriptor from the chain of trust */
 	img_desc = FCONF_GET_PROPERTY(tbbr, cot, img_id);
 
+#if MEASURED_BOOT
+	auth_img_digest.len = 0U;
+#endif
+
 	/* Ask the parser to check the image integrity */
+	AUTH_STATS_INC(parsed);
 	rc = img_parser_check_integrity(img_desc->img_type, img_ptr, img_len);
 	return_if_error(rc);
 
@@ -466,5 +649,11 @@ int auth_mod_verify_img(unsigned int img_id,
 	/* Mark image as authenticated */
 	auth_img_flags[img_desc->img_id] |= IMG_FLAG_AUTHENTICATED;
 
+#if AUTH_STATS
+	VERBOSE("AUTH: %u images parsed, %u signatures, %u hashes, %u cached keys\n",
+		auth_stats.parsed, auth_stats.sig_verified,
+		auth_stats.hash_verified, auth_stats.key_cache_hits);
+#endif
+
 	return 0;
 }
@@ -30,6 +30,7 @@ io_type_t device_type_block(void);
 static int block_open(io_dev_info_t *dev_info, const uintptr_t spec,
 		      io_entity_t *entity);
 static int block_seek(io_entity_t *entity, int mode, signed long long offset);
+static int block_len(io_entity_t *entity, size_t *length);
 static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		      size_t *length_read);
 static int block_write(io_entity_t *entity, const uintptr_t buffer,
@@ -46,7 +47,7 @@ static const io_dev_funcs_t block_dev_funcs = {
 	.type		= device_type_block,
 	.open		= block_open,
 	.seek		= block_seek,
-	.size		= NULL,
+	.size		= block_len,
 	.read		= block_read,
 	.write		= block_write,
 	.close		= block_close,
@@ -171,6 +172,15 @@ static int block_seek(io_entity_t *entity, int mode, signed long long offset)
 	return 0;
 }
 
+static int block_len(io_entity_t *entity, size_t *length)
+{
+	assert((entity->info != (uintptr_t)NULL) && (length != NULL));
+
+	*length = (size_t)((block_dev_state_t *)entity->info)->size;
+
+	return 0;
+}
+
 /*
  * This function allows the caller to read any number of bytes
  * from any position. It hides from the caller that the low level
@@ -296,6 +306,24 @@ static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		 */
 		lba = (cur->file_pos + cur->base) / block_size;
 
+		/*
+		 * Whole blocks to a block aligned user buffer are read
+		 * with a single request, without the temp buffer.
+		 */
+		if (cur->dev_spec->direct_read && (skip == 0U) &&
+		    (left >= block_size) &&
+		    (((buffer + count) & (block_size - 1U)) == 0U)) {
+			nbytes = ops->read(lba, buffer + count,
+					   left & ~(block_size - 1U));
+			if (nbytes == 0U) {
+				return -EIO;
+			}
+
+			cur->file_pos += nbytes;
+			count += nbytes;
+			continue;
+		}
+
 		if ((skip + left) > buf->length) {
 			/*
 			 * The underlying read buffer is too small to
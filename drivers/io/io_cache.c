@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#include <platform_def.h>
+
+#include <common/debug.h>
+#include <drivers/io/io_cache.h>
+#include <drivers/io/io_driver.h>
+#include <drivers/io/io_storage.h>
+#include <lib/utils.h>
+#include <lib/utils_def.h>
+
+/*
+ * Maximum number of cache lines, the actual number also depends on the size
+ * of the RAM window given by the platform.
+ */
+#ifndef MAX_IO_CACHE_LINES
+#define MAX_IO_CACHE_LINES	32U
+#endif
+
+#define is_power_of_2(x)	(((x) != 0U) && (((x) & ((x) - 1U)) == 0U))
+
+#define NO_OFFSET		(~0ULL)
+
+typedef struct {
+	unsigned long long	offset;	/* Backend offset of the line */
+	size_t			len;	/* Valid bytes, 0 for a free line */
+	unsigned int		stamp;	/* Last use, for LRU replacement */
+} cache_line_t;
+
+/* As for io_memmap, only one file can be open at a time */
+typedef struct {
+	int			in_use;
+	unsigned long long	base;
+	unsigned long long	file_pos;
+	unsigned long long	size;
+} cache_file_state_t;
+
+static io_cache_dev_spec_t *cache_spec;
+static cache_line_t cache_lines[MAX_IO_CACHE_LINES];
+static unsigned int nr_cache_lines;
+static unsigned int lru_clock;
+/* End of the last backend read, a miss there is a sequential access */
+static unsigned long long next_offset = NO_OFFSET;
+static io_cache_stats_t cache_stats;
+static cache_file_state_t current_cache_file;
+
+static io_type_t device_type_cache(void)
+{
+	return IO_TYPE_CACHE;
+}
+
+static int cache_dev_open(const uintptr_t dev_spec, io_dev_info_t **dev_info);
+static int cache_open(io_dev_info_t *dev_info, const uintptr_t spec,
+		      io_entity_t *entity);
+static int cache_seek(io_entity_t *entity, int mode, signed long long offset);
+static int cache_len(io_entity_t *entity, size_t *length);
+static int cache_read(io_entity_t *entity, uintptr_t buffer, size_t length,
+		      size_t *length_read);
+static int cache_close(io_entity_t *entity);
+static int cache_dev_close(io_dev_info_t *dev_info);
+
+static const io_dev_connector_t cache_dev_connector = {
+	.dev_open = cache_dev_open
+};
+
+static const io_dev_funcs_t cache_dev_funcs = {
+	.type = device_type_cache,
+	.open = cache_open,
+	.seek = cache_seek,
+	.size = cache_len,
+	.read = cache_read,
+	.write = NULL,
+	.close = cache_close,
+	.dev_init = NULL,
+	.dev_close = cache_dev_close,
+};
+
+static io_dev_info_t cache_dev_info = {
+	.funcs = &cache_dev_funcs,
+	.info = (uintptr_t)NULL
+};
+
+static uintptr_t cache_line_data(unsigned int idx)
+{
+	return cache_spec->buffer.offset + (idx * cache_spec->line_size);
+}
+
+/* Read the backend device, with its own region to use absolute offsets */
+static int cache_backend_read(unsigned long long offset, uintptr_t buffer,
+			      size_t length)
+{
+	io_block_spec_t region = {
+		.offset = offset,
+		.length = length,
+	};
+	uintptr_t handle;
+	size_t length_read;
+	int result;
+
+	result = io_open(cache_spec->backend_dev_handle, (uintptr_t)&region,
+			 &handle);
+	if (result != 0) {
+		return result;
+	}
+
+	result = io_read(handle, buffer, length, &length_read);
+	if ((result == 0) && (length_read != length)) {
+		result = -EIO;
+	}
+
+	io_close(handle);
+	cache_stats.dev_reads++;
+
+	return result;
+}
+
+static int cache_lookup(unsigned long long offset)
+{
+	unsigned int i;
+
+	for (i = 0U; i < nr_cache_lines; i++) {
+		if ((cache_lines[i].len != 0U) &&
+		    (cache_lines[i].offset == offset)) {
+			return (int)i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+/*
+ * Read the line at offset from the backend. On a sequential access, the next
+ * lines are read with the same command, in consecutive lines of the window:
+ * the least recently used run of lines is replaced.
+ */
+static int cache_fill(unsigned long long offset)
+{
+	size_t line_size = cache_spec->line_size;
+	unsigned int nr = 1U;
+	unsigned int first = 0U;
+	unsigned int best = ~0U;
+	unsigned int i, j, stamp;
+	size_t len;
+
+	if (offset == next_offset) {
+		nr = MIN(cache_spec->readahead, nr_cache_lines);
+	}
+
+	while ((nr > 1U) &&
+	       ((offset + ((nr - 1U) * line_size)) >=
+		cache_spec->backend_size)) {
+		nr--;
+	}
+
+	len = MIN((unsigned long long)(nr * line_size),
+		  cache_spec->backend_size - offset);
+
+	for (i = 0U; (i + nr) <= nr_cache_lines; i++) {
+		stamp = 0U;
+		for (j = i; j < (i + nr); j++) {
+			stamp = MAX(stamp, cache_lines[j].stamp);
+		}
+
+		if (stamp < best) {
+			best = stamp;
+			first = i;
+		}
+	}
+
+	/* Drop the lines read again outside of the replaced run */
+	for (i = 0U; i < nr_cache_lines; i++) {
+		if (((i < first) || (i >= (first + nr))) &&
+		    (cache_lines[i].offset >= offset) &&
+		    (cache_lines[i].offset < (offset + len))) {
+			cache_lines[i].len = 0U;
+		}
+	}
+
+	for (i = first; i < (first + nr); i++) {
+		cache_lines[i].len = 0U;
+	}
+
+	if (cache_backend_read(offset, cache_line_data(first), len) != 0) {
+		return -EIO;
+	}
+
+	for (i = first; i < (first + nr); i++) {
+		cache_lines[i].offset = offset;
+		cache_lines[i].len = MIN(line_size, len);
+		cache_lines[i].stamp = ++lru_clock;
+		offset += cache_lines[i].len;
+		len -= cache_lines[i].len;
+	}
+
+	next_offset = offset;
+	cache_stats.misses++;
+	cache_stats.prefetched += nr - 1U;
+
+	return (int)first;
+}
+
+void io_cache_invalidate(void)
+{
+	zeromem(cache_lines, sizeof(cache_lines));
+	lru_clock = 0U;
+	next_offset = NO_OFFSET;
+}
+
+void io_cache_get_stats(io_cache_stats_t *stats)
+{
+	assert(stats != NULL);
+
+	*stats = cache_stats;
+}
+
+static int cache_dev_open(const uintptr_t dev_spec, io_dev_info_t **dev_info)
+{
+	assert(dev_info != NULL);
+
+	cache_spec = (io_cache_dev_spec_t *)dev_spec;
+	assert((cache_spec != NULL) &&
+	       (is_power_of_2(cache_spec->line_size) != 0U) &&
+	       ((cache_spec->buffer.offset % cache_spec->line_size) == 0U) &&
+	       (cache_spec->buffer.length >= cache_spec->line_size));
+
+	nr_cache_lines = MIN(cache_spec->buffer.length / cache_spec->line_size,
+			     (size_t)MAX_IO_CACHE_LINES);
+	if (cache_spec->readahead == 0U) {
+		cache_spec->readahead = 1U;
+	}
+
+	io_cache_invalidate();
+	zeromem(&cache_stats, sizeof(cache_stats));
+
+	*dev_info = &cache_dev_info;
+
+	return 0;
+}
+
+static int cache_dev_close(io_dev_info_t *dev_info)
+{
+	VERBOSE("io_cache: %lu hits, %lu misses, %lu prefetched, %lu reads\n",
+		cache_stats.hits, cache_stats.misses, cache_stats.prefetched,
+		cache_stats.dev_reads);
+
+	io_cache_invalidate();
+	cache_spec = NULL;
+
+	return 0;
+}
+
+static int cache_open(io_dev_info_t *dev_info, const uintptr_t spec,
+		      io_entity_t *entity)
+{
+	const io_block_spec_t *region = (io_block_spec_t *)spec;
+
+	assert((region != NULL) && (entity != NULL));
+
+	if (current_cache_file.in_use != 0) {
+		WARN("A cache device file is already active. Close first.\n");
+		return -ENOMEM;
+	}
+
+	assert((region->offset + region->length) <= cache_spec->backend_size);
+
+	current_cache_file.in_use = 1;
+	current_cache_file.base = region->offset;
+	current_cache_file.file_pos = 0U;
+	current_cache_file.size = region->length;
+
+	entity->info = (uintptr_t)&current_cache_file;
+
+	return 0;
+}
+
+static int cache_seek(io_entity_t *entity, int mode, signed long long offset)
+{
+	cache_file_state_t *fp;
+
+	assert(entity != NULL);
+
+	fp = (cache_file_state_t *)entity->info;
+
+	switch (mode) {
+	case IO_SEEK_SET:
+		if ((offset < 0) || ((unsigned long long)offset > fp->size)) {
+			return -EINVAL;
+		}
+		fp->file_pos = (unsigned long long)offset;
+		break;
+	case IO_SEEK_CUR:
+		if ((offset < 0) ||
+		    ((fp->file_pos + (unsigned long long)offset) > fp->size)) {
+			return -EINVAL;
+		}
+		fp->file_pos += (unsigned long long)offset;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int cache_len(io_entity_t *entity, size_t *length)
+{
+	assert(entity != NULL);
+	assert(length != NULL);
+
+	*length = (size_t)((cache_file_state_t *)entity->info)->size;
+
+	return 0;
+}
+
+/*
+ * Small or unaligned reads are served from the cache lines. Reads of whole
+ * lines that are not cached go straight to the caller buffer, so that image
+ * payloads do not evict the metadata (FIP TOC, GPT entries...).
+ */
+static int cache_read(io_entity_t *entity, uintptr_t buffer, size_t length,
+		      size_t *length_read)
+{
+	cache_file_state_t *fp;
+	size_t line_size = cache_spec->line_size;
+	unsigned long long pos, offset;
+	size_t count, left, nbytes, skip;
+	int idx;
+
+	assert(entity != NULL);
+	assert(length_read != NULL);
+
+	fp = (cache_file_state_t *)entity->info;
+	if (length > (fp->size - fp->file_pos)) {
+		return -EINVAL;
+	}
+
+	for (count = 0U; count < length; count += nbytes) {
+		pos = fp->base + fp->file_pos;
+		offset = pos & ~((unsigned long long)line_size - 1U);
+		skip = pos - offset;
+		left = length - count;
+
+		idx = cache_lookup(offset);
+		if ((idx < 0) && (skip == 0U) && (left >= line_size)) {
+			nbytes = left & ~(line_size - 1U);
+			if (cache_backend_read(pos, buffer + count,
+					       nbytes) != 0) {
+				return -EIO;
+			}
+			next_offset = pos + nbytes;
+		} else {
+			if (idx < 0) {
+				idx = cache_fill(offset);
+				if (idx < 0) {
+					return -EIO;
+				}
+			} else {
+				cache_stats.hits++;
+				cache_lines[idx].stamp = ++lru_clock;
+			}
+
+			if (skip >= cache_lines[idx].len) {
+				return -EIO;
+			}
+
+			nbytes = MIN(cache_lines[idx].len - skip, left);
+			memcpy((void *)(buffer + count),
+			       (void *)(cache_line_data(idx) + skip), nbytes);
+		}
+
+		fp->file_pos += nbytes;
+	}
+
+	*length_read = count;
+
+	return 0;
+}
+
+static int cache_close(io_entity_t *entity)
+{
+	assert(entity != NULL);
+
+	zeromem(&current_cache_file, sizeof(current_cache_file));
+	entity->info = 0U;
+
+	return 0;
+}
+
+/* Exported functions */
+
+/* Register the cache driver with the IO abstraction */
+int register_io_dev_cache(const io_dev_connector_t **dev_con)
+{
+	int result;
+
+	assert(dev_con != NULL);
+
+	result = io_register_device(&cache_dev_info);
+	if (result == 0) {
+		*dev_con = &cache_dev_connector;
+	}
+
+	return result;
+}
@@ -11,6 +11,7 @@
 
 #include <common/bl_common.h>
 #include <common/debug.h>
+#include <drivers/auth/auth_mod.h>
 #include <drivers/auth/crypto_mod.h>
 #include <drivers/measured_boot/event_log/event_log.h>
 
@@ -26,6 +27,25 @@
 #  error Invalid TPM algorithm.
 #endif /* TPM_ALG_ID */
 
+/* Images loaded by BL1/BL2 may already have been hashed for authentication */
+#if TRUSTED_BOARD_BOOT && (defined(IMAGE_BL1) || defined(IMAGE_BL2))
+#define EVENT_LOG_AUTH_DIGEST	1
+
+/* DER encoded OID of the Event Log hash algorithm */
+static const uint8_t digest_alg_oid[] = {
+	0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02,
+#if TPM_ALG_ID == TPM_ALG_SHA512
+	0x03
+#elif TPM_ALG_ID == TPM_ALG_SHA384
+	0x02
+#else
+	0x01
+#endif
+};
+#else
+#define EVENT_LOG_AUTH_DIGEST	0
+#endif
+
 /* Running Event Log Pointer */
 static uint8_t *log_ptr;
 
@@ -269,6 +289,72 @@ int event_log_measure(uintptr_t data_base, uint32_t data_size,
 				    (void *)data_base, data_size, hash_data);
 }
 
+#if EVENT_LOG_AUTH_DIGEST
+/*
+ * Get the digest of an image from the DigestInfo checked while authenticating
+ * it. The DigestInfo is only used if it holds a digest of the Event Log
+ * algorithm:
+ *
+ *   SEQUENCE { SEQUENCE { OID, NULL (optional) }, OCTET STRING }
+ *
+ * @param[in]  data_base	Address of image
+ * @param[in]  data_size	Size of image
+ * @param[out] hash_data	Digest of TCG_DIGEST_SIZE bytes
+ * @return:
+ *	0 = success
+ *    < 0 = no suitable digest
+ */
+static int event_log_get_auth_digest(uintptr_t data_base, uint32_t data_size,
+				     unsigned char *hash_data)
+{
+	const void *digest_info;
+	const uint8_t *p;
+	unsigned int len;
+	unsigned int alg_len;
+
+	if (auth_mod_get_img_digest((const void *)data_base, data_size,
+				    &digest_info, &len) != 0) {
+		return -ENOENT;
+	}
+
+	/* All lengths fit in the DER short form */
+	p = digest_info;
+	if ((len < 2U) || (p[0] != 0x30U) || (p[1] != (len - 2U))) {
+		return -EINVAL;
+	}
+	p += 2;
+	len -= 2U;
+
+	if ((len < 2U) || (p[0] != 0x30U) || (p[1] > (len - 2U))) {
+		return -EINVAL;
+	}
+	alg_len = p[1];
+
+	if (((alg_len != sizeof(digest_alg_oid)) &&
+	     (alg_len != (sizeof(digest_alg_oid) + 2U))) ||
+	    (memcmp(&p[2], digest_alg_oid, sizeof(digest_alg_oid)) != 0)) {
+		return -EINVAL;
+	}
+
+	if ((alg_len > sizeof(digest_alg_oid)) &&
+	    ((p[2 + sizeof(digest_alg_oid)] != 0x05U) ||
+	     (p[3 + sizeof(digest_alg_oid)] != 0x00U))) {
+		return -EINVAL;
+	}
+	p += 2U + alg_len;
+	len -= 2U + alg_len;
+
+	if ((len != (2U + TCG_DIGEST_SIZE)) || (p[0] != 0x04U) ||
+	    (p[1] != TCG_DIGEST_SIZE)) {
+		return -EINVAL;
+	}
+
+	(void)memcpy(hash_data, &p[2], TCG_DIGEST_SIZE);
+
+	return 0;
+}
+#endif /* EVENT_LOG_AUTH_DIGEST */
+
 /*
  * Calculate and write hash of image, configuration data, etc.
  * to Event Log.
@@ -294,10 +380,17 @@ int event_log_measure_and_record(uintptr_t data_base, uint32_t data_size,
 	}
 	assert(metadata_ptr->id != EVLOG_INVALID_ID);
 
-	/* Measure the payload with algorithm selected by EventLog driver */
-	rc = event_log_measure(data_base, data_size, hash_data);
+	rc = -ENOENT;
+#if EVENT_LOG_AUTH_DIGEST
+	/* Reuse the digest checked by authentication if it is suitable */
+	rc = event_log_get_auth_digest(data_base, data_size, hash_data);
+#endif
 	if (rc != 0) {
-		return rc;
+		/* Measure the payload with algorithm selected by EventLog driver */
+		rc = event_log_measure(data_base, data_size, hash_data);
+		if (rc != 0) {
+			return rc;
+		}
 	}
 
 	event_log_record(hash_data, EV_POST_CODE, metadata_ptr);
@@ -22,8 +22,6 @@ static int unicode_to_ascii(unsigned short *str_in, unsigned char *str_out)
 
 	name = (uint8_t *)str_in;
 
-	assert(name[0] != '\0');
-
 	/* check whether the unicode string is valid */
 	for (i = 1; i < (EFI_NAMELEN << 1); i += 2) {
 		if (name[i] != '\0') {
@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2016-2022, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2024, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
 #include <inttypes.h>
+#include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -16,10 +18,36 @@
 #include <drivers/partition/partition.h>
 #include <drivers/partition/gpt.h>
 #include <drivers/partition/mbr.h>
+#include <lib/cassert.h>
+#include <lib/utils.h>
+#include <lib/utils_def.h>
 #include <plat/common/platform.h>
 
+/*
+ * The GPT entry array is read in requests of whole blocks into an aligned
+ * buffer, for its CRC, and the entries kept in the list are parsed on the way.
+ */
+#define GPT_HEADER_LBA		1ULL
+
+/*
+ * Open addressing indexes of the list, by name, type GUID and unique GUID.
+ * A slot holds the entry number + 1, 0 for a free slot. The indexes are at
+ * most half full, and entries with the same key are found in list order.
+ */
+#define PARTITION_INDEX_SIZE	(2U * PLAT_PARTITION_MAX_ENTRIES)
+
+#define FNV_OFFSET_BASIS	U(0x811c9dc5)
+#define FNV_PRIME		U(0x01000193)
+
 static uint8_t mbr_sector[PLAT_PARTITION_BLOCK_SIZE];
+static uint8_t gpt_entries[PLAT_PARTITION_BUFFER_SIZE]
+	__aligned(PLAT_PARTITION_BLOCK_SIZE);
 static partition_entry_list_t list;
+static uint8_t name_index[PARTITION_INDEX_SIZE];
+static uint8_t type_index[PARTITION_INDEX_SIZE];
+static uint8_t guid_index[PARTITION_INDEX_SIZE];
+
+CASSERT(PLAT_PARTITION_MAX_ENTRIES < UINT8_MAX, assert_partition_index_entries);
 
 #if LOG_LEVEL >= LOG_LEVEL_VERBOSE
 static void dump_entries(int num)
@@ -77,27 +105,79 @@ static int load_mbr_header(uintptr_t image_handle, mbr_entry_t *mbr_entry)
 }
 
 /*
- * Load GPT header and check the GPT signature and header CRC.
- * If partition numbers could be found, check & update it.
+ * The entry array is between the header and the usable area for the primary
+ * GPT, and between the usable area and the header for the backup GPT.
  */
-static int load_gpt_header(uintptr_t image_handle)
+static bool gpt_entries_in_bounds(const gpt_header_t *header)
+{
+	unsigned long long size = (unsigned long long)header->list_num *
+				  header->part_size;
+	unsigned long long blocks = (size + PLAT_PARTITION_BLOCK_SIZE - 1U) /
+				    PLAT_PARTITION_BLOCK_SIZE;
+	unsigned long long start, end;
+
+	if (header->current_lba < header->first_lba) {
+		start = header->current_lba + 1U;
+		end = header->first_lba;
+	} else {
+		start = header->last_lba + 1U;
+		end = header->current_lba;
+	}
+
+	return (header->part_lba >= start) && (header->part_lba < end) &&
+	       (blocks <= (end - header->part_lba));
+}
+
+/*
+ * Number of blocks of the GPT image region that can be read, which may be less
+ * than the device, e.g. when its size does not fit in a size_t.
+ */
+static unsigned long long gpt_region_blocks(uintptr_t image_handle)
+{
+	size_t size;
+
+	if (io_size(image_handle, &size) != 0) {
+		return ULLONG_MAX;
+	}
+
+	return size / PLAT_PARTITION_BLOCK_SIZE;
+}
+
+/*
+ * Load the GPT header at lba and check the GPT signature and header CRC, and
+ * that the header and entry array are within a device ending at last_lba.
+ */
+static int load_gpt_header(uintptr_t image_handle, unsigned long long lba,
+			   unsigned long long last_lba, gpt_header_t *header)
 {
-	gpt_header_t header;
 	size_t bytes_read;
 	int result;
 	uint32_t header_crc, calc_crc;
 
-	result = io_seek(image_handle, IO_SEEK_SET, GPT_HEADER_OFFSET);
+	if ((lba == 0U) || (lba > last_lba)) {
+		return -EINVAL;
+	}
+
+	if (lba >= gpt_region_blocks(image_handle)) {
+		WARN("GPT header at LBA %llu out of the GPT region\n", lba);
+		return -ERANGE;
+	}
+
+	result = io_seek(image_handle, IO_SEEK_SET,
+			 (signed long long)(lba * PLAT_PARTITION_BLOCK_SIZE));
 	if (result != 0) {
 		return result;
 	}
-	result = io_read(image_handle, (uintptr_t)&header,
+	result = io_read(image_handle, (uintptr_t)header,
 			 sizeof(gpt_header_t), &bytes_read);
-	if ((result != 0) || (sizeof(gpt_header_t) != bytes_read)) {
+	if (result != 0) {
 		return result;
 	}
-	if (memcmp(header.signature, GPT_SIGNATURE,
-		   sizeof(header.signature)) != 0) {
+	if (sizeof(gpt_header_t) != bytes_read) {
+		return -EIO;
+	}
+	if (memcmp(header->signature, GPT_SIGNATURE,
+		   sizeof(header->signature)) != 0) {
 		return -EINVAL;
 	}
 
@@ -106,23 +186,34 @@ static int load_gpt_header(uintptr_t image_handle)
 	 * computed by setting this field to 0, and computing the
 	 * 32-bit CRC for HeaderSize bytes.
 	 */
-	header_crc = header.header_crc;
-	header.header_crc = 0U;
+	header_crc = header->header_crc;
+	header->header_crc = 0U;
 
-	calc_crc = tf_crc32(0U, (uint8_t *)&header, DEFAULT_GPT_HEADER_SIZE);
+	calc_crc = tf_crc32(0U, (uint8_t *)header, DEFAULT_GPT_HEADER_SIZE);
 	if (header_crc != calc_crc) {
 		ERROR("Invalid GPT Header CRC: Expected 0x%x but got 0x%x.\n",
 		      header_crc, calc_crc);
 		return -EINVAL;
 	}
 
-	header.header_crc = header_crc;
+	header->header_crc = header_crc;
 
-	/* partition numbers can't exceed PLAT_PARTITION_MAX_ENTRIES */
-	list.entry_count = header.list_num;
-	if (list.entry_count > PLAT_PARTITION_MAX_ENTRIES) {
-		list.entry_count = PLAT_PARTITION_MAX_ENTRIES;
+	if ((header->current_lba != lba) ||
+	    (header->first_lba <= (GPT_HEADER_LBA + 1U)) ||
+	    (header->first_lba > header->last_lba) ||
+	    (header->last_lba >= last_lba) ||
+	    (header->backup_lba > last_lba)) {
+		return -EINVAL;
 	}
+
+	/* UEFI: SizeOfPartitionEntry is 128 x 2^n */
+	if ((header->list_num == 0U) ||
+	    (header->part_size < sizeof(gpt_entry_t)) ||
+	    ((header->part_size & (header->part_size - 1U)) != 0U) ||
+	    !gpt_entries_in_bounds(header)) {
+		return -EINVAL;
+	}
+
 	return 0;
 }
 
@@ -177,45 +268,185 @@ static int load_mbr_entries(uintptr_t image_handle)
 	return 0;
 }
 
-static int load_gpt_entry(uintptr_t image_handle, gpt_entry_t *entry)
+/*
+ * Read the entry array of the GPT header, check its CRC and parse the entries
+ * up to PLAT_PARTITION_MAX_ENTRIES in the list, stopping at the first unused
+ * one. Entries larger than gpt_entry_t start on a multiple of 128 bytes, so
+ * that each gpt_entry_t is in one buffer.
+ */
+static int verify_partition_gpt(uintptr_t image_handle,
+				const gpt_header_t *header)
 {
-	size_t bytes_read;
+	unsigned long long total = (unsigned long long)header->list_num *
+				   header->part_size;
+	unsigned long long offset, pos;
+	size_t len, bytes_read;
+	uint32_t calc_crc = 0U;
+	int count = (int)MIN(header->list_num,
+			     (unsigned int)PLAT_PARTITION_MAX_ENTRIES);
+	unsigned long long region = gpt_region_blocks(image_handle);
+	int valid = 0;
 	int result;
 
-	assert(entry != NULL);
-	result = io_read(image_handle, (uintptr_t)entry, sizeof(gpt_entry_t),
-			 &bytes_read);
-	if (sizeof(gpt_entry_t) != bytes_read)
-		return -EINVAL;
-	return result;
-}
+	if ((header->part_lba >= region) ||
+	    (((total + PLAT_PARTITION_BLOCK_SIZE - 1U) /
+	      PLAT_PARTITION_BLOCK_SIZE) > (region - header->part_lba))) {
+		WARN("GPT entries at LBA %llu out of the GPT region\n",
+		     (unsigned long long)header->part_lba);
+		return -ERANGE;
+	}
 
-static int verify_partition_gpt(uintptr_t image_handle)
-{
-	gpt_entry_t entry;
-	int result, i;
+	result = io_seek(image_handle, IO_SEEK_SET,
+			 (signed long long)(header->part_lba *
+					    PLAT_PARTITION_BLOCK_SIZE));
+	if (result != 0) {
+		return result;
+	}
 
-	for (i = 0; i < list.entry_count; i++) {
-		result = load_gpt_entry(image_handle, &entry);
-		assert(result == 0);
-		result = parse_gpt_entry(&entry, &list.list[i]);
-		if (result != 0) {
-			break;
+	for (offset = 0U; offset < total; offset += len) {
+		len = (size_t)MIN(total - offset,
+				  (unsigned long long)sizeof(gpt_entries));
+		result = io_read(image_handle, (uintptr_t)gpt_entries, len,
+				 &bytes_read);
+		if ((result != 0) || (bytes_read != len)) {
+			return -EIO;
+		}
+
+		calc_crc = tf_crc32(calc_crc, gpt_entries, len);
+
+		for (; valid < count; valid++) {
+			pos = (unsigned long long)valid * header->part_size;
+			if (pos >= (offset + len)) {
+				break;
+			}
+
+			result = parse_gpt_entry(
+				(gpt_entry_t *)&gpt_entries[pos - offset],
+				&list.list[valid]);
+			if (result != 0) {
+				count = valid;
+				break;
+			}
 		}
 	}
-	if (i == 0) {
+
+	if (calc_crc != header->part_crc) {
+		ERROR("Invalid GPT Entries CRC: Expected 0x%x but got 0x%x.\n",
+		      header->part_crc, calc_crc);
+		return -EINVAL;
+	}
+
+	if (valid == 0) {
 		return -EINVAL;
 	}
 	/*
 	 * Only records the valid partition number that is loaded from
 	 * partition table.
 	 */
-	list.entry_count = i;
+	list.entry_count = valid;
 	dump_entries(list.entry_count);
 
 	return 0;
 }
 
+/*
+ * Load the primary GPT, or the backup GPT when the primary header or entry
+ * array is corrupted. The backup header is found from the primary header, or
+ * at the last LBA of the device.
+ *
+ * The device size is given by the protective MBR, as the GPT image region may
+ * be smaller: the headers are checked against the device, only the reads are
+ * limited to the region.
+ */
+static int load_partition_gpt(uintptr_t image_handle,
+			      const mbr_entry_t *mbr_entry)
+{
+	unsigned long long last_lba = ULLONG_MAX;
+	unsigned long long backup_lba;
+	gpt_header_t header;
+	int result;
+
+	/* A protective MBR too large for the device size field is all ones */
+	if (mbr_entry->sector_nums != UINT32_MAX) {
+		last_lba = (unsigned long long)mbr_entry->first_lba +
+			   mbr_entry->sector_nums - 1U;
+	}
+	backup_lba = MIN(last_lba, gpt_region_blocks(image_handle) - 1U);
+
+	result = load_gpt_header(image_handle, GPT_HEADER_LBA, last_lba,
+				 &header);
+	if (result == 0) {
+		backup_lba = header.backup_lba;
+		result = verify_partition_gpt(image_handle, &header);
+		if (result == 0) {
+			return 0;
+		}
+	}
+
+	WARN("Primary GPT corrupted (%i), loading the backup GPT\n", result);
+
+	result = load_gpt_header(image_handle, backup_lba, last_lba, &header);
+	if (result != 0) {
+		return result;
+	}
+
+	return verify_partition_gpt(image_handle, &header);
+}
+
+static uint32_t hash_bytes(uint32_t hash, const uint8_t *buf, size_t len)
+{
+	size_t i;
+
+	for (i = 0U; i < len; i++) {
+		hash = (hash ^ buf[i]) * FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static uint32_t hash_name(const char *name)
+{
+	size_t len = 0U;
+
+	while ((len < EFI_NAMELEN) && (name[len] != '\0')) {
+		len++;
+	}
+
+	return hash_bytes(FNV_OFFSET_BASIS, (const uint8_t *)name, len);
+}
+
+static uint32_t hash_guid(const struct efi_guid *guid)
+{
+	return hash_bytes(FNV_OFFSET_BASIS, (const uint8_t *)guid,
+			  sizeof(*guid));
+}
+
+static void index_add(uint8_t *index, uint32_t hash, int entry)
+{
+	unsigned int slot = hash % PARTITION_INDEX_SIZE;
+
+	while (index[slot] != 0U) {
+		slot = (slot + 1U) % PARTITION_INDEX_SIZE;
+	}
+
+	index[slot] = (uint8_t)(entry + 1);
+}
+
+static void build_indexes(void)
+{
+	int i;
+
+	zeromem(name_index, sizeof(name_index));
+	zeromem(type_index, sizeof(type_index));
+	zeromem(guid_index, sizeof(guid_index));
+
+	for (i = 0; i < list.entry_count; i++) {
+		index_add(name_index, hash_name(list.list[i].name), i);
+		index_add(type_index, hash_guid(&list.list[i].type_guid), i);
+		index_add(guid_index, hash_guid(&list.list[i].part_guid), i);
+	}
+}
+
 int load_partition_table(unsigned int image_id)
 {
 	uintptr_t dev_handle, image_handle, image_spec = 0;
@@ -235,69 +466,81 @@ int load_partition_table(unsigned int image_id)
 		return result;
 	}
 
+	list.entry_count = 0;
+	build_indexes();
+
 	result = load_mbr_header(image_handle, &mbr_entry);
 	if (result != 0) {
 		WARN("Failed to access image id=%u (%i)\n", image_id, result);
+		io_close(image_handle);
 		return result;
 	}
 	if (mbr_entry.type == PARTITION_TYPE_GPT) {
-		result = load_gpt_header(image_handle);
-		assert(result == 0);
-		result = io_seek(image_handle, IO_SEEK_SET, GPT_ENTRY_OFFSET);
-		assert(result == 0);
-		result = verify_partition_gpt(image_handle);
+		result = load_partition_gpt(image_handle, &mbr_entry);
 	} else {
 		result = load_mbr_entries(image_handle);
 	}
 
 	io_close(image_handle);
+
+	if (result != 0) {
+		list.entry_count = 0;
+	}
+	build_indexes();
+
 	return result;
 }
 
 const partition_entry_t *get_partition_entry(const char *name)
 {
-	int i;
+	unsigned int slot = hash_name(name) % PARTITION_INDEX_SIZE;
 
-	for (i = 0; i < list.entry_count; i++) {
-		if (strcmp(name, list.list[i].name) == 0) {
-			return &list.list[i];
+	while (name_index[slot] != 0U) {
+		const partition_entry_t *entry = &list.list[name_index[slot] - 1U];
+
+		if (strcmp(name, entry->name) == 0) {
+			return entry;
 		}
+		slot = (slot + 1U) % PARTITION_INDEX_SIZE;
 	}
+
 	return NULL;
 }
 
-/*
- * Try retrieving a partition table entry based on the partition type GUID.
- */
-const partition_entry_t *get_partition_entry_by_type(
-	const struct efi_guid *type_guid)
+static const partition_entry_t *get_partition_entry_by_index(
+	const uint8_t *index, const struct efi_guid *guid, bool type)
 {
-	int i;
+	unsigned int slot = hash_guid(guid) % PARTITION_INDEX_SIZE;
 
-	for (i = 0; i < list.entry_count; i++) {
-		if (guidcmp(type_guid, &list.list[i].type_guid) == 0) {
-			return &list.list[i];
+	while (index[slot] != 0U) {
+		const partition_entry_t *entry = &list.list[index[slot] - 1U];
+
+		if (guidcmp(guid, type ? &entry->type_guid :
+					 &entry->part_guid) == 0) {
+			return entry;
 		}
+		slot = (slot + 1U) % PARTITION_INDEX_SIZE;
 	}
 
 	return NULL;
 }
 
+/*
+ * Try retrieving a partition table entry based on the partition type GUID.
+ */
+const partition_entry_t *get_partition_entry_by_type(
+	const struct efi_guid *type_guid)
+{
+	return get_partition_entry_by_index(type_index, type_guid, true);
+}
+
 /*
  * Try retrieving a partition table entry based on the unique partition GUID.
  */
 const partition_entry_t *get_partition_entry_by_guid(
 	const struct efi_guid *part_guid)
 {
-	int i;
-
-	for (i = 0; i < list.entry_count; i++) {
-		if (guidcmp(part_guid, &list.list[i].part_guid) == 0) {
-			return &list.list[i];
-		}
-	}
-
-	return NULL;
+	return get_partition_entry_by_index(guid_index, part_guid, false);
 }
 
 const partition_entry_list_t *get_partition_entry_list(void)
@@ -365,6 +365,8 @@ uint32_t bsec_write_otp(uint32_t val, uint32_t otp)
 
 	bsec_unlock();
 
+	stm32_otp_cache_invalidate(otp);
+
 	return result;
 }
 
@@ -435,6 +437,8 @@ uint32_t bsec_program_otp(uint32_t val, uint32_t otp)
 
 	bsec_unlock();
 
+	stm32_otp_cache_invalidate(otp);
+
 	if (power_up) {
 		if (bsec_power_safmem(false) != BSEC_OK) {
 			panic();
@@ -504,6 +508,8 @@ uint32_t bsec_permanent_lock_otp(uint32_t otp)
 
 	bsec_unlock();
 
+	stm32_otp_cache_invalidate(otp);
+
 	if (power_up) {
 		if (bsec_power_safmem(false) != BSEC_OK) {
 			panic();
@@ -588,6 +594,8 @@ uint32_t bsec_set_sr_lock(uint32_t otp)
 	mmio_write_32(BSEC_BASE + BSEC_SRLOCK_OFF + bank, otp_mask);
 	bsec_unlock();
 
+	stm32_otp_cache_invalidate(otp);
+
 	return BSEC_OK;
 }
 
@@ -636,6 +644,8 @@ uint32_t bsec_set_sw_lock(uint32_t otp)
 	mmio_write_32(BSEC_BASE + BSEC_SWLOCK_OFF + bank, otp_mask);
 	bsec_unlock();
 
+	stm32_otp_cache_invalidate(otp);
+
 	return BSEC_OK;
 }
 
@@ -684,6 +694,8 @@ uint32_t bsec_set_sp_lock(uint32_t otp)
 	mmio_write_32(BSEC_BASE + BSEC_SPLOCK_OFF + bank, otp_mask);
 	bsec_unlock();
 
+	stm32_otp_cache_invalidate(otp);
+
 	return BSEC_OK;
 }
 
@@ -263,6 +263,8 @@ uint32_t bsec_write_otp(uint32_t val, uint32_t otp)
 
 	mmio_write_32(BSEC_BASE + BSEC_FVR(otp), val);
 
+	stm32_otp_cache_invalidate(otp);
+
 	return BSEC_OK;
 }
 
@@ -308,6 +310,8 @@ uint32_t bsec_program_otp(uint32_t val, uint32_t otp)
 		}
 	}
 
+	stm32_otp_cache_invalidate(otp);
+
 	return result;
 }
 
@@ -360,6 +364,8 @@ uint32_t bsec_set_sr_lock(uint32_t otp)
 		panic();
 	}
 
+	stm32_otp_cache_invalidate(otp);
+
 	return bsec_lock_register_set(BSEC_SRLOCK(bank), otp_mask);
 }
 
@@ -398,6 +404,8 @@ uint32_t bsec_set_sw_lock(uint32_t otp)
 		panic();
 	}
 
+	stm32_otp_cache_invalidate(otp);
+
 	return bsec_lock_register_set(BSEC_SWLOCK(bank), otp_mask);
 }
 
@@ -436,6 +444,8 @@ uint32_t bsec_set_sp_lock(uint32_t otp)
 		panic();
 	}
 
+	stm32_otp_cache_invalidate(otp);
+
 	return bsec_lock_register_set(BSEC_SPLOCK(bank), otp_mask);
 }
 
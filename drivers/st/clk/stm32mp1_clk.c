@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2018-2023, STMicroelectronics - All Rights Reserved
+ * Copyright (C) 2018-2024, STMicroelectronics - All Rights Reserved
  *
  * SPDX-License-Identifier: GPL-2.0+ OR BSD-3-Clause
  */
@@ -21,6 +21,7 @@
 #include <dt-bindings/clock/stm32mp1-clksrc.h>
 #include <lib/mmio.h>
 #include <lib/spinlock.h>
+#include <lib/utils.h>
 #include <lib/utils_def.h>
 #include <libfdt.h>
 #include <plat/common/platform.h>
@@ -2179,6 +2180,75 @@ static int stm32mp1_pll_configure_src(struct stm32_clk_priv *priv, int pll_idx)
 	return stm32_clk_configure_mux(priv, pll_conf->src);
 }
 
+#if STM32MP1_FAST_RESUME
+#define SNAPSHOT_OCENR_MASK	(RCC_OCENR_HSION | RCC_OCENR_HSIKERON | \
+				 RCC_OCENR_CSION | RCC_OCENR_CSIKERON | \
+				 RCC_OCENR_DIGBYP | RCC_OCENR_HSEON | \
+				 RCC_OCENR_HSEKERON | RCC_OCENR_HSEBYP | \
+				 RCC_OCENR_HSECSSON)
+#define SNAPSHOT_BDCR_MASK	(RCC_BDCR_LSEON | RCC_BDCR_LSEBYP | \
+				 RCC_BDCR_DIGBYP | RCC_BDCR_LSEDRV_MASK)
+#define SNAPSHOT_PLLNCR_DIVEN	(RCC_PLLNCR_DIVPEN | RCC_PLLNCR_DIVQEN | \
+				 RCC_PLLNCR_DIVREN)
+
+CASSERT(STM32MP1_CLK_SNAPSHOT_PLL_NB == _PLL_NB, assert_clk_snapshot_pll_nb);
+CASSERT(STM32MP1_CLK_SNAPSHOT_DIV_NB >= ARRAY_SIZE(dividers_mp15),
+	assert_clk_snapshot_div_nb);
+CASSERT(STM32MP1_CLK_SNAPSHOT_MUX_NB == MUX_NB, assert_clk_snapshot_mux_nb);
+
+/*
+ * Read the clock tree from the RCC registers, at suspend: it includes the
+ * changes made by the secure and non-secure worlds since stm32mp1_clk_init().
+ */
+void stm32mp1_clk_get_snapshot(struct stm32mp1_clk_snapshot *snap)
+{
+	struct stm32_clk_priv *priv = clk_stm32_get_priv();
+	unsigned int id;
+
+	zeromem(snap, sizeof(*snap));
+
+	snap->ocenr = mmio_read_32(priv->base + RCC_OCENSETR) &
+		      SNAPSHOT_OCENR_MASK;
+	snap->rdlsicr = mmio_read_32(priv->base + RCC_RDLSICR) &
+			RCC_RDLSICR_LSION;
+	snap->bdcr = mmio_read_32(priv->base + RCC_BDCR) & SNAPSHOT_BDCR_MASK;
+	snap->hsicfgr = mmio_read_32(priv->base + RCC_HSICFGR) &
+			RCC_HSICFGR_HSIDIV_MASK;
+
+	for (id = 0U; id < _PLL_NB; id++) {
+		const struct stm32mp1_clk_pll *pll = pll_ref(id);
+		struct stm32mp1_clk_pll_snapshot *pll_snap = &snap->pll[id];
+
+		pll_snap->cfgr1 = mmio_read_32(priv->base + pll->pllxcfgr1);
+		pll_snap->cfgr2 = mmio_read_32(priv->base + pll->pllxcfgr2);
+		pll_snap->fracr = mmio_read_32(priv->base + pll->pllxfracr);
+		pll_snap->csgr = mmio_read_32(priv->base + pll->pllxcsgr);
+		pll_snap->cr = mmio_read_32(priv->base + pll->pllxcr) &
+			       (RCC_PLLNCR_PLLON | RCC_PLLNCR_SSCG_CTRL |
+				SNAPSHOT_PLLNCR_DIVEN);
+	}
+
+	for (id = 0U; id < priv->nb_div; id++) {
+		const struct div_cfg *divider = &priv->div[id];
+
+		if (divider->width == 0U) {
+			continue;
+		}
+
+		snap->div[id] = (mmio_read_32(priv->base + divider->offset) &
+				 MASK_WIDTH_SHIFT(divider->width,
+						  divider->shift)) >>
+				divider->shift;
+	}
+
+	for (id = 0U; id < priv->nb_parents; id++) {
+		if (id != MUX_RTC) {
+			snap->mux[id] = clk_mux_get_parent(priv, id);
+		}
+	}
+}
+#endif /* STM32MP1_FAST_RESUME */
+
 int stm32mp1_clk_init(uint32_t pll1_freq_khz)
 {
 	struct stm32_clk_priv *priv = clk_stm32_get_priv();
@@ -2407,6 +2477,166 @@ int stm32mp1_clk_init(uint32_t pll1_freq_khz)
 	return 0;
 }
 
+#if STM32MP1_FAST_RESUME
+/*
+ * Same sequence as stm32mp1_clk_init(), with the register values of the
+ * snapshot: only the oscillator, divider, mux and PLL lock waits remain.
+ */
+int stm32mp1_clk_restore_snapshot(const struct stm32mp1_clk_snapshot *snap)
+{
+	struct stm32_clk_priv *priv = clk_stm32_get_priv();
+	struct stm32_clk_platdata *pdata = priv->pdata;
+	uint32_t ocenr = snap->ocenr;
+	enum stm32mp1_pll_id i;
+	unsigned int id;
+	int ret;
+
+	if ((snap->rdlsicr & RCC_RDLSICR_LSION) != 0U) {
+		stm32mp1_lsi_set(true);
+	}
+	if ((snap->bdcr & RCC_BDCR_LSEON) != 0U) {
+		stm32mp1_lse_enable((snap->bdcr & RCC_BDCR_LSEBYP) != 0U,
+				    (snap->bdcr & RCC_BDCR_DIGBYP) != 0U,
+				    (snap->bdcr & RCC_BDCR_LSEDRV_MASK) >>
+				    RCC_BDCR_LSEDRV_SHIFT);
+	}
+	if ((ocenr & RCC_OCENR_HSEON) != 0U) {
+		stm32mp1_hse_enable((ocenr & RCC_OCENR_HSEBYP) != 0U,
+				    (ocenr & RCC_OCENR_DIGBYP) != 0U,
+				    (ocenr & RCC_OCENR_HSECSSON) != 0U);
+	}
+	stm32mp1_csi_set(true);
+
+	/* Come back to HSI */
+	for (id = MUX_MPU; id <= MUX_MCU; id++) {
+		ret = clk_mux_set_parent(priv, id, 0U);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	for (i = (enum stm32mp1_pll_id)0; i < _PLL_NB; i++) {
+		ret = stm32mp1_pll_stop(i);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	if ((snap->hsicfgr & RCC_HSICFGR_HSIDIV_MASK) != 0U) {
+		ret = stm32mp1_set_hsidiv(snap->hsicfgr &
+					  RCC_HSICFGR_HSIDIV_MASK);
+		if (ret != 0) {
+			return ret;
+		}
+
+		stm32mp_stgen_config(stm32mp_clk_get_rate(STGEN_K));
+	}
+
+	for (id = 0U; id < priv->nb_div; id++) {
+		if (priv->div[id].width == 0U) {
+			continue;
+		}
+
+		ret = clk_stm32_set_div(priv, id, snap->div[id]);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	/* PLLs source, then configure and start the PLLs together */
+	for (id = MUX_PLL12; id <= MUX_PLL4; id++) {
+		ret = clk_mux_set_parent(priv, id, snap->mux[id]);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	for (i = (enum stm32mp1_pll_id)0; i < _PLL_NB; i++) {
+		const struct stm32mp1_clk_pll *pll = pll_ref(i);
+		const struct stm32mp1_clk_pll_snapshot *pll_snap = &snap->pll[i];
+
+		if ((pll_snap->cr & RCC_PLLNCR_PLLON) == 0U) {
+			continue;
+		}
+
+		mmio_write_32(priv->base + pll->pllxcfgr1, pll_snap->cfgr1);
+		mmio_write_32(priv->base + pll->pllxfracr, 0U);
+		mmio_write_32(priv->base + pll->pllxfracr,
+			      pll_snap->fracr & ~RCC_PLLNFRACR_FRACLE);
+		mmio_write_32(priv->base + pll->pllxfracr, pll_snap->fracr);
+		mmio_write_32(priv->base + pll->pllxcfgr2, pll_snap->cfgr2);
+
+		if ((pll_snap->cr & RCC_PLLNCR_SSCG_CTRL) != 0U) {
+			mmio_write_32(priv->base + pll->pllxcsgr,
+				      pll_snap->csgr);
+			mmio_setbits_32(priv->base + pll->pllxcr,
+					RCC_PLLNCR_SSCG_CTRL);
+		}
+
+		stm32mp1_pll_start(i);
+	}
+
+	for (i = (enum stm32mp1_pll_id)0; i < _PLL_NB; i++) {
+		uint32_t cr = snap->pll[i].cr;
+
+		if ((cr & RCC_PLLNCR_PLLON) == 0U) {
+			continue;
+		}
+
+		ret = stm32mp1_pll_output(i, (cr & SNAPSHOT_PLLNCR_DIVEN) >>
+					  RCC_PLLNCR_DIVEN_SHIFT);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	if ((snap->bdcr & RCC_BDCR_LSEON) != 0U) {
+		stm32mp1_lse_wait();
+	}
+
+	/*
+	 * Kernel clock sources, CKPER last as in stm32_clk_source_configure().
+	 * RTC is in the backup domain, kept in Standby.
+	 */
+	for (id = MUX_MPU; id < MUX_NB; id++) {
+		if ((id >= MUX_PLL12) && (id <= MUX_RTC)) {
+			continue;
+		}
+
+		ret = clk_mux_set_parent(priv, id, snap->mux[id]);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	ret = clk_mux_set_parent(priv, MUX_CKPER, snap->mux[MUX_CKPER]);
+	if (ret != 0) {
+		return ret;
+	}
+
+	for (id = 0U; id < pdata->nclksrc; id++) {
+		if ((pdata->clksrc[id] & CMD_ADDR_BIT) != 0U) {
+			stm32_clk_configure_by_addr_val(priv, pdata->clksrc[id] &
+							~CMD_ADDR_BIT);
+		}
+	}
+
+	if ((ocenr & RCC_OCENR_HSION) == 0U) {
+		stm32mp1_hsi_set(false);
+	}
+
+	stm32mp_stgen_config(stm32mp_clk_get_rate(STGEN_K));
+
+	/* Software Self-Refresh mode (SSR) during DDR initilialization */
+	mmio_clrsetbits_32(priv->base + RCC_DDRITFCR,
+			   RCC_DDRITFCR_DDRCKMOD_MASK,
+			   RCC_DDRITFCR_DDRCKMOD_SSR <<
+			   RCC_DDRITFCR_DDRCKMOD_SHIFT);
+
+	return 0;
+}
+#endif /* STM32MP1_FAST_RESUME */
+
 static void stm32mp1_osc_clk_init(const char *name,
 				  enum stm32mp_osc_id index)
 {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2022-2023, STMicroelectronics - All Rights Reserved
+ * Copyright (c) 2022-2024, STMicroelectronics - All Rights Reserved
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -259,6 +259,17 @@ static const struct curve_parameters curve_def[] = {
 
 static struct stm32_pka_platdata pka_pdata;
 
+/*
+ * PKA state kept between two ECDSA verifications. Disabling the PKA clears its
+ * RAM, so it stays enabled to keep the curve parameters loaded.
+ */
+static struct {
+	bool clocked;
+	bool enabled;
+	bool curve_loaded;
+	enum stm32_pka_ecdsa_curve_id cid;
+} pka_state;
+
 static int stm32_pka_parse_fdt(void)
 {
 	int node;
@@ -585,6 +596,7 @@ int stm32_pka_init(void)
 	}
 
 	clk_enable(pka_pdata.clock_id);
+	pka_state.clocked = true;
 
 	if (stm32mp_reset_assert((unsigned long)pka_pdata.reset_id, TIMEOUT_US_1MS) != 0) {
 		panic();
@@ -606,7 +618,11 @@ int stm32_pka_init(void)
 	return 0;
 }
 
-int stm32_pka_ecdsa_verif(void *hash, unsigned int hash_size,
+/*
+ * Load the operands of an ECDSA verification in PKA RAM. The curve parameters
+ * are only written when they differ from the ones already loaded.
+ */
+static int pka_ecdsa_load(uintptr_t base, void *hash, unsigned int hash_size,
 			  void *sig_r_ptr, unsigned int sig_r_size,
 			  void *sig_s_ptr, unsigned int sig_s_size,
 			  void *pk_x_ptr, unsigned int pk_x_size,
@@ -614,89 +630,149 @@ int stm32_pka_ecdsa_verif(void *hash, unsigned int hash_size,
 			  enum stm32_pka_ecdsa_curve_id cid)
 {
 	int ret;
-	uintptr_t base = pka_pdata.base;
 	unsigned int eo_nbw = get_ecc_op_nbword(cid);
 
-	if ((hash == NULL) || (sig_r_ptr == NULL) || (sig_s_ptr == NULL) ||
-	    (pk_x_ptr == NULL) || (pk_y_ptr == NULL)) {
-		INFO("%s invalid input param\n", __func__);
-		return -EINVAL;
-	}
-
-	ret = stm32_pka_ecdsa_check_param(sig_r_ptr, sig_r_size,
-					  sig_s_ptr, sig_s_size,
-					  pk_x_ptr, pk_x_size,
-					  pk_y_ptr, pk_y_size,
-					  cid);
-	if (ret < 0) {
-		INFO("%s check param error %d\n", __func__, ret);
-		goto out;
-	}
+	/* With curve id values */
+	if (!pka_state.curve_loaded || (pka_state.cid != cid)) {
+		pka_state.curve_loaded = false;
 
-	if ((mmio_read_32(base + _PKA_SR) & _PKA_SR_BUSY) == _PKA_SR_BUSY) {
-		INFO("%s busy\n", __func__);
-		ret = -EBUSY;
-		goto out;
-	}
+		ret = stm32_pka_ecdsa_verif_configure_curve(base, cid);
+		if (ret < 0) {
+			return ret;
+		}
 
-	/* Fill PKA RAM */
-	/* With curve id values */
-	ret = stm32_pka_ecdsa_verif_configure_curve(base, cid);
-	if (ret < 0) {
-		goto out;
+		pka_state.curve_loaded = true;
+		pka_state.cid = cid;
 	}
 
 	/* With pubkey */
 	ret = write_eo_data(base + _PKA_RAM_XQ, pk_x_ptr, pk_x_size, eo_nbw);
 	if (ret < 0) {
-		goto out;
+		return ret;
 	}
 
 	ret = write_eo_data(base + _PKA_RAM_YQ, pk_y_ptr, pk_y_size, eo_nbw);
 	if (ret < 0) {
-		goto out;
+		return ret;
 	}
 
 	/* With hash */
 	ret = write_eo_data(base + _PKA_RAM_HASH_Z, hash, hash_size, eo_nbw);
 	if (ret < 0) {
-		goto out;
+		return ret;
 	}
 
 	/* With signature */
 	ret = write_eo_data(base + _PKA_RAM_SIGN_R, sig_r_ptr, sig_r_size, eo_nbw);
 	if (ret < 0) {
-		goto out;
+		return ret;
+	}
+
+	return write_eo_data(base + _PKA_RAM_SIGN_S, sig_s_ptr, sig_s_size, eo_nbw);
+}
+
+static void pka_ecdsa_stop(uintptr_t base)
+{
+	/* Disable PKA (will stop all pending proccess and reset RAM) */
+	pka_disable(base);
+
+	pka_state.enabled = false;
+	pka_state.curve_loaded = false;
+}
+
+/*
+ * @brief  Verify an ECDSA signature.
+ * @note   The PKA is left enabled with the curve parameters loaded, so that a
+ *         following verification on the same curve only loads its operands.
+ *         stm32_pka_release() disables it.
+ * @retval 0 if the signature is valid, negative value else.
+ */
+int stm32_pka_ecdsa_verif(void *hash, unsigned int hash_size,
+			  void *sig_r_ptr, unsigned int sig_r_size,
+			  void *sig_s_ptr, unsigned int sig_s_size,
+			  void *pk_x_ptr, unsigned int pk_x_size,
+			  void *pk_y_ptr, unsigned int pk_y_size,
+			  enum stm32_pka_ecdsa_curve_id cid)
+{
+	int ret;
+	uintptr_t base = pka_pdata.base;
+
+	if ((hash == NULL) || (sig_r_ptr == NULL) || (sig_s_ptr == NULL) ||
+	    (pk_x_ptr == NULL) || (pk_y_ptr == NULL)) {
+		INFO("%s invalid input param\n", __func__);
+		return -EINVAL;
 	}
 
-	ret = write_eo_data(base + _PKA_RAM_SIGN_S, sig_s_ptr, sig_s_size, eo_nbw);
+	ret = stm32_pka_ecdsa_check_param(sig_r_ptr, sig_r_size,
+					  sig_s_ptr, sig_s_size,
+					  pk_x_ptr, pk_x_size,
+					  pk_y_ptr, pk_y_size,
+					  cid);
 	if (ret < 0) {
-		goto out;
+		INFO("%s check param error %d\n", __func__, ret);
+		return ret;
 	}
 
-	/* Set mode to ecdsa signature verification */
-	ret = pka_enable(base, _PKA_CR_MODE_ECDSA_VERIF);
+	if (!pka_state.enabled &&
+	    ((mmio_read_32(base + _PKA_SR) & _PKA_SR_BUSY) == _PKA_SR_BUSY)) {
+		INFO("%s busy\n", __func__);
+		return -EBUSY;
+	}
+
+	/* Fill PKA RAM */
+	ret = pka_ecdsa_load(base, hash, hash_size, sig_r_ptr, sig_r_size,
+			     sig_s_ptr, sig_s_size, pk_x_ptr, pk_x_size,
+			     pk_y_ptr, pk_y_size, cid);
 	if (ret < 0) {
-		WARN("%s set mode pka error %d\n", __func__, ret);
-		goto out;
+		goto err;
+	}
+
+	if (!pka_state.enabled) {
+		/* Set mode to ecdsa signature verification */
+		ret = pka_enable(base, _PKA_CR_MODE_ECDSA_VERIF);
+		if (ret < 0) {
+			WARN("%s set mode pka error %d\n", __func__, ret);
+			goto err;
+		}
+
+		pka_state.enabled = true;
 	}
 
 	/* Start processing and wait end */
 	ret = stm32_pka_process(base);
 	if (ret < 0) {
 		WARN("%s process error %d\n", __func__, ret);
-		goto out;
+		goto err;
 	}
 
 	/* Check return status */
 	ret = stm32_pka_ecdsa_verif_check_return(base);
 
-	/* Unset end proc */
-	mmio_setbits_32(base + _PKA_CLRFR, _PKA_IT_PROCEND);
+	/* Unset end proc, and errors as the PKA stays enabled */
+	mmio_setbits_32(base + _PKA_CLRFR, _PKA_IT_MASK);
 
-out:
-	/* Disable PKA (will stop all pending proccess and reset RAM) */
-	pka_disable(base);
+	return ret;
+
+err:
+	pka_ecdsa_stop(base);
 
 	return ret;
 }
+
+/*
+ * @brief  Disable the PKA, which clears the curve parameters kept loaded
+ *         between two ECDSA verifications, and gate its clock.
+ * @param  None.
+ * @retval None.
+ */
+void stm32_pka_release(void)
+{
+	if (pka_state.enabled) {
+		pka_ecdsa_stop(pka_pdata.base);
+	}
+
+	if (pka_state.clocked) {
+		clk_disable(pka_pdata.clock_id);
+		pka_state.clocked = false;
+	}
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+
+#include <arch_helpers.h>
+#include <common/debug.h>
+#include <drivers/st/stm32mp_ddr_scrub.h>
+#include <lib/utils.h>
+#include <lib/utils_def.h>
+
+#include <platform_def.h>
+#if STM32MP_BL2_WORKER
+#include <stm32mp_worker.h>
+#endif
+
+/*
+ * Lines are zeroed in the data cache, then cleaned while they are still there,
+ * so that the DDR is written with full line bursts. Keep the chunk below the
+ * L2 cache size.
+ */
+#define DDR_SCRUB_CHUNK_SIZE	U(0x10000)
+
+struct ddr_scrub_range {
+	uintptr_t base;
+	size_t size;
+};
+
+static int ddr_scrub_range(void *arg)
+{
+	struct ddr_scrub_range *range = arg;
+	uintptr_t end = range->base + range->size;
+	uintptr_t addr;
+	size_t len;
+
+	for (addr = range->base; addr < end; addr += len) {
+		len = MIN((size_t)DDR_SCRUB_CHUNK_SIZE, (size_t)(end - addr));
+
+		zero_normalmem((void *)addr, len);
+		flush_dcache_range(addr, len);
+	}
+
+	return 0;
+}
+
+/*******************************************************************************
+ * This function writes zeros to a DDR region through the memory encryption
+ * (MCE or RISAF), so that it reads back as zeros once decrypted. The region
+ * must be mapped as cacheable normal memory. With the BL2 worker, the upper
+ * half of the region is scrubbed by the secondary core.
+ * Returns 0 if success, and a negative value else.
+ ******************************************************************************/
+int stm32mp_ddr_scrub(uintptr_t base, size_t size)
+{
+	uintptr_t ddr_end = STM32MP_DDR_BASE + dt_get_ddr_size();
+	uint64_t start = read_cntpct_el0();
+	struct ddr_scrub_range low = { .base = base, .size = size };
+	unsigned int cores = 1U;
+	uint64_t us;
+#if STM32MP_BL2_WORKER
+	struct ddr_scrub_range high;
+	struct stm32mp_worker_job job = {
+		.func = ddr_scrub_range,
+		.arg = &high,
+	};
+#endif
+
+	if ((base < STM32MP_DDR_BASE) || (size == 0U) || (base >= ddr_end) ||
+	    (size > (ddr_end - base))) {
+		return -EINVAL;
+	}
+
+#if STM32MP_BL2_WORKER
+	/* Split on a chunk, regions below two chunks are not worth a job */
+	high.size = round_down(size / 2U, (size_t)DDR_SCRUB_CHUNK_SIZE);
+	if (stm32mp_worker_is_running() && (high.size != 0U)) {
+		low.size = size - high.size;
+		high.base = base + low.size;
+		stm32mp_worker_submit(&job);
+		cores++;
+	}
+#endif
+
+	(void)ddr_scrub_range(&low);
+
+#if STM32MP_BL2_WORKER
+	if (cores > 1U) {
+		(void)stm32mp_worker_wait(&job);
+	}
+#endif
+
+	us = ((read_cntpct_el0() - start) * 1000000U) / read_cntfrq_el0();
+	if (us == 0U) {
+		us = 1U;
+	}
+
+	INFO("DDR: 0x%lx bytes scrubbed at 0x%lx by %u core(s) in %lu us (%lu MB/s)\n",
+	     (unsigned long)size, (unsigned long)base, cores, (unsigned long)us,
+	     (unsigned long)(size / us));
+
+	return 0;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2022, STMicroelectronics - All Rights Reserved
+ * Copyright (c) 2016-2024, STMicroelectronics - All Rights Reserved
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -16,6 +16,7 @@
 #include <drivers/st/stm32mp_clkfunc.h>
 #include <dt-bindings/gpio/stm32-gpio.h>
 #include <lib/mmio.h>
+#include <lib/utils.h>
 #include <lib/utils_def.h>
 #include <libfdt.h>
 
@@ -27,9 +28,49 @@
 #define DT_GPIO_PIN_MASK	GENMASK(11, 8)
 #define DT_GPIO_MODE_MASK	GENMASK(7, 0)
 
-static void set_gpio(uint32_t bank, uint32_t pin, uint32_t mode, uint32_t type,
-		     uint32_t speed, uint32_t pull, uint32_t od,
-		     uint32_t alternate, uint8_t status);
+/* Number of banks gathered in a batch before its registers are written */
+#define GPIO_BATCH_MAX_BANKS	4U
+
+enum gpio_batch_reg {
+	GPIO_BATCH_MODE,
+	GPIO_BATCH_TYPE,
+	GPIO_BATCH_SPEED,
+	GPIO_BATCH_PUPD,
+	GPIO_BATCH_AFRL,
+	GPIO_BATCH_AFRH,
+	GPIO_BATCH_OD,
+	GPIO_BATCH_NB_REGS
+};
+
+/* Registers of a bank batch, in the order they are written */
+static const uint32_t gpio_batch_offset[GPIO_BATCH_NB_REGS] = {
+	[GPIO_BATCH_MODE] = GPIO_MODE_OFFSET,
+	[GPIO_BATCH_TYPE] = GPIO_TYPE_OFFSET,
+	[GPIO_BATCH_SPEED] = GPIO_SPEED_OFFSET,
+	[GPIO_BATCH_PUPD] = GPIO_PUPD_OFFSET,
+	[GPIO_BATCH_AFRL] = GPIO_AFRL_OFFSET,
+	[GPIO_BATCH_AFRH] = GPIO_AFRH_OFFSET,
+	[GPIO_BATCH_OD] = GPIO_OD_OFFSET,
+};
+
+/*
+ * Configuration of the pins of a bank: the fields of all the pins are merged
+ * in the register images so that each register is written once.
+ */
+struct gpio_bank_batch {
+	uint32_t bank;
+	uint32_t pins;
+	uint32_t mask[GPIO_BATCH_NB_REGS];
+	uint32_t value[GPIO_BATCH_NB_REGS];
+};
+
+struct gpio_batch {
+	struct gpio_bank_batch banks[GPIO_BATCH_MAX_BANKS];
+	unsigned int nb_banks;
+	/* Banks whose DT node was already checked */
+	uint32_t checked_banks;
+	uint8_t status;
+};
 
 /*******************************************************************************
  * This function gets GPIO bank node in DT.
@@ -62,12 +103,156 @@ static int ckeck_gpio_bank(void *fdt, uint32_t bank, int pinctrl_node)
 	return 0;
 }
 
+static void set_gpio_bank_secure_cfg(uint32_t bank, uint32_t pins, bool secure)
+{
+	uintptr_t base = stm32_get_gpio_bank_base(bank);
+	unsigned long clock = stm32_get_gpio_bank_clock(bank);
+
+	clk_enable(clock);
+
+	if (secure) {
+		mmio_setbits_32(base + GPIO_SECR_OFFSET, pins);
+	} else {
+		mmio_clrbits_32(base + GPIO_SECR_OFFSET, pins);
+	}
+
+	clk_disable(clock);
+}
+
+static void gpio_batch_init(struct gpio_batch *batch, uint8_t status)
+{
+	zeromem(batch, sizeof(*batch));
+	batch->status = status;
+}
+
 /*******************************************************************************
- * This function gets the pin settings from DT information.
- * When analyze and parsing is done, set the GPIO registers.
+ * This function writes the registers of all the banks of a batch, each one
+ * once, then sets the secure configuration of the pins. The batch is emptied.
+ ******************************************************************************/
+static void gpio_batch_apply(struct gpio_batch *batch)
+{
+	unsigned int i;
+
+	for (i = 0U; i < batch->nb_banks; i++) {
+		struct gpio_bank_batch *bb = &batch->banks[i];
+		uintptr_t base = stm32_get_gpio_bank_base(bb->bank);
+		unsigned long clock = stm32_get_gpio_bank_clock(bb->bank);
+		unsigned int r;
+
+		clk_enable(clock);
+
+		for (r = 0U; r < GPIO_BATCH_NB_REGS; r++) {
+			if (bb->mask[r] != 0U) {
+				mmio_clrsetbits_32(base + gpio_batch_offset[r],
+						   bb->mask[r], bb->value[r]);
+			}
+		}
+
+		VERBOSE("GPIO %u mode set to 0x%x\n", bb->bank,
+			mmio_read_32(base + GPIO_MODE_OFFSET));
+		VERBOSE("GPIO %u type set to 0x%x\n", bb->bank,
+			mmio_read_32(base + GPIO_TYPE_OFFSET));
+		VERBOSE("GPIO %u speed set to 0x%x\n", bb->bank,
+			mmio_read_32(base + GPIO_SPEED_OFFSET));
+		VERBOSE("GPIO %u mode pull to 0x%x\n", bb->bank,
+			mmio_read_32(base + GPIO_PUPD_OFFSET));
+		VERBOSE("GPIO %u mode alternate low to 0x%x\n", bb->bank,
+			mmio_read_32(base + GPIO_AFRL_OFFSET));
+		VERBOSE("GPIO %u mode alternate high to 0x%x\n", bb->bank,
+			mmio_read_32(base + GPIO_AFRH_OFFSET));
+		VERBOSE("GPIO %u output data set to 0x%x\n", bb->bank,
+			mmio_read_32(base + GPIO_OD_OFFSET));
+
+		clk_disable(clock);
+
+#if STM32MP25
+		set_gpio_bank_secure_cfg(bb->bank, bb->pins, true);
+#else
+		for (r = 0U; r <= GPIO_PIN_MAX; r++) {
+			if ((bb->pins & BIT(r)) == 0U) {
+				continue;
+			}
+
+			if (batch->status == DT_SECURE) {
+				stm32mp_register_secure_gpio(bb->bank, r);
+			} else {
+				stm32mp_register_non_secure_gpio(bb->bank, r);
+			}
+		}
+
+#if !IMAGE_BL2
+		set_gpio_bank_secure_cfg(bb->bank, bb->pins,
+					 batch->status == DT_SECURE);
+#endif
+#endif
+	}
+
+	gpio_batch_init(batch, batch->status);
+}
+
+static void gpio_batch_set(struct gpio_bank_batch *bb, enum gpio_batch_reg reg,
+			   uint32_t field_mask, uint32_t shift, uint32_t value)
+{
+	bb->mask[reg] |= field_mask << shift;
+	bb->value[reg] &= ~(field_mask << shift);
+	bb->value[reg] |= (value & field_mask) << shift;
+}
+
+/*******************************************************************************
+ * This function adds the configuration of a pin to a batch. The batch is
+ * applied first if the bank is new and there is no room left for it.
+ ******************************************************************************/
+static void gpio_batch_add(struct gpio_batch *batch, uint32_t bank,
+			   uint32_t pin, uint32_t mode, uint32_t type,
+			   uint32_t speed, uint32_t pull, uint32_t od,
+			   uint32_t alternate)
+{
+	struct gpio_bank_batch *bb = NULL;
+	unsigned int i;
+
+	assert(pin <= GPIO_PIN_MAX);
+
+	for (i = 0U; i < batch->nb_banks; i++) {
+		if (batch->banks[i].bank == bank) {
+			bb = &batch->banks[i];
+			break;
+		}
+	}
+
+	if (bb == NULL) {
+		if (batch->nb_banks == GPIO_BATCH_MAX_BANKS) {
+			gpio_batch_apply(batch);
+		}
+
+		bb = &batch->banks[batch->nb_banks];
+		batch->nb_banks++;
+		bb->bank = bank;
+	}
+
+	bb->pins |= BIT(pin);
+
+	gpio_batch_set(bb, GPIO_BATCH_MODE, GPIO_MODE_MASK, pin << 1, mode);
+	gpio_batch_set(bb, GPIO_BATCH_TYPE, GPIO_TYPE_MASK, pin, type);
+	gpio_batch_set(bb, GPIO_BATCH_SPEED, GPIO_SPEED_MASK, pin << 1, speed);
+	gpio_batch_set(bb, GPIO_BATCH_PUPD, GPIO_PULL_MASK, pin << 1, pull);
+
+	if (pin < GPIO_ALT_LOWER_LIMIT) {
+		gpio_batch_set(bb, GPIO_BATCH_AFRL, GPIO_ALTERNATE_MASK,
+			       pin << 2, alternate);
+	} else {
+		gpio_batch_set(bb, GPIO_BATCH_AFRH, GPIO_ALTERNATE_MASK,
+			       (pin - GPIO_ALT_LOWER_LIMIT) << 2, alternate);
+	}
+
+	gpio_batch_set(bb, GPIO_BATCH_OD, GPIO_OD_MASK, pin, od);
+}
+
+/*******************************************************************************
+ * This function gets the pin settings from DT information and adds them to
+ * the batch, the GPIO registers are set when the batch is applied.
  * Returns 0 on success and a negative FDT error code on failure.
  ******************************************************************************/
-static int dt_set_gpio_config(void *fdt, int node, uint8_t status)
+static int dt_set_gpio_config(void *fdt, int node, struct gpio_batch *batch)
 {
 	const fdt32_t *cuint, *slewrate;
 	int len;
@@ -75,6 +260,9 @@ static int dt_set_gpio_config(void *fdt, int node, uint8_t status)
 	uint32_t i;
 	uint32_t speed = GPIO_SPEED_LOW;
 	uint32_t pull = GPIO_NO_PULL;
+	uint32_t type = GPIO_TYPE_PUSH_PULL;
+	bool output_high;
+	bool output_low;
 
 	cuint = fdt_getprop(fdt, node, "pinmux", &len);
 	if (cuint == NULL) {
@@ -99,16 +287,20 @@ static int dt_set_gpio_config(void *fdt, int node, uint8_t status)
 		VERBOSE("No bias configured in node %d\n", node);
 	}
 
+	if (fdt_getprop(fdt, node, "drive-open-drain", NULL) != NULL) {
+		type = GPIO_TYPE_OPEN_DRAIN;
+	}
+
+	output_high = fdt_getprop(fdt, node, "output-high", NULL) != NULL;
+	output_low = fdt_getprop(fdt, node, "output-low", NULL) != NULL;
+
 	for (i = 0U; i < ((uint32_t)len / sizeof(uint32_t)); i++) {
 		uint32_t pincfg;
 		uint32_t bank;
 		uint32_t pin;
 		uint32_t mode;
 		uint32_t alternate = GPIO_ALTERNATE_(0);
-		uint32_t type;
 		uint32_t od = GPIO_OD_OUTPUT_LOW;
-		int bank_node;
-		int clk;
 
 		pincfg = fdt32_to_cpu(*cuint);
 		cuint++;
@@ -135,41 +327,41 @@ static int dt_set_gpio_config(void *fdt, int node, uint8_t status)
 			break;
 		}
 
-		if (fdt_getprop(fdt, node, "drive-open-drain", NULL) != NULL) {
-			type = GPIO_TYPE_OPEN_DRAIN;
-		} else {
-			type = GPIO_TYPE_PUSH_PULL;
+		if (output_high && (mode == GPIO_MODE_INPUT)) {
+			mode = GPIO_MODE_OUTPUT;
+			od = GPIO_OD_OUTPUT_HIGH;
 		}
 
-		if (fdt_getprop(fdt, node, "output-high", NULL) != NULL) {
-			if (mode == GPIO_MODE_INPUT) {
-				mode = GPIO_MODE_OUTPUT;
-				od = GPIO_OD_OUTPUT_HIGH;
-			}
+		if (output_low && (mode == GPIO_MODE_INPUT)) {
+			mode = GPIO_MODE_OUTPUT;
+			od = GPIO_OD_OUTPUT_LOW;
 		}
 
-		if (fdt_getprop(fdt, node, "output-low", NULL) != NULL) {
-			if (mode == GPIO_MODE_INPUT) {
-				mode = GPIO_MODE_OUTPUT;
-				od = GPIO_OD_OUTPUT_LOW;
+		/* The bank node is checked once per batch */
+		if ((batch->checked_banks & BIT(bank)) == 0U) {
+			int bank_node;
+			int clk;
+
+			bank_node = ckeck_gpio_bank(fdt, bank, pinctrl_node);
+			if (bank_node == 0) {
+				ERROR("PINCTRL inconsistent in DT\n");
+				panic();
 			}
-		}
 
-		bank_node = ckeck_gpio_bank(fdt, bank, pinctrl_node);
-		if (bank_node == 0) {
-			ERROR("PINCTRL inconsistent in DT\n");
-			panic();
-		}
+			clk = fdt_get_clock_id(bank_node);
+			if (clk < 0) {
+				return -FDT_ERR_NOTFOUND;
+			}
 
-		clk = fdt_get_clock_id(bank_node);
-		if (clk < 0) {
-			return -FDT_ERR_NOTFOUND;
-		}
+			/* Platform knows the clock: assert it is okay */
+			assert((unsigned long)clk ==
+			       stm32_get_gpio_bank_clock(bank));
 
-		/* Platform knows the clock: assert it is okay */
-		assert((unsigned long)clk == stm32_get_gpio_bank_clock(bank));
+			batch->checked_banks |= BIT(bank);
+		}
 
-		set_gpio(bank, pin, mode, type, speed, pull, od, alternate, status);
+		gpio_batch_add(batch, bank, pin, mode, type, speed, pull, od,
+			       alternate);
 	}
 
 	return 0;
@@ -187,6 +379,8 @@ int dt_set_pinctrl_config(int node)
 	uint32_t i;
 	uint8_t status;
 	void *fdt;
+	struct gpio_batch batch;
+	int ret = 0;
 
 	if (fdt_get_address(&fdt) == 0) {
 		return -FDT_ERR_NOTFOUND;
@@ -202,122 +396,81 @@ int dt_set_pinctrl_config(int node)
 		return -FDT_ERR_NOTFOUND;
 	}
 
+	/*
+	 * All the pins of all the groups are gathered, then each register of
+	 * a bank is written once.
+	 */
+	gpio_batch_init(&batch, status);
+
 	for (i = 0; i < ((uint32_t)lenp / 4U); i++) {
 		int p_node, p_subnode;
 
 		p_node = fdt_node_offset_by_phandle(fdt, fdt32_to_cpu(*cuint));
 		if (p_node < 0) {
-			return -FDT_ERR_NOTFOUND;
+			ret = -FDT_ERR_NOTFOUND;
+			break;
 		}
 
 		fdt_for_each_subnode(p_subnode, fdt, p_node) {
-			int ret = dt_set_gpio_config(fdt, p_subnode, status);
-
+			ret = dt_set_gpio_config(fdt, p_subnode, &batch);
 			if (ret < 0) {
-				return ret;
+				break;
 			}
 		}
 
+		if (ret < 0) {
+			break;
+		}
+
 		cuint++;
 	}
 
-	return 0;
+	/* Pins parsed before an error are set, as when set one by one */
+	gpio_batch_apply(&batch);
+
+	return ret;
 }
 
 static void set_gpio(uint32_t bank, uint32_t pin, uint32_t mode, uint32_t type,
 		     uint32_t speed, uint32_t pull, uint32_t od,
 		     uint32_t alternate, uint8_t status)
 {
-	uintptr_t base = stm32_get_gpio_bank_base(bank);
-	unsigned long clock = stm32_get_gpio_bank_clock(bank);
-
-	assert(pin <= GPIO_PIN_MAX);
-
-	clk_enable(clock);
-
-	mmio_clrsetbits_32(base + GPIO_MODE_OFFSET,
-			   (uint32_t)GPIO_MODE_MASK << (pin << 1),
-			   mode << (pin << 1));
+	struct gpio_batch batch;
 
-	mmio_clrsetbits_32(base + GPIO_TYPE_OFFSET,
-			   (uint32_t)GPIO_TYPE_MASK << pin,
-			   type << pin);
-
-	mmio_clrsetbits_32(base + GPIO_SPEED_OFFSET,
-			   (uint32_t)GPIO_SPEED_MASK << (pin << 1),
-			   speed << (pin << 1));
-
-	mmio_clrsetbits_32(base + GPIO_PUPD_OFFSET,
-			   (uint32_t)GPIO_PULL_MASK << (pin << 1),
-			   pull << (pin << 1));
+	gpio_batch_init(&batch, status);
+	gpio_batch_add(&batch, bank, pin, mode, type, speed, pull, od,
+		       alternate);
+	gpio_batch_apply(&batch);
+}
 
-	if (pin < GPIO_ALT_LOWER_LIMIT) {
-		mmio_clrsetbits_32(base + GPIO_AFRL_OFFSET,
-				   (uint32_t)GPIO_ALTERNATE_MASK << (pin << 2),
-				   alternate << (pin << 2));
-	} else {
-		uint32_t shift = (pin - GPIO_ALT_LOWER_LIMIT) << 2;
+void set_gpio_secure_cfg(uint32_t bank, uint32_t pin, bool secure)
+{
+	assert(pin <= GPIO_PIN_MAX);
 
-		mmio_clrsetbits_32(base + GPIO_AFRH_OFFSET,
-				   (uint32_t)GPIO_ALTERNATE_MASK << shift,
-				   alternate << shift);
-	}
+	set_gpio_bank_secure_cfg(bank, BIT(pin), secure);
+}
 
-	mmio_clrsetbits_32(base + GPIO_OD_OFFSET,
-			   (uint32_t)GPIO_OD_MASK << pin,
-			   od << pin);
-
-	VERBOSE("GPIO %u mode set to 0x%x\n", bank,
-		mmio_read_32(base + GPIO_MODE_OFFSET));
-	VERBOSE("GPIO %u type set to 0x%x\n", bank,
-		mmio_read_32(base + GPIO_TYPE_OFFSET));
-	VERBOSE("GPIO %u speed set to 0x%x\n", bank,
-		mmio_read_32(base + GPIO_SPEED_OFFSET));
-	VERBOSE("GPIO %u mode pull to 0x%x\n", bank,
-		mmio_read_32(base + GPIO_PUPD_OFFSET));
-	VERBOSE("GPIO %u mode alternate low to 0x%x\n", bank,
-		mmio_read_32(base + GPIO_AFRL_OFFSET));
-	VERBOSE("GPIO %u mode alternate high to 0x%x\n", bank,
-		mmio_read_32(base + GPIO_AFRH_OFFSET));
-	VERBOSE("GPIO %u output data set to 0x%x\n", bank,
-		mmio_read_32(base + GPIO_OD_OFFSET));
+/* Secure configuration of all the pins of a bank, one bit per pin */
+uint32_t get_gpio_bank_secure_cfg(uint32_t bank)
+{
+	uintptr_t base = stm32_get_gpio_bank_base(bank);
+	unsigned long clock = stm32_get_gpio_bank_clock(bank);
+	uint32_t secure_pins;
 
+	clk_enable(clock);
+	secure_pins = mmio_read_32(base + GPIO_SECR_OFFSET);
 	clk_disable(clock);
 
-#if STM32MP25
-	set_gpio_secure_cfg(bank, pin, true);
-#else
-
-	if (status == DT_SECURE) {
-		stm32mp_register_secure_gpio(bank, pin);
-#if !IMAGE_BL2
-		set_gpio_secure_cfg(bank, pin, true);
-#endif
-
-	} else {
-		stm32mp_register_non_secure_gpio(bank, pin);
-#if !IMAGE_BL2
-		set_gpio_secure_cfg(bank, pin, false);
-#endif
-	}
-#endif
+	return secure_pins;
 }
 
-void set_gpio_secure_cfg(uint32_t bank, uint32_t pin, bool secure)
+void restore_gpio_bank_secure_cfg(uint32_t bank, uint32_t secure_pins)
 {
 	uintptr_t base = stm32_get_gpio_bank_base(bank);
 	unsigned long clock = stm32_get_gpio_bank_clock(bank);
 
-	assert(pin <= GPIO_PIN_MAX);
-
 	clk_enable(clock);
-
-	if (secure) {
-		mmio_setbits_32(base + GPIO_SECR_OFFSET, BIT(pin));
-	} else {
-		mmio_clrbits_32(base + GPIO_SECR_OFFSET, BIT(pin));
-	}
-
+	mmio_write_32(base + GPIO_SECR_OFFSET, secure_pins);
 	clk_disable(clock);
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2022, STMicroelectronics - All Rights Reserved
+ * Copyright (c) 2016-2024, STMicroelectronics - All Rights Reserved
  *
  * SPDX-License-Identifier: GPL-2.0+ OR BSD-3-Clause
  */
@@ -21,6 +21,10 @@
 
 #include <platform_def.h>
 
+#if STM32MP_I2C_TIMINGS_TABLE
+#include <stm32_i2c_timings.h>
+#endif
+
 /* STM32 I2C registers offsets */
 #define I2C_CR1			0x00U
 #define I2C_CR2			0x04U
@@ -345,6 +349,49 @@ static int i2c_compute_timing(struct stm32_i2c_init_s *init,
 	return 0;
 }
 
+#if STM32MP_I2C_TIMINGS_TABLE
+/*
+ * @brief  Look for the I2C device timings in the table generated from the
+ *	   DT by tools/stm32_i2c_timings.
+ * @param  init: Ref to the initialization configuration structure
+ * @param  clock_src: I2C clock source frequency (Hz)
+ * @param  timing: Pointer to the timing found in the table
+ * @retval 0 if found, negative value else
+ */
+static int i2c_lookup_timing(struct stm32_i2c_init_s *init,
+			     uint32_t clock_src, uint32_t *timing)
+{
+	uint8_t analog_filter = (init->analog_filter != 0) ? 1U : 0U;
+	size_t i;
+
+	for (i = 0U; i < ARRAY_SIZE(stm32_i2c_timings); i++) {
+		const struct stm32_i2c_timing_entry *entry =
+			&stm32_i2c_timings[i];
+
+		if ((entry->clock_src == clock_src) &&
+		    (entry->bus_rate == init->bus_rate) &&
+		    (entry->rise_time == init->rise_time) &&
+		    (entry->fall_time == init->fall_time) &&
+		    (entry->analog_filter == analog_filter) &&
+		    (entry->digital_filter_coef ==
+		     init->digital_filter_coef)) {
+			*timing = entry->timing;
+			VERBOSE("I2C TIMINGR: 0x%x (table)\n", *timing);
+
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
+#else
+static int i2c_lookup_timing(struct stm32_i2c_init_s *init,
+			     uint32_t clock_src, uint32_t *timing)
+{
+	return -ENOENT;
+}
+#endif
+
 static uint32_t get_lower_rate(uint32_t rate)
 {
 	int i;
@@ -389,7 +436,10 @@ static int i2c_setup_timing(struct i2c_handle_s *hi2c,
 	}
 
 	do {
-		rc = i2c_compute_timing(init, clock_src, timing);
+		rc = i2c_lookup_timing(init, clock_src, timing);
+		if (rc != 0) {
+			rc = i2c_compute_timing(init, clock_src, timing);
+		}
 		if (rc != 0) {
 			ERROR("Failed to compute I2C timings\n");
 			if (init->bus_rate > STANDARD_RATE) {
@@ -688,18 +738,27 @@ static int i2c_ack_failed(struct i2c_handle_s *hi2c, uint64_t timeout_ref)
 }
 
 /*
- * @brief  This function handles I2C Communication timeout for specific usage
- *	   of TXIS flag.
+ * @brief  Wait for a flag to be set, or for a NACK from the target. ISR is
+ *	   read once per iteration and the timeout is only checked while the
+ *	   flag is not set, to keep the per-byte overhead low.
  * @param  hi2c: Pointer to a struct i2c_handle_s structure that contains
  *               the configuration information for the specified I2C.
+ * @param  flag: Specifies the I2C flag to wait for
  * @param  timeout_ref: Reference to target timeout
  * @retval 0 if OK, negative value else
  */
-static int i2c_wait_txis(struct i2c_handle_s *hi2c, uint64_t timeout_ref)
+static int i2c_wait_flag_or_nack(struct i2c_handle_s *hi2c, uint32_t flag,
+				 uint64_t timeout_ref)
 {
-	while ((mmio_read_32(hi2c->i2c_base_addr + I2C_ISR) &
-		I2C_FLAG_TXIS) == 0U) {
-		if (i2c_ack_failed(hi2c, timeout_ref) != 0) {
+	for ( ; ; ) {
+		uint32_t isr = mmio_read_32(hi2c->i2c_base_addr + I2C_ISR);
+
+		if ((isr & flag) != 0U) {
+			return 0;
+		}
+
+		if (((isr & I2C_FLAG_AF) != 0U) &&
+		    (i2c_ack_failed(hi2c, timeout_ref) != 0)) {
 			return -EIO;
 		}
 
@@ -710,8 +769,19 @@ static int i2c_wait_txis(struct i2c_handle_s *hi2c, uint64_t timeout_ref)
 			return -EIO;
 		}
 	}
+}
 
-	return 0;
+/*
+ * @brief  This function handles I2C Communication timeout for specific usage
+ *	   of TXIS flag.
+ * @param  hi2c: Pointer to a struct i2c_handle_s structure that contains
+ *               the configuration information for the specified I2C.
+ * @param  timeout_ref: Reference to target timeout
+ * @retval 0 if OK, negative value else
+ */
+static int i2c_wait_txis(struct i2c_handle_s *hi2c, uint64_t timeout_ref)
+{
+	return i2c_wait_flag_or_nack(hi2c, I2C_FLAG_TXIS, timeout_ref);
 }
 
 /*
@@ -724,21 +794,7 @@ static int i2c_wait_txis(struct i2c_handle_s *hi2c, uint64_t timeout_ref)
  */
 static int i2c_wait_stop(struct i2c_handle_s *hi2c, uint64_t timeout_ref)
 {
-	while ((mmio_read_32(hi2c->i2c_base_addr + I2C_ISR) &
-		 I2C_FLAG_STOPF) == 0U) {
-		if (i2c_ack_failed(hi2c, timeout_ref) != 0) {
-			return -EIO;
-		}
-
-		if (timeout_elapsed(timeout_ref)) {
-			notif_i2c_timeout(hi2c);
-			hi2c->lock = 0;
-
-			return -EIO;
-		}
-	}
-
-	return 0;
+	return i2c_wait_flag_or_nack(hi2c, I2C_FLAG_STOPF, timeout_ref);
 }
 
 /*
@@ -779,6 +835,33 @@ static void i2c_transfer_config(struct i2c_handle_s *hi2c, uint16_t dev_addr,
 	mmio_clrsetbits_32(hi2c->i2c_base_addr + I2C_CR2, clr_value, set_value);
 }
 
+/*
+ * @brief  Program the next chunk of a transfer. NBYTES is limited to
+ *	   MAX_NBYTE_SIZE: RELOAD is set while more data follow the chunk,
+ *	   AUTOEND ends the last one.
+ * @param  hi2c: I2C handle
+ * @param  dev_addr: Specifies the slave address to be programmed
+ * @param  xfer_count: Number of bytes left in the transfer
+ * @param  request: START/STOP generation, see i2c_transfer_config()
+ * @retval Number of bytes of the chunk
+ */
+static uint32_t i2c_transfer_chunk(struct i2c_handle_s *hi2c,
+				   uint16_t dev_addr, uint32_t xfer_count,
+				   uint32_t request)
+{
+	if (xfer_count > MAX_NBYTE_SIZE) {
+		i2c_transfer_config(hi2c, dev_addr, MAX_NBYTE_SIZE,
+				    I2C_RELOAD_MODE, request);
+
+		return MAX_NBYTE_SIZE;
+	}
+
+	i2c_transfer_config(hi2c, dev_addr, (uint16_t)xfer_count,
+			    I2C_AUTOEND_MODE, request);
+
+	return xfer_count;
+}
+
 /*
  * @brief  Master sends target device address followed by internal memory
  *	   address for write request.
@@ -931,63 +1014,39 @@ static int i2c_write(struct i2c_handle_s *hi2c, uint16_t dev_addr,
 			goto bail;
 		}
 
-		if (xfer_count > MAX_NBYTE_SIZE) {
-			xfer_size = MAX_NBYTE_SIZE;
-			i2c_transfer_config(hi2c, dev_addr, xfer_size,
-					    I2C_RELOAD_MODE, I2C_NO_STARTSTOP);
-		} else {
-			xfer_size = xfer_count;
-			i2c_transfer_config(hi2c, dev_addr, xfer_size,
-					    I2C_AUTOEND_MODE, I2C_NO_STARTSTOP);
-		}
+		xfer_size = i2c_transfer_chunk(hi2c, dev_addr, xfer_count,
+					       I2C_NO_STARTSTOP);
 	} else {
 		/* In Master Mode, Send Slave Address */
-		if (xfer_count > MAX_NBYTE_SIZE) {
-			xfer_size = MAX_NBYTE_SIZE;
-			i2c_transfer_config(hi2c, dev_addr, xfer_size,
-					    I2C_RELOAD_MODE,
-					    I2C_GENERATE_START_WRITE);
-		} else {
-			xfer_size = xfer_count;
-			i2c_transfer_config(hi2c, dev_addr, xfer_size,
-					    I2C_AUTOEND_MODE,
-					    I2C_GENERATE_START_WRITE);
-		}
+		xfer_size = i2c_transfer_chunk(hi2c, dev_addr, xfer_count,
+					       I2C_GENERATE_START_WRITE);
 	}
 
-	do {
-		if (i2c_wait_txis(hi2c, timeout_ref) != 0) {
-			goto bail;
-		}
-
-		mmio_write_8(hi2c->i2c_base_addr + I2C_TXDR, *p_buff);
-		p_buff++;
-		xfer_count--;
-		xfer_size--;
+	for ( ; ; ) {
+		uint8_t *p_end = p_buff + xfer_size;
 
-		if ((xfer_count != 0U) && (xfer_size == 0U)) {
-			/* Wait until TCR flag is set */
-			if (i2c_wait_flag(hi2c, I2C_FLAG_TCR, 0,
-					  timeout_ref) != 0) {
+		while (p_buff < p_end) {
+			if (i2c_wait_txis(hi2c, timeout_ref) != 0) {
 				goto bail;
 			}
 
-			if (xfer_count > MAX_NBYTE_SIZE) {
-				xfer_size = MAX_NBYTE_SIZE;
-				i2c_transfer_config(hi2c, dev_addr,
-						    xfer_size,
-						    I2C_RELOAD_MODE,
-						    I2C_NO_STARTSTOP);
-			} else {
-				xfer_size = xfer_count;
-				i2c_transfer_config(hi2c, dev_addr,
-						    xfer_size,
-						    I2C_AUTOEND_MODE,
-						    I2C_NO_STARTSTOP);
-			}
+			mmio_write_8(hi2c->i2c_base_addr + I2C_TXDR, *p_buff);
+			p_buff++;
 		}
 
-	} while (xfer_count > 0U);
+		xfer_count -= xfer_size;
+		if (xfer_count == 0U) {
+			break;
+		}
+
+		/* Wait until TCR flag is set */
+		if (i2c_wait_flag(hi2c, I2C_FLAG_TCR, 0, timeout_ref) != 0) {
+			goto bail;
+		}
+
+		xfer_size = i2c_transfer_chunk(hi2c, dev_addr, xfer_count,
+					       I2C_NO_STARTSTOP);
+	}
 
 	/*
 	 * No need to Check TC flag, with AUTOEND mode the stop
@@ -1116,47 +1175,34 @@ static int i2c_read(struct i2c_handle_s *hi2c, uint16_t dev_addr,
 	 * Set NBYTES to write and reload if xfer_count > MAX_NBYTE_SIZE
 	 * and generate RESTART.
 	 */
-	if (xfer_count > MAX_NBYTE_SIZE) {
-		xfer_size = MAX_NBYTE_SIZE;
-		i2c_transfer_config(hi2c, dev_addr, xfer_size,
-				    I2C_RELOAD_MODE, I2C_GENERATE_START_READ);
-	} else {
-		xfer_size = xfer_count;
-		i2c_transfer_config(hi2c, dev_addr, xfer_size,
-				    I2C_AUTOEND_MODE, I2C_GENERATE_START_READ);
-	}
+	xfer_size = i2c_transfer_chunk(hi2c, dev_addr, xfer_count,
+				       I2C_GENERATE_START_READ);
 
-	do {
-		if (i2c_wait_flag(hi2c, I2C_FLAG_RXNE, 0, timeout_ref) != 0) {
-			goto bail;
-		}
-
-		*p_buff = mmio_read_8(hi2c->i2c_base_addr + I2C_RXDR);
-		p_buff++;
-		xfer_size--;
-		xfer_count--;
+	for ( ; ; ) {
+		uint8_t *p_end = p_buff + xfer_size;
 
-		if ((xfer_count != 0U) && (xfer_size == 0U)) {
-			if (i2c_wait_flag(hi2c, I2C_FLAG_TCR, 0,
+		while (p_buff < p_end) {
+			if (i2c_wait_flag(hi2c, I2C_FLAG_RXNE, 0,
 					  timeout_ref) != 0) {
 				goto bail;
 			}
 
-			if (xfer_count > MAX_NBYTE_SIZE) {
-				xfer_size = MAX_NBYTE_SIZE;
-				i2c_transfer_config(hi2c, dev_addr,
-						    xfer_size,
-						    I2C_RELOAD_MODE,
-						    I2C_NO_STARTSTOP);
-			} else {
-				xfer_size = xfer_count;
-				i2c_transfer_config(hi2c, dev_addr,
-						    xfer_size,
-						    I2C_AUTOEND_MODE,
-						    I2C_NO_STARTSTOP);
-			}
+			*p_buff = mmio_read_8(hi2c->i2c_base_addr + I2C_RXDR);
+			p_buff++;
+		}
+
+		xfer_count -= xfer_size;
+		if (xfer_count == 0U) {
+			break;
+		}
+
+		if (i2c_wait_flag(hi2c, I2C_FLAG_TCR, 0, timeout_ref) != 0) {
+			goto bail;
 		}
-	} while (xfer_count > 0U);
+
+		xfer_size = i2c_transfer_chunk(hi2c, dev_addr, xfer_count,
+					       I2C_NO_STARTSTOP);
+	}
 
 	/*
 	 * No need to Check TC flag, with AUTOEND mode the stop
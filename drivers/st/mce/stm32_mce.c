@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020-2023, STMicroelectronics - All Rights Reserved
+ * Copyright (c) 2020-2024, STMicroelectronics - All Rights Reserved
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -10,6 +10,10 @@
 #include <drivers/clk.h>
 #include <drivers/delay_timer.h>
 #include <drivers/st/stm32_mce.h>
+#if STM32MP_DDR_SCRUB
+#include <drivers/st/stm32mp1_ram.h>
+#include <drivers/st/stm32mp_ddr_scrub.h>
+#endif
 #include <lib/mmio.h>
 #include <libfdt.h>
 
@@ -419,6 +423,15 @@ static int fconf_populate_mce(uintptr_t config)
 			panic();
 		}
 
+#if STM32MP_DDR_SCRUB
+		/* DDR content is kept when exiting from Self-Refresh */
+		if ((region.encrypt_mode == MCE_ENCRYPT_MODE) &&
+		    !stm32mp1_ddr_is_restored() &&
+		    (stm32mp_ddr_scrub(region.start_address, size) != 0)) {
+			panic();
+		}
+#endif
+
 		stm32mp1_pm_save_mce_region(i, &region);
 	}
 
@@ -20,7 +20,6 @@
 #include <platform_def.h>
 
 #define PMIC_NODE_NOT_FOUND	1
-#define NB_REG			14U
 
 static struct i2c_handle_s i2c_handle;
 static uint32_t pmic_i2c_addr;
@@ -200,10 +199,23 @@ void initialize_pmic(void)
 
 	register_pmic_shared_peripherals();
 
+	/*
+	 * Read the PMIC configuration and write the DT configuration of the
+	 * regulators at once. The voltage and DDR supply setup that follow
+	 * then only write their registers.
+	 */
+	if (stpmic1_batch_start() != 0) {
+		panic();
+	}
+
 	if (register_pmic() < 0) {
 		panic();
 	}
 
+	if (stpmic1_batch_flush() != 0) {
+		panic();
+	}
+
 	if (stpmic1_powerctrl_on() < 0) {
 		panic();
 	}
@@ -264,31 +276,37 @@ void pmic_switch_off(void)
 	panic();
 }
 
-enum {
-	STPMIC1_BUCK1 = 0,
-	STPMIC1_BUCK2,
-	STPMIC1_BUCK3,
-	STPMIC1_BUCK4,
-	STPMIC1_LDO1,
-	STPMIC1_LDO2,
-	STPMIC1_LDO3,
-	STPMIC1_LDO4,
-	STPMIC1_LDO5,
-	STPMIC1_LDO6,
-	STPMIC1_VREF_DDR,
-	STPMIC1_BOOST,
-	STPMIC1_VBUS_OTG,
-	STPMIC1_SW_OUT,
+/* Regulator ID in the STPMIC1 driver, pointed by the description driver_data */
+static const uint8_t pmic_regul_ids[STPMIC1_NB_REG] = {
+	[STPMIC1_BUCK1] = STPMIC1_BUCK1,
+	[STPMIC1_BUCK2] = STPMIC1_BUCK2,
+	[STPMIC1_BUCK3] = STPMIC1_BUCK3,
+	[STPMIC1_BUCK4] = STPMIC1_BUCK4,
+	[STPMIC1_LDO1] = STPMIC1_LDO1,
+	[STPMIC1_LDO2] = STPMIC1_LDO2,
+	[STPMIC1_LDO3] = STPMIC1_LDO3,
+	[STPMIC1_LDO4] = STPMIC1_LDO4,
+	[STPMIC1_LDO5] = STPMIC1_LDO5,
+	[STPMIC1_LDO6] = STPMIC1_LDO6,
+	[STPMIC1_VREF_DDR] = STPMIC1_VREF_DDR,
+	[STPMIC1_BOOST] = STPMIC1_BOOST,
+	[STPMIC1_VBUS_OTG] = STPMIC1_VBUS_OTG,
+	[STPMIC1_SW_OUT] = STPMIC1_SW_OUT,
 };
 
+static uint8_t regul_id(const struct regul_description *desc)
+{
+	return *(const uint8_t *)desc->driver_data;
+}
+
 static int pmic_set_state(const struct regul_description *desc, bool enable)
 {
 	VERBOSE("%s: set state to %d\n", desc->node_name, enable);
 
 	if (enable == STATE_ENABLE) {
-		return stpmic1_regulator_enable(desc->node_name);
+		return stpmic1_regulator_enable(regul_id(desc));
 	} else {
-		return stpmic1_regulator_disable(desc->node_name);
+		return stpmic1_regulator_disable(regul_id(desc));
 	}
 }
 
@@ -296,21 +314,21 @@ static int pmic_get_state(const struct regul_description *desc)
 {
 	VERBOSE("%s: get state\n", desc->node_name);
 
-	return stpmic1_is_regulator_enabled(desc->node_name);
+	return stpmic1_is_regulator_enabled(regul_id(desc));
 }
 
 static int pmic_get_voltage(const struct regul_description *desc)
 {
 	VERBOSE("%s: get volt\n", desc->node_name);
 
-	return stpmic1_regulator_voltage_get(desc->node_name);
+	return stpmic1_regulator_voltage_get(regul_id(desc));
 }
 
 static int pmic_set_voltage(const struct regul_description *desc, uint16_t mv)
 {
 	VERBOSE("%s: get volt\n", desc->node_name);
 
-	return stpmic1_regulator_voltage_set(desc->node_name, mv);
+	return stpmic1_regulator_voltage_set(regul_id(desc), mv);
 }
 
 static int pmic_list_voltages(const struct regul_description *desc,
@@ -318,7 +336,7 @@ static int pmic_list_voltages(const struct regul_description *desc,
 {
 	VERBOSE("%s: list volt\n", desc->node_name);
 
-	return stpmic1_regulator_levels_mv(desc->node_name, levels, count);
+	return stpmic1_regulator_levels_mv(regul_id(desc), levels, count);
 }
 
 static int pmic_set_flag(const struct regul_description *desc, uint16_t flag)
@@ -327,22 +345,22 @@ static int pmic_set_flag(const struct regul_description *desc, uint16_t flag)
 
 	switch (flag) {
 	case REGUL_OCP:
-		return stpmic1_regulator_icc_set(desc->node_name);
+		return stpmic1_regulator_icc_set(regul_id(desc));
 
 	case REGUL_ACTIVE_DISCHARGE:
-		return stpmic1_active_discharge_mode_set(desc->node_name);
+		return stpmic1_active_discharge_mode_set(regul_id(desc));
 
 	case REGUL_PULL_DOWN:
-		return stpmic1_regulator_pull_down_set(desc->node_name);
+		return stpmic1_regulator_pull_down_set(regul_id(desc));
 
 	case REGUL_MASK_RESET:
-		return stpmic1_regulator_mask_reset_set(desc->node_name);
+		return stpmic1_regulator_mask_reset_set(regul_id(desc));
 
 	case REGUL_SINK_SOURCE:
-		return stpmic1_regulator_sink_mode_set(desc->node_name);
+		return stpmic1_regulator_sink_mode_set(regul_id(desc));
 
 	case REGUL_ENABLE_BYPASS:
-		return stpmic1_regulator_bypass_mode_set(desc->node_name);
+		return stpmic1_regulator_bypass_mode_set(regul_id(desc));
 
 	default:
 		return -EINVAL;
@@ -358,28 +376,28 @@ static const struct regul_ops pmic_ops = {
 	.set_flag = pmic_set_flag,
 };
 
-#define DEFINE_REGU(name) { \
+#define DEFINE_REGU(rid, name) [rid] = { \
 	.node_name = (name), \
 	.ops = &pmic_ops, \
-	.driver_data = NULL, \
+	.driver_data = &pmic_regul_ids[rid], \
 	.enable_ramp_delay = 1000, \
 }
 
-static const struct regul_description pmic_regs[NB_REG] = {
-	[STPMIC1_BUCK1] = DEFINE_REGU("buck1"),
-	[STPMIC1_BUCK2] = DEFINE_REGU("buck2"),
-	[STPMIC1_BUCK3] = DEFINE_REGU("buck3"),
-	[STPMIC1_BUCK4] = DEFINE_REGU("buck4"),
-	[STPMIC1_LDO1] = DEFINE_REGU("ldo1"),
-	[STPMIC1_LDO2] = DEFINE_REGU("ldo2"),
-	[STPMIC1_LDO3] = DEFINE_REGU("ldo3"),
-	[STPMIC1_LDO4] = DEFINE_REGU("ldo4"),
-	[STPMIC1_LDO5] = DEFINE_REGU("ldo5"),
-	[STPMIC1_LDO6] = DEFINE_REGU("ldo6"),
-	[STPMIC1_VREF_DDR] = DEFINE_REGU("vref_ddr"),
-	[STPMIC1_BOOST] = DEFINE_REGU("boost"),
-	[STPMIC1_VBUS_OTG] = DEFINE_REGU("pwr_sw1"),
-	[STPMIC1_SW_OUT] = DEFINE_REGU("pwr_sw2"),
+static const struct regul_description pmic_regs[STPMIC1_NB_REG] = {
+	DEFINE_REGU(STPMIC1_BUCK1, "buck1"),
+	DEFINE_REGU(STPMIC1_BUCK2, "buck2"),
+	DEFINE_REGU(STPMIC1_BUCK3, "buck3"),
+	DEFINE_REGU(STPMIC1_BUCK4, "buck4"),
+	DEFINE_REGU(STPMIC1_LDO1, "ldo1"),
+	DEFINE_REGU(STPMIC1_LDO2, "ldo2"),
+	DEFINE_REGU(STPMIC1_LDO3, "ldo3"),
+	DEFINE_REGU(STPMIC1_LDO4, "ldo4"),
+	DEFINE_REGU(STPMIC1_LDO5, "ldo5"),
+	DEFINE_REGU(STPMIC1_LDO6, "ldo6"),
+	DEFINE_REGU(STPMIC1_VREF_DDR, "vref_ddr"),
+	DEFINE_REGU(STPMIC1_BOOST, "boost"),
+	DEFINE_REGU(STPMIC1_VBUS_OTG, "pwr_sw1"),
+	DEFINE_REGU(STPMIC1_SW_OUT, "pwr_sw2"),
 };
 
 static int register_pmic(void)
@@ -409,13 +427,13 @@ static int register_pmic(void)
 		unsigned int i;
 		int ret;
 
-		for (i = 0U; i < NB_REG; i++) {
+		for (i = 0U; i < STPMIC1_NB_REG; i++) {
 			desc = &pmic_regs[i];
 			if (strcmp(desc->node_name, reg_name) == 0) {
 				break;
 			}
 		}
-		assert(i < NB_REG);
+		assert(i < STPMIC1_NB_REG);
 
 		ret = regulator_register(desc, subnode);
 		if (ret != 0) {
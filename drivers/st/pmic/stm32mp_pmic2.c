@@ -487,12 +487,24 @@ void initialize_pmic(void)
 	}
 	INFO("PMIC2 product ID = 0x%02x\n", val);
 
+	/*
+	 * Read the PMIC configuration and write the DT configuration of the
+	 * regulators at once.
+	 */
+	if (stpmic2_batch_start(pmic2) != 0) {
+		panic();
+	}
+
 	ret = register_pmic2();
 	if (ret < 0) {
 		ERROR("Register pmic2 failed\n");
 		panic();
 	}
 
+	if (stpmic2_batch_flush(pmic2) != 0) {
+		panic();
+	}
+
 #if EVENT_LOG_LEVEL == LOG_LEVEL_VERBOSE
 	stpmic2_dump_regulators(pmic2);
 #endif
@@ -4,11 +4,13 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <assert.h>
 #include <errno.h>
 #include <string.h>
 
 #include <common/debug.h>
 #include <drivers/st/stpmic1.h>
+#include <lib/cassert.h>
 
 #define I2C_TIMEOUT_MS		25
 
@@ -29,6 +31,34 @@ struct regul_struct {
 
 static struct i2c_handle_s *pmic_i2c_handle;
 static uint16_t pmic_i2c_addr;
+
+/*
+ * In BL2, nothing else accesses the PMIC: the configuration registers are
+ * shadowed, written through, so that register updates do not read them
+ * again and skip the writes that do not change them.
+ * stpmic1_batch_start() loads the whole shadow with one auto-increment read
+ * per run of registers. Until stpmic1_batch_flush(), writes only update the
+ * shadow and each run of contiguous dirty registers is then written with a
+ * single auto-increment I2C transfer.
+ * MAIN_CONTROL_REG and WATCHDOG_CONTROL_REG hold self-clearing bits and are
+ * never shadowed.
+ */
+#if defined(IMAGE_BL2)
+#define PMIC_SHADOW			1
+#else
+#define PMIC_SHADOW			0
+#endif
+#define SHADOW_FIRST_REG		PADS_PULL_REG
+#define SHADOW_LAST_REG			USB_CONTROL_REG
+#define SHADOW_NB_REGS			(SHADOW_LAST_REG - SHADOW_FIRST_REG + 1U)
+
+#if PMIC_SHADOW
+static uint8_t shadow_regs[SHADOW_NB_REGS];
+static uint64_t shadow_valid;
+static uint64_t shadow_dirty;
+static bool shadow_batch;
+CASSERT(SHADOW_NB_REGS <= 64U, assert_stpmic1_shadow_size);
+#endif
 /*
  * Special mode corresponds to LDO3 in sink source mode or in bypass mode.
  * LDO3 doesn't switch back from special to normal mode.
@@ -436,8 +466,8 @@ static const uint16_t fixed_5v_voltage_table[] = {
 };
 
 /* Table of Regulators in PMIC SoC */
-static const struct regul_struct regulators_table[] = {
-	{
+static const struct regul_struct regulators_table[STPMIC1_NB_REG] = {
+	[STPMIC1_BUCK1] = {
 		.dt_node_name	= "buck1",
 		.voltage_table	= buck1_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(buck1_voltage_table),
@@ -451,7 +481,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= BUCK_ICC_TURNOFF_REG,
 		.icc_mask	= BUCK1_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_BUCK2] = {
 		.dt_node_name	= "buck2",
 		.voltage_table	= buck2_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(buck2_voltage_table),
@@ -465,7 +495,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= BUCK_ICC_TURNOFF_REG,
 		.icc_mask	= BUCK2_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_BUCK3] = {
 		.dt_node_name	= "buck3",
 		.voltage_table	= buck3_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(buck3_voltage_table),
@@ -479,7 +509,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= BUCK_ICC_TURNOFF_REG,
 		.icc_mask	= BUCK3_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_BUCK4] = {
 		.dt_node_name	= "buck4",
 		.voltage_table	= buck4_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(buck4_voltage_table),
@@ -493,7 +523,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= BUCK_ICC_TURNOFF_REG,
 		.icc_mask	= BUCK4_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_LDO1] = {
 		.dt_node_name	= "ldo1",
 		.voltage_table	= ldo1_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(ldo1_voltage_table),
@@ -505,7 +535,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= LDO_ICC_TURNOFF_REG,
 		.icc_mask	= LDO1_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_LDO2] = {
 		.dt_node_name	= "ldo2",
 		.voltage_table	= ldo2_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(ldo2_voltage_table),
@@ -517,7 +547,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= LDO_ICC_TURNOFF_REG,
 		.icc_mask	= LDO2_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_LDO3] = {
 		.dt_node_name	= "ldo3",
 		.voltage_table	= ldo3_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(ldo3_voltage_table),
@@ -529,7 +559,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= LDO_ICC_TURNOFF_REG,
 		.icc_mask	= LDO3_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_LDO4] = {
 		.dt_node_name	= "ldo4",
 		.voltage_table	= ldo4_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(ldo4_voltage_table),
@@ -541,7 +571,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= LDO_ICC_TURNOFF_REG,
 		.icc_mask	= LDO4_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_LDO5] = {
 		.dt_node_name	= "ldo5",
 		.voltage_table	= ldo5_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(ldo5_voltage_table),
@@ -553,7 +583,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= LDO_ICC_TURNOFF_REG,
 		.icc_mask	= LDO5_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_LDO6] = {
 		.dt_node_name	= "ldo6",
 		.voltage_table	= ldo6_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(ldo6_voltage_table),
@@ -565,7 +595,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= LDO_ICC_TURNOFF_REG,
 		.icc_mask	= LDO6_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_VREF_DDR] = {
 		.dt_node_name	= "vref_ddr",
 		.voltage_table	= vref_ddr_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(vref_ddr_voltage_table),
@@ -575,7 +605,7 @@ static const struct regul_struct regulators_table[] = {
 		.mask_reset_reg	= MASK_RESET_LDO_REG,
 		.mask_reset	= VREF_DDR_MASK_RESET,
 	},
-	{
+	[STPMIC1_BOOST] = {
 		.dt_node_name	= "boost",
 		.voltage_table	= fixed_5v_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(fixed_5v_voltage_table),
@@ -584,7 +614,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= BUCK_ICC_TURNOFF_REG,
 		.icc_mask	= BOOST_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_VBUS_OTG] = {
 		.dt_node_name	= "pwr_sw1",
 		.voltage_table	= fixed_5v_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(fixed_5v_voltage_table),
@@ -593,7 +623,7 @@ static const struct regul_struct regulators_table[] = {
 		.icc_reg	= BUCK_ICC_TURNOFF_REG,
 		.icc_mask	= PWR_SW1_ICC_SHIFT,
 	},
-	{
+	[STPMIC1_SW_OUT] = {
 		.dt_node_name	= "pwr_sw2",
 		.voltage_table	= fixed_5v_voltage_table,
 		.voltage_table_size = ARRAY_SIZE(fixed_5v_voltage_table),
@@ -604,27 +634,19 @@ static const struct regul_struct regulators_table[] = {
 	},
 };
 
-#define MAX_REGUL	ARRAY_SIZE(regulators_table)
-
-static const struct regul_struct *get_regulator_data(const char *name)
+static const struct regul_struct *get_regulator_data(uint8_t id)
 {
-	uint8_t i;
-
-	for (i = 0 ; i < MAX_REGUL ; i++) {
-		if (strncmp(name, regulators_table[i].dt_node_name,
-			    strlen(regulators_table[i].dt_node_name)) == 0) {
-			return &regulators_table[i];
-		}
+	if (id >= STPMIC1_NB_REG) {
+		/* Regulator not found */
+		panic();
 	}
 
-	/* Regulator not found */
-	panic();
-	return NULL;
+	return &regulators_table[id];
 }
 
-static uint8_t voltage_to_index(const char *name, uint16_t millivolts)
+static uint8_t voltage_to_index(uint8_t id, uint16_t millivolts)
 {
-	const struct regul_struct *regul = get_regulator_data(name);
+	const struct regul_struct *regul = get_regulator_data(id);
 	uint8_t i;
 
 	for (i = 0 ; i < regul->voltage_table_size ; i++) {
@@ -639,6 +661,20 @@ static uint8_t voltage_to_index(const char *name, uint16_t millivolts)
 	return 0;
 }
 
+/* Voltage can be set for buck<N> or ldo<N> (except ldo4) regulators */
+static uint8_t voltage_mask(uint8_t id)
+{
+	if (id <= STPMIC1_BUCK4) {
+		return BUCK_VOLTAGE_MASK;
+	}
+
+	if ((id <= STPMIC1_LDO6) && (id != STPMIC1_LDO4)) {
+		return LDO_VOLTAGE_MASK;
+	}
+
+	return 0U;
+}
+
 int stpmic1_powerctrl_on(void)
 {
 	return stpmic1_register_update(MAIN_CONTROL_REG, PWRCTRL_PIN_VALID,
@@ -651,26 +687,26 @@ int stpmic1_switch_off(void)
 				       SOFTWARE_SWITCH_OFF_ENABLED);
 }
 
-int stpmic1_regulator_enable(const char *name)
+int stpmic1_regulator_enable(uint8_t id)
 {
-	const struct regul_struct *regul = get_regulator_data(name);
+	const struct regul_struct *regul = get_regulator_data(id);
 
 	return stpmic1_register_update(regul->control_reg, regul->enable_mask,
 				       regul->enable_mask);
 }
 
-int stpmic1_regulator_disable(const char *name)
+int stpmic1_regulator_disable(uint8_t id)
 {
-	const struct regul_struct *regul = get_regulator_data(name);
+	const struct regul_struct *regul = get_regulator_data(id);
 
 	return stpmic1_register_update(regul->control_reg, 0,
 				       regul->enable_mask);
 }
 
-bool stpmic1_is_regulator_enabled(const char *name)
+bool stpmic1_is_regulator_enabled(uint8_t id)
 {
 	uint8_t val;
-	const struct regul_struct *regul = get_regulator_data(name);
+	const struct regul_struct *regul = get_regulator_data(id);
 
 	if (stpmic1_register_read(regul->control_reg, &val) != 0) {
 		panic();
@@ -679,13 +715,13 @@ bool stpmic1_is_regulator_enabled(const char *name)
 	return (val & regul->enable_mask) == regul->enable_mask;
 }
 
-int stpmic1_regulator_voltage_set(const char *name, uint16_t millivolts)
+int stpmic1_regulator_voltage_set(uint8_t id, uint16_t millivolts)
 {
-	uint8_t voltage_index = voltage_to_index(name, millivolts);
-	const struct regul_struct *regul = get_regulator_data(name);
-	uint8_t mask;
+	uint8_t voltage_index = voltage_to_index(id, millivolts);
+	const struct regul_struct *regul = get_regulator_data(id);
+	uint8_t mask = voltage_mask(id);
 
-	if ((strncmp(name, "ldo3", 5) == 0) && ldo3_special_mode) {
+	if ((id == STPMIC1_LDO3) && ldo3_special_mode) {
 		/*
 		 * when the LDO3 is in special mode, we do not change voltage,
 		 * because by setting voltage, the LDO would leaves sink-source
@@ -695,13 +731,7 @@ int stpmic1_regulator_voltage_set(const char *name, uint16_t millivolts)
 		return 0;
 	}
 
-	/* Voltage can be set for buck<N> or ldo<N> (except ldo4) regulators */
-	if (strncmp(name, "buck", 4) == 0) {
-		mask = BUCK_VOLTAGE_MASK;
-	} else if ((strncmp(name, "ldo", 3) == 0) &&
-		   (strncmp(name, "ldo4", 5) != 0)) {
-		mask = LDO_VOLTAGE_MASK;
-	} else {
+	if (mask == 0U) {
 		return 0;
 	}
 
@@ -710,9 +740,9 @@ int stpmic1_regulator_voltage_set(const char *name, uint16_t millivolts)
 				       mask);
 }
 
-int stpmic1_regulator_pull_down_set(const char *name)
+int stpmic1_regulator_pull_down_set(uint8_t id)
 {
-	const struct regul_struct *regul = get_regulator_data(name);
+	const struct regul_struct *regul = get_regulator_data(id);
 
 	if (regul->pull_down_reg != 0) {
 		return stpmic1_register_update(regul->pull_down_reg,
@@ -724,9 +754,9 @@ int stpmic1_regulator_pull_down_set(const char *name)
 	return 0;
 }
 
-int stpmic1_regulator_mask_reset_set(const char *name)
+int stpmic1_regulator_mask_reset_set(uint8_t id)
 {
-	const struct regul_struct *regul = get_regulator_data(name);
+	const struct regul_struct *regul = get_regulator_data(id);
 
 	if (regul->mask_reset_reg == 0U) {
 		return -EPERM;
@@ -738,9 +768,9 @@ int stpmic1_regulator_mask_reset_set(const char *name)
 				       regul->mask_reset);
 }
 
-int stpmic1_regulator_icc_set(const char *name)
+int stpmic1_regulator_icc_set(uint8_t id)
 {
-	const struct regul_struct *regul = get_regulator_data(name);
+	const struct regul_struct *regul = get_regulator_data(id);
 
 	if (regul->mask_reset_reg == 0U) {
 		return -EPERM;
@@ -751,9 +781,9 @@ int stpmic1_regulator_icc_set(const char *name)
 				       BIT(regul->icc_mask));
 }
 
-int stpmic1_regulator_sink_mode_set(const char *name)
+int stpmic1_regulator_sink_mode_set(uint8_t id)
 {
-	if (strncmp(name, "ldo3", 5) != 0) {
+	if (id != STPMIC1_LDO3) {
 		return -EPERM;
 	}
 
@@ -765,9 +795,9 @@ int stpmic1_regulator_sink_mode_set(const char *name)
 				       LDO3_BYPASS | LDO_VOLTAGE_MASK);
 }
 
-int stpmic1_regulator_bypass_mode_set(const char *name)
+int stpmic1_regulator_bypass_mode_set(uint8_t id)
 {
-	if (strncmp(name, "ldo3", 5) != 0) {
+	if (id != STPMIC1_LDO3) {
 		return -EPERM;
 	}
 
@@ -779,15 +809,15 @@ int stpmic1_regulator_bypass_mode_set(const char *name)
 				       LDO3_BYPASS | LDO_VOLTAGE_MASK);
 }
 
-int stpmic1_active_discharge_mode_set(const char *name)
+int stpmic1_active_discharge_mode_set(uint8_t id)
 {
-	if (strncmp(name, "pwr_sw1", 8) == 0) {
+	if (id == STPMIC1_VBUS_OTG) {
 		return stpmic1_register_update(USB_CONTROL_REG,
 					       VBUS_OTG_DISCHARGE,
 					       VBUS_OTG_DISCHARGE);
 	}
 
-	if (strncmp(name, "pwr_sw2", 8) == 0) {
+	if (id == STPMIC1_SW_OUT) {
 		return stpmic1_register_update(USB_CONTROL_REG,
 					       SW_OUT_DISCHARGE,
 					       SW_OUT_DISCHARGE);
@@ -796,12 +826,12 @@ int stpmic1_active_discharge_mode_set(const char *name)
 	return -EPERM;
 }
 
-int stpmic1_regulator_levels_mv(const char *name, const uint16_t **levels,
+int stpmic1_regulator_levels_mv(uint8_t id, const uint16_t **levels,
 				size_t *levels_count)
 {
-	const struct regul_struct *regul = get_regulator_data(name);
+	const struct regul_struct *regul = get_regulator_data(id);
 
-	if ((strncmp(name, "ldo3", 5) == 0) && ldo3_special_mode) {
+	if ((id == STPMIC1_LDO3) && ldo3_special_mode) {
 		*levels_count = ARRAY_SIZE(ldo3_special_mode_table);
 		*levels = ldo3_special_mode_table;
 	} else {
@@ -812,24 +842,18 @@ int stpmic1_regulator_levels_mv(const char *name, const uint16_t **levels,
 	return 0;
 }
 
-int stpmic1_regulator_voltage_get(const char *name)
+int stpmic1_regulator_voltage_get(uint8_t id)
 {
-	const struct regul_struct *regul = get_regulator_data(name);
+	const struct regul_struct *regul = get_regulator_data(id);
+	uint8_t mask = voltage_mask(id);
 	uint8_t value;
-	uint8_t mask;
 	int status;
 
-	if ((strncmp(name, "ldo3", 5) == 0) && ldo3_special_mode) {
+	if ((id == STPMIC1_LDO3) && ldo3_special_mode) {
 		return 0;
 	}
 
-	/* Voltage can be set for buck<N> or ldo<N> (except ldo4) regulators */
-	if (strncmp(name, "buck", 4) == 0) {
-		mask = BUCK_VOLTAGE_MASK;
-	} else if ((strncmp(name, "ldo", 3) == 0) &&
-		   (strncmp(name, "ldo4", 5) != 0)) {
-		mask = LDO_VOLTAGE_MASK;
-	} else {
+	if (mask == 0U) {
 		return 0;
 	}
 
@@ -847,22 +871,22 @@ int stpmic1_regulator_voltage_get(const char *name)
 	return (int)regul->voltage_table[value];
 }
 
-int stpmic1_register_read(uint8_t register_id,  uint8_t *value)
+static int pmic_i2c_read(uint8_t register_id, uint8_t *value, uint16_t size)
 {
 	return stm32_i2c_mem_read(pmic_i2c_handle, pmic_i2c_addr,
 				  (uint16_t)register_id,
 				  I2C_MEMADD_SIZE_8BIT, value,
-				  1, I2C_TIMEOUT_MS);
+				  size, I2C_TIMEOUT_MS);
 }
 
-int stpmic1_register_write(uint8_t register_id, uint8_t value)
+static int pmic_i2c_write(uint8_t register_id, uint8_t *value, uint16_t size)
 {
 	int status;
 
 	status = stm32_i2c_mem_write(pmic_i2c_handle, pmic_i2c_addr,
 				     (uint16_t)register_id,
-				     I2C_MEMADD_SIZE_8BIT, &value,
-				     1, I2C_TIMEOUT_MS);
+				     I2C_MEMADD_SIZE_8BIT, value,
+				     size, I2C_TIMEOUT_MS);
 
 #if ENABLE_ASSERTIONS
 	if (status != 0) {
@@ -870,14 +894,16 @@ int stpmic1_register_write(uint8_t register_id, uint8_t value)
 	}
 
 	if ((register_id != WATCHDOG_CONTROL_REG) && (register_id <= 0x40U)) {
-		uint8_t readval;
+		uint8_t readval[SHADOW_NB_REGS];
 
-		status = stpmic1_register_read(register_id, &readval);
+		assert(size <= sizeof(readval));
+
+		status = pmic_i2c_read(register_id, readval, size);
 		if (status != 0) {
 			return status;
 		}
 
-		if (readval != value) {
+		if (memcmp(readval, value, size) != 0) {
 			return -EIO;
 		}
 	}
@@ -886,19 +912,173 @@ int stpmic1_register_write(uint8_t register_id, uint8_t value)
 	return status;
 }
 
+#if PMIC_SHADOW
+static bool shadowed(uint8_t register_id)
+{
+	return (register_id >= SHADOW_FIRST_REG) &&
+	       (register_id <= SHADOW_LAST_REG) &&
+	       (register_id != WATCHDOG_CONTROL_REG);
+}
+
+static uint64_t shadow_bit(uint8_t register_id)
+{
+	return BIT_64(register_id - SHADOW_FIRST_REG);
+}
+#endif
+
+int stpmic1_register_read(uint8_t register_id,  uint8_t *value)
+{
+#if PMIC_SHADOW
+	if (shadowed(register_id)) {
+		uint8_t idx = register_id - SHADOW_FIRST_REG;
+		int status;
+
+		if ((shadow_valid & shadow_bit(register_id)) == 0U) {
+			status = pmic_i2c_read(register_id, &shadow_regs[idx],
+					       1U);
+			if (status != 0) {
+				return status;
+			}
+
+			shadow_valid |= shadow_bit(register_id);
+		}
+
+		*value = shadow_regs[idx];
+
+		return 0;
+	}
+#endif
+
+	return pmic_i2c_read(register_id, value, 1U);
+}
+
+int stpmic1_register_write(uint8_t register_id, uint8_t value)
+{
+#if PMIC_SHADOW
+	if (shadowed(register_id)) {
+		uint8_t idx = register_id - SHADOW_FIRST_REG;
+		int status = 0;
+
+		shadow_regs[idx] = value;
+		shadow_valid |= shadow_bit(register_id);
+
+		if (shadow_batch) {
+			shadow_dirty |= shadow_bit(register_id);
+		} else {
+			status = pmic_i2c_write(register_id, &shadow_regs[idx],
+						1U);
+			if (status != 0) {
+				shadow_valid &= ~shadow_bit(register_id);
+			}
+		}
+
+		return status;
+	}
+#endif
+
+	return pmic_i2c_write(register_id, &value, 1U);
+}
+
 int stpmic1_register_update(uint8_t register_id, uint8_t value, uint8_t mask)
 {
 	int status;
 	uint8_t val;
+	uint8_t new_val;
 
 	status = stpmic1_register_read(register_id, &val);
 	if (status != 0) {
 		return status;
 	}
 
-	val = (val & ~mask) | (value & mask);
+	new_val = (val & ~mask) | (value & mask);
+
+#if PMIC_SHADOW
+	/* The shadow holds the register value: nothing to write */
+	if (shadowed(register_id) && (new_val == val)) {
+		return 0;
+	}
+#endif
+
+	return stpmic1_register_write(register_id, new_val);
+}
+
+#if PMIC_SHADOW
+/* Shadowed register at @idx not read yet */
+static bool shadow_to_load(uint8_t idx)
+{
+	return shadowed(SHADOW_FIRST_REG + idx) &&
+	       ((shadow_valid & BIT_64(idx)) == 0U);
+}
+#endif
+
+int stpmic1_batch_start(void)
+{
+#if PMIC_SHADOW
+	uint8_t first, last;
+	int status;
+
+	/* Read each run of registers not shadowed yet at once */
+	for (first = 0U; first < SHADOW_NB_REGS; first = last + 1U) {
+		if (!shadow_to_load(first)) {
+			last = first;
+			continue;
+		}
+
+		for (last = first; last < (SHADOW_NB_REGS - 1U); last++) {
+			if (!shadow_to_load(last + 1U)) {
+				break;
+			}
+		}
+
+		status = pmic_i2c_read(SHADOW_FIRST_REG + first,
+				       &shadow_regs[first], last - first + 1U);
+		if (status != 0) {
+			return status;
+		}
+
+		shadow_valid |= GENMASK_64(last, first);
+	}
+
+	shadow_batch = true;
+#endif
+
+	return 0;
+}
+
+int stpmic1_batch_flush(void)
+{
+#if PMIC_SHADOW
+	uint8_t first, last;
+	int status;
+
+	shadow_batch = false;
+
+	for (first = 0U; first < SHADOW_NB_REGS; first = last + 1U) {
+		if ((shadow_dirty & BIT_64(first)) == 0U) {
+			last = first;
+			continue;
+		}
+
+		for (last = first; last < (SHADOW_NB_REGS - 1U); last++) {
+			if ((shadow_dirty & BIT_64(last + 1U)) == 0U) {
+				break;
+			}
+		}
+
+		status = pmic_i2c_write(SHADOW_FIRST_REG + first,
+					&shadow_regs[first],
+					last - first + 1U);
+		if (status != 0) {
+			shadow_valid = 0U;
+			shadow_dirty = 0U;
+			return status;
+		}
+
+		shadow_dirty &= ~GENMASK_64(last, first);
+	}
+#endif
 
-	return stpmic1_register_write(register_id, val);
+	return 0;
 }
 
 void stpmic1_bind_i2c(struct i2c_handle_s *i2c_handle, uint16_t i2c_addr)
@@ -909,15 +1089,13 @@ void stpmic1_bind_i2c(struct i2c_handle_s *i2c_handle, uint16_t i2c_addr)
 
 void stpmic1_dump_regulators(void)
 {
-	uint32_t i;
-
-	for (i = 0U; i < MAX_REGUL; i++) {
-		const char *name __unused = regulators_table[i].dt_node_name;
+	uint8_t i;
 
+	for (i = 0U; i < STPMIC1_NB_REG; i++) {
 		VERBOSE("PMIC regul %s: %sable, %dmV",
-			name,
-			stpmic1_is_regulator_enabled(name) ? "en" : "dis",
-			stpmic1_regulator_voltage_get(name));
+			regulators_table[i].dt_node_name,
+			stpmic1_is_regulator_enabled(i) ? "en" : "dis",
+			stpmic1_regulator_voltage_get(i));
 	}
 }
 
@@ -10,6 +10,7 @@
 
 #include <common/debug.h>
 #include <drivers/st/stpmic2.h>
+#include <lib/utils.h>
 
 #define RET_SUCCESS			0
 #define RET_ERROR_NOT_SUPPORTED		-1
@@ -20,6 +21,33 @@
 
 #define VOLTAGE_INDEX_INVALID		((size_t)~0U)
 
+/*
+ * In BL2, nothing else accesses the PMIC: the control registers are
+ * shadowed, written through, so that register updates do not read them
+ * again and skip the writes that do not change them.
+ * stpmic2_batch_start() reads the registers not shadowed yet, each run of
+ * contiguous registers at once. Until stpmic2_batch_flush(), writes then
+ * only update the shadow and each run of contiguous dirty registers is
+ * written with a single auto-increment I2C transfer.
+ * MAIN_CR, WDG_CR (self-clearing bits) and WDG_TMR_SR are never shadowed.
+ */
+#if defined(IMAGE_BL2)
+#define PMIC_SHADOW			1
+#else
+#define PMIC_SHADOW			0
+#endif
+#define SHADOW_FIRST_REG		VINLOW_CR
+#define SHADOW_LAST_REG			REFDDR_PWRCTRL_CR
+#define SHADOW_NB_REGS			(SHADOW_LAST_REG - SHADOW_FIRST_REG + 1U)
+#define SHADOW_NB_WORDS			DIV_ROUND_UP_2EVAL(SHADOW_NB_REGS, 32U)
+
+#if PMIC_SHADOW
+static uint8_t shadow_regs[SHADOW_NB_REGS];
+static uint32_t shadow_valid[SHADOW_NB_WORDS];
+static uint32_t shadow_dirty[SHADOW_NB_WORDS];
+static bool shadow_batch;
+#endif
+
 struct regul_struct {
 	const char *name;
 	const uint16_t *volt_table;
@@ -164,14 +192,14 @@ static const struct regul_struct regul_table[STPMIC2_NB_REG] = {
 
 };
 
-int stpmic2_register_read(struct pmic_handle_s *pmic,
-			  uint8_t register_id, uint8_t *value)
+static int pmic_i2c_read(struct pmic_handle_s *pmic, uint8_t register_id,
+			 uint8_t *value, uint16_t size)
 {
 	int ret = stm32_i2c_mem_read(pmic->i2c_handle,
 				     pmic->i2c_addr,
 				     (uint16_t)register_id,
 				     I2C_MEMADD_SIZE_8BIT, value,
-				     1, I2C_TIMEOUT_MS);
+				     size, I2C_TIMEOUT_MS);
 	if (ret != 0) {
 		ERROR("Failed to read reg:0x%x\n", register_id);
 	}
@@ -179,15 +207,14 @@ int stpmic2_register_read(struct pmic_handle_s *pmic,
 	return ret;
 }
 
-int stpmic2_register_write(struct pmic_handle_s *pmic,
-			   uint8_t register_id, uint8_t value)
+static int pmic_i2c_write(struct pmic_handle_s *pmic, uint8_t register_id,
+			  uint8_t *value, uint16_t size)
 {
-	uint8_t val = value;
 	int ret = stm32_i2c_mem_write(pmic->i2c_handle,
 				      pmic->i2c_addr,
 				      (uint16_t)register_id,
-				      I2C_MEMADD_SIZE_8BIT, &val,
-				      1, I2C_TIMEOUT_MS);
+				      I2C_MEMADD_SIZE_8BIT, value,
+				      size, I2C_TIMEOUT_MS);
 	if (ret != 0) {
 		ERROR("Failed to write reg:0x%x\n", register_id);
 	}
@@ -195,23 +222,192 @@ int stpmic2_register_write(struct pmic_handle_s *pmic,
 	return ret;
 }
 
+#if PMIC_SHADOW
+static bool shadowed(uint8_t register_id)
+{
+	return (register_id >= SHADOW_FIRST_REG) &&
+	       (register_id <= SHADOW_LAST_REG) &&
+	       (register_id != WDG_CR) && (register_id != WDG_TMR_SR);
+}
+
+static bool shadow_test(const uint32_t *bitmap, unsigned int idx)
+{
+	return (bitmap[idx / 32U] & BIT_32(idx % 32U)) != 0U;
+}
+
+static void shadow_set(uint32_t *bitmap, unsigned int idx)
+{
+	bitmap[idx / 32U] |= BIT_32(idx % 32U);
+}
+
+static void shadow_clear(uint32_t *bitmap, unsigned int idx)
+{
+	bitmap[idx / 32U] &= ~BIT_32(idx % 32U);
+}
+#endif
+
+int stpmic2_register_read(struct pmic_handle_s *pmic,
+			  uint8_t register_id, uint8_t *value)
+{
+#if PMIC_SHADOW
+	if (shadowed(register_id)) {
+		unsigned int idx = register_id - SHADOW_FIRST_REG;
+		int ret;
+
+		if (!shadow_test(shadow_valid, idx)) {
+			ret = pmic_i2c_read(pmic, register_id,
+					    &shadow_regs[idx], 1U);
+			if (ret != 0) {
+				return ret;
+			}
+
+			shadow_set(shadow_valid, idx);
+		}
+
+		*value = shadow_regs[idx];
+
+		return 0;
+	}
+#endif
+
+	return pmic_i2c_read(pmic, register_id, value, 1U);
+}
+
+int stpmic2_register_write(struct pmic_handle_s *pmic,
+			   uint8_t register_id, uint8_t value)
+{
+	uint8_t val = value;
+
+#if PMIC_SHADOW
+	if (shadowed(register_id)) {
+		unsigned int idx = register_id - SHADOW_FIRST_REG;
+		int ret = 0;
+
+		shadow_regs[idx] = value;
+		shadow_set(shadow_valid, idx);
+
+		if (shadow_batch) {
+			shadow_set(shadow_dirty, idx);
+		} else {
+			ret = pmic_i2c_write(pmic, register_id,
+					     &shadow_regs[idx], 1U);
+			if (ret != 0) {
+				shadow_clear(shadow_valid, idx);
+			}
+		}
+
+		return ret;
+	}
+#endif
+
+	return pmic_i2c_write(pmic, register_id, &val, 1U);
+}
+
 int stpmic2_register_update(struct pmic_handle_s *pmic,
 			    uint8_t register_id, uint8_t value, uint8_t mask)
 {
 	int status;
 	uint8_t val = 0U;
+	uint8_t new_val;
 
 	status = stpmic2_register_read(pmic, register_id, &val);
 	if (status != 0) {
 		return status;
 	}
 
-	val = (val & ((uint8_t)~mask)) | (value & mask);
+	new_val = (val & ((uint8_t)~mask)) | (value & mask);
 
 	VERBOSE("REG:0x%x v=0x%x mask=0x%x -> 0x%x\n",
-		register_id, value, mask, val);
+		register_id, value, mask, new_val);
+
+#if PMIC_SHADOW
+	/* The shadow holds the register value: nothing to write */
+	if (shadowed(register_id) && (new_val == val)) {
+		return 0;
+	}
+#endif
+
+	return stpmic2_register_write(pmic, register_id, new_val);
+}
+
+#if PMIC_SHADOW
+/* Shadowed register at @idx not read yet */
+static bool shadow_to_load(unsigned int idx)
+{
+	return shadowed(SHADOW_FIRST_REG + idx) &&
+	       !shadow_test(shadow_valid, idx);
+}
+#endif
+
+int stpmic2_batch_start(struct pmic_handle_s *pmic)
+{
+#if PMIC_SHADOW
+	unsigned int first, last, i;
+	int ret;
+
+	/* Read each run of registers not shadowed yet at once */
+	for (first = 0U; first < SHADOW_NB_REGS; first = last + 1U) {
+		last = first;
+		if (!shadow_to_load(first)) {
+			continue;
+		}
+
+		while ((last < (SHADOW_NB_REGS - 1U)) &&
+		       shadow_to_load(last + 1U)) {
+			last++;
+		}
+
+		ret = pmic_i2c_read(pmic, SHADOW_FIRST_REG + first,
+				    &shadow_regs[first], last - first + 1U);
+		if (ret != 0) {
+			return ret;
+		}
+
+		for (i = first; i <= last; i++) {
+			shadow_set(shadow_valid, i);
+		}
+	}
+
+	shadow_batch = true;
+#endif
+
+	return 0;
+}
+
+int stpmic2_batch_flush(struct pmic_handle_s *pmic)
+{
+#if PMIC_SHADOW
+	unsigned int first, last, i;
+	int ret;
+
+	shadow_batch = false;
+
+	for (first = 0U; first < SHADOW_NB_REGS; first = last + 1U) {
+		last = first;
+		if (!shadow_test(shadow_dirty, first)) {
+			continue;
+		}
+
+		while ((last < (SHADOW_NB_REGS - 1U)) &&
+		       shadow_test(shadow_dirty, last + 1U)) {
+			last++;
+		}
+
+		ret = pmic_i2c_write(pmic, SHADOW_FIRST_REG + first,
+				     &shadow_regs[first], last - first + 1U);
+		if (ret != 0) {
+			zeromem(shadow_valid, sizeof(shadow_valid));
+			zeromem(shadow_dirty, sizeof(shadow_dirty));
+			return ret;
+		}
 
-	return stpmic2_register_write(pmic, register_id, val);
+		for (i = first; i <= last; i++) {
+			shadow_clear(shadow_dirty, i);
+		}
+	}
+#endif
+
+	return 0;
 }
 
 int stpmic2_regulator_set_state(struct pmic_handle_s *pmic,
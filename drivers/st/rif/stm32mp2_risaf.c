@@ -13,6 +13,9 @@
 #include <drivers/clk.h>
 #include <drivers/delay_timer.h>
 #include <drivers/st/stm32mp2_risaf.h>
+#if STM32MP_DDR_SCRUB
+#include <drivers/st/stm32mp_ddr_scrub.h>
+#endif
 #include <dt-bindings/soc/rif.h>
 #include <lib/mmio.h>
 #include <lib/utils_def.h>
@@ -21,6 +24,10 @@
 #include <platform_def.h>
 #include <plat/common/platform.h>
 #include <stm32mp_fconf_getter.h>
+#if STM32MP_RISAF_TABLE
+#include <common/tf_crc32.h>
+#include <stm32mp2_risaf_table.h>
+#endif
 
 /* RISAF general registers (base relative) */
 #define _RISAF_CR			U(0x00)
@@ -658,9 +665,118 @@ static int risaf_parse_fwconfig(uintptr_t config)
 	return 0;
 }
 
+#if STM32MP_DDR_SCRUB
+/* Initialize an encrypted DDR region through the cipher */
+static void risaf_scrub_region(int instance, uintptr_t addr, size_t len)
+{
+	/* DDR content is kept when exiting from standby */
+	if ((stm32_risaf_get_memory_base(instance) != STM32MP_DDR_BASE) ||
+	    stm32mp_is_wakeup_from_standby()) {
+		return;
+	}
+
+	if (stm32mp_ddr_scrub(addr, len) != 0) {
+		panic();
+	}
+}
+#endif
+
+#if STM32MP_RISAF_TABLE
+/*
+ * Apply the register writes generated at build time from the FW_CONFIG, where
+ * the regions were already checked. Only the checks that depend on the
+ * hardware and on the DDR size are done here, before the first write.
+ */
+static int risaf_apply_table(uintptr_t config)
+{
+	struct stm32mp2_risaf_platdata *pdata = &stm32mp2_risaf;
+	const void *fdt = (const void *)config;
+	unsigned int i;
+	unsigned int n;
+
+	/* Regions from the boot DT would need an overlap check */
+	if ((pdata->nregions != 0) ||
+	    (fdt_totalsize(fdt) != STM32MP2_RISAF_TABLE_FDT_SIZE) ||
+	    (tf_crc32(0U, fdt, STM32MP2_RISAF_TABLE_FDT_SIZE) !=
+	     STM32MP2_RISAF_TABLE_FDT_CRC)) {
+		return -ENOENT;
+	}
+
+	for (i = 0U; i < ARRAY_SIZE(stm32mp2_risaf_table_instances); i++) {
+		const struct stm32mp2_risaf_table_instance *t =
+			&stm32mp2_risaf_table_instances[i];
+		uintptr_t base = pdata->base[t->instance];
+		uint32_t hwcfgr;
+		uint32_t mask_lsb;
+		uint32_t mask_msb;
+		bool enc_ok;
+
+		if (base == 0U) {
+			return -ENODEV;
+		}
+
+		clk_enable(pdata->clock[t->instance]);
+		hwcfgr = mmio_read_32(base + _RISAF_HWCFGR);
+		enc_ok = !t->enc || risaf_is_hw_encryption_functional(t->instance);
+		clk_disable(pdata->clock[t->instance]);
+
+		mask_lsb = (hwcfgr & _RISAF_HWCFGR_CFG3_MASK) >> _RISAF_HWCFGR_CFG3_SHIFT;
+		mask_msb = mask_lsb + ((hwcfgr & _RISAF_HWCFGR_CFG4_MASK) >>
+				       _RISAF_HWCFGR_CFG4_SHIFT) - 1U;
+
+		if ((t->granularity != BIT(mask_lsb)) ||
+		    (t->max_id >= ((hwcfgr & _RISAF_HWCFGR_CFG1_MASK) >>
+				   _RISAF_HWCFGR_CFG1_SHIFT)) ||
+		    ((t->end >> (mask_msb + 1U)) != 0U) ||
+		    (t->end >= stm32_risaf_get_memory_size(t->instance)) ||
+		    !enc_ok) {
+			return -EINVAL;
+		}
+	}
+
+	for (i = 0U; i < ARRAY_SIZE(stm32mp2_risaf_table_instances); i++) {
+		const struct stm32mp2_risaf_table_instance *t =
+			&stm32mp2_risaf_table_instances[i];
+		uintptr_t base = pdata->base[t->instance];
+
+		clk_enable(pdata->clock[t->instance]);
+
+		for (n = t->first; n < (t->first + t->nwrites); n++) {
+			mmio_write_32(base + stm32mp2_risaf_table_writes[n].offset,
+				      stm32mp2_risaf_table_writes[n].value);
+		}
+
+		clk_disable(pdata->clock[t->instance]);
+	}
+
+#if STM32MP_DDR_SCRUB
+	for (i = 0U; i < ARRAY_SIZE(stm32mp2_risaf_table_enc_regions); i++) {
+		risaf_scrub_region(stm32mp2_risaf_table_enc_regions[i].instance,
+				   (uintptr_t)stm32mp2_risaf_table_enc_regions[i].base,
+				   (size_t)stm32mp2_risaf_table_enc_regions[i].size);
+	}
+#endif
+
+	return 0;
+}
+#endif /* STM32MP_RISAF_TABLE */
+
 static int fconf_populate_risaf(uintptr_t config)
 {
 	int err;
+#if STM32MP_DDR_SCRUB
+	int i;
+#endif
+
+#if STM32MP_RISAF_TABLE
+	err = risaf_apply_table(config);
+	if (err == 0) {
+		return 0;
+	}
+
+	/* FW_CONFIG not the one of the build, or a different SoC */
+	VERBOSE("RISAF: no build time table (%d), parse FW_CONFIG\n", err);
+#endif
 
 	err = risaf_parse_fwconfig(config);
 	if (err != 0) {
@@ -669,6 +785,16 @@ static int fconf_populate_risaf(uintptr_t config)
 
 	risaf_conf_protreg();
 
+#if STM32MP_DDR_SCRUB
+	for (i = 0; i < stm32mp2_risaf.nregions; i++) {
+		struct stm32mp2_risaf_region *region = &stm32mp2_risaf.region[i];
+
+		if (((region->cfg & DT_RISAF_ENC_MASK) >> (DT_RISAF_ENC_SHIFT + 1)) != 0U) {
+			risaf_scrub_region(region->instance, region->addr, region->len);
+		}
+	}
+#endif
+
 	return err;
 }
 
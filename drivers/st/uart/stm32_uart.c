@@ -22,6 +22,9 @@
 /* UART time-out value */
 #define STM32_UART_TIMEOUT_US	20000U
 
+/* Maximum baud rate error, in percent, tolerated by the receivers */
+#define STM32_UART_BAUD_ERROR_PCT	2U
+
 /* Mask to clear ALL the configuration registers */
 
 #define STM32_UART_CR1_FIELDS \
@@ -109,6 +112,7 @@ static int uart_set_config(struct stm32_uart_handle_s *huart,
 	uint32_t tmpreg;
 	unsigned long clockfreq;
 	unsigned long int_div;
+	unsigned long actual_baud;
 	uint32_t brrtemp;
 	uint32_t over_sampling;
 
@@ -124,6 +128,12 @@ static int uart_set_config(struct stm32_uart_handle_s *huart,
 						       init->baud_rate,
 						       init->prescaler);
 
+		/* BRR must be at least 16, i.e. baud rate up to clock / 8 */
+		if (usartdiv < 16U) {
+			return -EINVAL;
+		}
+
+		actual_baud = (clockfreq / presc_table[init->prescaler]) * 2U / usartdiv;
 		brrtemp = (usartdiv & USART_BRR_DIV_MANTISSA) |
 			  ((usartdiv & USART_BRR_DIV_FRACTION) >> 1);
 		over_sampling = USART_CR1_OVER8;
@@ -132,10 +142,25 @@ static int uart_set_config(struct stm32_uart_handle_s *huart,
 					      init->baud_rate,
 					      init->prescaler) &
 			  (USART_BRR_DIV_FRACTION | USART_BRR_DIV_MANTISSA);
+
+		/* BRR must be at least 16, the prescaler may bring it below */
+		if (brrtemp < 16U) {
+			return -EINVAL;
+		}
+
+		actual_baud = (clockfreq / presc_table[init->prescaler]) / brrtemp;
 		over_sampling = 0x0U;
 	}
 	mmio_write_32(huart->base + USART_BRR, brrtemp);
 
+	/* High baud rates may not be reachable accurately from the UART clock */
+	if ((MAX(actual_baud, (unsigned long)init->baud_rate) -
+	     MIN(actual_baud, (unsigned long)init->baud_rate)) * 100U >
+	    (unsigned long)init->baud_rate * STM32_UART_BAUD_ERROR_PCT) {
+		WARN("UART: baud rate %u configured as %lu\n",
+		     init->baud_rate, actual_baud);
+	}
+
 	/*
 	 * ---------------------- USART CR1 Configuration --------------------
 	 * Clear M, PCE, PS, TE, RE and OVER8 bits and configure
@@ -411,6 +436,54 @@ int stm32_uart_flush(struct stm32_uart_handle_s *huart)
 	return stm32_uart_wait_flag(huart, USART_ISR_TC);
 }
 
+/*
+ * @brief  Receive a buffer, reading the RX FIFO as long as it holds data.
+ * @param  huart: UART handle.
+ * @param  buf: destination buffer.
+ * @param  len: number of data to receive.
+ * @param  timeout_us: maximum time to wait for the next data.
+ * @retval UART status.
+ */
+int stm32_uart_read(struct stm32_uart_handle_s *huart, uint8_t *buf,
+		    size_t len, uint32_t timeout_us)
+{
+	uint64_t timeout_ref = 0ULL;
+	bool waiting = false;
+	size_t i = 0U;
+
+	if ((huart == NULL) || (buf == NULL)) {
+		return -EINVAL;
+	}
+
+	while (i < len) {
+		uint32_t isr = mmio_read_32(huart->base + USART_ISR);
+
+		if ((isr & USART_ISR_RXNE) == 0U) {
+			/* Only look at the timer while the FIFO is empty */
+			if (!waiting) {
+				timeout_ref = timeout_init_us(timeout_us);
+				waiting = true;
+			} else if (timeout_elapsed(timeout_ref)) {
+				return -ETIMEDOUT;
+			}
+
+			continue;
+		}
+
+		waiting = false;
+		buf[i++] = (uint8_t)(mmio_read_32(huart->base + USART_RDR) & huart->rdr_mask);
+
+		/* Errors of the data just read may only show after the read */
+		if (((isr & STM32_UART_ISR_ERRORS) != 0U) ||
+		    stm32_uart_error_detected(huart)) {
+			stm32_uart_error_clear(huart);
+			return -EFAULT;
+		}
+	}
+
+	return 0;
+}
+
 /*
  * @brief  Receive a data in no blocking mode.
  * @retval value if >0 or UART status.
@@ -55,6 +55,9 @@ int auth_mod_get_parent_id(unsigned int img_id, unsigned int *parent_id);
 int auth_mod_verify_img(unsigned int img_id,
 			void *img_ptr,
 			unsigned int img_len);
+int auth_mod_get_img_digest(const void *img_ptr, unsigned int img_len,
+			    const void **digest_info,
+			    unsigned int *digest_info_len);
 
 /* Macro to register a CoT defined as an array of auth_img_desc_t pointers */
 #define REGISTER_COT(_cot) \
@@ -7,6 +7,8 @@
 #ifndef IO_BLOCK_H
 #define IO_BLOCK_H
 
+#include <stdbool.h>
+
 #include <drivers/io/io_storage.h>
 
 /* block devices ops */
@@ -19,6 +21,11 @@ typedef struct io_block_dev_spec {
 	io_block_spec_t	buffer;
 	io_block_ops_t	ops;
 	size_t		block_size;
+	/*
+	 * Whole blocks are read straight into block aligned user buffers, the
+	 * device must then be able to write anywhere the users read into.
+	 */
+	bool		direct_read;
 } io_block_dev_spec_t;
 
 struct io_dev_connector;
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IO_CACHE_H
+#define IO_CACHE_H
+
+#include <stdint.h>
+
+#include <drivers/io/io_storage.h>
+
+/*
+ * Read cache stacked on a device accessed with io_block_spec_t specs
+ * (io_block, io_mtd, io_memmap...). The files opened on the cache device use
+ * the same io_block_spec_t specs as on the backend device.
+ */
+typedef struct io_cache_dev_spec {
+	/* Device holding the data, already opened and initialised */
+	uintptr_t	backend_dev_handle;
+	/* Size of the backend device, the cache never reads beyond it */
+	size_t		backend_size;
+	/* RAM window holding the cache lines */
+	io_block_spec_t	buffer;
+	/* Size of a cache line, a power of 2 multiple of the backend block */
+	size_t		line_size;
+	/* Lines read with a single backend command on a sequential miss */
+	unsigned int	readahead;
+} io_cache_dev_spec_t;
+
+typedef struct io_cache_stats {
+	unsigned long	hits;		/* Lines found in the cache */
+	unsigned long	misses;		/* Lines read from the backend */
+	unsigned long	prefetched;	/* Lines read ahead of a miss */
+	unsigned long	dev_reads;	/* Backend read commands */
+} io_cache_stats_t;
+
+struct io_dev_connector;
+
+int register_io_dev_cache(const struct io_dev_connector **dev_con);
+
+/* Drop all cache lines, e.g. after the backend device was written */
+void io_cache_invalidate(void);
+
+void io_cache_get_stats(io_cache_stats_t *stats);
+
+#endif /* IO_CACHE_H */
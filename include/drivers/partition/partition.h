@@ -27,6 +27,14 @@ CASSERT((PLAT_PARTITION_BLOCK_SIZE == 512) ||
 	(PLAT_PARTITION_BLOCK_SIZE == 4096),
 	assert_plat_partition_block_size);
 
+#if !PLAT_PARTITION_BUFFER_SIZE
+# define PLAT_PARTITION_BUFFER_SIZE	PLAT_PARTITION_BLOCK_SIZE
+#endif /* PLAT_PARTITION_BUFFER_SIZE */
+
+CASSERT((PLAT_PARTITION_BUFFER_SIZE != 0) &&
+	((PLAT_PARTITION_BUFFER_SIZE % PLAT_PARTITION_BLOCK_SIZE) == 0),
+	assert_plat_partition_buffer_size);
+
 #define LEGACY_PARTITION_BLOCK_SIZE	512
 
 #define DEFAULT_GPT_HEADER_SIZE 	92
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2022, STMicroelectronics - All Rights Reserved
+ * Copyright (c) 2015-2024, STMicroelectronics - All Rights Reserved
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -58,6 +58,8 @@
 int dt_set_pinctrl_config(int node);
 void set_gpio_secure_cfg(uint32_t bank, uint32_t pin, bool secure);
 void set_gpio_reset_cfg(uint32_t bank, uint32_t pin);
+uint32_t get_gpio_bank_secure_cfg(uint32_t bank);
+void restore_gpio_bank_secure_cfg(uint32_t bank, uint32_t secure_pins);
 
 enum gpio_level {
 	GPIO_LEVEL_LOW,
@@ -29,5 +29,6 @@ int stm32_pka_ecdsa_verif(void *hash, unsigned int hash_size,
 			  void *pk_x_ptr, unsigned int pk_x_size,
 			  void *pk_y_ptr, unsigned int pk_y_size,
 			  enum stm32_pka_ecdsa_curve_id cid);
+void stm32_pka_release(void);
 
 #endif /* STM32_PKA_H */
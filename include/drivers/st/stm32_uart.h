@@ -7,6 +7,9 @@
 #ifndef STM32_UART_H
 #define STM32_UART_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 /* UART word length */
 #define STM32_UART_WORDLENGTH_7B		USART_CR1_M1
 #define STM32_UART_WORDLENGTH_8B		0x00000000U
@@ -155,5 +158,7 @@ void stm32_uart_stop(uintptr_t base_addr);
 int stm32_uart_putc(struct stm32_uart_handle_s *huart, int c);
 int stm32_uart_flush(struct stm32_uart_handle_s *huart);
 int stm32_uart_getc(struct stm32_uart_handle_s *huart);
+int stm32_uart_read(struct stm32_uart_handle_s *huart, uint8_t *buf,
+		    size_t len, uint32_t timeout_us);
 
 #endif /* STM32_UART_H */
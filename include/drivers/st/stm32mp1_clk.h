@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2022, STMicroelectronics - All Rights Reserved
+ * Copyright (c) 2018-2024, STMicroelectronics - All Rights Reserved
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -25,6 +25,37 @@ extern const char *stm32mp_osc_node_label[NB_OSC];
 int stm32mp1_clk_probe(void);
 int stm32mp1_clk_init(uint32_t pll1_freq_khz);
 
+#if STM32MP1_FAST_RESUME
+#define STM32MP1_CLK_SNAPSHOT_PLL_NB	4U
+#define STM32MP1_CLK_SNAPSHOT_DIV_NB	25U
+#define STM32MP1_CLK_SNAPSHOT_MUX_NB	44U
+
+struct stm32mp1_clk_pll_snapshot {
+	uint32_t cfgr1;
+	uint32_t cfgr2;
+	uint32_t fracr;
+	uint32_t csgr;
+	uint32_t cr;
+};
+
+/*
+ * Registers of the clock tree read at suspend, replayed on a wakeup from
+ * Standby instead of parsing the device tree again.
+ */
+struct stm32mp1_clk_snapshot {
+	uint32_t ocenr;
+	uint32_t rdlsicr;
+	uint32_t bdcr;
+	uint32_t hsicfgr;
+	struct stm32mp1_clk_pll_snapshot pll[STM32MP1_CLK_SNAPSHOT_PLL_NB];
+	uint8_t div[STM32MP1_CLK_SNAPSHOT_DIV_NB];
+	uint8_t mux[STM32MP1_CLK_SNAPSHOT_MUX_NB];
+};
+
+void stm32mp1_clk_get_snapshot(struct stm32mp1_clk_snapshot *snap);
+int stm32mp1_clk_restore_snapshot(const struct stm32mp1_clk_snapshot *snap);
+#endif
+
 bool stm32mp1_rcc_is_secure(void);
 bool stm32mp1_rcc_is_mckprot(void);
 
@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef STM32MP_DDR_SCRUB_H
+#define STM32MP_DDR_SCRUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+int stm32mp_ddr_scrub(uintptr_t base, size_t size);
+
+#endif /* STM32MP_DDR_SCRUB_H */
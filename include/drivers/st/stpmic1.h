@@ -10,6 +10,25 @@
 #include <drivers/st/stm32_i2c.h>
 #include <lib/utils_def.h>
 
+/* Regulator IDs, index of the driver regulator table */
+enum {
+	STPMIC1_BUCK1 = 0,
+	STPMIC1_BUCK2,
+	STPMIC1_BUCK3,
+	STPMIC1_BUCK4,
+	STPMIC1_LDO1,
+	STPMIC1_LDO2,
+	STPMIC1_LDO3,
+	STPMIC1_LDO4,
+	STPMIC1_LDO5,
+	STPMIC1_LDO6,
+	STPMIC1_VREF_DDR,
+	STPMIC1_BOOST,
+	STPMIC1_VBUS_OTG,
+	STPMIC1_SW_OUT,
+	STPMIC1_NB_REG
+};
+
 #define TURN_ON_REG			0x1U
 #define TURN_OFF_REG			0x2U
 #define ICC_LDO_TURN_OFF_REG		0x3U
@@ -177,19 +196,26 @@ int stpmic1_switch_off(void);
 int stpmic1_register_read(uint8_t register_id, uint8_t *value);
 int stpmic1_register_write(uint8_t register_id, uint8_t value);
 int stpmic1_register_update(uint8_t register_id, uint8_t value, uint8_t mask);
-int stpmic1_regulator_enable(const char *name);
-int stpmic1_regulator_disable(const char *name);
-bool stpmic1_is_regulator_enabled(const char *name);
-int stpmic1_regulator_voltage_set(const char *name, uint16_t millivolts);
-int stpmic1_regulator_levels_mv(const char *name, const uint16_t **levels,
+/*
+ * Read the configuration registers at once and defer their writes until
+ * stpmic1_batch_flush(), which writes contiguous registers at once. Later
+ * updates are then served from the shadow. Only in BL2, no effect otherwise.
+ */
+int stpmic1_batch_start(void);
+int stpmic1_batch_flush(void);
+int stpmic1_regulator_enable(uint8_t id);
+int stpmic1_regulator_disable(uint8_t id);
+bool stpmic1_is_regulator_enabled(uint8_t id);
+int stpmic1_regulator_voltage_set(uint8_t id, uint16_t millivolts);
+int stpmic1_regulator_levels_mv(uint8_t id, const uint16_t **levels,
 				size_t *levels_count);
-int stpmic1_regulator_voltage_get(const char *name);
-int stpmic1_regulator_pull_down_set(const char *name);
-int stpmic1_regulator_mask_reset_set(const char *name);
-int stpmic1_regulator_icc_set(const char *name);
-int stpmic1_regulator_sink_mode_set(const char *name);
-int stpmic1_regulator_bypass_mode_set(const char *name);
-int stpmic1_active_discharge_mode_set(const char *name);
+int stpmic1_regulator_voltage_get(uint8_t id);
+int stpmic1_regulator_pull_down_set(uint8_t id);
+int stpmic1_regulator_mask_reset_set(uint8_t id);
+int stpmic1_regulator_icc_set(uint8_t id);
+int stpmic1_regulator_sink_mode_set(uint8_t id);
+int stpmic1_regulator_bypass_mode_set(uint8_t id);
+int stpmic1_active_discharge_mode_set(uint8_t id);
 void stpmic1_bind_i2c(struct i2c_handle_s *i2c_handle, uint16_t i2c_addr);
 
 int stpmic1_get_version(unsigned long *version);
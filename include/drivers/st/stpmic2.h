@@ -280,6 +280,13 @@ int stpmic2_register_write(struct pmic_handle_s *pmic,
 			   uint8_t register_id, uint8_t value);
 int stpmic2_register_update(struct pmic_handle_s *pmic,
 			    uint8_t register_id, uint8_t value, uint8_t mask);
+/*
+ * Read the control registers at once and defer their writes until
+ * stpmic2_batch_flush(), which writes contiguous registers at once. Later
+ * updates are then served from the shadow. Only in BL2, no effect otherwise.
+ */
+int stpmic2_batch_start(struct pmic_handle_s *pmic);
+int stpmic2_batch_flush(struct pmic_handle_s *pmic);
 
 int stpmic2_regulator_set_state(struct pmic_handle_s *pmic,
 				uint8_t id, bool enable);
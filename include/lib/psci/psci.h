@@ -97,6 +97,17 @@
 #endif
 #endif
 
+#if PSCI_STAT_HISTOGRAM
+/*
+ * Suspend latency histograms: bucket 0 counts latencies below 1us, bucket N
+ * counts latencies in [2^(N-1), 2^N) us and the last bucket saturates.
+ */
+#define PSCI_STAT_HIST_BUCKETS		U(16)
+#define PSCI_STAT_HIST_ENTRY		U(0)
+#define PSCI_STAT_HIST_EXIT		U(1)
+#define PSCI_STAT_HIST_TYPES		U(2)
+#endif
+
 /* The macros below are used to identify PSCI calls from the SMC function ID */
 #define PSCI_FID_MASK			U(0xffe0)
 #define PSCI_FID_VALUE			U(0)
@@ -335,6 +346,10 @@ typedef struct plat_psci_ops {
 	void (*pwr_domain_suspend_pwrdown_early)(
 				const psci_power_state_t *target_state);
 	void (*pwr_domain_suspend)(const psci_power_state_t *target_state);
+#if PSCI_STAT_HISTOGRAM
+	void (*pwr_domain_demote_suspend)(psci_power_state_t *req_state,
+				u_register_t predicted_residency);
+#endif
 	void (*pwr_domain_on_finish)(const psci_power_state_t *target_state);
 	void (*pwr_domain_on_finish_late)(
 				const psci_power_state_t *target_state);
@@ -94,6 +94,10 @@ int psci_stop_other_cores(unsigned int wait_ms,
 bool psci_is_last_on_cpu_safe(void);
 bool psci_are_all_cpus_on_safe(void);
 void psci_pwrdown_cpu(unsigned int power_level);
+#if PSCI_STAT_HISTOGRAM
+u_register_t psci_stat_latency_hist(u_register_t target_cpu,
+				    unsigned int type, unsigned int bucket);
+#endif
 
 #endif /* __ASSEMBLER__ */
 
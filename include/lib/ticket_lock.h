@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef TICKET_LOCK_H
+#define TICKET_LOCK_H
+
+#if !HW_ASSISTED_COHERENCY
+#include <platform_def.h>
+#endif
+
+#ifndef __ASSEMBLER__
+
+#include <cdefs.h>
+#include <stdint.h>
+
+/*
+ * Fair ticket lock built on load-/store-exclusive (or ARMv8.1-LSE atomics).
+ * Acquiring the lock is a single atomic increment of `next`, followed by a
+ * wait on `owner`, so the cost does not depend on the number of CPUs like
+ * the bakery lock does.
+ *
+ * Without HW_ASSISTED_COHERENCY, the lock may be released by a CPU whose data
+ * cache is already off, as PSCI does on the power down path. `owner` and
+ * `next` then live in separate cache lines: `next` is only updated by
+ * coherent CPUs, taking their ticket with the data cache on, while `owner` is
+ * only written by the lock holder, which cleans it to memory, and waiters
+ * invalidate it before reading it.
+ */
+#if HW_ASSISTED_COHERENCY
+typedef struct ticket_lock {
+	volatile uint16_t owner;
+	volatile uint16_t next;
+} ticket_lock_t;
+#else
+typedef struct ticket_lock {
+	volatile uint16_t owner;
+	uint8_t pad[CACHE_WRITEBACK_GRANULE - sizeof(uint16_t)];
+	volatile uint16_t next;
+} __aligned(CACHE_WRITEBACK_GRANULE) ticket_lock_t;
+#endif
+
+#define DEFINE_TICKET_LOCK(_name)	ticket_lock_t _name
+#define DECLARE_TICKET_LOCK(_name)	extern DEFINE_TICKET_LOCK(_name)
+
+void ticket_lock_get(ticket_lock_t *lock);
+void ticket_lock_release(ticket_lock_t *lock);
+
+#else
+
+/* Ticket lock definitions for use in assembly */
+#if HW_ASSISTED_COHERENCY
+#define TICKET_LOCK_NEXT_SHIFT	16
+#else
+#define TICKET_LOCK_NEXT_OFFSET	CACHE_WRITEBACK_GRANULE
+#endif
+
+#endif
+
+#endif /* TICKET_LOCK_H */
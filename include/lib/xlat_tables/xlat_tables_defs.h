@@ -55,6 +55,8 @@
 #define PXN			(ULL(1) << 1)
 #define CONT_HINT		(ULL(1) << 0)
 #define UPPER_ATTRS(x)		(((x) & ULL(0x7)) << 52)
+/* Number of aligned entries that a contiguous hint applies to (4KB granule) */
+#define XLAT_CONT_ENTRIES	U(16)
 
 #define NON_GLOBAL		(U(1) << 9)
 #define ACCESS_FLAG		(U(1) << 8)
@@ -39,4 +39,30 @@ struct fw_enc_hdr {
 	uint8_t tag[ENC_MAX_TAG_SIZE];
 };
 
+/*
+ * Chunked AES-GCM payload, kept out of the values of enum crypto_dec_algo.
+ * The encryption header (whose tag is unused) is followed by a chunk header
+ * and by the encrypted chunks, each one followed by its own tag.
+ *
+ * The chunks are not encrypted with the image key, but with a key derived
+ * from it by HKDF-SHA256, with the header IV as salt and ENC_CHUNK_KDF_INFO
+ * as info. Chunk n then uses a 12-byte IV made of 4 zero bytes and of n as a
+ * 64-bit big-endian counter. An IV is thus never reused under a key as long
+ * as each image has its own nonce, as for the single tag format. The chunk
+ * header is the additional authenticated data of every chunk, so that chunks
+ * cannot be reordered, dropped or swapped between images. Only the last
+ * chunk may be shorter than chunk_size.
+ *
+ * This format lets a loader authenticate an image chunk by chunk; it is not
+ * decrypted by the io_encrypted driver yet.
+ */
+#define ENC_DEC_ALGO_GCM_CHUNKED	0x100U
+#define ENC_CHUNK_KDF_INFO		"TF-A chunked AES-GCM"
+
+struct fw_enc_chunk_hdr {
+	uint32_t chunk_size;
+	uint32_t reserved;
+	uint64_t data_size;
+};
+
 #endif /* FIRMWARE_ENCRYPTED_H */
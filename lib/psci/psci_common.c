@@ -970,6 +970,7 @@ void psci_warmboot_entrypoint(void)
 	unsigned int cpu_idx = plat_my_core_pos();
 	unsigned int parent_nodes[PLAT_MAX_PWR_LVL] = {0};
 	psci_power_state_t state_info = { {PSCI_LOCAL_STATE_RUN} };
+	bool resumed;
 
 	/*
 	 * Verify that we have been explicitly turned ON or resumed from
@@ -1014,7 +1015,8 @@ void psci_warmboot_entrypoint(void)
 	 * of power management handler and perform the generic, architecture
 	 * and platform specific handling.
 	 */
-	if (psci_get_aff_info_state() == AFF_STATE_ON_PENDING)
+	resumed = psci_get_aff_info_state() != AFF_STATE_ON_PENDING;
+	if (!resumed)
 		psci_cpu_on_finish(cpu_idx, &state_info);
 	else
 		psci_cpu_suspend_finish(cpu_idx, &state_info);
@@ -1039,7 +1041,7 @@ void psci_warmboot_entrypoint(void)
 	 * Since caches are now enabled, it's necessary to do cache
 	 * maintenance before reading that same data.
 	 */
-	psci_stats_update_pwr_up(end_pwrlvl, &state_info);
+	psci_stats_update_pwr_up(end_pwrlvl, &state_info, resumed);
 #endif
 
 	/*
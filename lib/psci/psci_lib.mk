@@ -25,6 +25,10 @@ PSCI_LIB_SOURCES	+=	lib/el3_runtime/aarch64/context.S	\
 				lib/psci/aarch64/runtime_errata.S
 endif
 
+ifeq (${PSCI_USE_TICKET_LOCK}, 1)
+PSCI_LIB_SOURCES		+=	lib/locks/ticket/${ARCH}/ticket_lock.S
+endif
+
 ifeq (${USE_COHERENT_MEM}, 1)
 PSCI_LIB_SOURCES		+=	lib/locks/bakery/bakery_lock_coherent.c
 else
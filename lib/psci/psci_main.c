@@ -76,6 +76,18 @@ int psci_cpu_suspend(unsigned int power_state,
 	 */
 	is_power_down_state = psci_get_pstate_type(power_state);
 
+#if PSCI_STAT_HISTOGRAM
+	/*
+	 * Let the platform demote the requested state if the predicted
+	 * residency does not pay off, and refresh the state type accordingly.
+	 */
+	psci_stats_demote_suspend(&state_info);
+	if ((is_power_down_state != 0U) &&
+	    (psci_find_max_off_lvl(&state_info) == PSCI_INVALID_PWR_LVL)) {
+		is_power_down_state = 0U;
+	}
+#endif
+
 	/* Sanity check the requested suspend levels */
 	assert(psci_validate_suspend_req(&state_info, is_power_down_state)
 			== PSCI_E_SUCCESS);
@@ -145,7 +157,7 @@ int psci_cpu_suspend(unsigned int power_state,
 		plat_psci_stat_accounting_stop(&state_info);
 
 		/* Update PSCI stats */
-		psci_stats_update_pwr_up(PSCI_CPU_PWR_LVL, &state_info);
+		psci_stats_update_pwr_up(PSCI_CPU_PWR_LVL, &state_info, true);
 #endif
 
 		return PSCI_E_SUCCESS;
@@ -16,6 +16,7 @@
 #include <lib/el3_runtime/cpu_data.h>
 #include <lib/psci/psci.h>
 #include <lib/spinlock.h>
+#include <lib/ticket_lock.h>
 
 /*
  * The PSCI capability which are provided by the generic code but does not
@@ -176,36 +177,40 @@ typedef enum suspend_mode {
 /*******************************************************************************
  * The following are helpers and declarations of locks.
  ******************************************************************************/
-#if HW_ASSISTED_COHERENCY
+#if PSCI_USE_TICKET_LOCK
 /*
- * On systems where participant CPUs are cache-coherent, we can use spinlocks
- * instead of bakery locks.
+ * Use fair ticket locks for state coordination. The locks are released after
+ * psci_pwrdown_cpu() on the power down path, which the ticket lock handles
+ * without HW_ASSISTED_COHERENCY, but they must be acquired with the data cache
+ * on, including on the warm boot path (enforced by the build).
  */
-#define DEFINE_PSCI_LOCK(_name)		spinlock_t _name
-#define DECLARE_PSCI_LOCK(_name)	extern DEFINE_PSCI_LOCK(_name)
+#define DEFINE_PSCI_LOCK(_name)		DEFINE_TICKET_LOCK(_name)
+#define DECLARE_PSCI_LOCK(_name)	DECLARE_TICKET_LOCK(_name)
 
 /* One lock is required per non-CPU power domain node */
 DECLARE_PSCI_LOCK(psci_locks[PSCI_NUM_NON_CPU_PWR_DOMAINS]);
 
-/*
- * On systems with hardware-assisted coherency, make PSCI cache operations NOP,
- * as PSCI participants are cache-coherent, and there's no need for explicit
- * cache maintenance operations or barriers to coordinate their state.
- */
-static inline void psci_flush_dcache_range(uintptr_t __unused addr,
-					   size_t __unused size)
+static inline void psci_lock_get(non_cpu_pd_node_t *non_cpu_pd_node)
 {
-	/* Empty */
+	ticket_lock_get(&psci_locks[non_cpu_pd_node->lock_index]);
 }
 
-#define psci_flush_cpu_data(member)
-#define psci_inv_cpu_data(member)
-
-static inline void psci_dsbish(void)
+static inline void psci_lock_release(non_cpu_pd_node_t *non_cpu_pd_node)
 {
-	/* Empty */
+	ticket_lock_release(&psci_locks[non_cpu_pd_node->lock_index]);
 }
 
+#elif HW_ASSISTED_COHERENCY
+/*
+ * On systems where participant CPUs are cache-coherent, we can use spinlocks
+ * instead of bakery locks.
+ */
+#define DEFINE_PSCI_LOCK(_name)		spinlock_t _name
+#define DECLARE_PSCI_LOCK(_name)	extern DEFINE_PSCI_LOCK(_name)
+
+/* One lock is required per non-CPU power domain node */
+DECLARE_PSCI_LOCK(psci_locks[PSCI_NUM_NON_CPU_PWR_DOMAINS]);
+
 static inline void psci_lock_get(non_cpu_pd_node_t *non_cpu_pd_node)
 {
 	spin_lock(&psci_locks[non_cpu_pd_node->lock_index]);
@@ -227,6 +232,39 @@ static inline void psci_lock_release(non_cpu_pd_node_t *non_cpu_pd_node)
 /* One lock is required per non-CPU power domain node */
 DECLARE_PSCI_LOCK(psci_locks[PSCI_NUM_NON_CPU_PWR_DOMAINS]);
 
+static inline void psci_lock_get(non_cpu_pd_node_t *non_cpu_pd_node)
+{
+	bakery_lock_get(&psci_locks[non_cpu_pd_node->lock_index]);
+}
+
+static inline void psci_lock_release(non_cpu_pd_node_t *non_cpu_pd_node)
+{
+	bakery_lock_release(&psci_locks[non_cpu_pd_node->lock_index]);
+}
+
+#endif /* PSCI_USE_TICKET_LOCK */
+
+#if HW_ASSISTED_COHERENCY
+/*
+ * On systems with hardware-assisted coherency, make PSCI cache operations NOP,
+ * as PSCI participants are cache-coherent, and there's no need for explicit
+ * cache maintenance operations or barriers to coordinate their state.
+ */
+static inline void psci_flush_dcache_range(uintptr_t __unused addr,
+					   size_t __unused size)
+{
+	/* Empty */
+}
+
+#define psci_flush_cpu_data(member)
+#define psci_inv_cpu_data(member)
+
+static inline void psci_dsbish(void)
+{
+	/* Empty */
+}
+
+#else /* if HW_ASSISTED_COHERENCY == 0 */
 /*
  * If not all PSCI participants are cache-coherent, perform cache maintenance
  * and issue barriers wherever required to coordinate state.
@@ -244,16 +282,6 @@ static inline void psci_dsbish(void)
 	dsbish();
 }
 
-static inline void psci_lock_get(non_cpu_pd_node_t *non_cpu_pd_node)
-{
-	bakery_lock_get(&psci_locks[non_cpu_pd_node->lock_index]);
-}
-
-static inline void psci_lock_release(non_cpu_pd_node_t *non_cpu_pd_node)
-{
-	bakery_lock_release(&psci_locks[non_cpu_pd_node->lock_index]);
-}
-
 #endif /* HW_ASSISTED_COHERENCY */
 
 static inline void psci_lock_init(non_cpu_pd_node_t *non_cpu_pd_node,
@@ -363,11 +391,15 @@ u_register_t psci_system_reset2(uint32_t reset_type, u_register_t cookie);
 void psci_stats_update_pwr_down(unsigned int end_pwrlvl,
 			const psci_power_state_t *state_info);
 void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
-			const psci_power_state_t *state_info);
+			const psci_power_state_t *state_info,
+			bool resumed);
 u_register_t psci_stat_residency(u_register_t target_cpu,
 			unsigned int power_state);
 u_register_t psci_stat_count(u_register_t target_cpu,
 			unsigned int power_state);
+#if PSCI_STAT_HISTOGRAM
+void psci_stats_demote_suspend(psci_power_state_t *state_info);
+#endif
 
 /* Private exported functions from psci_mem_protect.c */
 u_register_t psci_mem_protect(unsigned int enable);
@@ -8,7 +8,10 @@
 
 #include <platform_def.h>
 
+#include <arch_helpers.h>
 #include <common/debug.h>
+#include <lib/pmf/pmf.h>
+#include <lib/runtime_instr.h>
 #include <plat/common/platform.h>
 
 #include "psci_private.h"
@@ -39,6 +42,97 @@ static psci_stat_t psci_cpu_stat[PLATFORM_CORE_COUNT]
 static psci_stat_t psci_non_cpu_stat[PSCI_NUM_NON_CPU_PWR_DOMAINS]
 				[PLAT_MAX_PWR_LVL_STATES];
 
+#if PSCI_STAT_HISTOGRAM
+/*
+ * Weight of the last CPU residency in the predicted residency, expressed as
+ * a right shift: predicted = predicted + (last - predicted) / 8.
+ */
+#define PSCI_STAT_PREDICT_SHIFT		3
+
+/* Following structure is used for the PSCI STAT latency histograms */
+typedef struct psci_stat_hist {
+	u_register_t bucket[PSCI_STAT_HIST_TYPES][PSCI_STAT_HIST_BUCKETS];
+	u_register_t predicted_residency;
+} psci_stat_hist_t;
+
+static psci_stat_hist_t psci_cpu_hist[PLATFORM_CORE_COUNT];
+
+/*
+ * Convert the interval between two timestamps into microseconds. Intervals
+ * where the end precedes the start are discarded and reported as 0.
+ */
+static unsigned long long psci_stat_ts_to_us(unsigned long long start,
+					     unsigned long long end)
+{
+	unsigned long long ticks_per_us = read_cntfrq_el0() / MHZ_TICKS_PER_SEC;
+
+	assert(ticks_per_us > 0U);
+
+	if (end < start) {
+		return 0U;
+	}
+
+	return (end - start) / ticks_per_us;
+}
+
+static void psci_stat_hist_add(unsigned int cpu_idx, unsigned int type,
+			       unsigned long long latency_us)
+{
+	unsigned int idx = 0U;
+
+	while (((latency_us >> idx) != 0U) &&
+	       (idx < (PSCI_STAT_HIST_BUCKETS - 1U))) {
+		idx++;
+	}
+
+	psci_cpu_hist[cpu_idx].bucket[type][idx]++;
+}
+
+/*******************************************************************************
+ * This function records the entry latency (PSCI entry to WFI), the exit
+ * latency (wake-up to this point of the finisher) and the CPU residency used
+ * to predict the next one. It relies on the runtime instrumentation
+ * timestamps of the suspend that just completed on the calling CPU.
+ ******************************************************************************/
+static void psci_stats_update_hist(unsigned int cpu_idx,
+				   const psci_power_state_t *state_info,
+				   u_register_t residency)
+{
+	unsigned long long enter_psci_ts, enter_wfi_ts, exit_wfi_ts;
+	unsigned long long now = read_cntpct_el0();
+	unsigned int pmf_flags = PMF_NO_CACHE_MAINT;
+	psci_stat_hist_t *hist = &psci_cpu_hist[cpu_idx];
+
+	/* Timestamps of a power down state were captured with caches off */
+	if (is_local_state_off(
+		state_info->pwr_domain_state[PSCI_CPU_PWR_LVL]) != 0) {
+		pmf_flags = PMF_CACHE_MAINT;
+	}
+
+	PMF_GET_TIMESTAMP_BY_INDEX(rt_instr_svc, RT_INSTR_ENTER_PSCI,
+				   cpu_idx, pmf_flags, enter_psci_ts);
+	PMF_GET_TIMESTAMP_BY_INDEX(rt_instr_svc, RT_INSTR_ENTER_HW_LOW_PWR,
+				   cpu_idx, pmf_flags, enter_wfi_ts);
+	PMF_GET_TIMESTAMP_BY_INDEX(rt_instr_svc, RT_INSTR_EXIT_HW_LOW_PWR,
+				   cpu_idx, pmf_flags, exit_wfi_ts);
+
+	psci_stat_hist_add(cpu_idx, PSCI_STAT_HIST_ENTRY,
+			   psci_stat_ts_to_us(enter_psci_ts, enter_wfi_ts));
+	psci_stat_hist_add(cpu_idx, PSCI_STAT_HIST_EXIT,
+			   psci_stat_ts_to_us(exit_wfi_ts, now));
+
+	if (residency >= hist->predicted_residency) {
+		hist->predicted_residency +=
+			(residency - hist->predicted_residency) >>
+			PSCI_STAT_PREDICT_SHIFT;
+	} else {
+		hist->predicted_residency -=
+			(hist->predicted_residency - residency) >>
+			PSCI_STAT_PREDICT_SHIFT;
+	}
+}
+#endif /* PSCI_STAT_HISTOGRAM */
+
 /*
  * This functions returns the index into the `psci_stat_t` array given the
  * local power state and power domain level. If the platform implements the
@@ -105,9 +199,12 @@ void psci_stats_update_pwr_down(unsigned int end_pwrlvl,
  * This function updates the PSCI STATS(residency time and count) for CPU
  * and NON-CPU power domains.
  * It is called with caches enabled and locks acquired(for NON-CPU domain)
+ * `resumed` is false when the CPU has just been turned on, the suspend latency
+ * histograms and the predicted residency are then left untouched.
  ******************************************************************************/
 void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
-			const psci_power_state_t *state_info)
+			const psci_power_state_t *state_info,
+			bool resumed)
 {
 	unsigned int lvl, parent_idx;
 	unsigned int cpu_idx = plat_my_core_pos();
@@ -130,6 +227,12 @@ void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
 	psci_cpu_stat[cpu_idx][stat_idx].residency += residency;
 	psci_cpu_stat[cpu_idx][stat_idx].count++;
 
+#if PSCI_STAT_HISTOGRAM
+	if (resumed) {
+		psci_stats_update_hist(cpu_idx, state_info, residency);
+	}
+#endif
+
 	/*
 	 * Check what power domains above CPU were off
 	 * prior to this CPU powering on.
@@ -256,3 +359,44 @@ u_register_t psci_stat_count(u_register_t target_cpu,
 	else
 		return 0;
 }
+
+#if PSCI_STAT_HISTOGRAM
+/*******************************************************************************
+ * This function lets the platform demote the requested suspend state of the
+ * calling CPU, based on the residency predicted from its recent history. It
+ * is called before any state coordination takes place.
+ ******************************************************************************/
+void psci_stats_demote_suspend(psci_power_state_t *state_info)
+{
+	unsigned int cpu_idx = plat_my_core_pos();
+
+	assert(state_info != NULL);
+
+	if (psci_plat_pm_ops->pwr_domain_demote_suspend == NULL) {
+		return;
+	}
+
+	psci_plat_pm_ops->pwr_domain_demote_suspend(state_info,
+			psci_cpu_hist[cpu_idx].predicted_residency);
+}
+
+/*
+ * This function returns the number of CPU_SUSPEND latencies of the given type
+ * (PSCI_STAT_HIST_ENTRY or PSCI_STAT_HIST_EXIT) recorded in `bucket` for the
+ * CPU represented by `target_cpu`.
+ */
+u_register_t psci_stat_latency_hist(u_register_t target_cpu,
+				    unsigned int type, unsigned int bucket)
+{
+	unsigned int target_idx;
+
+	if (!is_valid_mpidr(target_cpu) || (type >= PSCI_STAT_HIST_TYPES) ||
+	    (bucket >= PSCI_STAT_HIST_BUCKETS)) {
+		return 0;
+	}
+
+	target_idx = (unsigned int)plat_core_pos_by_mpidr(target_cpu);
+
+	return psci_cpu_hist[target_idx].bucket[type][bucket];
+}
+#endif /* PSCI_STAT_HISTOGRAM */
@@ -45,7 +45,7 @@ static void psci_suspend_to_standby_finisher(unsigned int cpu_idx,
 
 #if ENABLE_PSCI_STAT
 	plat_psci_stat_accounting_stop(&state_info);
-	psci_stats_update_pwr_up(end_pwrlvl, &state_info);
+	psci_stats_update_pwr_up(end_pwrlvl, &state_info, true);
 #endif
 
 	/*
@@ -561,6 +561,33 @@ static action_t xlat_tables_map_region_action(const mmap_region_t *mm,
 	}
 }
 
+#if XLAT_TABLES_PROMOTION && PLAT_XLAT_TABLES_DYNAMIC
+/*
+ * Returns the contiguous hint of a block or page descriptor written for a
+ * dynamic region while the translation tables are live. The hint has to be
+ * set when the descriptor is created, as setting it in valid descriptors
+ * would need a break-before-make sequence on the whole run. A dynamic region
+ * cannot overlap any other region, so every entry of an aligned run lying
+ * within it is created by the same call, as a block or page descriptor with
+ * the same attributes.
+ */
+static uint64_t xlat_dynamic_cont_hint(const xlat_ctx_t *ctx,
+				       const mmap_region_t *mm,
+				       uintptr_t va, unsigned int level)
+{
+	size_t run_size = XLAT_BLOCK_SIZE(level) * XLAT_CONT_ENTRIES;
+	uintptr_t run_va = va & ~(run_size - 1U);
+
+	if (!ctx->initialized || (level < MIN_LVL_BLOCK_DESC) ||
+	    (mm->granularity < run_size) || (run_va < mm->base_va) ||
+	    ((run_va + run_size - 1U) > (mm->base_va + mm->size - 1U)) ||
+	    (((mm->base_pa + (run_va - mm->base_va)) & (run_size - 1U)) != 0U))
+		return 0U;
+
+	return UPPER_ATTRS(CONT_HINT);
+}
+#endif /* XLAT_TABLES_PROMOTION && PLAT_XLAT_TABLES_DYNAMIC */
+
 /*
  * Recursive function that writes to the translation tables and maps the
  * specified region. On success, it returns the VA of the last byte that was
@@ -608,6 +635,10 @@ static uintptr_t xlat_tables_map_region(xlat_ctx_t *ctx, mmap_region_t *mm,
 			table_base[table_idx] =
 				xlat_desc(ctx, (uint32_t)mm->attr, table_idx_pa,
 					  level);
+#if XLAT_TABLES_PROMOTION && PLAT_XLAT_TABLES_DYNAMIC
+			table_base[table_idx] |= xlat_dynamic_cont_hint(ctx,
+					mm, table_idx_va, level);
+#endif
 
 		} else if (action == ACTION_CREATE_NEW_TABLE) {
 			uintptr_t end_va;
@@ -667,6 +698,249 @@ static uintptr_t xlat_tables_map_region(xlat_ctx_t *ctx, mmap_region_t *mm,
 	return table_idx_va - 1U;
 }
 
+#if XLAT_TABLES_PROMOTION
+
+/* Descriptor bits that must match in all the entries of a promoted run. */
+#define XLAT_PROMOTION_ATTR_MASK	(~(TABLE_ADDR_MASK | UPPER_ATTRS(CONT_HINT)))
+
+/*
+ * Returns true if the regions mapped in the given VA range allow it to be
+ * described by a single TLB entry: none of them requires a finer granularity,
+ * and no dynamic region shares it with another region.
+ */
+static bool xlat_regions_allow_promotion(const xlat_ctx_t *ctx,
+					 uintptr_t base_va, size_t size)
+{
+	uintptr_t end_va = base_va + size - 1U;
+	const mmap_region_t *mm;
+
+	for (mm = ctx->mmap; mm->size != 0U; mm++) {
+		uintptr_t mm_end_va = mm->base_va + mm->size - 1U;
+
+		if ((mm->base_va > end_va) || (mm_end_va < base_va))
+			continue;
+
+		if (mm->granularity < size)
+			return false;
+
+#if PLAT_XLAT_TABLES_DYNAMIC
+		if (((mm->attr & MT_DYNAMIC) != 0U) &&
+		    ((mm->base_va > base_va) || (mm_end_va < end_va)))
+			return false;
+#endif
+	}
+
+	return true;
+}
+
+/*
+ * Returns true if the given entries are block or page descriptors with the
+ * same attributes, mapping a contiguous output range aligned on its size.
+ */
+static bool xlat_descs_are_uniform(const uint64_t *desc, unsigned int count,
+				   unsigned int level)
+{
+	unsigned long long block_size = XLAT_BLOCK_SIZE(level);
+	unsigned long long oa = desc[0] & TABLE_ADDR_MASK;
+	uint64_t attr = desc[0] & XLAT_PROMOTION_ATTR_MASK;
+	uint64_t desc_type = (level == XLAT_TABLE_LEVEL_MAX) ?
+			     PAGE_DESC : BLOCK_DESC;
+
+	if ((desc[0] & DESC_MASK) != desc_type)
+		return false;
+
+	if ((oa & ((block_size * count) - 1ULL)) != 0ULL)
+		return false;
+
+	for (unsigned int i = 1U; i < count; i++) {
+		oa += block_size;
+		if (((desc[i] & TABLE_ADDR_MASK) != oa) ||
+		    ((desc[i] & XLAT_PROMOTION_ATTR_MASK) != attr))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Recursive function that sets the contiguous hint on the aligned runs of
+ * XLAT_CONT_ENTRIES uniform descriptors found within [base_va, end_va]. As it
+ * changes valid descriptors, it must only be used before the MMU is enabled.
+ */
+static void __init xlat_tables_set_cont_hint(xlat_ctx_t *ctx, uintptr_t base_va,
+				      uintptr_t end_va,
+				      uintptr_t table_base_va,
+				      uint64_t *const table_base,
+				      unsigned int table_entries,
+				      unsigned int level)
+{
+	size_t block_size = XLAT_BLOCK_SIZE(level);
+	bool modified = false;
+	unsigned int idx;
+
+	for (idx = 0U; idx < table_entries; idx++) {
+		uint64_t desc = table_base[idx];
+		uintptr_t entry_va = table_base_va + (idx * block_size);
+
+		if ((level == XLAT_TABLE_LEVEL_MAX) ||
+		    ((desc & DESC_MASK) != TABLE_DESC) ||
+		    (entry_va > end_va) ||
+		    ((entry_va + block_size - 1U) < base_va))
+			continue;
+
+		xlat_tables_set_cont_hint(ctx, base_va, end_va, entry_va,
+				(uint64_t *)(uintptr_t)(desc & TABLE_ADDR_MASK),
+				XLAT_TABLE_ENTRIES, level + 1U);
+	}
+
+	if (level < MIN_LVL_BLOCK_DESC)
+		return;
+
+	for (idx = 0U; (idx + XLAT_CONT_ENTRIES) <= table_entries;
+	     idx += XLAT_CONT_ENTRIES) {
+		uintptr_t run_va = table_base_va + (idx * block_size);
+		size_t run_size = block_size * XLAT_CONT_ENTRIES;
+
+		if ((run_va < base_va) || ((run_va + run_size - 1U) > end_va))
+			continue;
+
+		if (!xlat_descs_are_uniform(&table_base[idx],
+					    XLAT_CONT_ENTRIES, level) ||
+		    !xlat_regions_allow_promotion(ctx, run_va, run_size))
+			continue;
+
+		for (unsigned int i = 0U; i < XLAT_CONT_ENTRIES; i++)
+			table_base[idx + i] |= UPPER_ATTRS(CONT_HINT);
+
+		modified = true;
+	}
+
+#if !(HW_ASSISTED_COHERENCY || WARMBOOT_ENABLE_DCACHE_EARLY)
+	if (modified) {
+		xlat_clean_dcache_range((uintptr_t)table_base,
+				 table_entries * sizeof(uint64_t));
+	}
+#endif
+}
+
+/*
+ * Recursive function that replaces the sub-tables whose entries all describe
+ * a single uniform block by a block descriptor. As it changes valid table
+ * descriptors, it must only be used before the MMU is enabled.
+ */
+static void __init xlat_tables_collapse(xlat_ctx_t *ctx,
+					uintptr_t table_base_va,
+					uint64_t *const table_base,
+					unsigned int table_entries,
+					unsigned int level)
+{
+	size_t block_size = XLAT_BLOCK_SIZE(level);
+	bool modified = false;
+
+	assert(level < XLAT_TABLE_LEVEL_MAX);
+
+	for (unsigned int idx = 0U; idx < table_entries; idx++) {
+		uint64_t desc = table_base[idx];
+		uintptr_t entry_va = table_base_va + (idx * block_size);
+		uint64_t *subtable;
+
+		if ((desc & DESC_MASK) != TABLE_DESC)
+			continue;
+
+		subtable = (uint64_t *)(uintptr_t)(desc & TABLE_ADDR_MASK);
+
+		if ((level + 1U) < XLAT_TABLE_LEVEL_MAX) {
+			xlat_tables_collapse(ctx, entry_va, subtable,
+					     XLAT_TABLE_ENTRIES, level + 1U);
+		}
+
+		if ((level < MIN_LVL_BLOCK_DESC) ||
+		    !xlat_descs_are_uniform(subtable, XLAT_TABLE_ENTRIES,
+					    level + 1U) ||
+		    !xlat_regions_allow_promotion(ctx, entry_va, block_size))
+			continue;
+
+		/* Page and block descriptors only differ in their type bits */
+		table_base[idx] = (subtable[0] &
+				   ~(UPPER_ATTRS(CONT_HINT) | DESC_MASK)) |
+				  BLOCK_DESC;
+		modified = true;
+
+#if PLAT_XLAT_TABLES_DYNAMIC
+		/* Give the sub-table back to the pool of free tables. */
+		for (unsigned int i = 0U; i < XLAT_TABLE_ENTRIES; i++)
+			subtable[i] = INVALID_DESC;
+		ctx->tables_mapped_regions[xlat_table_get_index(ctx,
+							subtable)] = 0;
+#endif
+	}
+
+#if !(HW_ASSISTED_COHERENCY || WARMBOOT_ENABLE_DCACHE_EARLY)
+	if (modified) {
+		xlat_clean_dcache_range((uintptr_t)table_base,
+				 table_entries * sizeof(uint64_t));
+	}
+#endif
+}
+
+#if PLAT_XLAT_TABLES_DYNAMIC && ENABLE_ASSERTIONS
+/*
+ * Recursive function that checks the contiguous hint of the runs overlapping
+ * [base_va, end_va]: a run with the hint in one of its entries must have it
+ * in all of them, and they must describe a uniform range.
+ */
+static bool xlat_tables_cont_hint_ok(uintptr_t base_va, uintptr_t end_va,
+				     uintptr_t table_base_va,
+				     const uint64_t *table_base,
+				     unsigned int table_entries,
+				     unsigned int level)
+{
+	size_t block_size = XLAT_BLOCK_SIZE(level);
+	unsigned int idx;
+
+	for (idx = 0U; idx < table_entries; idx++) {
+		uint64_t desc = table_base[idx];
+		uintptr_t entry_va = table_base_va + (idx * block_size);
+
+		if ((level == XLAT_TABLE_LEVEL_MAX) ||
+		    ((desc & DESC_MASK) != TABLE_DESC) ||
+		    (entry_va > end_va) ||
+		    ((entry_va + block_size - 1U) < base_va))
+			continue;
+
+		if (!xlat_tables_cont_hint_ok(base_va, end_va, entry_va,
+				(const uint64_t *)(uintptr_t)(desc & TABLE_ADDR_MASK),
+				XLAT_TABLE_ENTRIES, level + 1U))
+			return false;
+	}
+
+	for (idx = 0U; idx < table_entries; idx += XLAT_CONT_ENTRIES) {
+		uintptr_t run_va = table_base_va + (idx * block_size);
+		size_t run_size = block_size * XLAT_CONT_ENTRIES;
+		unsigned int hinted = 0U;
+
+		if ((run_va > end_va) || ((run_va + run_size - 1U) < base_va))
+			continue;
+
+		for (unsigned int i = idx;
+		     (i < (idx + XLAT_CONT_ENTRIES)) && (i < table_entries); i++) {
+			if ((table_base[i] & UPPER_ATTRS(CONT_HINT)) != 0U)
+				hinted++;
+		}
+
+		if ((hinted != 0U) &&
+		    ((hinted != XLAT_CONT_ENTRIES) ||
+		     !xlat_descs_are_uniform(&table_base[idx],
+					     XLAT_CONT_ENTRIES, level)))
+			return false;
+	}
+
+	return true;
+}
+#endif /* PLAT_XLAT_TABLES_DYNAMIC && ENABLE_ASSERTIONS */
+
+#endif /* XLAT_TABLES_PROMOTION */
+
 /*
  * Function that verifies that a region can be mapped.
  * Returns:
@@ -1037,6 +1311,7 @@ int mmap_add_dynamic_region_ctx(xlat_ctx_t *ctx, mmap_region_t *mm)
 			xlat_clean_dcache_range((uintptr_t)ctx->base_table,
 				ctx->base_table_entries * sizeof(uint64_t));
 #endif
+
 			return -ENOMEM;
 		}
 
@@ -1122,6 +1397,16 @@ int mmap_remove_dynamic_region_ctx(xlat_ctx_t *ctx, uintptr_t base_va,
 #if !(HW_ASSISTED_COHERENCY || WARMBOOT_ENABLE_DCACHE_EARLY)
 		xlat_clean_dcache_range((uintptr_t)ctx->base_table,
 			ctx->base_table_entries * sizeof(uint64_t));
+#endif
+#if XLAT_TABLES_PROMOTION
+		/*
+		 * A run with the contiguous hint never spans a dynamic region
+		 * and another region, so no hinted run can be left partially
+		 * unmapped.
+		 */
+		assert(xlat_tables_cont_hint_ok(base_va, base_va + size - 1U,
+				0U, ctx->base_table, ctx->base_table_entries,
+				ctx->base_level));
 #endif
 		xlat_arch_tlbi_va_sync();
 	}
@@ -1234,6 +1519,15 @@ void __init init_xlat_tables_ctx(xlat_ctx_t *ctx)
 		mm++;
 	}
 
+#if XLAT_TABLES_PROMOTION
+	/* Use the largest TLB entries allowed now that all regions are mapped */
+	xlat_tables_collapse(ctx, 0U, ctx->base_table, ctx->base_table_entries,
+			     ctx->base_level);
+	xlat_tables_set_cont_hint(ctx, 0U, ctx->va_max_address, 0U,
+			ctx->base_table, ctx->base_table_entries,
+			ctx->base_level);
+#endif
+
 	assert(ctx->pa_max_address <= xlat_arch_get_max_supported_pa());
 	assert(ctx->max_va <= ctx->va_max_address);
 	assert(ctx->max_pa <= ctx->pa_max_address);
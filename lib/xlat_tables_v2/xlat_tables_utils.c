@@ -120,6 +120,10 @@ static void xlat_desc_print(const xlat_ctx_t *ctx, uint64_t desc)
 		printf("-GP");
 	}
 #endif
+
+	if ((desc & UPPER_ATTRS(CONT_HINT)) != 0ULL) {
+		printf("-CONT");
+	}
 }
 
 static const char * const level_spacers[] = {
@@ -219,6 +223,61 @@ static void xlat_tables_print_internal(xlat_ctx_t *ctx, uintptr_t table_base_va,
 	}
 }
 
+/*
+ * Recursive function that counts, for each lookup level, the block or page
+ * descriptors of the translation tables and how many of them have the
+ * contiguous hint set.
+ */
+static void xlat_tables_count_descs(const uint64_t *table_base,
+		unsigned int table_entries, unsigned int level,
+		unsigned int *descs, unsigned int *cont_descs)
+{
+	for (unsigned int i = 0U; i < table_entries; i++) {
+		uint64_t desc = table_base[i];
+
+		if ((desc & DESC_MASK) == INVALID_DESC) {
+			continue;
+		}
+
+		if (((desc & DESC_MASK) == TABLE_DESC) &&
+		    (level < XLAT_TABLE_LEVEL_MAX)) {
+			xlat_tables_count_descs(
+				(uint64_t *)(uintptr_t)(desc & TABLE_ADDR_MASK),
+				XLAT_TABLE_ENTRIES, level + 1U,
+				descs, cont_descs);
+			continue;
+		}
+
+		descs[level]++;
+		if ((desc & UPPER_ATTRS(CONT_HINT)) != 0ULL) {
+			cont_descs[level]++;
+		}
+	}
+}
+
+/*
+ * Print how the mapped memory is split between the lookup levels. The fewer
+ * the descriptors and the more of them are part of contiguous runs, the fewer
+ * TLB entries are needed to cover the mappings.
+ */
+static void xlat_tables_print_shape(const xlat_ctx_t *ctx)
+{
+	unsigned int descs[XLAT_TABLE_LEVEL_MAX + 1U] = { 0U };
+	unsigned int cont_descs[XLAT_TABLE_LEVEL_MAX + 1U] = { 0U };
+
+	xlat_tables_count_descs(ctx->base_table, ctx->base_table_entries,
+				ctx->base_level, descs, cont_descs);
+
+	VERBOSE("  Mapping shape:\n");
+	for (unsigned int level = ctx->base_level;
+	     level <= XLAT_TABLE_LEVEL_MAX; level++) {
+		VERBOSE("    Level %u (0x%lx): %u %s, %u with contiguous hint\n",
+			level, XLAT_BLOCK_SIZE(level), descs[level],
+			(level == XLAT_TABLE_LEVEL_MAX) ? "pages" : "blocks",
+			cont_descs[level]);
+	}
+}
+
 void xlat_tables_print(xlat_ctx_t *ctx)
 {
 	const char *xlat_regime_str;
@@ -256,6 +315,8 @@ void xlat_tables_print(xlat_ctx_t *ctx)
 		used_page_tables, ctx->tables_num,
 		ctx->tables_num - used_page_tables);
 
+	xlat_tables_print_shape(ctx);
+
 	xlat_tables_print_internal(ctx, 0U, ctx->base_table,
 				   ctx->base_table_entries, ctx->base_level);
 }
@@ -444,6 +505,24 @@ int xlat_get_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 }
 
 
+#if XLAT_TABLES_PROMOTION
+/* Clear the contiguous hint of the whole run the given entry is part of. */
+static void xlat_clear_cont_hint(uint64_t *entry)
+{
+	uintptr_t table_offset = (uintptr_t)entry & (XLAT_TABLE_SIZE - 1U);
+	unsigned int first = (table_offset / sizeof(uint64_t)) &
+			     ~(XLAT_CONT_ENTRIES - 1U);
+	uint64_t *run = (uint64_t *)((uintptr_t)entry - table_offset) + first;
+
+	for (unsigned int i = 0U; i < XLAT_CONT_ENTRIES; i++)
+		run[i] &= ~UPPER_ATTRS(CONT_HINT);
+
+#if !HW_ASSISTED_COHERENCY
+	clean_dcache_range((uintptr_t)run, XLAT_CONT_ENTRIES * sizeof(uint64_t));
+#endif
+}
+#endif /* XLAT_TABLES_PROMOTION */
+
 int xlat_change_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 				   size_t size, uint32_t attr)
 {
@@ -484,23 +563,22 @@ int xlat_change_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 	VERBOSE("Changing memory attributes of %zu pages starting from address 0x%lx...\n",
 		pages_count, base_va);
 
-	uintptr_t base_va_original = base_va;
-
 	/*
 	 * Sanity checks.
 	 */
 	for (unsigned int i = 0U; i < pages_count; ++i) {
-		const uint64_t *entry;
+		uintptr_t va = base_va + (i * PAGE_SIZE);
+		uint64_t *entry;
 		uint64_t desc, attr_index;
 		unsigned int level;
 
-		entry = find_xlat_table_entry(base_va,
+		entry = find_xlat_table_entry(va,
 					      ctx->base_table,
 					      ctx->base_table_entries,
 					      virt_addr_space_size,
 					      &level);
 		if (entry == NULL) {
-			WARN("Address 0x%lx is not mapped.\n", base_va);
+			WARN("Address 0x%lx is not mapped.\n", va);
 			return -EINVAL;
 		}
 
@@ -513,12 +591,28 @@ int xlat_change_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 		if (((desc & DESC_MASK) != PAGE_DESC) ||
 			(level != XLAT_TABLE_LEVEL_MAX)) {
 			WARN("Address 0x%lx is not mapped at the right granularity.\n",
-			     base_va);
+			     va);
 			WARN("Granularity is 0x%lx, should be 0x%lx.\n",
 			     XLAT_BLOCK_SIZE(level), PAGE_SIZE);
 			return -EINVAL;
 		}
 
+#if XLAT_TABLES_PROMOTION
+		/*
+		 * A page of a contiguous run can't get attributes different
+		 * from the rest of the run. The hint can only be removed from
+		 * the run while the MMU is disabled, as it would otherwise
+		 * require to unmap the whole run. It is removed once all the
+		 * pages have been checked.
+		 */
+		if (((desc & UPPER_ATTRS(CONT_HINT)) != 0ULL) &&
+		    is_mmu_enabled_ctx(ctx)) {
+			WARN("Address 0x%lx is part of a contiguous run.\n",
+			     va);
+			return -EINVAL;
+		}
+#endif
+
 		/*
 		 * If the region type is device, it shouldn't be executable.
 		 */
@@ -526,17 +620,12 @@ int xlat_change_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 		if (attr_index == ATTR_DEVICE_INDEX) {
 			if ((attr & MT_EXECUTE_NEVER) == 0U) {
 				WARN("Setting device memory as executable at address 0x%lx.",
-				     base_va);
+				     va);
 				return -EINVAL;
 			}
 		}
-
-		base_va += PAGE_SIZE;
 	}
 
-	/* Restore original value. */
-	base_va = base_va_original;
-
 	for (unsigned int i = 0U; i < pages_count; ++i) {
 
 		uint32_t old_attr = 0U, new_attr;
@@ -547,6 +636,12 @@ int xlat_change_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 		(void) xlat_get_mem_attributes_internal(ctx, base_va, &old_attr,
 					    &entry, &addr_pa, &level);
 
+#if XLAT_TABLES_PROMOTION
+		if ((*entry & UPPER_ATTRS(CONT_HINT)) != 0ULL) {
+			xlat_clear_cont_hint(entry);
+		}
+#endif
+
 		/*
 		 * From attr, only MT_RO/MT_RW, MT_EXECUTE/MT_EXECUTE_NEVER and
 		 * MT_USER/MT_PRIVILEGED are taken into account. Any other
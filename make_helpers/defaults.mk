@@ -26,6 +26,12 @@ ARM_ARCH_FEATURE		:= none
 ARM_ARCH_MAJOR			:= 8
 ARM_ARCH_MINOR			:= 0
 
+# Cache the public keys already authenticated against the ROTPK hash
+AUTH_KEY_CACHE			:= 0
+
+# Count the images parsed and the crypto operations of the authentication
+AUTH_STATS			:= 0
+
 # Base commit to perform code check on
 BASE_COMMIT			:= origin/master
 
@@ -262,6 +268,12 @@ PSCI_EXTENDED_STATE_ID		:= 0
 # Enable PSCI OS-initiated mode support
 PSCI_OS_INIT_MODE		:= 0
 
+# Enable PSCI suspend latency histograms and residency based state demotion
+PSCI_STAT_HISTOGRAM		:= 0
+
+# Use ticket locks instead of bakery locks or spinlocks for PSCI coordination
+PSCI_USE_TICKET_LOCK		:= 0
+
 # Enable RAS support
 RAS_EXTENSION			:= 0
 
@@ -349,6 +361,10 @@ USE_ROMLIB			:= 0
 # level makefile where we can check for incompatible features/build options.
 ALLOW_RO_XLAT_TABLES		:= 0
 
+# Build option to let the xlat tables v2 library set the contiguous hint on
+# runs of identical descriptors and merge uniform tables into blocks.
+XLAT_TABLES_PROMOTION		:= 0
+
 # Chain of trust.
 COT				:= tbbr
 
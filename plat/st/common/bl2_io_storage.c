@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2023, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2024, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -17,6 +17,9 @@
 #include <drivers/hyperflash.h>
 #endif
 #include <drivers/io/io_block.h>
+#if STM32MP_IO_CACHE
+#include <drivers/io/io_cache.h>
+#endif
 #include <drivers/io/io_driver.h>
 #include <drivers/io/io_encrypted.h>
 #include <drivers/io/io_fip.h>
@@ -49,6 +52,7 @@
 #include <stm32cubeprogrammer.h>
 #include <stm32mp_efi.h>
 #include <stm32mp_fconf_getter.h>
+#include <stm32mp_fwu_bank.h>
 #include <stm32mp_io_storage.h>
 #include <usb_dfu.h>
 
@@ -80,9 +84,35 @@ static io_block_dev_spec_t mmc_block_dev_spec = {
 		.write = NULL,
 	},
 	.block_size = MMC_BLOCK_SIZE,
+	/* The SDMMC driver chooses its DMA from the buffer address */
+	.direct_read = true,
 };
 
 static const io_dev_connector_t *mmc_dev_con;
+
+#if STM32MP_IO_CACHE
+/*
+ * Read cache stacked on the MMC block device, so that the GPT, the FWU
+ * metadata and the FIP TOC are read with a few multi-block commands.
+ */
+#define MMC_CACHE_LINES		16U
+#define MMC_CACHE_READAHEAD	8U
+
+static uint8_t mmc_cache_buffer[MMC_CACHE_LINES * MMC_BLOCK_SIZE]
+	__aligned(MMC_BLOCK_SIZE);
+
+static io_cache_dev_spec_t mmc_cache_dev_spec = {
+	.buffer = {
+		.offset = (size_t)&mmc_cache_buffer,
+		.length = sizeof(mmc_cache_buffer),
+	},
+	.line_size = MMC_BLOCK_SIZE,
+	.readahead = MMC_CACHE_READAHEAD,
+};
+
+static const io_dev_connector_t *cache_dev_con;
+static uintptr_t mmc_dev_handle;
+#endif
 #endif /* STM32MP_SDMMC || STM32MP_EMMC */
 
 #if STM32MP_SPI_NOR
@@ -247,11 +277,21 @@ static void print_boot_device(boot_api_context_t *boot_context)
 }
 
 #if STM32MP_SDMMC || STM32MP_EMMC
+/* Size of the MMC device, limited to whole blocks in a size_t */
+static size_t mmc_region_size(void)
+{
+	return (size_t)MIN(mmc_info.device_size,
+			   (unsigned long long)round_down(SIZE_MAX,
+							  MMC_BLOCK_SIZE));
+}
+
 static void boot_mmc(enum mmc_device_type mmc_dev_type,
 		     uint16_t boot_interface_instance)
 {
 	int io_result __maybe_unused;
 	struct stm32_sdmmc2_params params;
+	const struct plat_io_policy *policy;
+	io_block_spec_t *gpt_spec;
 
 	zeromem(&params, sizeof(struct stm32_sdmmc2_params));
 
@@ -297,6 +337,16 @@ static void boot_mmc(enum mmc_device_type mmc_dev_type,
 				&storage_dev_handle);
 	assert(io_result == 0);
 
+	/*
+	 * The GPT region goes up to the backup GPT, at the end of the device.
+	 * With a 32-bit size_t it stops at 4GiB: the GPT is still checked
+	 * against the device size of the protective MBR, but the backup GPT of
+	 * a larger device cannot be read.
+	 */
+	policy = FCONF_GET_PROPERTY(stm32mp, io_policies, GPT_IMAGE_ID);
+	gpt_spec = (io_block_spec_t *)policy->image_spec;
+	gpt_spec->length = mmc_region_size();
+
 #if STM32MP_EMMC_BOOT
 	if (mmc_dev_type == MMC_IS_EMMC) {
 		io_result = mmc_part_switch_current_boot();
@@ -317,6 +367,32 @@ static void boot_mmc(enum mmc_device_type mmc_dev_type,
 	}
 #endif
 }
+
+#if STM32MP_IO_CACHE
+/* Insert the read cache between the users of the storage and the MMC */
+static void mmc_cache_setup(void)
+{
+	int io_result __maybe_unused;
+
+	mmc_dev_handle = storage_dev_handle;
+	mmc_cache_dev_spec.backend_dev_handle = mmc_dev_handle;
+
+	/* The eMMC boot partition holding the FIP is the whole device then */
+	if (image_block_spec.length != 0U) {
+		mmc_cache_dev_spec.backend_size = image_block_spec.offset +
+						  image_block_spec.length;
+	} else {
+		mmc_cache_dev_spec.backend_size = mmc_region_size();
+	}
+
+	io_result = register_io_dev_cache(&cache_dev_con);
+	assert(io_result == 0);
+
+	io_result = io_dev_open(cache_dev_con, (uintptr_t)&mmc_cache_dev_spec,
+				&storage_dev_handle);
+	assert(io_result == 0);
+}
+#endif
 #endif /* STM32MP_SDMMC || STM32MP_EMMC */
 
 #if STM32MP_SPI_NOR
@@ -488,12 +564,18 @@ void stm32mp_io_setup(void)
 	case BOOT_API_CTX_BOOT_INTERFACE_SEL_FLASH_SD:
 		dmbsy();
 		boot_mmc(MMC_IS_SD, boot_context->boot_interface_instance);
+#if STM32MP_IO_CACHE
+		mmc_cache_setup();
+#endif
 		break;
 #endif
 #if STM32MP_EMMC
 	case BOOT_API_CTX_BOOT_INTERFACE_SEL_FLASH_EMMC:
 		dmbsy();
 		boot_mmc(MMC_IS_EMMC, boot_context->boot_interface_instance);
+#if STM32MP_IO_CACHE
+		mmc_cache_setup();
+#endif
 		break;
 #endif
 #if STM32MP_SPI_NOR
@@ -547,6 +629,13 @@ void stm32mp_io_exit(void)
 	/* Close connection to device */
 	io_result = io_dev_close(storage_dev_handle);
 	assert(io_result == 0);
+
+#if STM32MP_IO_CACHE && (STM32MP_SDMMC || STM32MP_EMMC)
+	if (mmc_dev_handle != 0U) {
+		io_result = io_dev_close(mmc_dev_handle);
+		assert(io_result == 0);
+	}
+#endif
 }
 
 int bl2_plat_handle_pre_image_load(unsigned int image_id)
@@ -774,6 +863,80 @@ int plat_try_backup_partitions(unsigned int image_id)
 }
 
 #if PSA_FWU_SUPPORT
+/*
+ * Location of the images of each bank, resolved once per boot from the
+ * metadata, and looked up by image type GUID.
+ */
+struct stm32_fwu_image_loc {
+	struct efi_guid img_type_guid;
+	io_block_spec_t *image_spec;
+	io_block_spec_t bank[NR_OF_FW_BANKS];
+	bool resolved[NR_OF_FW_BANKS];
+};
+
+static struct stm32_fwu_image_loc fwu_image_locs[NR_OF_IMAGES_IN_FW_BANK];
+static unsigned int fwu_image_locs_nb;
+
+#if STM32MP_FWU_VERIFY_BANK
+static int stm32_fwu_check_bank(uint32_t idx)
+{
+	const struct efi_guid fip_guid = STM32MP_FIP_GUID;
+	unsigned int i;
+	int ret;
+
+	for (i = 0U; i < fwu_image_locs_nb; i++) {
+		const struct stm32_fwu_image_loc *loc = &fwu_image_locs[i];
+
+		if (!loc->resolved[idx]) {
+			return -ENOENT;
+		}
+
+		if (guidcmp(&loc->img_type_guid, &fip_guid) != 0) {
+			continue;
+		}
+
+		ret = stm32_fwu_check_fip(storage_dev_handle, &loc->bank[idx]);
+		if (ret != 0) {
+			WARN("FWU bank %u: invalid FIP (%d)\n", idx, ret);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Check the images of the selected bank before loading starts, and fall back
+ * to the alternate bank when they are corrupted and the alternate ones are not.
+ *
+ * BL2 does not write the metadata: its active_index and bank states still
+ * designate the rejected bank, while the boot index stored in the fwu-info
+ * cell by stm32_fwu_set_boot_idx() is the alternate one, as after a failed
+ * trial boot. The update agent has to compare both to know the bank really
+ * booted. The trial counter is cleared so that a bank in trial state is not
+ * tried again.
+ */
+static uint32_t stm32_fwu_verify_boot_idx(uint32_t boot_idx)
+{
+	uint32_t alt_idx;
+
+	if ((fwu_image_locs_nb == 0U) || (stm32_fwu_check_bank(boot_idx) == 0)) {
+		return boot_idx;
+	}
+
+	alt_idx = fwu_get_alternate_boot_bank();
+	if ((alt_idx == INVALID_BOOT_IDX) || (alt_idx == boot_idx) ||
+	    (stm32_fwu_check_bank(alt_idx) != 0)) {
+		return boot_idx;
+	}
+
+	WARN("FWU bank %u rejected, boot from bank %u\n", boot_idx, alt_idx);
+	stm32_clear_fwu_trial_boot_cnt();
+
+	return alt_idx;
+}
+#endif /* STM32MP_FWU_VERIFY_BANK */
+
 /*
  * In each boot in non-trial mode, we set the BKP register to
  * FWU_MAX_TRIAL_REBOOT, and return the active_index from metadata.
@@ -816,6 +979,12 @@ uint32_t plat_fwu_get_boot_idx(void)
 			boot_idx = fwu_get_alternate_boot_bank();
 			stm32_clear_fwu_trial_boot_cnt();
 		}
+
+#if STM32MP_FWU_VERIFY_BANK
+		if (boot_idx < NR_OF_FW_BANKS) {
+			boot_idx = stm32_fwu_verify_boot_idx(boot_idx);
+		}
+#endif
 	}
 
 	return boot_idx;
@@ -834,72 +1003,130 @@ static void *stm32_get_image_spec(const struct efi_guid *img_type_guid)
 	return NULL;
 }
 
-void plat_fwu_set_images_source(const struct fwu_metadata *metadata)
+static int stm32_fwu_resolve_image(const struct efi_guid *img_guid,
+				   io_block_spec_t *spec)
 {
-	unsigned int i;
-	uint32_t boot_idx;
 	const partition_entry_t *entry __maybe_unused;
-	const struct fwu_image_entry *img_entry;
-	const void *img_type_guid;
-	const void *img_guid;
-	io_block_spec_t *image_spec;
 
-	boot_idx = plat_fwu_get_boot_idx();
-	assert(boot_idx < NR_OF_FW_BANKS);
-	VERBOSE("Selecting to boot from bank %u\n", boot_idx);
+#if (STM32MP_SDMMC || STM32MP_EMMC)
+	entry = get_partition_entry_by_guid(img_guid);
+	if (entry == NULL) {
+		return -ENOENT;
+	}
+
+	spec->offset = entry->start;
+	spec->length = entry->length;
+#endif
+#if STM32MP_SPI_NOR
+	if (guidcmp(img_guid, &STM32MP_NOR_FIP_A_GUID) == 0) {
+		spec->offset = STM32MP_NOR_FIP_A_OFFSET;
+	} else if (guidcmp(img_guid, &STM32MP_NOR_FIP_B_GUID) == 0) {
+		spec->offset = STM32MP_NOR_FIP_B_OFFSET;
+	} else {
+		return -ENOENT;
+	}
+
+	spec->length = STM32MP_NOR_FIP_B_OFFSET - STM32MP_NOR_FIP_A_OFFSET;
+#endif
+#if (STM32MP_SPI_NAND || STM32MP_RAW_NAND)
+	if (guidcmp(img_guid, &STM32MP_NAND_FIP_A_GUID) == 0) {
+		spec->offset = STM32MP_NAND_FIP_A_OFFSET;
+	} else if (guidcmp(img_guid, &STM32MP_NAND_FIP_B_GUID) == 0) {
+		spec->offset = STM32MP_NAND_FIP_B_OFFSET;
+	} else {
+		return -ENOENT;
+	}
+
+	spec->length = STM32MP_NAND_FIP_B_OFFSET - STM32MP_NAND_FIP_A_OFFSET;
+#endif
+#if STM32MP_HYPERFLASH
+	if (guidcmp(img_guid, &STM32MP_HYPERFLASH_FIP_A_GUID) == 0) {
+		spec->offset = STM32MP_HYPERFLASH_FIP_A_OFFSET;
+	} else if (guidcmp(img_guid, &STM32MP_HYPERFLASH_FIP_B_GUID) == 0) {
+		spec->offset = STM32MP_HYPERFLASH_FIP_B_OFFSET;
+	} else {
+		return -ENOENT;
+	}
+
+	spec->length = STM32MP_HYPERFLASH_FIP_B_OFFSET -
+		       STM32MP_HYPERFLASH_FIP_A_OFFSET;
+#endif
+
+	return 0;
+}
+
+/* Resolve the location of all the images of all the banks */
+static void stm32_fwu_resolve_images(const struct fwu_metadata *metadata)
+{
+	const struct fwu_image_entry *img_entry;
+	unsigned int i;
+	uint32_t idx;
 
 	img_entry = (void *)&metadata->fw_desc.img_entry;
 	for (i = 0U; i < NR_OF_IMAGES_IN_FW_BANK; i++) {
-		img_type_guid = &img_entry[i].img_type_guid;
+		struct stm32_fwu_image_loc *loc = &fwu_image_locs[i];
 
-		img_guid = &img_entry[i].img_bank_info[boot_idx].img_guid;
-
-		image_spec = stm32_get_image_spec(img_type_guid);
-		if (image_spec == NULL) {
+		loc->img_type_guid = img_entry[i].img_type_guid;
+		loc->image_spec = stm32_get_image_spec(&loc->img_type_guid);
+		if (loc->image_spec == NULL) {
 			ERROR("Unable to get image spec for the image in the metadata\n");
 			panic();
 		}
 
-#if (STM32MP_SDMMC || STM32MP_EMMC)
-		entry = get_partition_entry_by_guid(img_guid);
-		if (entry == NULL) {
-			ERROR("No partition with the uuid mentioned in metadata\n");
-			panic();
-		}
+		for (idx = 0U; idx < NR_OF_FW_BANKS; idx++) {
+			const void *img_guid =
+				&img_entry[i].img_bank_info[idx].img_guid;
 
-		image_spec->offset = entry->start;
-		image_spec->length = entry->length;
-#endif
-#if STM32MP_SPI_NOR
-		if (guidcmp(img_guid, &STM32MP_NOR_FIP_A_GUID) == 0) {
-			image_spec->offset = STM32MP_NOR_FIP_A_OFFSET;
-		} else if (guidcmp(img_guid, &STM32MP_NOR_FIP_B_GUID) == 0) {
-			image_spec->offset = STM32MP_NOR_FIP_B_OFFSET;
-		} else {
-			ERROR("Invalid uuid mentioned in metadata\n");
-			panic();
+			loc->resolved[idx] =
+				stm32_fwu_resolve_image(img_guid,
+							&loc->bank[idx]) == 0;
 		}
-#endif
-#if (STM32MP_SPI_NAND || STM32MP_RAW_NAND)
-		if (guidcmp(img_guid, &STM32MP_NAND_FIP_A_GUID) == 0) {
-			image_spec->offset = STM32MP_NAND_FIP_A_OFFSET;
-		} else if (guidcmp(img_guid, &STM32MP_NAND_FIP_B_GUID) == 0) {
-			image_spec->offset = STM32MP_NAND_FIP_B_OFFSET;
-		} else {
-			ERROR("Invalid uuid mentioned in metadata\n");
-			panic();
+	}
+
+	fwu_image_locs_nb = NR_OF_IMAGES_IN_FW_BANK;
+}
+
+/* Return the location of an image in a bank, NULL if not found */
+static const io_block_spec_t *stm32_fwu_get_image_loc(const struct efi_guid *img_type_guid,
+						      uint32_t idx)
+{
+	unsigned int i;
+
+	for (i = 0U; i < fwu_image_locs_nb; i++) {
+		const struct stm32_fwu_image_loc *loc = &fwu_image_locs[i];
+
+		if (guidcmp(&loc->img_type_guid, img_type_guid) == 0) {
+			return loc->resolved[idx] ? &loc->bank[idx] : NULL;
 		}
-#endif
-#if STM32MP_HYPERFLASH
-		if (guidcmp(img_guid, &STM32MP_HYPERFLASH_FIP_A_GUID) == 0) {
-			image_spec->offset = STM32MP_HYPERFLASH_FIP_A_OFFSET;
-		} else if (guidcmp(img_guid, &STM32MP_HYPERFLASH_FIP_B_GUID) == 0) {
-			image_spec->offset = STM32MP_HYPERFLASH_FIP_B_OFFSET;
-		} else {
+	}
+
+	return NULL;
+}
+
+void plat_fwu_set_images_source(const struct fwu_metadata *metadata)
+{
+	unsigned int i;
+	uint32_t boot_idx;
+	const io_block_spec_t *bank_spec;
+
+	stm32_fwu_resolve_images(metadata);
+
+	boot_idx = plat_fwu_get_boot_idx();
+	assert(boot_idx < NR_OF_FW_BANKS);
+	VERBOSE("Selecting to boot from bank %u\n", boot_idx);
+
+	for (i = 0U; i < fwu_image_locs_nb; i++) {
+		struct stm32_fwu_image_loc *loc = &fwu_image_locs[i];
+
+		bank_spec = stm32_fwu_get_image_loc(&loc->img_type_guid,
+						    boot_idx);
+		if (bank_spec == NULL) {
 			ERROR("Invalid uuid mentioned in metadata\n");
 			panic();
 		}
-#endif
+
+		loc->image_spec->offset = bank_spec->offset;
+		loc->image_spec->length = bank_spec->length;
 	}
 }
 
@@ -10,6 +10,24 @@ STM32MP_EARLY_CONSOLE	?=	0
 STM32MP_RECONFIGURE_CONSOLE ?=	0
 STM32MP_UART_BAUDRATE	?=	115200
 
+# Resolve the OTP names once and cache the OTP values read
+STM32MP_OTP_CACHE	?=	1
+
+# Run BL2 jobs on the secondary core
+STM32MP_BL2_WORKER	?=	0
+
+# Stack a read cache on the MMC device in BL2
+STM32MP_IO_CACHE	?=	0
+
+# Zero the encrypted DDR regions (MCE or RISAF) through the cipher
+STM32MP_DDR_SCRUB	?=	0
+
+# Look for the I2C timings in a table generated from the BL2 DT before
+# running the solver
+STM32MP_I2C_TIMINGS_TABLE ?=	1
+# I2C kernel clock rates (Hz) added to the fixed clocks of the DT
+STM32MP_I2C_TIMINGS_CLOCKS ?=
+
 # Add specific ST version
 ST_VERSION 		:=	r2.0
 ST_GIT_SHA1		:=	$(shell git rev-parse --short=8 HEAD 2>/dev/null)
@@ -39,6 +57,8 @@ STM32_TF_A_COPIES		:=	2
 
 # PLAT_PARTITION_MAX_ENTRIES must take care of STM32_TF-A_COPIES and other partitions
 PLAT_PARTITION_MAX_ENTRIES	:=	$(shell echo $$(($(STM32_TF_A_COPIES) + $(STM32_EXTRA_PARTS))))
+# The 16KiB GPT entry array is read with a single request, STM32MP1 sets less
+PLAT_PARTITION_BUFFER_SIZE	:=	16384
 
 ifeq (${PSA_FWU_SUPPORT},1)
 # Number of banks of updatable firmware
@@ -55,6 +75,9 @@ $(PLAT_PARTITION_MAX_ENTRIES)")
 endif
 endif
 
+# Check the FIP of the selected FWU bank before loading it
+STM32MP_FWU_VERIFY_BANK	?=	0
+
 # Boot devices
 STM32MP_EMMC		?=	0
 STM32MP_SDMMC		?=	0
@@ -67,6 +90,8 @@ STM32MP_EMMC_BOOT	?=	0
 # Serial boot devices
 STM32MP_UART_PROGRAMMER	?=	0
 STM32MP_USB_PROGRAMMER	?=	0
+# DFU wTransferSize, in bytes
+STM32MP_USB_DFU_XFER_SIZE ?=	1024
 
 $(eval DTC_V = $(shell $(DTC) -v | awk '{print $$NF}'))
 $(eval DTC_VERSION = $(shell printf "%d" $(shell echo ${DTC_V} | cut -d- -f1 | sed "s/\./0/g" | grep -o "[0-9]*")))
@@ -112,10 +137,16 @@ endif
 $(eval $(call assert_booleans,\
 	$(sort \
 		PLAT_XLAT_TABLES_DYNAMIC \
+		STM32MP_BL2_WORKER \
+		STM32MP_DDR_SCRUB \
 		STM32MP_EARLY_CONSOLE \
 		STM32MP_EMMC \
 		STM32MP_EMMC_BOOT \
+		STM32MP_FWU_VERIFY_BANK \
 		STM32MP_HYPERFLASH \
+		STM32MP_I2C_TIMINGS_TABLE \
+		STM32MP_IO_CACHE \
+		STM32MP_OTP_CACHE \
 		STM32MP_RAW_NAND \
 		STM32MP_RECONFIGURE_CONSOLE \
 		STM32MP_SDMMC \
@@ -129,16 +160,23 @@ $(eval $(call assert_numerics,\
 	$(sort \
 		STM32_TF_VERSION \
 		STM32MP_UART_BAUDRATE \
+		STM32MP_USB_DFU_XFER_SIZE \
 )))
 
 $(eval $(call add_defines,\
 	$(sort \
 		PLAT_XLAT_TABLES_DYNAMIC \
 		STM32_TF_VERSION \
+		STM32MP_BL2_WORKER \
+		STM32MP_DDR_SCRUB \
 		STM32MP_EARLY_CONSOLE \
 		STM32MP_EMMC \
 		STM32MP_EMMC_BOOT \
+		STM32MP_FWU_VERIFY_BANK \
 		STM32MP_HYPERFLASH \
+		STM32MP_I2C_TIMINGS_TABLE \
+		STM32MP_IO_CACHE \
+		STM32MP_OTP_CACHE \
 		STM32MP_RAW_NAND \
 		STM32MP_RECONFIGURE_CONSOLE \
 		STM32MP_SDMMC \
@@ -146,12 +184,18 @@ $(eval $(call add_defines,\
 		STM32MP_SPI_NOR \
 		STM32MP_UART_BAUDRATE \
 		STM32MP_UART_PROGRAMMER \
+		STM32MP_USB_DFU_XFER_SIZE \
 		STM32MP_USB_PROGRAMMER \
 )))
 
 # Include paths and source files
 PLAT_INCLUDES		+=	-Iplat/st/common/include/
 
+ifeq (${STM32MP_I2C_TIMINGS_TABLE},1)
+STM32MP_I2C_TIMINGS_H	:=	${BUILD_PLAT}/include/stm32_i2c_timings.h
+PLAT_INCLUDES		+=	-I${BUILD_PLAT}/include
+endif
+
 include lib/fconf/fconf.mk
 include lib/libfdt/libfdt.mk
 include lib/zlib/zlib.mk
@@ -181,16 +225,26 @@ PLAT_BL_COMMON_SOURCES	+=	drivers/clk/clk.c					\
 				plat/st/common/stm32mp_fconf_fuse.c
 
 BL2_SOURCES		+=	${FCONF_SOURCES} ${FCONF_DYN_SOURCES}
+ifeq (${STM32MP_BL2_WORKER},1)
+BL2_SOURCES		+=	plat/st/common/stm32mp_worker.c
+endif
 BL2_SOURCES		+=	$(ZLIB_SOURCES)
 
 BL2_SOURCES		+=	drivers/io/io_fip.c					\
 				plat/st/common/bl2_io_storage.c				\
 				plat/st/common/stm32mp_fconf_io.c
+ifeq (${STM32MP_FWU_VERIFY_BANK},1)
+BL2_SOURCES		+=	plat/st/common/stm32mp_fwu_bank.c
+endif
 
 BL2_SOURCES		+=	drivers/io/io_block.c					\
 				drivers/io/io_mtd.c					\
 				drivers/io/io_storage.c
 
+ifeq (${STM32MP_IO_CACHE},1)
+BL2_SOURCES		+=	drivers/io/io_cache.c
+endif
+
 ifeq (${TRUSTED_BOARD_BOOT},1)
 AUTH_SOURCES		:=	drivers/auth/auth_mod.c					\
 				drivers/auth/crypto_mod.c				\
@@ -217,6 +271,7 @@ MBEDTLS_CONFIG_FILE	?=	"<stm32mp_mbedtls_config.h>"
 include drivers/auth/mbedtls/mbedtls_x509.mk
 
 COT_DESC_IN_DTB		:=	1
+AUTH_KEY_CACHE		?=	1
 AUTH_SOURCES		+=	lib/fconf/fconf_cot_getter.c				\
 				lib/fconf/fconf_tbbr_getter.c				\
 				plat/st/common/stm32mp_crypto_lib.c
@@ -287,6 +342,10 @@ endif
 BL2_SOURCES		+=	drivers/st/ddr/stm32mp_ddr_test.c			\
 				drivers/st/ddr/stm32mp_ram.c
 
+ifeq (${STM32MP_DDR_SCRUB},1)
+BL2_SOURCES		+=	drivers/st/ddr/stm32mp_ddr_scrub.c
+endif
+
 BL2_SOURCES		+=	common/desc_image_load.c
 
 BL2_SOURCES		+=	lib/optee/optee_utils.c
@@ -48,6 +48,18 @@ ${BUILD_PLAT}/fdts/%-bl2.dts: $(DT_SOURCE_PATH)/%.dts fdts/${BL2_DTSI} | ${BUILD
 
 ${BUILD_PLAT}/fdts/%-bl2.dtb: ${BUILD_PLAT}/fdts/%-bl2.dts
 
+ifneq (${STM32MP_I2C_TIMINGS_H},)
+# Compute the TIMINGR values of the I2C buses of the BL2 DTs
+$(foreach img,bl2 bl31 bl32,${BUILD_PLAT}/${img}/stm32_i2c.o): ${STM32MP_I2C_TIMINGS_H}
+
+${STM32MP_I2C_TIMINGS_H}: $(addprefix ${BUILD_PLAT}/fdts/,$(patsubst %.dtb,%-bl2.dtb,$(DTB_FILE_NAME))) \
+			  tools/stm32_i2c_timings/stm32_i2c_timings.py
+	@echo "  GEN     $@"
+	${Q}mkdir -p $(dir $@)
+	${Q}${PYTHON} tools/stm32_i2c_timings/stm32_i2c_timings.py \
+		$(filter %.dtb,$^) $(addprefix -c ,${STM32MP_I2C_TIMINGS_CLOCKS}) -o $@
+endif
+
 ${BUILD_PLAT}/$(PLAT)-%.o: ${BUILD_PLAT}/fdts/%-bl2.dtb $(STM32_BINARY_MAPPING) ${BUILD_PLAT}/bl2.bin
 	@echo "  AS      $${PLAT}.S"
 	${Q}${AS} ${ASFLAGS} ${TF_CFLAGS} \
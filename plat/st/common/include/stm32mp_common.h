@@ -64,6 +64,16 @@ int stm32_get_otp_index(const char *otp_name, uint32_t *otp_idx,
 			uint32_t *otp_len);
 int stm32_get_otp_value(const char *otp_name, uint32_t *otp_val);
 int stm32_get_otp_value_from_idx(const uint32_t otp_idx, uint32_t *otp_val);
+/* Read an OTP through the OTP value cache, return a BSEC status */
+uint32_t stm32_otp_cached_read(uint32_t *val, uint32_t otp);
+#if STM32MP_OTP_CACHE
+/* Drop the cached value of an OTP, called by BSEC on write/program/lock */
+void stm32_otp_cache_invalidate(uint32_t otp);
+#else
+static inline void stm32_otp_cache_invalidate(uint32_t otp)
+{
+}
+#endif
 int stm32_lock_enc_key_otp(void);
 /* update UID_WORD_NB array */
 int stm32_get_uid_otp(uint32_t uid[]);
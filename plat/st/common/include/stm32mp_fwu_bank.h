@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef STM32MP_FWU_BANK_H
+#define STM32MP_FWU_BANK_H
+
+#include <stdint.h>
+
+#include <drivers/io/io_storage.h>
+#include <lib/utils_def.h>
+
+/* Bound of the FIP ToC walk, the FIP generated for STM32MP has far less */
+#define FWU_FIP_MAX_ENTRIES	U(32)
+
+int stm32_fwu_check_fip(uintptr_t dev_handle, const io_block_spec_t *spec);
+
+#endif /* STM32MP_FWU_BANK_H */
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef STM32MP_WORKER_H
+#define STM32MP_WORKER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lib/utils_def.h>
+
+/*
+ * BL2 jobs run by the secondary core. The job structure belongs to the caller
+ * and must stay valid until stm32mp_worker_wait() returns. When the worker is
+ * not available, the job is run by the caller in stm32mp_worker_submit().
+ */
+struct stm32mp_worker_job {
+	int (*func)(void *arg);
+	void *arg;
+	volatile int status;
+	volatile bool done;
+};
+
+int stm32mp_worker_start(void);
+void stm32mp_worker_stop(void);
+bool stm32mp_worker_is_running(void);
+void stm32mp_worker_submit(struct stm32mp_worker_job *job);
+int stm32mp_worker_wait(struct stm32mp_worker_job *job);
+
+/* Entry of the secondary core, with its stack and MMU set */
+void stm32mp_worker_main(void) __dead2;
+
+/* Platform functions */
+int stm32mp_plat_worker_cpu_on(void);
+void stm32mp_plat_worker_cpu_park(void) __dead2;
+void stm32mp_plat_worker_cpu_off(void);
+
+#endif /* STM32MP_WORKER_H */
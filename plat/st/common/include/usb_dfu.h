@@ -13,8 +13,12 @@
 
 #define DFU_DESCRIPTOR_TYPE		0x21U
 
-/* Max DFU Packet Size = 1024 bytes */
-#define USBD_DFU_XFER_SIZE		1024U
+/* Max DFU Packet Size, advertised as wTransferSize */
+#define USBD_DFU_XFER_SIZE		U(STM32MP_USB_DFU_XFER_SIZE)
+
+#if (STM32MP_USB_DFU_XFER_SIZE < USB_MAX_EP0_SIZE) || (STM32MP_USB_DFU_XFER_SIZE > 0xFFFF)
+#error "STM32MP_USB_DFU_XFER_SIZE must fit in a control transfer wLength"
+#endif
 
 #define TRANSFER_SIZE_BYTES(size) \
 	((uint8_t)((size) & 0xFF)), /* XFERSIZEB0 */\
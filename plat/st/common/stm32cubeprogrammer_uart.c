@@ -331,14 +331,15 @@ static int uart_download_part(void)
 		return 0;
 	}
 
-	for (i = 0U; i < packet_size; i++) {
-		ret = uart_read_8(&byte);
-		if (ret != 0) {
-			return ret;
-		}
+	/* Receive the whole packet in place, then check it */
+	ret = stm32_uart_read(&handle.uart, handle.addr, packet_size,
+			      PROGRAMMER_TIMEOUT_US);
+	if (ret != 0) {
+		return ret;
+	}
 
-		*(handle.addr + i) = byte;
-		xor ^= byte;
+	for (i = 0U; i < packet_size; i++) {
+		xor ^= handle.addr[i];
 	}
 
 	/* Checksum */
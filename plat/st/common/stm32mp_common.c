@@ -169,6 +169,112 @@ int stm32mp_unmap_ddr(void)
 					   STM32MP_DDR_MAX_SIZE);
 }
 
+#if STM32MP_OTP_CACHE
+/*
+ * Values of the OTP already read, so that board ID, part number or MAC
+ * address lookups do not go back to BSEC. The BSEC driver drops an entry
+ * each time the related OTP is written, programmed or locked.
+ */
+#define OTP_CACHE_ENTRIES		16U
+
+struct otp_cache_entry {
+	uint32_t otp;
+	uint32_t value;
+};
+
+static struct otp_cache_entry otp_cache[OTP_CACHE_ENTRIES];
+static unsigned int otp_cache_nb;
+static unsigned int otp_cache_next;
+static spinlock_t otp_cache_lock;
+
+static void otp_cache_lock_get(void)
+{
+	if (stm32mp_lock_available()) {
+		spin_lock(&otp_cache_lock);
+	}
+}
+
+static void otp_cache_lock_put(void)
+{
+	if (stm32mp_lock_available()) {
+		spin_unlock(&otp_cache_lock);
+	}
+}
+
+static struct otp_cache_entry *otp_cache_find(uint32_t otp)
+{
+	unsigned int i;
+
+	for (i = 0U; i < otp_cache_nb; i++) {
+		if (otp_cache[i].otp == otp) {
+			return &otp_cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+void stm32_otp_cache_invalidate(uint32_t otp)
+{
+	struct otp_cache_entry *entry;
+
+	otp_cache_lock_get();
+
+	entry = otp_cache_find(otp);
+	if (entry != NULL) {
+		otp_cache_nb--;
+		*entry = otp_cache[otp_cache_nb];
+		otp_cache_next = otp_cache_nb;
+	}
+
+	otp_cache_lock_put();
+}
+#endif /* STM32MP_OTP_CACHE */
+
+static uint32_t otp_read(uint32_t *val, uint32_t otp)
+{
+#if defined(IMAGE_BL2)
+	return stm32_otp_shadow_read(val, otp);
+#elif defined(IMAGE_BL31) || defined(IMAGE_BL32)
+	return stm32_otp_read(val, otp);
+#else
+#error "Not supported"
+#endif
+}
+
+uint32_t stm32_otp_cached_read(uint32_t *val, uint32_t otp)
+{
+#if STM32MP_OTP_CACHE
+	struct otp_cache_entry *entry;
+	uint32_t ret = BSEC_OK;
+
+	otp_cache_lock_get();
+
+	entry = otp_cache_find(otp);
+	if (entry != NULL) {
+		*val = entry->value;
+	} else {
+		ret = otp_read(val, otp);
+		if (ret == BSEC_OK) {
+			entry = &otp_cache[otp_cache_next];
+			entry->otp = otp;
+			entry->value = *val;
+
+			if (otp_cache_nb < OTP_CACHE_ENTRIES) {
+				otp_cache_nb++;
+			}
+			otp_cache_next = (otp_cache_next + 1U) % OTP_CACHE_ENTRIES;
+		}
+	}
+
+	otp_cache_lock_put();
+
+	return ret;
+#else
+	return otp_read(val, otp);
+#endif
+}
+
 int stm32_get_otp_index(const char *otp_name, uint32_t *otp_idx,
 			uint32_t *otp_len)
 {
@@ -199,17 +305,11 @@ int stm32_get_otp_value(const char *otp_name, uint32_t *otp_val)
 
 int stm32_get_otp_value_from_idx(const uint32_t otp_idx, uint32_t *otp_val)
 {
-	uint32_t ret = BSEC_NOT_SUPPORTED;
+	uint32_t ret;
 
 	assert(otp_val != NULL);
 
-#if defined(IMAGE_BL2)
-	ret = stm32_otp_shadow_read(otp_val, otp_idx);
-#elif defined(IMAGE_BL31) || defined(IMAGE_BL32)
-	ret = stm32_otp_read(otp_val, otp_idx);
-#else
-#error "Not supported"
-#endif
+	ret = stm32_otp_cached_read(otp_val, otp_idx);
 	if (ret != BSEC_OK) {
 		ERROR("BSEC: idx=%u Read Error\n", otp_idx);
 		return -1;
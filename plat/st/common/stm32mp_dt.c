@@ -18,6 +18,22 @@
 
 static void *fdt;
 
+#if STM32MP_OTP_CACHE
+/* BSEC nvmem cells, resolved once from the DT */
+#define DT_OTP_CELL_MAX		16U
+
+struct dt_otp_cell {
+	const char *name;
+	uint32_t phandle;
+	uint32_t offset;
+	uint32_t size;
+};
+
+static struct dt_otp_cell dt_otp_cells[DT_OTP_CELL_MAX];
+static unsigned int dt_otp_cell_nb;
+static bool dt_otp_cells_resolved;
+#endif
+
 /*******************************************************************************
  * This function checks device tree file with its header.
  * Returns 0 on success and a negative FDT error code on failure.
@@ -29,6 +45,9 @@ int dt_open_and_check(uintptr_t dt_addr)
 	ret = fdt_check_header((void *)dt_addr);
 	if (ret == 0) {
 		fdt = (void *)dt_addr;
+#if STM32MP_OTP_CACHE
+		dt_otp_cells_resolved = false;
+#endif
 	}
 
 	return ret;
@@ -343,6 +362,100 @@ const char *dt_get_board_model(void)
 	return (const char *)fdt_getprop(fdt, node, "model", NULL);
 }
 
+#if STM32MP_OTP_CACHE
+/*
+ * dt_otp_cells_init: record all well-formed BSEC nvmem cells. Other cells are
+ * not recorded: looking them up falls back to the DT, which reports the error.
+ */
+static void dt_otp_cells_init(void)
+{
+	int node;
+	int child;
+
+	dt_otp_cells_resolved = true;
+	dt_otp_cell_nb = 0U;
+
+	node = fdt_node_offset_by_compatible(fdt, -1, DT_BSEC_COMPAT);
+	if (node < 0) {
+		return;
+	}
+
+	fdt_for_each_subnode(child, fdt, node) {
+		struct dt_otp_cell *cell;
+		const fdt32_t *cuint;
+		int len;
+
+		if (dt_otp_cell_nb == DT_OTP_CELL_MAX) {
+			VERBOSE("BSEC: only %u nvmem cells cached\n", DT_OTP_CELL_MAX);
+			break;
+		}
+
+		cell = &dt_otp_cells[dt_otp_cell_nb];
+
+		cuint = fdt_getprop(fdt, child, "reg", &len);
+		if ((cuint == NULL) || (len != (2 * (int)sizeof(uint32_t))) ||
+		    ((fdt32_to_cpu(*cuint) % sizeof(uint32_t)) != 0U)) {
+			continue;
+		}
+
+		cell->name = fdt_get_name(fdt, child, NULL);
+		if (cell->name == NULL) {
+			continue;
+		}
+
+		cell->phandle = fdt_get_phandle(fdt, child);
+		cell->offset = fdt32_to_cpu(*cuint);
+		cuint++;
+		cell->size = fdt32_to_cpu(*cuint);
+		dt_otp_cell_nb++;
+	}
+}
+
+/*
+ * dt_otp_cell_by_name: same name matching rule as fdt_subnode_offset(), the
+ * unit address can be omitted.
+ */
+static const struct dt_otp_cell *dt_otp_cell_by_name(const char *name)
+{
+	size_t len = strlen(name);
+	bool with_addr = memchr(name, '@', len) != NULL;
+	unsigned int i;
+
+	if (!dt_otp_cells_resolved) {
+		dt_otp_cells_init();
+	}
+
+	for (i = 0U; i < dt_otp_cell_nb; i++) {
+		const char *cell_name = dt_otp_cells[i].name;
+
+		if ((strncmp(cell_name, name, len) == 0) &&
+		    ((cell_name[len] == '\0') ||
+		     (!with_addr && (cell_name[len] == '@')))) {
+			return &dt_otp_cells[i];
+		}
+	}
+
+	return NULL;
+}
+
+static const struct dt_otp_cell *dt_otp_cell_by_phandle(uint32_t phandle)
+{
+	unsigned int i;
+
+	if (!dt_otp_cells_resolved) {
+		dt_otp_cells_init();
+	}
+
+	for (i = 0U; i < dt_otp_cell_nb; i++) {
+		if ((phandle != 0U) && (dt_otp_cells[i].phandle == phandle)) {
+			return &dt_otp_cells[i];
+		}
+	}
+
+	return NULL;
+}
+#endif /* STM32MP_OTP_CACHE */
+
 /*******************************************************************************
  * dt_find_otp_name: get OTP ID and length in DT.
  * name: sub-node name to look up.
@@ -355,11 +468,27 @@ int dt_find_otp_name(const char *name, uint32_t *otp, uint32_t *otp_len)
 	int node;
 	int len;
 	const fdt32_t *cuint;
+#if STM32MP_OTP_CACHE
+	const struct dt_otp_cell *cell;
+#endif
 
 	if ((name == NULL) || (otp == NULL)) {
 		return -FDT_ERR_BADVALUE;
 	}
 
+#if STM32MP_OTP_CACHE
+	cell = dt_otp_cell_by_name(name);
+	if (cell != NULL) {
+		*otp = cell->offset / sizeof(uint32_t);
+
+		if (otp_len != NULL) {
+			*otp_len = cell->size * CHAR_BIT;
+		}
+
+		return 0;
+	}
+#endif
+
 	node = fdt_node_offset_by_compatible(fdt, -1, DT_BSEC_COMPAT);
 	if (node < 0) {
 		return node;
@@ -408,6 +537,16 @@ int dt_get_otp_by_phandle(const uint32_t phandle, uint32_t *otp_id, uint32_t *ot
 	const fdt32_t *cuint;
 	uint32_t offset;
 	bool otp_found = false;
+#if STM32MP_OTP_CACHE
+	const struct dt_otp_cell *cell = dt_otp_cell_by_phandle(phandle);
+
+	if (cell != NULL) {
+		*otp_len = cell->size;
+		*otp_id = cell->offset / sizeof(uint32_t);
+
+		return 0;
+	}
+#endif
 
 	node = fdt_node_offset_by_compatible(fdt, -1, DT_BSEC_COMPAT);
 	if (node < 0) {
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <drivers/io/io_storage.h>
+#include <tools_share/firmware_image_package.h>
+
+#include <stm32mp_fwu_bank.h>
+
+/*
+ * Check the FIP ToC of a bank: header, and all entries ending inside the
+ * bank partition. The image contents are authenticated when loaded.
+ */
+int stm32_fwu_check_fip(uintptr_t dev_handle, const io_block_spec_t *spec)
+{
+	static const uuid_t uuid_null = { {0} }; /* Double braces for clang */
+	fip_toc_header_t header;
+	fip_toc_entry_t entry;
+	uintptr_t handle;
+	size_t bytes_read;
+	unsigned int i;
+	int ret;
+
+	ret = io_open(dev_handle, (uintptr_t)spec, &handle);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = io_read(handle, (uintptr_t)&header, sizeof(header), &bytes_read);
+	if ((ret == 0) && ((bytes_read != sizeof(header)) ||
+			   (header.name != TOC_HEADER_NAME) ||
+			   (header.serial_number == 0U))) {
+		ret = -EINVAL;
+	}
+
+	for (i = 0U; (ret == 0) && (i < FWU_FIP_MAX_ENTRIES); i++) {
+		ret = io_read(handle, (uintptr_t)&entry, sizeof(entry),
+			      &bytes_read);
+		if ((ret != 0) || (bytes_read != sizeof(entry))) {
+			ret = -EIO;
+			break;
+		}
+
+		if (memcmp(&entry.uuid, &uuid_null, sizeof(uuid_t)) == 0) {
+			break;
+		}
+
+		if ((entry.offset_address > spec->length) ||
+		    (entry.size > (spec->length - entry.offset_address))) {
+			ret = -EINVAL;
+		}
+	}
+
+	if (i == FWU_FIP_MAX_ENTRIES) {
+		ret = -EINVAL;
+	}
+
+	io_close(handle);
+
+	return ret;
+}
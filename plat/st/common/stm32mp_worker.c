@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <arch_helpers.h>
+#include <common/debug.h>
+#include <drivers/delay_timer.h>
+#include <lib/xlat_tables/xlat_mmu_helpers.h>
+
+#include <platform_def.h>
+#include <stm32mp_worker.h>
+
+#define WORKER_QUEUE_SIZE	8U
+#define WORKER_TIMEOUT_US	U(10000)
+
+/* Set by the primary core in xlat_tables, used to enable the worker MMU */
+extern uint64_t mmu_cfg_params[MMU_CFG_PARAM_MAX];
+
+/*
+ * Single producer (primary core), single consumer (worker) ring of jobs. Both
+ * cores are in the same coherency domain with their MMU and caches enabled.
+ */
+static struct {
+	struct stm32mp_worker_job *jobs[WORKER_QUEUE_SIZE];
+	volatile unsigned int head;	/* Written by the primary core */
+	volatile unsigned int tail;	/* Written by the worker */
+	volatile bool stop;
+	volatile bool running;
+} worker;
+
+static uint8_t worker_stack[PLATFORM_STACK_SIZE] __aligned(16);
+
+/* Read by the worker before it enables its MMU */
+uintptr_t stm32mp_worker_sp;
+
+/*
+ * Written by the worker once out of the coherency domain, alone in its cache
+ * line as the primary core invalidates it to read the value.
+ */
+uint32_t stm32mp_worker_parked[CACHE_WRITEBACK_GRANULE / sizeof(uint32_t)]
+	__aligned(CACHE_WRITEBACK_GRANULE);
+
+static void worker_run_job(struct stm32mp_worker_job *job)
+{
+	job->status = job->func(job->arg);
+	dmbish();
+	job->done = true;
+}
+
+void stm32mp_worker_main(void)
+{
+	worker.running = true;
+	dsbish();
+	sev();
+
+	while (true) {
+		while ((worker.tail == worker.head) && !worker.stop) {
+			wfe();
+		}
+
+		/* Queue is drained before leaving */
+		if (worker.tail == worker.head) {
+			break;
+		}
+
+		dmbish();
+		worker_run_job(worker.jobs[worker.tail % WORKER_QUEUE_SIZE]);
+		worker.tail++;
+		dsbish();
+		sev();
+	}
+
+	stm32mp_plat_worker_cpu_park();
+}
+
+int stm32mp_worker_start(void)
+{
+	uint64_t timeout;
+	int ret;
+
+	if (worker.running) {
+		return 0;
+	}
+
+	worker.head = 0U;
+	worker.tail = 0U;
+	worker.stop = false;
+	stm32mp_worker_sp = (uintptr_t)worker_stack + sizeof(worker_stack);
+	stm32mp_worker_parked[0] = 0U;
+
+	flush_dcache_range((uintptr_t)&stm32mp_worker_sp,
+			   sizeof(stm32mp_worker_sp));
+	flush_dcache_range((uintptr_t)stm32mp_worker_parked,
+			   sizeof(stm32mp_worker_parked));
+	flush_dcache_range((uintptr_t)mmu_cfg_params, sizeof(mmu_cfg_params));
+
+	ret = stm32mp_plat_worker_cpu_on();
+	if (ret != 0) {
+		return ret;
+	}
+
+	timeout = timeout_init_us(WORKER_TIMEOUT_US);
+	while (!worker.running) {
+		if (timeout_elapsed(timeout)) {
+			WARN("BL2 worker not started\n");
+			stm32mp_plat_worker_cpu_off();
+			return -ETIMEDOUT;
+		}
+	}
+
+	VERBOSE("BL2 worker started\n");
+
+	return 0;
+}
+
+void stm32mp_worker_stop(void)
+{
+	volatile uint32_t *parked = &stm32mp_worker_parked[0];
+	uint64_t timeout;
+
+	if (!worker.running) {
+		return;
+	}
+
+	worker.stop = true;
+	dsbish();
+	sev();
+
+	while (worker.tail != worker.head) {
+		wfe();
+	}
+
+	/* Last lines of the worker are cleaned before it sets the flag */
+	timeout = timeout_init_us(WORKER_TIMEOUT_US);
+	do {
+		inv_dcache_range((uintptr_t)stm32mp_worker_parked,
+				 sizeof(stm32mp_worker_parked));
+		if (timeout_elapsed(timeout)) {
+			WARN("BL2 worker not parked\n");
+			break;
+		}
+	} while (*parked == 0U);
+
+	stm32mp_plat_worker_cpu_off();
+	worker.running = false;
+}
+
+bool stm32mp_worker_is_running(void)
+{
+	return worker.running;
+}
+
+/*
+ * Jobs must not depend on each other: a job is run by the caller when the
+ * worker is not running or when the queue is full.
+ */
+void stm32mp_worker_submit(struct stm32mp_worker_job *job)
+{
+	assert((job != NULL) && (job->func != NULL));
+
+	job->done = false;
+
+	if (!worker.running || ((worker.head - worker.tail) == WORKER_QUEUE_SIZE)) {
+		worker_run_job(job);
+		return;
+	}
+
+	worker.jobs[worker.head % WORKER_QUEUE_SIZE] = job;
+	dmbish();
+	worker.head++;
+	dsbish();
+	sev();
+}
+
+int stm32mp_worker_wait(struct stm32mp_worker_job *job)
+{
+	assert(job != NULL);
+
+	while (!job->done) {
+		wfe();
+	}
+
+	dmbish();
+
+	return job->status;
+}
@@ -22,6 +22,7 @@
 #include <drivers/st/stm32_iwdg.h>
 #if STM32MP13
 #include <drivers/st/stm32_mce.h>
+#include <drivers/st/stm32_pka.h>
 #endif
 #include <drivers/st/stm32_rng.h>
 #if STM32MP13
@@ -348,6 +349,33 @@ static void check_tamper_event(bool lse_tamper_occured)
 	}
 }
 
+/*
+ * On a wakeup from Standby, replay the clock tree, the ETZPC and the GPIOZ
+ * secure configuration saved at suspend.
+ * The TAMP backup registers used by stm32mp_is_wakeup_from_standby() are not
+ * available yet: rely on the reset flags, the BootROM action and the CRC of
+ * the snapshot.
+ */
+static bool clk_fast_resume(void)
+{
+#if STM32MP1_FAST_RESUME
+	uint32_t rstsr = mmio_read_32(stm32mp_rcc_base() + RCC_MP_RSTSCLRR);
+
+	if ((rstsr & (RCC_MP_RSTSCLRR_STDBYRSTF | RCC_MP_RSTSCLRR_PADRSTF)) !=
+	    RCC_MP_RSTSCLRR_STDBYRSTF) {
+		return false;
+	}
+
+	if (stm32mp_get_boot_action() != BOOT_API_CTX_BOOT_ACTION_WAKEUP_STANDBY) {
+		return false;
+	}
+
+	return stm32_context_restore_pm_snapshot() == 0;
+#else
+	return false;
+#endif
+}
+
 void bl2_el3_plat_arch_setup(void)
 {
 	const char *board_model;
@@ -404,7 +432,8 @@ void bl2_el3_plat_arch_setup(void)
 		panic();
 	}
 
-	if (stm32mp1_clk_init(PLL1_NOMINAL_FREQ_IN_KHZ) < 0) {
+	if (!clk_fast_resume() &&
+	    (stm32mp1_clk_init(PLL1_NOMINAL_FREQ_IN_KHZ) < 0)) {
 		panic();
 	}
 
@@ -803,6 +832,11 @@ void bl2_el3_plat_prepare_exit(void)
 	flush_dcache_range(DATA_START, DATA_END - DATA_START);
 #endif
 
+#if STM32MP13 && TRUSTED_BOARD_BOOT
+	/* Clear the curve parameters kept in PKA RAM by the authentication */
+	stm32_pka_release();
+#endif
+
 #if !defined(DECRYPTION_SUPPORT_none)
 	if (stm32_lock_enc_key_otp() != 0) {
 		panic();
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2022, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2024, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -14,6 +14,10 @@
 
 void stm32_clean_context(void);
 void stm32_context_save_bl2_param(void);
+#if STM32MP1_FAST_RESUME
+void stm32_context_save_pm_snapshot(void);
+int stm32_context_restore_pm_snapshot(void);
+#endif
 uint32_t stm32_get_zdata_from_context(void);
 bool stm32_pm_context_is_valid(void);
 void stm32_restore_ddr_training_area(void);
@@ -14,6 +14,9 @@ ARM_CORTEX_A7		:=	yes
 ARM_WITH_NEON		:=	yes
 USE_COHERENT_MEM	:=	0
 
+# GPT entry array read with 4 requests instead of 1, to spare 12KiB of SYSRAM
+PLAT_PARTITION_BUFFER_SIZE	:=	4096
+
 # Default Device tree
 DTB_FILE_NAME		?=	stm32mp157c-ev1.dtb
 
@@ -57,6 +60,15 @@ STM32_HEADER_VERSION_MINOR:=	0
 
 # OP-TEE cannot be in SYSRAM on STM32MP13
 override STM32MP1_OPTEE_IN_SYSRAM :=	0
+
+# Clock tree snapshot only supported by the STM32MP15 clock driver
+override STM32MP1_FAST_RESUME :=	0
+endif
+
+# STM32MP13 has a single Cortex-A7 and STM32MP15 has no DDR encryption, so
+# BL2 has no job to run on a secondary core
+ifeq (${STM32MP_BL2_WORKER},1)
+$(error "STM32MP_BL2_WORKER not supported on STM32MP1")
 endif
 
 ifeq ($(STM32MP15),1)
@@ -71,6 +83,9 @@ STM32MP_CRYPTO_ROM_LIB :=	1
 
 STM32MP1_OPTEE_IN_SYSRAM ?=	0
 
+# Replay the clock tree saved in backup SRAM on a wakeup from Standby
+STM32MP1_FAST_RESUME	?=	0
+
 # Decryption support
 ifneq ($(DECRYPTION_SUPPORT),none)
 $(error "DECRYPTION_SUPPORT not supported on STM32MP15")
@@ -170,11 +185,13 @@ $(eval $(call assert_booleans,\
 		STM32MP_USE_EXTERNAL_HEAP \
 		STM32MP13 \
 		STM32MP15 \
+		STM32MP1_FAST_RESUME \
 		STM32MP1_OPTEE_IN_SYSRAM \
 )))
 
 $(eval $(call assert_numerics,\
 	$(sort \
+		PLAT_PARTITION_BUFFER_SIZE \
 		PLAT_PARTITION_MAX_ENTRIES \
 		STM32_HASH_VER \
 		STM32_HEADER_VERSION_MAJOR \
@@ -188,6 +205,7 @@ $(eval $(call add_defines,\
 		DWL_BUFFER_BASE \
 		PKA_USE_BRAINPOOL_P256T1 \
 		PKA_USE_NIST_P256 \
+		PLAT_PARTITION_BUFFER_SIZE \
 		PLAT_PARTITION_MAX_ENTRIES \
 		PLAT_TBBR_IMG_DEF \
 		STM32_HASH_VER \
@@ -201,6 +219,7 @@ $(eval $(call add_defines,\
 		STM32MP_USE_EXTERNAL_HEAP \
 		STM32MP13 \
 		STM32MP15 \
+		STM32MP1_FAST_RESUME \
 		STM32MP1_OPTEE_IN_SYSRAM \
 )))
 
@@ -251,6 +270,10 @@ ifeq ($(STM32MP13),1)
 BL2_SOURCES		+=	drivers/st/mce/stm32_mce.c
 endif
 
+ifeq (${STM32MP1_FAST_RESUME},1)
+BL2_SOURCES		+=	drivers/st/etzpc/etzpc.c
+endif
+
 ifeq (${TRUSTED_BOARD_BOOT},1)
 ifeq ($(STM32MP13),1)
 BL2_SOURCES		+=	drivers/st/crypto/stm32_pka.c
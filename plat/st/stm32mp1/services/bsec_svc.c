@@ -24,7 +24,7 @@ uint32_t bsec_main(uint32_t x1, uint32_t x2, uint32_t x3,
 
 	switch (x1) {
 	case STM32_SMC_READ_SHADOW:
-		result = bsec_read_otp(ret_otp_value, x2);
+		result = stm32_otp_cached_read(ret_otp_value, x2);
 		break;
 	case STM32_SMC_PROG_OTP:
 		*ret_otp_value = 0U;
@@ -42,11 +42,12 @@ uint32_t bsec_main(uint32_t x1, uint32_t x2, uint32_t x3,
 		}
 
 		result = bsec_shadow_read_otp(ret_otp_value, x2);
-		if (result != BSEC_OK) {
-			break;
+		if (result == BSEC_OK) {
+			result = bsec_write_otp(tmp_data, x2);
 		}
 
-		result = bsec_write_otp(tmp_data, x2);
+		/* Shadow reloaded from the fuse, restored or not */
+		stm32_otp_cache_invalidate(x2);
 		break;
 
 	default:
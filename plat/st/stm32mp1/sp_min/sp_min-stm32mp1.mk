@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2017-2022, ARM Limited and Contributors. All rights reserved.
+# Copyright (c) 2017-2024, ARM Limited and Contributors. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -23,6 +23,11 @@ BL32_SOURCES		+=	drivers/st/etzpc/etzpc.c			\
 				plat/st/stm32mp1/stm32mp1_shared_resources.c	\
 				plat/st/stm32mp1/stm32mp1_topology.c
 
+# CRC of the snapshot saved at suspend, the unused inflate code is dropped
+ifeq (${STM32MP1_FAST_RESUME},1)
+BL32_SOURCES		+=	$(ZLIB_SOURCES)
+endif
+
 # FDT wrappers
 include common/fdt_wrappers.mk
 BL32_SOURCES		+=	${FDT_WRAPPERS_SOURCES}
@@ -1,17 +1,25 @@
 /*
- * Copyright (c) 2017-2023, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2024, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <assert.h>
+#include <errno.h>
+#include <stddef.h>
 #include <string.h>
 
 #include <arch_helpers.h>
 #include <common/debug.h>
+#include <common/tf_crc32.h>
 #include <drivers/clk.h>
+#include <drivers/st/etzpc.h>
+#include <drivers/st/stm32_gpio.h>
+#include <drivers/st/stm32mp1_clk.h>
 #include <drivers/st/stm32mp1_ddr_helpers.h>
 #include <drivers/st/stm32mp1_ddr_regs.h>
 #include <dt-bindings/clock/stm32mp1-clks.h>
+#include <dt-bindings/gpio/stm32-gpio.h>
 #include <lib/utils.h>
 
 #include <platform_def.h>
@@ -34,6 +42,10 @@
  * MAILBOX_MAGIC_V3:
  * Context provides V2 content, low power entry point, BL2 code start, end and
  * BL2_END (102 bytes). And, only for STM32MP13, adds MCE master key (16 bytes).
+ *
+ * With STM32MP1_FAST_RESUME, SP_MIN appends at suspend a snapshot of the clock
+ * tree, of the ETZPC and of the GPIOZ secure configuration, with a CRC. It is
+ * not part of the layout shared with the secure OS and only read by BL2.
  */
 #define MAILBOX_MAGIC_V1		(0x0001U << 16U)
 #define MAILBOX_MAGIC_V2		(0x0002U << 16U)
@@ -53,6 +65,20 @@
 					  (PLAT_MAX_PLLCFG_NB + 3U)) + 1U) * \
 					 sizeof(uint32_t))
 
+/* Size of the MAILBOX_MAGIC_V3 content up to BL2_END */
+#define BACKUP_DATA_V3_SIZE		U(168)
+
+#if STM32MP1_FAST_RESUME
+#define PM_SNAPSHOT_TZMA_NB		2U
+
+struct pm_snapshot_s {
+	struct stm32mp1_clk_snapshot clk;
+	uint8_t etzpc_decprot[STM32MP_ETZPC_MAX_ID];
+	uint16_t etzpc_tzma[PM_SNAPSHOT_TZMA_NB];
+	uint32_t gpioz_secr;
+};
+#endif
+
 struct backup_data_s {
 	uint32_t magic;
 	uint32_t core0_resume_hint;
@@ -67,8 +93,26 @@ struct backup_data_s {
 	uint8_t mce_seed[MCE_SEED_SIZE_IN_BYTES];
 	struct stm32_mce_region_s mce_regions[MCE_IP_MAX_REGION_NB];
 #endif
+#if STM32MP1_FAST_RESUME
+	struct pm_snapshot_s pm_snapshot;
+	uint32_t pm_snapshot_crc;
+#endif
 };
 
+CASSERT((offsetof(struct backup_data_s, bl2_end) + sizeof(uint32_t)) ==
+	BACKUP_DATA_V3_SIZE, assert_backup_data_v3_layout);
+CASSERT(sizeof(struct backup_data_s) <= STM32MP_BACKUP_RAM_SIZE,
+	assert_backup_data_size);
+
+#if STM32MP1_FAST_RESUME
+/* Seeded with the snapshot size: a snapshot of another layout is rejected */
+static uint32_t pm_snapshot_crc(const struct pm_snapshot_s *snap)
+{
+	return tf_crc32((uint32_t)sizeof(*snap), (const unsigned char *)snap,
+			sizeof(*snap));
+}
+#endif
+
 uint32_t stm32_pm_get_optee_ep(void)
 {
 	struct backup_data_s *backup_data;
@@ -138,7 +182,109 @@ void stm32_context_save_bl2_param(void)
 
 	clk_disable(BKPSRAM);
 }
-#endif
+
+#if STM32MP1_FAST_RESUME
+/*
+ * Replay the snapshot saved at suspend: the clock tree first, then the ETZPC
+ * and GPIOZ secure configuration that it clocks.
+ * Returns 0 on success, a negative errno if there is no valid snapshot or if
+ * the clock tree cannot be replayed.
+ */
+int stm32_context_restore_pm_snapshot(void)
+{
+	struct backup_data_s *backup_data;
+	struct pm_snapshot_s snap;
+	unsigned int id;
+	int ret = -ENOENT;
+
+	if (!stm32mp_bkpram_get_access()) {
+		return ret;
+	}
+
+	clk_enable(BKPSRAM);
+
+	backup_data = (struct backup_data_s *)STM32MP_BACKUP_RAM_BASE;
+
+	if ((MAGIC_ID(backup_data->magic) == MAILBOX_MAGIC_V3) &&
+	    (backup_data->pm_snapshot_crc ==
+	     pm_snapshot_crc(&backup_data->pm_snapshot))) {
+		snap = backup_data->pm_snapshot;
+		ret = 0;
+	}
+
+	clk_disable(BKPSRAM);
+
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = stm32mp1_clk_restore_snapshot(&snap.clk);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = etzpc_init();
+	if (ret != 0) {
+		return ret;
+	}
+
+	for (id = 0U; id < etzpc_get_num_per_sec(); id++) {
+		etzpc_configure_decprot(id, (enum etzpc_decprot_attributes)
+					snap.etzpc_decprot[id]);
+	}
+
+	for (id = 0U; id < PM_SNAPSHOT_TZMA_NB; id++) {
+		etzpc_configure_tzma(id, snap.etzpc_tzma[id]);
+	}
+
+	restore_gpio_bank_secure_cfg(GPIO_BANK_Z, snap.gpioz_secr);
+
+	return 0;
+}
+#endif /* STM32MP1_FAST_RESUME */
+#endif /* IMAGE_BL2 */
+
+#if STM32MP1_FAST_RESUME
+/*
+ * Save the clock tree, the ETZPC and the GPIOZ secure configuration at
+ * suspend, for BL2 to replay them on a wakeup from Standby. The snapshot is
+ * built aside so that its padding bytes are covered by the CRC.
+ */
+void stm32_context_save_pm_snapshot(void)
+{
+	struct backup_data_s *backup_data;
+	struct pm_snapshot_s snap;
+	unsigned int id;
+
+	if (!stm32mp_bkpram_get_access()) {
+		return;
+	}
+
+	zeromem(&snap, sizeof(snap));
+
+	stm32mp1_clk_get_snapshot(&snap.clk);
+
+	assert(etzpc_get_num_per_sec() <= STM32MP_ETZPC_MAX_ID);
+	for (id = 0U; id < etzpc_get_num_per_sec(); id++) {
+		snap.etzpc_decprot[id] = (uint8_t)etzpc_get_decprot(id);
+	}
+
+	for (id = 0U; id < PM_SNAPSHOT_TZMA_NB; id++) {
+		snap.etzpc_tzma[id] = etzpc_get_tzma(id);
+	}
+
+	snap.gpioz_secr = get_gpio_bank_secure_cfg(GPIO_BANK_Z);
+
+	clk_enable(BKPSRAM);
+
+	backup_data = (struct backup_data_s *)STM32MP_BACKUP_RAM_BASE;
+
+	memcpy(&backup_data->pm_snapshot, &snap, sizeof(snap));
+	backup_data->pm_snapshot_crc = pm_snapshot_crc(&snap);
+
+	clk_disable(BKPSRAM);
+}
+#endif /* STM32MP1_FAST_RESUME */
 
 uint32_t stm32_get_zdata_from_context(void)
 {
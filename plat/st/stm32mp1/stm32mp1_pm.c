@@ -118,7 +118,10 @@ static void stm32_pwr_domain_off(const psci_power_state_t *target_state)
  ******************************************************************************/
 static void stm32_pwr_domain_suspend(const psci_power_state_t *target_state)
 {
-	/* Nothing to do, power domain is not disabled */
+#if STM32MP1_FAST_RESUME
+	/* Replayed by BL2 if the system reaches Standby */
+	stm32_context_save_pm_snapshot();
+#endif
 }
 
 /*******************************************************************************
@@ -21,6 +21,7 @@
 #include <drivers/st/stm32_console.h>
 #include <drivers/st/stm32_hash.h>
 #include <drivers/st/stm32_iwdg.h>
+#include <drivers/st/stm32_pka.h>
 #include <drivers/st/stm32_rifsc.h>
 #include <drivers/st/stm32_rng.h>
 #include <drivers/st/stm32_saes.h>
@@ -43,6 +44,9 @@
 #include <stm32mp_common.h>
 #include <stm32mp_dt.h>
 #include <stm32mp2_context.h>
+#if STM32MP_BL2_WORKER
+#include <stm32mp_worker.h>
+#endif
 
 #define BOOT_CTX_ADDR	0x0e000020UL
 
@@ -217,6 +221,16 @@ void bl2_platform_setup(void)
 		panic();
 	}
 
+#if STM32MP_BL2_WORKER
+	/*
+	 * Nothing to offload when the DDR content is kept. The jobs are run by
+	 * the primary core if the worker does not start.
+	 */
+	if (!stm32mp_is_wakeup_from_standby()) {
+		(void)stm32mp_worker_start();
+	}
+#endif
+
 #if !STM32MP_M33_TDCID
 	/* Set QOS ICN priority */
 	stm32mp_syscfg_set_icn_qos();
@@ -775,9 +789,19 @@ int bl2_plat_handle_post_image_load(unsigned int image_id)
 
 void bl2_el3_plat_prepare_exit(void)
 {
+#if STM32MP_BL2_WORKER
+	/* Reset the secondary core for BL31 */
+	stm32mp_worker_stop();
+#endif
+
 	flush_dcache_range(BSS_START, BSS_END - BSS_START);
 	flush_dcache_range(DATA_START, DATA_END - DATA_START);
 
+#if TRUSTED_BOARD_BOOT
+	/* Clear the curve parameters kept in PKA RAM by the authentication */
+	stm32_pka_release();
+#endif
+
 	stm32mp_io_exit();
 
 	/* Unmask potential tamper before exit */
@@ -7,7 +7,11 @@
 #ifndef STM32MP2_SMC_H
 #define STM32MP2_SMC_H
 
+#if PSCI_STAT_HISTOGRAM
+#define STM32_COMMON_SIP_NUM_CALLS			2U
+#else
 #define STM32_COMMON_SIP_NUM_CALLS			1U
+#endif
 
 /*
  * STM32_SIP_SMC_STGEN_SET_RATE call API
@@ -19,4 +23,17 @@
  */
 #define STM32_SIP_SMC_STGEN_SET_RATE                    0x82000000
 
+/*
+ * STM32_SIP_SMC_PSCI_STAT_HIST call API
+ * Read a bucket of the CPU_SUSPEND latency histograms (PSCI_STAT_HISTOGRAM).
+ *
+ * Argument a0: (input) SMCC ID
+ *		(output) number of latencies recorded in the bucket, bits 31:0
+ * Argument a1: (input) Target CPU MPIDR
+ *		(output) number of latencies recorded in the bucket, bits 63:32
+ * Argument a2: (input) Histogram type (0: entry, 1: exit)
+ * Argument a3: (input) Bucket index
+ */
+#define STM32_SIP_SMC_PSCI_STAT_HIST                    0x82000001
+
 #endif /* STM32MP2_SMC_H */
@@ -8,6 +8,9 @@
 # metadata (2) and fsbl-m (2) and the FIP partitions (default is 2).
 STM32_EXTRA_PARTS	:=	6
 
+# DWC3 receives a whole DFU block on EP0 with a single DMA transfer
+STM32MP_USB_DFU_XFER_SIZE ?=	4096
+
 include plat/st/common/common.mk
 
 CRASH_REPORTING		:=	1
@@ -36,6 +39,9 @@ STM32MP_M33_TDCID	?=	0
 
 STM32MP_USE_EXTERNAL_HEAP :=	1
 
+# Apply the FW_CONFIG RISAF regions from a table generated at build time
+STM32MP_RISAF_TABLE	?=	0
+
 ifeq (${TRUSTED_BOARD_BOOT},1)
 # PKA algo to include
 PKA_USE_NIST_P256	:=	1
@@ -138,12 +144,14 @@ $(eval $(call assert_booleans,\
 		STM32MP_DDR4_TYPE \
 		STM32MP_LPDDR4_TYPE \
 		STM32MP_M33_TDCID \
+		STM32MP_RISAF_TABLE \
 		STM32MP_USE_EXTERNAL_HEAP \
 		STM32MP25 \
 )))
 
 $(eval $(call assert_numerics,\
 	$(sort \
+		PLAT_PARTITION_BUFFER_SIZE \
 		PLAT_PARTITION_MAX_ENTRIES \
 		STM32_HASH_VER \
 		STM32_RNG_VER \
@@ -156,6 +164,7 @@ $(eval $(call add_defines,\
 		PKA_USE_BRAINPOOL_P256T1 \
 		PKA_USE_NIST_P256 \
 		PLAT_DEF_FIP_UUID \
+		PLAT_PARTITION_BUFFER_SIZE \
 		PLAT_PARTITION_MAX_ENTRIES \
 		PLAT_TBBR_IMG_DEF \
 		STM32_HASH_VER \
@@ -168,6 +177,7 @@ $(eval $(call add_defines,\
 		STM32MP_DDR4_TYPE \
 		STM32MP_LPDDR4_TYPE \
 		STM32MP_M33_TDCID \
+		STM32MP_RISAF_TABLE \
 		STM32MP_USE_EXTERNAL_HEAP \
 		STM32MP25 \
 )))
@@ -223,8 +233,22 @@ BL2_SOURCES		+=	drivers/st/crypto/stm32_hash.c				\
 
 BL2_SOURCES		+=	drivers/st/rif/stm32_rifsc.c
 
+ifeq (${STM32MP_BL2_WORKER},1)
+BL2_SOURCES		+=	plat/st/stm32mp2/stm32mp2_worker.c			\
+				plat/st/stm32mp2/${ARCH}/stm32mp2_worker_entry.S
+endif
+
 ifeq ($(STM32MP_M33_TDCID),0)
 BL2_SOURCES		+=	drivers/st/rif/stm32mp2_risaf.c
+
+ifeq (${STM32MP_RISAF_TABLE},1)
+STM32MP_RISAF_TABLE_H	:=	${BUILD_PLAT}/include/stm32mp2_risaf_table.h
+# RISAF index:memory base:memory size:granularity, the region limits are
+# read from stm32mp2_def.h
+STM32MP_RISAF_TABLE_INST ?=	1:0x60000000:0x10000000:0x1000			\
+				3:0x80000000:0x100000000:0x1000
+PLAT_INCLUDES		+=	-I${BUILD_PLAT}/include
+endif
 endif
 
 
@@ -388,4 +412,17 @@ ${BUILD_PLAT}/fdts/%-bl31.dts: $(DT_SOURCE_PATH)/%.dts fdts/${BL31_DTSI} | ${BUI
 
 ${BUILD_PLAT}/fdts/%-bl31.dtb: ${BUILD_PLAT}/fdts/%-bl31.dts
 
+ifneq (${STM32MP_RISAF_TABLE_H},)
+# Check the FW_CONFIG regions and generate their RISAF register writes
+${BUILD_PLAT}/bl2/stm32mp2_risaf.o: ${STM32MP_RISAF_TABLE_H}
+
+${STM32MP_RISAF_TABLE_H}: ${STM32MP_FW_CONFIG} tools/stm32_risaf_table/stm32_risaf_table.py \
+			  plat/st/stm32mp2/stm32mp2_def.h
+	@echo "  GEN     $@"
+	${Q}mkdir -p $(dir $@)
+	${Q}${PYTHON} tools/stm32_risaf_table/stm32_risaf_table.py $< \
+		$(addprefix -i ,${STM32MP_RISAF_TABLE_INST}) \
+		-d plat/st/stm32mp2/stm32mp2_def.h -o $@
+endif
+
 include plat/st/common/common_rules.mk
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2022, STMicroelectronics - All Rights Reserved
+ * Copyright (c) 2022-2024, STMicroelectronics - All Rights Reserved
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -10,6 +10,7 @@
 #include <common/debug.h>
 #include <common/runtime_svc.h>
 #include <lib/mmio.h>
+#include <lib/psci/psci_lib.h>
 
 #include <stm32mp_svc_setup.h>
 #include <stm32mp2_smc.h>
@@ -38,6 +39,18 @@ void plat_svc_smc_handler(uint32_t smc_fid, u_register_t x1,
 
 		*ret1 = stgen_svc_handler();
 		break;
+#if PSCI_STAT_HISTOGRAM
+	case STM32_SIP_SMC_PSCI_STAT_HIST:
+	{
+		uint64_t count = psci_stat_latency_hist(x1, (unsigned int)x2,
+							(unsigned int)x3);
+
+		*ret1 = (uint32_t)count;
+		*ret2 = (uint32_t)(count >> 32);
+		*ret2_enabled = true;
+		break;
+	}
+#endif
 	default:
 		WARN("Unimplemented STM32MP2 Service Call: 0x%x\n", smc_fid);
 		*ret1 = STM32_SMC_NOT_SUPPORTED;
@@ -549,6 +549,12 @@ enum ddr_type {
 #define RISAF_MAX_REGION		(RISAF1_MAX_REGION + RISAF2_MAX_REGION + \
 					RISAF4_MAX_REGION + RISAF5_MAX_REGION)
 
+/* Regions of each instance, region IDs go from 1 to this number */
+#define RISAF1_NB_REGIONS		4
+#define RISAF2_NB_REGIONS		4
+#define RISAF4_NB_REGIONS		15
+#define RISAF5_NB_REGIONS		2
+
 #define RISAF_KEY_SIZE_IN_BYTES		U(16)
 #define RISAF_SEED_SIZE_IN_BYTES	U(4)
 
@@ -576,6 +582,7 @@ enum ddr_type {
  * STM32MP CA35SSC
  ******************************************************************************/
 #define A35SSC_BASE			U(0x48800000)
+#define CA35SS_SYSCFG_VBAR_CR		U(0x2084)
 
 /*******************************************************************************
  * REGULATORS
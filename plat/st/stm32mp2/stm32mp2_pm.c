@@ -35,8 +35,6 @@
 #define DEFAULT_LPLVDLY_D2	0U		/* 6xLSI cycle = 187 us */
 #define DEFAULT_LPSTOP1DLY	100U		/* LP-Stop1 PWRLP_DLY to wait VTT */
 
-#define CA35SS_SYSCFG_VBAR_CR	0x2084U
-
 #define RAMCFG_RETRAMCR		0x180U
 #define SRAMHWERDIS		BIT(12)
 
@@ -155,6 +153,11 @@ static const unsigned int stm32mp_pm_idle_states[] = {
 /* The supported low power mode on the board, including STANDBY */
 static unsigned int stm32mp_supported_pwr_states[PM_IDLE_STATES_SIZE + 1U];
 
+#if PSCI_STAT_HISTOGRAM
+/* Target residency in us of each supported power state, from DT */
+static uint32_t stm32mp_supported_min_residency[PM_IDLE_STATES_SIZE + 1U];
+#endif
+
 extern void stm32_stop2_entrypoint(void);
 
 static bool stm32mp_state_check(unsigned int core_id, unsigned int state_id)
@@ -814,6 +817,51 @@ static int stm32_validate_power_state(unsigned int power_state,
 	return PSCI_E_SUCCESS;
 }
 
+#if PSCI_STAT_HISTOGRAM
+/*
+ * stm32_pwr_domain_demote_suspend() - Demote the requested idle state to the
+ * deepest shallower supported state whose target residency is covered by the
+ * predicted residency of the calling core.
+ *
+ * @req_state			Requested state, updated on demotion
+ * @predicted_residency		Predicted residency in us
+ */
+static void stm32_pwr_domain_demote_suspend(psci_power_state_t *req_state,
+					    u_register_t predicted_residency)
+{
+	unsigned int power_state = stm32_get_stateid(req_state->pwr_domain_state);
+	unsigned int state_id;
+	unsigned int lvl;
+	unsigned int i;
+
+	for (i = 0U; stm32mp_supported_pwr_states[i] != 0U; i++) {
+		if (power_state == stm32mp_supported_pwr_states[i]) {
+			break;
+		}
+	}
+	if (stm32mp_supported_pwr_states[i] == 0U) {
+		return;
+	}
+
+	/* Supported states are sorted by increasing depth */
+	while ((i > 0U) && (predicted_residency < stm32mp_supported_min_residency[i])) {
+		i--;
+	}
+	if (power_state == stm32mp_supported_pwr_states[i]) {
+		return;
+	}
+
+	VERBOSE("PSCI power state %x demoted to %x\n", power_state,
+		stm32mp_supported_pwr_states[i]);
+
+	state_id = psci_get_pstate_id(stm32mp_supported_pwr_states[i]);
+	for (lvl = 0U; lvl <= PLAT_MAX_PWR_LVL; lvl++) {
+		req_state->pwr_domain_state[lvl] = state_id & PLAT_LOCAL_PSTATE_MASK;
+		state_id >>= PLAT_LOCAL_PSTATE_WIDTH;
+	}
+}
+#endif
+
 static int stm32_validate_ns_entrypoint(uintptr_t entrypoint)
 {
 	/* The non-secure entry point must be in DDR */
@@ -922,6 +970,9 @@ static const plat_psci_ops_t stm32_psci_ops = {
 	.pwr_domain_off = stm32_pwr_domain_off,
 	.pwr_domain_validate_suspend = stm32_pwr_domain_validate_suspend,
 	.pwr_domain_suspend = stm32_pwr_domain_suspend,
+#if PSCI_STAT_HISTOGRAM
+	.pwr_domain_demote_suspend = stm32_pwr_domain_demote_suspend,
+#endif
 	.pwr_domain_on_finish = stm32_pwr_domain_on_finish,
 	.pwr_domain_suspend_finish = stm32_pwr_domain_suspend_finish,
 	.pwr_domain_pwr_down_wfi = stm32_pwr_domain_pwr_down_wfi,
@@ -939,6 +990,9 @@ static const plat_psci_ops_t stm32_psci_ops = {
 static int stm32_parse_domain_idle_state(void *fdt)
 {
 	unsigned int domain_idle_states[PM_IDLE_STATES_SIZE];
+#if PSCI_STAT_HISTOGRAM
+	uint32_t domain_min_residency[PM_IDLE_STATES_SIZE];
+#endif
 	int node = 0;
 	int subnode = 0;
 	uint32_t power_state;
@@ -971,6 +1025,10 @@ static int stm32_parse_domain_idle_state(void *fdt)
 			return -EINVAL;
 		}
 
+#if PSCI_STAT_HISTOGRAM
+		domain_min_residency[i] = fdt_read_uint32_default(fdt, subnode,
+								  "min-residency-us", 0U);
+#endif
 		domain_idle_states[i++] = power_state;
 
 		/* Check array size */
@@ -980,6 +1038,9 @@ static int stm32_parse_domain_idle_state(void *fdt)
 	}
 
 	memset(stm32mp_supported_pwr_states, 0, sizeof(stm32mp_supported_pwr_states));
+#if PSCI_STAT_HISTOGRAM
+	memset(stm32mp_supported_min_residency, 0, sizeof(stm32mp_supported_min_residency));
+#endif
 
 	/* The CPU idle state is always supported, not present in domain node */
 	stm32mp_supported_pwr_states[nb_states++] = PWRSTATE_RUN;
@@ -988,6 +1049,10 @@ static int stm32_parse_domain_idle_state(void *fdt)
 	for (j = 0U; stm32mp_pm_idle_states[j] != 0U; j++) {
 		for (i = 0U; domain_idle_states[i] != 0U && i < PM_IDLE_STATES_SIZE; i++) {
 			if (domain_idle_states[i] == stm32mp_pm_idle_states[j]) {
+#if PSCI_STAT_HISTOGRAM
+				stm32mp_supported_min_residency[nb_states] =
+					domain_min_residency[i];
+#endif
 				stm32mp_supported_pwr_states[nb_states++] = domain_idle_states[i];
 				break;
 			}
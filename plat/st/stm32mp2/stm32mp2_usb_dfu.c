@@ -104,12 +104,11 @@ static const uint8_t usb_stm32mp2_config_desc[USB_DFU_CONFIG_DESC_SIZ] = {
 	DFU_BM_ATTRIBUTE, /* bmAttribute for DFU */
 	0xFF, /* DetachTimeOut = 255 ms */
 	0x00,
-	/* WARNING: In DMA mode the multiple MPS packets feature
-	 *  is still not supported ==> In this case,
-	 *  when using DMA USBD_DFU_XFER_SIZE should be set
-	 *  to 64 in usbd_conf.h
+	/*
+	 * With USB_CORE_AVOID_PACKET_SPLIT_MPS, a DNLOAD block is received
+	 * with a single DMA transfer to its load address, whatever its size.
 	 */
-	TRANSFER_SIZE_BYTES(USBD_DFU_XFER_SIZE), /* TransferSize = 1024 Byte */
+	TRANSFER_SIZE_BYTES(USBD_DFU_XFER_SIZE), /* TransferSize */
 	((USB_DFU_VERSION >> 0) & 0xFF), /* bcdDFUVersion */
 	((USB_DFU_VERSION >> 8) & 0xFF)
 };
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <arch_helpers.h>
+#include <drivers/st/stm32mp2_rcc.h>
+#include <lib/mmio.h>
+
+#include <platform_def.h>
+#include <stm32mp_common.h>
+#include <stm32mp_worker.h>
+
+void stm32mp2_worker_entrypoint(void);
+
+/* Reset address of the secondary core when BL2 started */
+static uint32_t core1_vbar;
+
+static void core1_reset(uint32_t entrypoint)
+{
+	mmio_write_32(A35SSC_BASE + CA35SS_SYSCFG_VBAR_CR, entrypoint);
+	dsb();
+
+	mmio_write_32(stm32mp_rcc_base() + RCC_C1P1RSTCSETR,
+		      RCC_C1P1RSTCSETR_C1P1PORRST);
+}
+
+/*
+ * The secondary core restarts from the CA35SS reset address after a power-on
+ * reset, as for a PSCI CPU_ON in BL31.
+ */
+int stm32mp_plat_worker_cpu_on(void)
+{
+	if (stm32mp_is_single_core()) {
+		return -ENODEV;
+	}
+
+	core1_vbar = mmio_read_32(A35SSC_BASE + CA35SS_SYSCFG_VBAR_CR);
+
+	core1_reset((uint32_t)(uintptr_t)&stm32mp2_worker_entrypoint);
+
+	return 0;
+}
+
+/*
+ * Reset the secondary core at the address it had when BL2 started, so that it
+ * waits there for BL31 to release it.
+ */
+void stm32mp_plat_worker_cpu_off(void)
+{
+	core1_reset(core1_vbar);
+}
@@ -23,6 +23,7 @@
 #include "cmd_opt.h"
 #include "debug.h"
 #include "ext.h"
+#include "jobs.h"
 #include "key.h"
 #include "sha.h"
 
@@ -65,6 +66,12 @@ static int key_size;
 static int new_keys;
 static int save_keys;
 static int print_cert;
+static int jobs = 1;
+
+/* Image hash algorithm and digests of the images, indexed by extension */
+static const EVP_MD *md_info;
+static unsigned int md_len;
+static unsigned char (*ext_md)[SHA512_DIGEST_LENGTH];
 
 /* Info messages created in the Makefile */
 extern const char build_msg[];
@@ -291,25 +298,128 @@ static const cmd_opt_t common_cmd_opt[] = {
 	{
 		{ "print-cert", no_argument, NULL, 'p' },
 		"Print the certificates in the standard output"
+	},
+	{
+		{ "jobs", required_argument, NULL, 'j' },
+		"Number of keys, image hashes and certificates processed in "
+		"parallel (default: 1)"
 	}
 };
 
-int main(int argc, char *argv[])
+static void create_key(int i)
+{
+	NOTICE("Creating new key for '%s'\n", keys[i].desc);
+	if (!key_create(&keys[i], key_alg, key_size)) {
+		ERROR("Error creating key '%s'\n", keys[i].desc);
+		exit(1);
+	}
+}
+
+static void hash_image(int i)
+{
+	if (!sha_file(hash_alg, extensions[i].arg, ext_md[i])) {
+		ERROR("Cannot calculate hash of %s\n", extensions[i].arg);
+		exit(1);
+	}
+}
+
+static void create_cert(int i)
 {
 	STACK_OF(X509_EXTENSION) * sk;
 	X509_EXTENSION *cert_ext = NULL;
+	cert_t *cert = &certs[i];
+	ext_t *ext;
+	int j, ext_nid, nvctr;
+	unsigned char zero_md[SHA512_DIGEST_LENGTH] = { 0 };
+
+	/* Create a new stack of extensions. This stack will be used
+	 * to create the certificate */
+	CHECK_NULL(sk, sk_X509_EXTENSION_new_null());
+
+	for (j = 0 ; j < cert->num_ext ; j++) {
+
+		ext = &extensions[cert->ext[j]];
+
+		/* Get OpenSSL internal ID for this extension */
+		CHECK_OID(ext_nid, ext->oid);
+
+		/*
+		 * Three types of extensions are currently supported:
+		 *     - EXT_TYPE_NVCOUNTER
+		 *     - EXT_TYPE_HASH
+		 *     - EXT_TYPE_PKEY
+		 */
+		switch (ext->type) {
+		case EXT_TYPE_NVCOUNTER:
+			if (ext->optional && ext->arg == NULL) {
+				/* Skip this NVCounter */
+				continue;
+			} else {
+				/* Checked by `check_cmd_params` */
+				assert(ext->arg != NULL);
+				nvctr = atoi(ext->arg);
+				CHECK_NULL(cert_ext, ext_new_nvcounter(ext_nid,
+					EXT_CRIT, nvctr));
+			}
+			break;
+		case EXT_TYPE_HASH:
+			if (ext->arg == NULL) {
+				if (ext->optional) {
+					/* Include a hash filled with zeros */
+					CHECK_NULL(cert_ext, ext_new_hash(ext_nid,
+						EXT_CRIT, md_info, zero_md,
+						md_len));
+				} else {
+					/* Do not include this hash in the certificate */
+					continue;
+				}
+			} else {
+				/* Hash of the file, computed by hash_image() */
+				CHECK_NULL(cert_ext, ext_new_hash(ext_nid,
+					EXT_CRIT, md_info, ext_md[cert->ext[j]],
+					md_len));
+			}
+			break;
+		case EXT_TYPE_PKEY:
+			CHECK_NULL(cert_ext, ext_new_key(ext_nid,
+				EXT_CRIT, keys[ext->attr.key].key));
+			break;
+		default:
+			ERROR("Unknown extension type '%d' in %s\n",
+					ext->type, cert->cn);
+			exit(1);
+		}
+
+		/* Push the extension into the stack */
+		sk_X509_EXTENSION_push(sk, cert_ext);
+	}
+
+	/* Create certificate. Signed with corresponding key */
+	if (!cert_new(hash_alg, cert, VAL_DAYS, 0, sk)) {
+		ERROR("Cannot create %s\n", cert->cn);
+		exit(1);
+	}
+
+	for (cert_ext = sk_X509_EXTENSION_pop(sk); cert_ext != NULL;
+			cert_ext = sk_X509_EXTENSION_pop(sk)) {
+		X509_EXTENSION_free(cert_ext);
+	}
+
+	sk_X509_EXTENSION_free(sk);
+}
+
+int main(int argc, char *argv[])
+{
 	ext_t *ext;
 	key_t *key;
 	cert_t *cert;
 	FILE *file;
-	int i, j, ext_nid, nvctr;
+	int i, j, nr, lvl, max_lvl;
+	int *idx, *cert_lvl;
 	int c, opt_idx = 0;
 	const struct option *cmd_opt;
 	const char *cur_opt;
 	unsigned int err_code;
-	unsigned char md[SHA512_DIGEST_LENGTH];
-	unsigned int  md_len;
-	const EVP_MD *md_info;
 
 	NOTICE("CoT Generation Tool: %s\n", build_msg);
 	NOTICE("Target platform: %s\n", platform_msg);
@@ -347,7 +457,7 @@ int main(int argc, char *argv[])
 
 	while (1) {
 		/* getopt_long stores the option index here. */
-		c = getopt_long(argc, argv, "a:b:hknps:", cmd_opt, &opt_idx);
+		c = getopt_long(argc, argv, "a:b:hj:knps:", cmd_opt, &opt_idx);
 
 		/* Detect the end of the options. */
 		if (c == -1) {
@@ -372,6 +482,14 @@ int main(int argc, char *argv[])
 		case 'h':
 			print_help(argv[0], cmd_opt);
 			exit(0);
+		case 'j':
+			jobs = atoi(optarg);
+			if ((jobs < 1) || (jobs > MAX_JOBS)) {
+				ERROR("Invalid number of jobs '%s' (1 to %d)\n",
+				      optarg, MAX_JOBS);
+				exit(1);
+			}
+			break;
 		case 'k':
 			save_keys = 1;
 			break;
@@ -431,7 +549,13 @@ int main(int argc, char *argv[])
 		md_len  = SHA256_DIGEST_LENGTH;
 	}
 
+	CHECK_NULL(idx, malloc(sizeof(int) *
+			       (num_keys + num_extensions + num_certs)));
+	CHECK_NULL(cert_lvl, calloc(num_certs, sizeof(int)));
+	CHECK_NULL(ext_md, calloc(num_extensions, sizeof(*ext_md)));
+
 	/* Load private keys from files (or generate new ones) */
+	nr = 0;
 	for (i = 0 ; i < num_keys ; i++) {
 #if !USING_OPENSSL3
 		if (!key_new(&keys[i])) {
@@ -457,12 +581,8 @@ int main(int argc, char *argv[])
 		/* File does not exist, could not be opened or no filename was
 		 * given */
 		if (new_keys) {
-			/* Try to create a new key */
-			NOTICE("Creating new key for '%s'\n", keys[i].desc);
-			if (!key_create(&keys[i], key_alg, key_size)) {
-				ERROR("Error creating key '%s'\n", keys[i].desc);
-				exit(1);
-			}
+			/* Create a new key, see below */
+			idx[nr++] = i;
 		} else {
 			if (err_code == KEY_ERR_OPEN) {
 				ERROR("Error opening '%s'\n", keys[i].fn);
@@ -473,95 +593,67 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	/* Create the certificates */
-	for (i = 0 ; i < num_certs ; i++) {
+	run_jobs(create_key, idx, nr, jobs);
 
+	/* Hash the images bound to the requested certificates */
+	nr = 0;
+	for (i = 0 ; i < num_certs ; i++) {
 		cert = &certs[i];
-
 		if (cert->fn == NULL) {
-			/* Certificate not requested. Skip to the next one */
 			continue;
 		}
 
-		/* Create a new stack of extensions. This stack will be used
-		 * to create the certificate */
-		CHECK_NULL(sk, sk_X509_EXTENSION_new_null());
-
 		for (j = 0 ; j < cert->num_ext ; j++) {
-
 			ext = &extensions[cert->ext[j]];
+			if ((ext->type != EXT_TYPE_HASH) || (ext->arg == NULL)) {
+				continue;
+			}
 
-			/* Get OpenSSL internal ID for this extension */
-			CHECK_OID(ext_nid, ext->oid);
-
-			/*
-			 * Three types of extensions are currently supported:
-			 *     - EXT_TYPE_NVCOUNTER
-			 *     - EXT_TYPE_HASH
-			 *     - EXT_TYPE_PKEY
-			 */
-			switch (ext->type) {
-			case EXT_TYPE_NVCOUNTER:
-				if (ext->optional && ext->arg == NULL) {
-					/* Skip this NVCounter */
-					continue;
-				} else {
-					/* Checked by `check_cmd_params` */
-					assert(ext->arg != NULL);
-					nvctr = atoi(ext->arg);
-					CHECK_NULL(cert_ext, ext_new_nvcounter(ext_nid,
-						EXT_CRIT, nvctr));
-				}
-				break;
-			case EXT_TYPE_HASH:
-				if (ext->arg == NULL) {
-					if (ext->optional) {
-						/* Include a hash filled with zeros */
-						memset(md, 0x0, SHA512_DIGEST_LENGTH);
-					} else {
-						/* Do not include this hash in the certificate */
-						continue;
-					}
-				} else {
-					/* Calculate the hash of the file */
-					if (!sha_file(hash_alg, ext->arg, md)) {
-						ERROR("Cannot calculate hash of %s\n",
-							ext->arg);
-						exit(1);
-					}
+			/* An extension may be shared by several certificates */
+			for (c = 0 ; c < nr ; c++) {
+				if (idx[c] == cert->ext[j]) {
+					break;
 				}
-				CHECK_NULL(cert_ext, ext_new_hash(ext_nid,
-						EXT_CRIT, md_info, md,
-						md_len));
-				break;
-			case EXT_TYPE_PKEY:
-				CHECK_NULL(cert_ext, ext_new_key(ext_nid,
-					EXT_CRIT, keys[ext->attr.key].key));
-				break;
-			default:
-				ERROR("Unknown extension type '%d' in %s\n",
-						ext->type, cert->cn);
-				exit(1);
 			}
-
-			/* Push the extension into the stack */
-			sk_X509_EXTENSION_push(sk, cert_ext);
+			if (c == nr) {
+				idx[nr++] = cert->ext[j];
+			}
 		}
+	}
+	run_jobs(hash_image, idx, nr, jobs);
 
-		/* Create certificate. Signed with corresponding key */
-		if (!cert_new(hash_alg, cert, VAL_DAYS, 0, sk)) {
-			ERROR("Cannot create %s\n", cert->cn);
-			exit(1);
+	/*
+	 * Create the certificates. A certificate needs its issuer certificate
+	 * if it was created before it in the serial order, so certificates
+	 * are created by levels of issuers, in parallel within a level.
+	 */
+	max_lvl = 0;
+	for (i = 0 ; i < num_certs ; i++) {
+		j = certs[i].issuer;
+		if ((certs[i].fn == NULL) || (j >= i) ||
+		    (certs[j].fn == NULL)) {
+			continue;
 		}
 
-		for (cert_ext = sk_X509_EXTENSION_pop(sk); cert_ext != NULL;
-				cert_ext = sk_X509_EXTENSION_pop(sk)) {
-			X509_EXTENSION_free(cert_ext);
+		cert_lvl[i] = cert_lvl[j] + 1;
+		if (cert_lvl[i] > max_lvl) {
+			max_lvl = cert_lvl[i];
 		}
+	}
 
-		sk_X509_EXTENSION_free(sk);
+	for (lvl = 0 ; lvl <= max_lvl ; lvl++) {
+		nr = 0;
+		for (i = 0 ; i < num_certs ; i++) {
+			if ((certs[i].fn != NULL) && (cert_lvl[i] == lvl)) {
+				idx[nr++] = i;
+			}
+		}
+		run_jobs(create_cert, idx, nr, jobs);
 	}
 
+	free(ext_md);
+	free(cert_lvl);
+	free(idx);
 
 	/* Print the certificates */
 	if (print_cert) {
@@ -4,7 +4,11 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <fcntl.h>
 #include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "debug.h"
 #include "key.h"
 #if USING_OPENSSL3
@@ -14,7 +18,17 @@
 #include <openssl/sha.h>
 #endif
 
-#define BUFFER_SIZE	256
+#define BUFFER_SIZE	16384
+
+typedef struct sha_ctx {
+#if USING_OPENSSL3
+	EVP_MD_CTX *mdctx;
+#else
+	int md_alg;
+	SHA256_CTX shaContext;
+	SHA512_CTX sha512Context;
+#endif
+} sha_ctx_t;
 
 #if USING_OPENSSL3
 static int get_algorithm_nid(int hash_alg)
@@ -27,37 +41,14 @@ static int get_algorithm_nid(int hash_alg)
 }
 #endif
 
-int sha_file(int md_alg, const char *filename, unsigned char *md)
+static int sha_init(sha_ctx_t *ctx, int md_alg)
 {
-	FILE *inFile;
-	int bytes;
-	unsigned char data[BUFFER_SIZE];
 #if USING_OPENSSL3
-	EVP_MD_CTX *mdctx;
 	const EVP_MD *md_type;
 	int alg_nid;
-	unsigned int total_bytes;
-#else
-	SHA256_CTX shaContext;
-	SHA512_CTX sha512Context;
-#endif
-
-	if ((filename == NULL) || (md == NULL)) {
-		ERROR("%s(): NULL argument\n", __func__);
-		return 0;
-	}
 
-	inFile = fopen(filename, "rb");
-	if (inFile == NULL) {
-		ERROR("Cannot read %s\n", filename);
-		return 0;
-	}
-
-#if USING_OPENSSL3
-
-	mdctx = EVP_MD_CTX_new();
-	if (mdctx == NULL) {
-		fclose(inFile);
+	ctx->mdctx = EVP_MD_CTX_new();
+	if (ctx->mdctx == NULL) {
 		ERROR("%s(): Could not create EVP MD context\n", __func__);
 		return 0;
 	}
@@ -69,50 +60,113 @@ int sha_file(int md_alg, const char *filename, unsigned char *md)
 	}
 
 	md_type = EVP_get_digestbynid(alg_nid);
-	if (EVP_DigestInit_ex(mdctx, md_type, NULL) == 0) {
+	if (EVP_DigestInit_ex(ctx->mdctx, md_type, NULL) == 0) {
 		ERROR("%s(): Could not initialize EVP MD digest\n", __func__);
 		goto err;
 	}
 
-	while ((bytes = fread(data, 1, BUFFER_SIZE, inFile)) != 0) {
-		EVP_DigestUpdate(mdctx, data, bytes);
-	}
-	EVP_DigestFinal_ex(mdctx, md, &total_bytes);
-
-	fclose(inFile);
-	EVP_MD_CTX_free(mdctx);
 	return 1;
 
 err:
-	fclose(inFile);
-	EVP_MD_CTX_free(mdctx);
+	EVP_MD_CTX_free(ctx->mdctx);
 	return 0;
-
 #else
-
+	ctx->md_alg = md_alg;
 	if (md_alg == HASH_ALG_SHA384) {
-		SHA384_Init(&sha512Context);
-		while ((bytes = fread(data, 1, BUFFER_SIZE, inFile)) != 0) {
-			SHA384_Update(&sha512Context, data, bytes);
-		}
-		SHA384_Final(md, &sha512Context);
+		SHA384_Init(&ctx->sha512Context);
 	} else if (md_alg == HASH_ALG_SHA512) {
-		SHA512_Init(&sha512Context);
-		while ((bytes = fread(data, 1, BUFFER_SIZE, inFile)) != 0) {
-			SHA512_Update(&sha512Context, data, bytes);
-		}
-		SHA512_Final(md, &sha512Context);
+		SHA512_Init(&ctx->sha512Context);
 	} else {
-		SHA256_Init(&shaContext);
-		while ((bytes = fread(data, 1, BUFFER_SIZE, inFile)) != 0) {
-			SHA256_Update(&shaContext, data, bytes);
-		}
-		SHA256_Final(md, &shaContext);
+		SHA256_Init(&ctx->shaContext);
 	}
 
-	fclose(inFile);
 	return 1;
+#endif
+}
+
+static void sha_update(sha_ctx_t *ctx, const void *data, size_t len)
+{
+#if USING_OPENSSL3
+	EVP_DigestUpdate(ctx->mdctx, data, len);
+#else
+	if (ctx->md_alg == HASH_ALG_SHA384) {
+		SHA384_Update(&ctx->sha512Context, data, len);
+	} else if (ctx->md_alg == HASH_ALG_SHA512) {
+		SHA512_Update(&ctx->sha512Context, data, len);
+	} else {
+		SHA256_Update(&ctx->shaContext, data, len);
+	}
+#endif
+}
+
+static void sha_final(sha_ctx_t *ctx, unsigned char *md)
+{
+#if USING_OPENSSL3
+	unsigned int total_bytes;
 
+	EVP_DigestFinal_ex(ctx->mdctx, md, &total_bytes);
+	EVP_MD_CTX_free(ctx->mdctx);
+#else
+	if (ctx->md_alg == HASH_ALG_SHA384) {
+		SHA384_Final(md, &ctx->sha512Context);
+	} else if (ctx->md_alg == HASH_ALG_SHA512) {
+		SHA512_Final(md, &ctx->sha512Context);
+	} else {
+		SHA256_Final(md, &ctx->shaContext);
+	}
 #endif
 }
 
+/*
+ * Regular files are mapped and hashed in one go. Other files (e.g. pipes) or
+ * files that cannot be mapped are read by chunks.
+ */
+int sha_file(int md_alg, const char *filename, unsigned char *md)
+{
+	int fd;
+	struct stat st;
+	ssize_t bytes = 0;
+	unsigned char data[BUFFER_SIZE];
+	sha_ctx_t ctx;
+
+	if ((filename == NULL) || (md == NULL)) {
+		ERROR("%s(): NULL argument\n", __func__);
+		return 0;
+	}
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		ERROR("Cannot read %s\n", filename);
+		return 0;
+	}
+
+	if (!sha_init(&ctx, md_alg)) {
+		close(fd);
+		return 0;
+	}
+
+	if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0)) {
+		void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+				 fd, 0);
+
+		if (map != MAP_FAILED) {
+			sha_update(&ctx, map, st.st_size);
+			munmap(map, st.st_size);
+			goto done;
+		}
+	}
+
+	while ((bytes = read(fd, data, BUFFER_SIZE)) > 0) {
+		sha_update(&ctx, data, bytes);
+	}
+
+done:
+	sha_final(&ctx, md);
+	close(fd);
+	if (bytes < 0) {
+		ERROR("Cannot read %s\n", filename);
+		return 0;
+	}
+
+	return 1;
+}
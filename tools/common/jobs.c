@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2024, Arm Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include "jobs.h"
+
+typedef struct job {
+	void (*fn)(int idx);
+	const int *idx;
+	int nr;
+	int next;
+	pthread_mutex_t lock;
+} job_t;
+
+static void *job_worker(void *arg)
+{
+	job_t *job = arg;
+	int i;
+
+	while (1) {
+		pthread_mutex_lock(&job->lock);
+		i = job->next++;
+		pthread_mutex_unlock(&job->lock);
+		if (i >= job->nr) {
+			break;
+		}
+
+		job->fn((job->idx != NULL) ? job->idx[i] : i);
+	}
+
+	return NULL;
+}
+
+void run_jobs(void (*fn)(int idx), const int *idx, int nr, int nr_jobs)
+{
+	pthread_t threads[MAX_JOBS];
+	job_t job = {
+		.fn = fn,
+		.idx = idx,
+		.nr = nr,
+		.next = 0,
+	};
+	int nr_threads = (nr_jobs < nr) ? nr_jobs : nr;
+	int i;
+
+	if (nr_threads > MAX_JOBS) {
+		nr_threads = MAX_JOBS;
+	}
+
+	pthread_mutex_init(&job.lock, NULL);
+
+	for (i = 0; i + 1 < nr_threads; i++) {
+		if (pthread_create(&threads[i], NULL, job_worker, &job) != 0) {
+			break;
+		}
+	}
+	job_worker(&job);
+	while (i > 0) {
+		pthread_join(threads[--i], NULL);
+	}
+
+	pthread_mutex_destroy(&job.lock);
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2024, Arm Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef JOBS_H
+#define JOBS_H
+
+/* Maximum number of threads run_jobs() may use */
+#define MAX_JOBS		64
+
+/*
+ * Run fn() on each index of idx[] (or on 0 to nr - 1 when idx is NULL), using
+ * up to nr_jobs threads. The calling thread is one of the workers.
+ */
+void run_jobs(void (*fn)(int idx), const int *idx, int nr, int nr_jobs);
+
+#endif /* JOBS_H */
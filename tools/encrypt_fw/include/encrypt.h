@@ -13,7 +13,14 @@ enum {
 	KEY_ALG_GCM		/* AES-GCM (default) */
 };
 
-int encrypt_file(unsigned short fw_enc_status, int enc_alg, char *key_string,
-		 char *nonce_string, const char *ip_name, const char *op_name);
+/*
+ * Encrypt ip_name into op_name. A non-zero chunk_size selects the chunked
+ * format described in firmware_encrypted.h. Several images may be encrypted
+ * in parallel.
+ */
+int encrypt_file(unsigned short fw_enc_status, int enc_alg,
+		 unsigned int chunk_size, const char *key_string,
+		 const char *nonce_string, const char *ip_name,
+		 const char *op_name);
 
 #endif /* ENCRYPT_H */
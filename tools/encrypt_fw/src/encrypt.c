@@ -5,33 +5,274 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <fcntl.h>
 #include <firmware_encrypted.h>
 #include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "debug.h"
 #include "encrypt.h"
 
-#define BUFFER_SIZE		256
+#define BUFFER_SIZE		65536
 #define IV_SIZE			12
 #define IV_STRING_SIZE		24
 #define TAG_SIZE		16
 #define KEY_SIZE		32
 #define KEY_STRING_SIZE		64
 
-static int gcm_encrypt(unsigned short fw_enc_status, char *key_string,
-		       char *nonce_string, const char *ip_name,
-		       const char *op_name)
+/*
+ * Input image. Regular files are mapped, other files (e.g. pipes) or files
+ * that cannot be mapped are read by blocks of BUFFER_SIZE bytes.
+ */
+typedef struct enc_input {
+	int fd;
+	const unsigned char *map;
+	size_t size;
+	size_t off;
+	unsigned char buf[BUFFER_SIZE];
+} enc_input_t;
+
+/* Point to the next (up to len) input bytes and return their number */
+static ssize_t input_get(enc_input_t *in, const unsigned char **data,
+			 size_t len)
+{
+	if (in->map != NULL) {
+		if (len > in->size - in->off) {
+			len = in->size - in->off;
+		}
+		*data = in->map + in->off;
+		in->off += len;
+		return len;
+	}
+
+	*data = in->buf;
+	return read(in->fd, in->buf, (len < BUFFER_SIZE) ? len : BUFFER_SIZE);
+}
+
+static int gcm_start(EVP_CIPHER_CTX *ctx, const unsigned char *key,
+		     const unsigned char *iv, const void *aad, int aad_len)
+{
+	int len;
+
+	if ((EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, NULL, NULL) != 1) ||
+	    (EVP_EncryptInit_ex(ctx, NULL, NULL, key, iv) != 1)) {
+		ERROR("EVP_EncryptInit_ex failed\n");
+		return -1;
+	}
+
+	if ((aad_len != 0) &&
+	    (EVP_EncryptUpdate(ctx, NULL, &len, aad, aad_len) != 1)) {
+		ERROR("EVP_EncryptUpdate failed\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int gcm_update(EVP_CIPHER_CTX *ctx, FILE *op_file,
+		      const unsigned char *data, size_t len,
+		      unsigned char *enc_data)
+{
+	int bytes, enc_len;
+
+	while (len != 0U) {
+		bytes = (len < BUFFER_SIZE) ? len : BUFFER_SIZE;
+		if (EVP_EncryptUpdate(ctx, enc_data, &enc_len, data,
+				      bytes) != 1) {
+			ERROR("EVP_EncryptUpdate failed\n");
+			return -1;
+		}
+
+		if (fwrite(enc_data, 1, enc_len, op_file) != enc_len) {
+			ERROR("fwrite failed\n");
+			return -1;
+		}
+
+		data += bytes;
+		len -= bytes;
+	}
+
+	return 0;
+}
+
+static int gcm_finish(EVP_CIPHER_CTX *ctx, unsigned char *enc_data,
+		      unsigned char *tag)
+{
+	int enc_len;
+
+	/* GCM does not buffer data: nothing is output here */
+	if (EVP_EncryptFinal_ex(ctx, enc_data, &enc_len) != 1) {
+		ERROR("EVP_EncryptFinal_ex failed\n");
+		return -1;
+	}
+
+	if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, TAG_SIZE,
+				tag) != 1) {
+		ERROR("EVP_CIPHER_CTX_ctrl failed\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Encrypt the whole image with a single tag */
+static int gcm_encrypt_image(EVP_CIPHER_CTX *ctx, enc_input_t *in,
+			     FILE *op_file, const unsigned char *key,
+			     const unsigned char *iv, unsigned char *enc_data,
+			     unsigned char *tag)
+{
+	const unsigned char *data;
+	ssize_t bytes;
+
+	if (gcm_start(ctx, key, iv, NULL, 0) != 0) {
+		return -1;
+	}
+
+	while ((bytes = input_get(in, &data, SIZE_MAX)) > 0) {
+		if (gcm_update(ctx, op_file, data, bytes, enc_data) != 0) {
+			return -1;
+		}
+	}
+
+	if (bytes < 0) {
+		ERROR("read failed\n");
+		return -1;
+	}
+
+	return gcm_finish(ctx, enc_data, tag);
+}
+
+/* Derive the key of the chunks of an image, see struct fw_enc_chunk_hdr */
+static int gcm_chunk_key(const unsigned char *key, const unsigned char *iv,
+			 unsigned char *chunk_key)
+{
+	EVP_PKEY_CTX *pctx;
+	size_t len = KEY_SIZE;
+	int ret = -1;
+
+	pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, NULL);
+	if (pctx == NULL) {
+		ERROR("EVP_PKEY_CTX_new_id failed\n");
+		return -1;
+	}
+
+	if ((EVP_PKEY_derive_init(pctx) != 1) ||
+	    (EVP_PKEY_CTX_set_hkdf_md(pctx, EVP_sha256()) != 1) ||
+	    (EVP_PKEY_CTX_set1_hkdf_salt(pctx, iv, IV_SIZE) != 1) ||
+	    (EVP_PKEY_CTX_set1_hkdf_key(pctx, key, KEY_SIZE) != 1) ||
+	    (EVP_PKEY_CTX_add1_hkdf_info(pctx,
+					 (const unsigned char *)ENC_CHUNK_KDF_INFO,
+					 strlen(ENC_CHUNK_KDF_INFO)) != 1) ||
+	    (EVP_PKEY_derive(pctx, chunk_key, &len) != 1) ||
+	    (len != KEY_SIZE)) {
+		ERROR("HKDF failed\n");
+	} else {
+		ret = 0;
+	}
+
+	EVP_PKEY_CTX_free(pctx);
+
+	return ret;
+}
+
+/* Encrypt the image by chunks, see struct fw_enc_chunk_hdr */
+static int gcm_encrypt_chunks(EVP_CIPHER_CTX *ctx, enc_input_t *in,
+			      FILE *op_file, const unsigned char *key,
+			      const unsigned char *iv, unsigned char *enc_data,
+			      unsigned int chunk_size)
+{
+	struct fw_enc_chunk_hdr chunk_hdr;
+	unsigned char chunk_key[KEY_SIZE];
+	unsigned char chunk_iv[IV_SIZE], tag[TAG_SIZE];
+	const unsigned char *data;
+	uint64_t nr_chunks, n;
+	size_t rem;
+	ssize_t bytes;
+	int i, ret = -1;
+
+	if (gcm_chunk_key(key, iv, chunk_key) != 0) {
+		return -1;
+	}
+
+	nr_chunks = (in->size + chunk_size - 1U) / chunk_size;
+
+	memset(&chunk_hdr, 0, sizeof(chunk_hdr));
+	chunk_hdr.chunk_size = chunk_size;
+	chunk_hdr.data_size = in->size;
+	if (fwrite(&chunk_hdr, 1, sizeof(chunk_hdr), op_file) !=
+	    sizeof(chunk_hdr)) {
+		ERROR("fwrite failed\n");
+		goto out;
+	}
+
+	memset(chunk_iv, 0, IV_SIZE);
+	for (n = 0U; n < nr_chunks; n++) {
+		for (i = 0; i < 8; i++) {
+			chunk_iv[IV_SIZE - 1 - i] = (n >> (8 * i)) & 0xff;
+		}
+
+		if (gcm_start(ctx, chunk_key, chunk_iv, &chunk_hdr,
+			      sizeof(chunk_hdr)) != 0) {
+			goto out;
+		}
+
+		rem = in->size - (size_t)n * chunk_size;
+		if (rem > chunk_size) {
+			rem = chunk_size;
+		}
+
+		while (rem != 0U) {
+			bytes = input_get(in, &data, rem);
+			if (bytes <= 0) {
+				ERROR("read failed\n");
+				goto out;
+			}
+
+			if (gcm_update(ctx, op_file, data, bytes,
+				       enc_data) != 0) {
+				goto out;
+			}
+
+			rem -= bytes;
+		}
+
+		if ((gcm_finish(ctx, enc_data, tag) != 0) ||
+		    (fwrite(tag, 1, TAG_SIZE, op_file) != TAG_SIZE)) {
+			ERROR("Cannot finish chunk %llu\n",
+			      (unsigned long long)n);
+			goto out;
+		}
+	}
+
+	ret = 0;
+
+out:
+	OPENSSL_cleanse(chunk_key, sizeof(chunk_key));
+
+	return ret;
+}
+
+static int gcm_encrypt(unsigned short fw_enc_status, unsigned int chunk_size,
+		       const char *key_string, const char *nonce_string,
+		       const char *ip_name, const char *op_name)
 {
-	FILE *ip_file;
 	FILE *op_file;
 	EVP_CIPHER_CTX *ctx;
-	unsigned char data[BUFFER_SIZE], enc_data[BUFFER_SIZE];
+	enc_input_t *in;
+	struct stat st;
+	unsigned char *enc_data;
 	unsigned char key[KEY_SIZE], iv[IV_SIZE], tag[TAG_SIZE];
-	int bytes, enc_len = 0, i, j, ret = 0;
+	int i, j, ret = -1;
 	struct fw_enc_hdr header;
 
 	memset(&header, 0, sizeof(struct fw_enc_hdr));
+	memset(tag, 0, TAG_SIZE);
 
 	if (strlen(key_string) != KEY_STRING_SIZE) {
 		ERROR("Unsupported key size: %lu\n", strlen(key_string));
@@ -57,17 +298,42 @@ static int gcm_encrypt(unsigned short fw_enc_status, char *key_string,
 		}
 	}
 
-	ip_file = fopen(ip_name, "rb");
-	if (ip_file == NULL) {
+	/* Per-image buffers: images may be encrypted by several threads */
+	in = malloc(sizeof(*in));
+	enc_data = malloc(BUFFER_SIZE);
+	if ((in == NULL) || (enc_data == NULL)) {
+		ERROR("Cannot allocate buffers\n");
+		goto out_mem;
+	}
+	memset(in, 0, sizeof(*in));
+
+	in->fd = open(ip_name, O_RDONLY);
+	if (in->fd < 0) {
 		ERROR("Cannot read %s\n", ip_name);
-		return -1;
+		goto out_mem;
+	}
+
+	if ((fstat(in->fd, &st) == 0) && S_ISREG(st.st_mode)) {
+		in->size = st.st_size;
+		if (in->size != 0U) {
+			void *map = mmap(NULL, in->size, PROT_READ,
+					 MAP_PRIVATE, in->fd, 0);
+
+			if (map != MAP_FAILED) {
+				in->map = map;
+			}
+		}
+	} else if (chunk_size != 0U) {
+		/* The chunk header holds the image size */
+		ERROR("%s must be a regular file to be encrypted by chunks\n",
+		      ip_name);
+		goto out_input;
 	}
 
 	op_file = fopen(op_name, "wb");
 	if (op_file == NULL) {
 		ERROR("Cannot write %s\n", op_name);
-		fclose(ip_file);
-		return -1;
+		goto out_input;
 	}
 
 	ret = fseek(op_file, sizeof(struct fw_enc_hdr), SEEK_SET);
@@ -83,47 +349,21 @@ static int gcm_encrypt(unsigned short fw_enc_status, char *key_string,
 		goto out_file;
 	}
 
-	ret = EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, NULL, NULL);
-	if (ret != 1) {
-		ERROR("EVP_EncryptInit_ex failed\n");
-		ret = -1;
-		goto out;
-	}
-
-	ret = EVP_EncryptInit_ex(ctx, NULL, NULL, key, iv);
-	if (ret != 1) {
-		ERROR("EVP_EncryptInit_ex failed\n");
-		goto out;
-	}
-
-	while ((bytes = fread(data, 1, BUFFER_SIZE, ip_file)) != 0) {
-		ret = EVP_EncryptUpdate(ctx, enc_data, &enc_len, data, bytes);
-		if (ret != 1) {
-			ERROR("EVP_EncryptUpdate failed\n");
-			ret = -1;
-			goto out;
-		}
-
-		fwrite(enc_data, 1, enc_len, op_file);
-	}
-
-	ret = EVP_EncryptFinal_ex(ctx, enc_data, &enc_len);
-	if (ret != 1) {
-		ERROR("EVP_EncryptFinal_ex failed\n");
-		ret = -1;
-		goto out;
+	if (chunk_size != 0U) {
+		ret = gcm_encrypt_chunks(ctx, in, op_file, key, iv, enc_data,
+					 chunk_size);
+	} else {
+		ret = gcm_encrypt_image(ctx, in, op_file, key, iv, enc_data,
+					tag);
 	}
-
-	ret = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, TAG_SIZE, tag);
-	if (ret != 1) {
-		ERROR("EVP_CIPHER_CTX_ctrl failed\n");
-		ret = -1;
+	if (ret != 0) {
 		goto out;
 	}
 
 	header.magic = ENC_HEADER_MAGIC;
 	header.flags |= fw_enc_status & FW_ENC_STATUS_FLAG_MASK;
-	header.dec_algo = KEY_ALG_GCM;
+	header.dec_algo = (chunk_size != 0U) ? ENC_DEC_ALGO_GCM_CHUNKED :
+					       KEY_ALG_GCM;
 	header.iv_len = IV_SIZE;
 	header.tag_len = TAG_SIZE;
 	memcpy(header.iv, iv, IV_SIZE);
@@ -135,32 +375,43 @@ static int gcm_encrypt(unsigned short fw_enc_status, char *key_string,
 		goto out;
 	}
 
-	fwrite(&header, 1, sizeof(struct fw_enc_hdr), op_file);
+	if (fwrite(&header, 1, sizeof(struct fw_enc_hdr), op_file) !=
+	    sizeof(struct fw_enc_hdr)) {
+		ERROR("fwrite failed\n");
+		ret = -1;
+	}
 
 out:
 	EVP_CIPHER_CTX_free(ctx);
 
 out_file:
-	fclose(ip_file);
-	fclose(op_file);
-
-	/*
-	 * EVP_* APIs returns 1 as success but enctool considers
-	 * 0 as success.
-	 */
-	if (ret == 1)
-		ret = 0;
+	if (fclose(op_file) != 0) {
+		ERROR("Cannot write %s\n", op_name);
+		ret = -1;
+	}
+
+out_input:
+	if (in->map != NULL) {
+		munmap((void *)in->map, in->size);
+	}
+	close(in->fd);
+
+out_mem:
+	free(enc_data);
+	free(in);
 
 	return ret;
 }
 
-int encrypt_file(unsigned short fw_enc_status, int enc_alg, char *key_string,
-		 char *nonce_string, const char *ip_name, const char *op_name)
+int encrypt_file(unsigned short fw_enc_status, int enc_alg,
+		 unsigned int chunk_size, const char *key_string,
+		 const char *nonce_string, const char *ip_name,
+		 const char *op_name)
 {
 	switch (enc_alg) {
 	case KEY_ALG_GCM:
-		return gcm_encrypt(fw_enc_status, key_string, nonce_string,
-				   ip_name, op_name);
+		return gcm_encrypt(fw_enc_status, chunk_size, key_string,
+				   nonce_string, ip_name, op_name);
 	default:
 		return -1;
 	}
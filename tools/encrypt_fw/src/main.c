@@ -8,9 +8,11 @@
 #include <assert.h>
 #include <ctype.h>
 #include <getopt.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdbool.h>
 
 #include <openssl/conf.h>
@@ -18,12 +20,26 @@
 #include "cmd_opt.h"
 #include "debug.h"
 #include "encrypt.h"
+#include "jobs.h"
 #include "firmware_encrypted.h"
 
 #define NUM_ELEM(x)			((sizeof(x)) / (sizeof(x[0])))
 #define HELP_OPT_MAX_LEN		128
+#define MAX_IMAGES			64
 
 /* Global options */
+static int key_alg;
+static char *key;
+static unsigned short fw_enc_status;
+static unsigned int chunk_size;
+static int jobs = 1;
+
+/* Images to encrypt, each one with its own nonce */
+static char *in_fn[MAX_IMAGES];
+static char *out_fn[MAX_IMAGES];
+static char *nonce[MAX_IMAGES];
+static int nr_in, nr_out, nr_nonce;
+static int result[MAX_IMAGES];
 
 /* Info messages created in the Makefile */
 extern const char build_msg[];
@@ -46,6 +62,9 @@ static void print_help(const char *cmd, const struct option *long_opt)
 	printf("The firmware encryption tool loads the binary image and\n"
 	       "outputs encrypted binary image using an encryption key\n"
 	       "provided as an input hex string.\n");
+	printf("Several images may be given by repeating the --in, --out\n"
+	       "and --nonce options, in the same order. Each image must use\n"
+	       "a different nonce.\n");
 	printf("\n");
 	printf("Usage:\n");
 	printf("\t%s [OPTIONS]\n\n", cmd);
@@ -98,6 +117,16 @@ static void parse_fw_enc_status_flag(const char *arg,
 	*fw_enc_status = flag & FW_ENC_STATUS_FLAG_MASK;
 }
 
+static void add_arg(char **args, int *nr, const char *opt, char *arg)
+{
+	if (*nr == MAX_IMAGES) {
+		ERROR("Too many '%s' options (max %d)\n", opt, MAX_IMAGES);
+		exit(1);
+	}
+
+	args[(*nr)++] = arg;
+}
+
 /* Common command line options */
 static const cmd_opt_t common_cmd_opt[] = {
 	{
@@ -128,18 +157,33 @@ static const cmd_opt_t common_cmd_opt[] = {
 		{ "out", required_argument, NULL, 'o' },
 		"Encrypted output filename."
 	},
+	{
+		{ "chunk-size", required_argument, NULL, 'c' },
+		"Encrypt by chunks of the given size in bytes, each one with "
+		"its own tag (default: 0, whole image with a single tag)"
+	},
+	{
+		{ "jobs", required_argument, NULL, 'j' },
+		"Number of images encrypted in parallel (default: 1)"
+	},
 };
 
+static void encrypt_image(int i)
+{
+	result[i] = encrypt_file(fw_enc_status, key_alg, chunk_size, key,
+				 nonce[i], in_fn[i], out_fn[i]);
+	if (result[i] != 0) {
+		ERROR("Cannot encrypt %s\n", in_fn[i]);
+	}
+}
+
 int main(int argc, char *argv[])
 {
-	int i, key_alg, ret;
+	int i, j, ret;
 	int c, opt_idx = 0;
 	const struct option *cmd_opt;
-	char *key = NULL;
-	char *nonce = NULL;
-	char *in_fn = NULL;
-	char *out_fn = NULL;
-	unsigned short fw_enc_status = 0;
+	unsigned long val;
+	char *endptr;
 
 	NOTICE("Firmware Encryption Tool: %s\n", build_msg);
 
@@ -156,7 +200,7 @@ int main(int argc, char *argv[])
 
 	while (1) {
 		/* getopt_long stores the option index here. */
-		c = getopt_long(argc, argv, "a:f:hi:k:n:o:", cmd_opt, &opt_idx);
+		c = getopt_long(argc, argv, "a:c:f:hi:j:k:n:o:", cmd_opt, &opt_idx);
 
 		/* Detect the end of the options. */
 		if (c == -1) {
@@ -171,6 +215,14 @@ int main(int argc, char *argv[])
 				exit(1);
 			}
 			break;
+		case 'c':
+			val = strtoul(optarg, &endptr, 0);
+			if ((*endptr != '\0') || (val > UINT_MAX)) {
+				ERROR("Invalid chunk size '%s'\n", optarg);
+				exit(1);
+			}
+			chunk_size = val;
+			break;
 		case 'f':
 			parse_fw_enc_status_flag(optarg, &fw_enc_status);
 			break;
@@ -178,13 +230,21 @@ int main(int argc, char *argv[])
 			key = optarg;
 			break;
 		case 'i':
-			in_fn = optarg;
+			add_arg(in_fn, &nr_in, "in", optarg);
+			break;
+		case 'j':
+			jobs = atoi(optarg);
+			if ((jobs < 1) || (jobs > MAX_JOBS)) {
+				ERROR("Invalid number of jobs '%s' (1 to %d)\n",
+				      optarg, MAX_JOBS);
+				exit(1);
+			}
 			break;
 		case 'o':
-			out_fn = optarg;
+			add_arg(out_fn, &nr_out, "out", optarg);
 			break;
 		case 'n':
-			nonce = optarg;
+			add_arg(nonce, &nr_nonce, "nonce", optarg);
 			break;
 		case 'h':
 			print_help(argv[0], cmd_opt);
@@ -201,22 +261,45 @@ int main(int argc, char *argv[])
 		exit(1);
 	}
 
-	if (!nonce) {
+	if (nr_nonce == 0) {
 		ERROR("Nonce must not be NULL\n");
 		exit(1);
 	}
 
-	if (!in_fn) {
+	if (nr_in == 0) {
 		ERROR("Input filename must not be NULL\n");
 		exit(1);
 	}
 
-	if (!out_fn) {
+	if (nr_out == 0) {
 		ERROR("Output filename must not be NULL\n");
 		exit(1);
 	}
 
-	ret = encrypt_file(fw_enc_status, key_alg, key, nonce, in_fn, out_fn);
+	if ((nr_out != nr_in) || (nr_nonce != nr_in)) {
+		ERROR("Each input file needs an output file and a nonce\n");
+		exit(1);
+	}
+
+	/* Reusing a nonce with the same key breaks AES-GCM */
+	for (i = 0; i < nr_nonce; i++) {
+		for (j = i + 1; j < nr_nonce; j++) {
+			if (strcasecmp(nonce[i], nonce[j]) == 0) {
+				ERROR("%s and %s use the same nonce\n",
+				      in_fn[i], in_fn[j]);
+				exit(1);
+			}
+		}
+	}
+
+	run_jobs(encrypt_image, NULL, nr_in, jobs);
+
+	ret = 0;
+	for (i = 0; i < nr_in; i++) {
+		if (result[i] != 0) {
+			ret = result[i];
+		}
+	}
 
 	CRYPTO_cleanup_all_ex_data();
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2024, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -17,12 +17,16 @@
 #include <string.h>
 
 #include "fiptool.h"
+#include "jobs.h"
 #include "tbbr_config.h"
 
 #define OPT_TOC_ENTRY 0
 #define OPT_PLAT_TOC_FLAGS 1
 #define OPT_ALIGN 2
 
+/* Upper limit of threads used to hash the images. */
+#define MAX_HASH_THREADS 16
+
 static int info_cmd(int argc, char *argv[]);
 static void info_usage(int);
 static int create_cmd(int argc, char *argv[]);
@@ -54,6 +58,16 @@ static size_t nr_image_descs;
 static const uuid_t uuid_null;
 static int verbose;
 
+/* Contents of the FIP parsed by parse_fip(), shared by its images. */
+static char *fip_buf;
+static size_t fip_buf_size;
+static int fip_buf_type = IMAGE_BUF_NONE;
+static size_t fip_nr_images;
+#ifndef _MSC_VER
+static dev_t fip_dev;
+static ino_t fip_ino;
+#endif
+
 static void vlog(int prio, const char *msg, va_list ap)
 {
 	char *prefix[] = { "DEBUG", "WARN", "ERROR" };
@@ -128,12 +142,126 @@ static void *xzalloc(size_t size, const char *msg)
 	return memset(xmalloc(size, msg), 0, size);
 }
 
-static void xfwrite(void *buf, size_t size, FILE *fp, const char *filename)
+static void xfwrite(const void *buf, size_t size, FILE *fp,
+    const char *filename)
 {
 	if (fwrite(buf, 1, size, fp) != size)
 		log_errx("Failed to write %s", filename);
 }
 
+static void write_padding(FILE *fp, uint64_t size, const char *filename)
+{
+	static const char zeros[4096];
+
+	while (size > 0) {
+		size_t len = size < sizeof(zeros) ? size : sizeof(zeros);
+
+		xfwrite(zeros, len, fp, filename);
+		size -= len;
+	}
+}
+
+/*
+ * Return the contents of a file. The file is mapped when the platform
+ * supports it, otherwise it is read into a heap buffer.
+ */
+static void *load_file(const char *filename, size_t *size, int *buffer_type,
+    struct BLD_PLAT_STAT *st_out)
+{
+	struct BLD_PLAT_STAT st;
+	FILE *fp;
+	void *buf;
+
+	fp = fopen(filename, "rb");
+	if (fp == NULL)
+		log_err("fopen %s", filename);
+
+	if (fstat(fileno(fp), &st) == -1)
+		log_err("fstat %s", filename);
+
+	*size = st.st_size;
+	if (st_out != NULL)
+		*st_out = st;
+
+#ifndef _MSC_VER
+	if (st.st_size != 0) {
+		buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+		    fileno(fp), 0);
+		if (buf != MAP_FAILED) {
+			fclose(fp);
+			*buffer_type = IMAGE_BUF_MMAP;
+			return buf;
+		}
+	}
+#endif
+
+	buf = xmalloc(st.st_size, "failed to load file into memory");
+	if (fread(buf, 1, st.st_size, fp) != st.st_size)
+		log_errx("Failed to read %s", filename);
+	fclose(fp);
+	*buffer_type = IMAGE_BUF_MALLOC;
+	return buf;
+}
+
+static void unload_buffer(void *buf, size_t size, int buffer_type)
+{
+	if (buffer_type == IMAGE_BUF_MALLOC)
+		free(buf);
+#ifndef _MSC_VER
+	else if (buffer_type == IMAGE_BUF_MMAP)
+		munmap(buf, size);
+#endif
+}
+
+/*
+ * Make the contents of an image available in its buffer. Return 1 if it had
+ * to be loaded, in which case it should be released with image_unload().
+ */
+static int image_load(image_t *image)
+{
+	size_t size;
+
+	if (image->buffer_type != IMAGE_BUF_NONE)
+		return 0;
+
+	assert(image->filename != NULL);
+	image->buffer = load_file(image->filename, &size,
+	    &image->buffer_type, NULL);
+	if (size != image->toc_e.size)
+		log_errx("%s changed size while packing", image->filename);
+	return 1;
+}
+
+static void image_unload(image_t *image)
+{
+	unload_buffer(image->buffer, image->toc_e.size, image->buffer_type);
+	image->buffer = NULL;
+	image->buffer_type = IMAGE_BUF_NONE;
+}
+
+/* Give an image its own copy of its contents found in the parsed FIP. */
+static void image_detach_from_fip(image_t *image)
+{
+	void *buf;
+
+	if (image->buffer_type != IMAGE_BUF_FIP)
+		return;
+
+	buf = xmalloc(image->toc_e.size, "failed to allocate image buffer");
+	memcpy(buf, image->buffer, image->toc_e.size);
+	image->buffer = buf;
+	image->buffer_type = IMAGE_BUF_MALLOC;
+}
+
+static void free_image(image_t *image)
+{
+	if (image->buffer_type != IMAGE_BUF_FIP)
+		unload_buffer(image->buffer, image->toc_e.size,
+		    image->buffer_type);
+	free(image->filename);
+	free(image);
+}
+
 static image_desc_t *new_image_desc(const uuid_t *uuid,
     const char *name, const char *cmdline_name)
 {
@@ -169,10 +297,8 @@ static void free_image_desc(image_desc_t *desc)
 	free(desc->name);
 	free(desc->cmdline_name);
 	free(desc->action_arg);
-	if (desc->image) {
-		free(desc->image->buffer);
-		free(desc->image);
-	}
+	if (desc->image)
+		free_image(desc->image);
 	free(desc);
 }
 
@@ -199,6 +325,10 @@ static void free_image_descs(void)
 		nr_image_descs--;
 	}
 	assert(nr_image_descs == 0);
+
+	unload_buffer(fip_buf, fip_buf_size, fip_buf_type);
+	fip_buf = NULL;
+	fip_buf_type = IMAGE_BUF_NONE;
 }
 
 static void fill_image_descs(void)
@@ -293,24 +423,20 @@ static void uuid_from_str(uuid_t *u, const char *s)
 static int parse_fip(const char *filename, fip_toc_header_t *toc_header_out)
 {
 	struct BLD_PLAT_STAT st;
-	FILE *fp;
 	char *buf, *bufend;
 	fip_toc_header_t *toc_header;
 	fip_toc_entry_t *toc_entry;
 	int terminated = 0;
 
-	fp = fopen(filename, "rb");
-	if (fp == NULL)
-		log_err("fopen %s", filename);
-
-	if (fstat(fileno(fp), &st) == -1)
-		log_err("fstat %s", filename);
-
-	buf = xmalloc(st.st_size, "failed to load file into memory");
-	if (fread(buf, 1, st.st_size, fp) != st.st_size)
-		log_errx("Failed to read %s", filename);
+	/* The images keep pointing into the file contents, no copy is made. */
+	assert(fip_buf == NULL);
+	buf = load_file(filename, &fip_buf_size, &fip_buf_type, &st);
 	bufend = buf + st.st_size;
-	fclose(fp);
+	fip_buf = buf;
+#ifndef _MSC_VER
+	fip_dev = st.st_dev;
+	fip_ino = st.st_ino;
+#endif
 
 	if (st.st_size < sizeof(fip_toc_header_t))
 		log_errx("FIP %s is truncated", filename);
@@ -343,16 +469,15 @@ static int parse_fip(const char *filename, fip_toc_header_t *toc_header_out)
 		image = xzalloc(sizeof(*image),
 		    "failed to allocate memory for image");
 		image->toc_e = *toc_entry;
-		image->buffer = xmalloc(toc_entry->size,
-		    "failed to allocate image buffer, is FIP file corrupted?");
-		/* Overflow checks before memory copy. */
+		/* Overflow checks before referencing the image contents. */
 		if (toc_entry->size > (uint64_t)-1 - toc_entry->offset_address)
 			log_errx("FIP %s is corrupted", filename);
 		if (toc_entry->size + toc_entry->offset_address > st.st_size)
 			log_errx("FIP %s is corrupted", filename);
 
-		memcpy(image->buffer, buf + toc_entry->offset_address,
-		    toc_entry->size);
+		image->buffer = buf + toc_entry->offset_address;
+		image->buffer_type = IMAGE_BUF_FIP;
+		fip_nr_images++;
 
 		/* If this is an unknown image, create a descriptor for it. */
 		desc = lookup_image_desc_from_uuid(&toc_entry->uuid);
@@ -378,34 +503,30 @@ static int parse_fip(const char *filename, fip_toc_header_t *toc_header_out)
 	if (terminated == 0)
 		log_errx("FIP %s does not have a ToC terminator entry",
 		    filename);
-	free(buf);
 	return 0;
 }
 
-static image_t *read_image_from_file(const uuid_t *uuid, const char *filename)
+/*
+ * Create an image for the given file. Only its size is read here, its
+ * contents are streamed to the FIP when it is written.
+ */
+static image_t *image_from_file(const uuid_t *uuid, const char *filename)
 {
 	struct BLD_PLAT_STAT st;
 	image_t *image;
-	FILE *fp;
 
 	assert(uuid != NULL);
 	assert(filename != NULL);
 
-	fp = fopen(filename, "rb");
-	if (fp == NULL)
-		log_err("fopen %s", filename);
-
-	if (fstat(fileno(fp), &st) == -1)
-		log_errx("fstat %s", filename);
+	if (BLD_PLAT_STAT(filename, &st) == -1)
+		log_err("stat %s", filename);
 
 	image = xzalloc(sizeof(*image), "failed to allocate memory for image");
 	image->toc_e.uuid = *uuid;
-	image->buffer = xmalloc(st.st_size, "failed to allocate image buffer");
-	if (fread(image->buffer, 1, st.st_size, fp) != st.st_size)
-		log_errx("Failed to read %s", filename);
 	image->toc_e.size = st.st_size;
-
-	fclose(fp);
+	image->buffer_type = IMAGE_BUF_NONE;
+	image->filename = xstrdup(filename,
+	    "failed to allocate memory for image filename");
 	return image;
 }
 
@@ -454,10 +575,43 @@ static void md_print(const unsigned char *md, size_t len)
 		printf("%02x", md[i]);
 }
 
+#ifndef _MSC_VER	/* We don't have SHA256 for Visual Studio. */
+/* Images hashed by hash_images(), and their digests. */
+static image_t **hash_job_images;
+static unsigned char (*hash_job_md)[SHA256_DIGEST_LENGTH];
+
+static void hash_image(int idx)
+{
+	SHA256(hash_job_images[idx]->buffer, hash_job_images[idx]->toc_e.size,
+	    hash_job_md[idx]);
+}
+
+/* Compute the SHA-256 digest of each image, using one thread per CPU. */
+static void hash_images(image_t **images, size_t nr_images,
+    unsigned char (*md)[SHA256_DIGEST_LENGTH])
+{
+	long nr_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int nr_jobs;
+
+	nr_jobs = nr_cpus > 1 ? (int)nr_cpus : 1;
+	if (nr_jobs > MAX_HASH_THREADS)
+		nr_jobs = MAX_HASH_THREADS;
+
+	hash_job_images = images;
+	hash_job_md = md;
+	run_jobs(hash_image, NULL, (int)nr_images, nr_jobs);
+}
+#endif
+
 static int info_cmd(int argc, char *argv[])
 {
 	image_desc_t *desc;
 	fip_toc_header_t toc_header;
+#ifndef _MSC_VER
+	unsigned char (*md)[SHA256_DIGEST_LENGTH] = NULL;
+	image_t **images = NULL;
+	size_t nr_images = 0;
+#endif
 
 	if (argc != 2)
 		info_usage(EXIT_FAILURE);
@@ -474,6 +628,20 @@ static int info_cmd(int argc, char *argv[])
 		    (unsigned long long)toc_header.flags);
 	}
 
+#ifndef _MSC_VER	/* We don't have SHA256 for Visual Studio. */
+	if (verbose && fip_nr_images != 0) {
+		images = xmalloc(fip_nr_images * sizeof(*images),
+		    "failed to allocate memory for image list");
+		md = xmalloc(fip_nr_images * sizeof(*md),
+		    "failed to allocate memory for image digests");
+		for (desc = image_desc_head; desc != NULL; desc = desc->next)
+			if (desc->image != NULL)
+				images[nr_images++] = desc->image;
+		hash_images(images, nr_images, md);
+		nr_images = 0;
+	}
+#endif
+
 	for (desc = image_desc_head; desc != NULL; desc = desc->next) {
 		image_t *image = desc->image;
 
@@ -486,16 +654,17 @@ static int info_cmd(int argc, char *argv[])
 		       desc->cmdline_name);
 #ifndef _MSC_VER	/* We don't have SHA256 for Visual Studio. */
 		if (verbose) {
-			unsigned char md[SHA256_DIGEST_LENGTH];
-
-			SHA256(image->buffer, image->toc_e.size, md);
 			printf(", sha256=");
-			md_print(md, sizeof(md));
+			md_print(md[nr_images++], SHA256_DIGEST_LENGTH);
 		}
 #endif
 		putchar('\n');
 	}
 
+#ifndef _MSC_VER
+	free(images);
+	free(md);
+#endif
 	return 0;
 }
 
@@ -505,14 +674,19 @@ static void info_usage(int exit_status)
 	exit(exit_status);
 }
 
-static int pack_images(const char *filename, uint64_t toc_flags, unsigned long align)
+/*
+ * Build the header and ToC entries of the FIP from the image table and
+ * assign its offset to each image. The ToC size and the total FIP size are
+ * returned through 'toc_size' and 'fip_size'.
+ */
+static char *build_toc(uint64_t toc_flags, unsigned long align,
+    uint64_t *toc_size, uint64_t *fip_size)
 {
-	FILE *fp;
 	image_desc_t *desc;
 	fip_toc_header_t *toc_header;
 	fip_toc_entry_t *toc_entry;
 	char *buf;
-	uint64_t entry_offset, buf_size, payload_size = 0, pad_size;
+	uint64_t entry_offset, buf_size, payload_size = 0;
 	size_t nr_images = 0;
 
 	for (desc = image_desc_head; desc != NULL; desc = desc->next)
@@ -554,41 +728,194 @@ static int pack_images(const char *filename, uint64_t toc_flags, unsigned long a
 	memset(toc_entry, 0, sizeof(*toc_entry));
 	toc_entry->offset_address = (entry_offset + align - 1) & ~(align - 1);
 
-	/* Generate the FIP file. */
+	if (verbose) {
+		log_dbgx("Metadata size: %zu bytes", buf_size);
+		log_dbgx("Payload size: %zu bytes", payload_size);
+	}
+
+	*toc_size = buf_size;
+	*fip_size = toc_entry->offset_address;
+	return buf;
+}
+
+/*
+ * Stream the images placed at or after 'offset' to the FIP, with the padding
+ * between them, up to the end of the FIP at 'fip_size'. Images read from
+ * files are only loaded while they are written.
+ */
+static void write_payload(FILE *fp, const char *filename, uint64_t offset,
+    uint64_t fip_size)
+{
+	image_desc_t *desc;
+
+	for (desc = image_desc_head; desc != NULL; desc = desc->next) {
+		image_t *image = desc->image;
+		int loaded;
+
+		if (image == NULL || (image->toc_e.size == 0ULL) ||
+		    (image->toc_e.offset_address < offset))
+			continue;
+
+		write_padding(fp, image->toc_e.offset_address - offset,
+		    filename);
+
+		loaded = image_load(image);
+		xfwrite(image->buffer, image->toc_e.size, fp, filename);
+		if (loaded)
+			image_unload(image);
+
+		offset = image->toc_e.offset_address + image->toc_e.size;
+	}
+
+	write_padding(fp, fip_size - offset, filename);
+}
+
+/*
+ * Open the FIP file to write. If it is the FIP that was parsed, whose
+ * contents are still referenced by the images, write to a temporary file
+ * that replaces it once complete.
+ */
+static FILE *open_fip_output(const char *filename, char **tmp_filename)
+{
+	FILE *fp;
+#ifndef _MSC_VER
+	struct stat st;
+
+	if ((fip_buf_type == IMAGE_BUF_MMAP) &&
+	    (stat(filename, &st) == 0) &&
+	    (st.st_dev == fip_dev) && (st.st_ino == fip_ino)) {
+		size_t len = strlen(filename) + sizeof(".XXXXXX");
+		char *tmp;
+		int fd;
+
+		tmp = xmalloc(len, "failed to allocate memory for filename");
+		snprintf(tmp, len, "%s.XXXXXX", filename);
+		fd = mkstemp(tmp);
+		if (fd == -1)
+			log_err("mkstemp %s", tmp);
+		if (fchmod(fd, st.st_mode & 07777) == -1)
+			log_err("fchmod %s", tmp);
+		fp = fdopen(fd, "wb");
+		if (fp == NULL)
+			log_err("fdopen %s", tmp);
+
+		*tmp_filename = tmp;
+		return fp;
+	}
+#endif
+
+	*tmp_filename = NULL;
 	fp = fopen(filename, "wb");
 	if (fp == NULL)
 		log_err("fopen %s", filename);
+	return fp;
+}
 
-	if (verbose)
-		log_dbgx("Metadata size: %zu bytes", buf_size);
+static void close_fip_output(FILE *fp, const char *filename,
+    char *tmp_filename)
+{
+	if (fclose(fp) != 0)
+		log_err("Failed to write %s", filename);
 
-	xfwrite(buf, buf_size, fp, filename);
+	if (tmp_filename != NULL) {
+		if (rename(tmp_filename, filename) == -1)
+			log_err("rename %s", tmp_filename);
+		free(tmp_filename);
+	}
+}
 
-	if (verbose)
-		log_dbgx("Payload size: %zu bytes", payload_size);
+static int pack_images(const char *filename, uint64_t toc_flags, unsigned long align)
+{
+	FILE *fp;
+	char *buf, *tmp_filename;
+	uint64_t toc_size, fip_size;
+
+	buf = build_toc(toc_flags, align, &toc_size, &fip_size);
 
+	/* Generate the FIP file. */
+	fp = open_fip_output(filename, &tmp_filename);
+
+	xfwrite(buf, toc_size, fp, filename);
+	write_payload(fp, filename, toc_size, fip_size);
+
+	free(buf);
+	close_fip_output(fp, filename, tmp_filename);
+	return 0;
+}
+
+#ifndef _MSC_VER
+/*
+ * Update the parsed FIP file in place. The images that keep their offset
+ * before the first modified one are left untouched, only the ToC and the
+ * payload from that image on are rewritten. Return -1 if the ToC size
+ * changes, in which case the whole file must be packed again.
+ */
+static int update_fip_in_place(const char *filename, uint64_t toc_flags,
+    unsigned long align)
+{
+	image_desc_t *desc;
+	FILE *fp;
+	char *buf;
+	uint64_t toc_size, fip_size, tail_offset;
+	int tail = 0;
+
+	buf = build_toc(toc_flags, align, &toc_size, &fip_size);
+
+	if (toc_size != sizeof(fip_toc_header_t) +
+	    sizeof(fip_toc_entry_t) * (fip_nr_images + 1)) {
+		free(buf);
+		return -1;
+	}
+
+	/*
+	 * Find where the payload starts to differ. The FIP images placed after
+	 * that point may be overwritten before they are written back to their
+	 * new offset, so they need their own copy.
+	 */
+	tail_offset = toc_size;
 	for (desc = image_desc_head; desc != NULL; desc = desc->next) {
 		image_t *image = desc->image;
 
-		if (image == NULL)
+		if (image == NULL || (image->toc_e.size == 0ULL))
 			continue;
-		if (fseek(fp, image->toc_e.offset_address, SEEK_SET))
-			log_errx("Failed to set file position");
 
-		xfwrite(image->buffer, image->toc_e.size, fp, filename);
+		if (!tail && (image->buffer_type == IMAGE_BUF_FIP) &&
+		    ((char *)image->buffer - fip_buf ==
+		     image->toc_e.offset_address)) {
+			tail_offset = image->toc_e.offset_address +
+			    image->toc_e.size;
+			continue;
+		}
+
+		tail = 1;
+		image_detach_from_fip(image);
 	}
 
-	if (fseek(fp, entry_offset, SEEK_SET))
+	fp = fopen(filename, "r+b");
+	if (fp == NULL)
+		log_err("fopen %s", filename);
+
+	xfwrite(buf, toc_size, fp, filename);
+	if (fseek(fp, tail_offset, SEEK_SET))
 		log_errx("Failed to set file position");
+	write_payload(fp, filename, tail_offset, fip_size);
 
-	pad_size = toc_entry->offset_address - entry_offset;
-	while (pad_size--)
-		fputc(0x0, fp);
+	if (fflush(fp) != 0)
+		log_err("Failed to write %s", filename);
+	if (ftruncate(fileno(fp), fip_size) == -1)
+		log_err("ftruncate %s", filename);
+	if (fclose(fp) != 0)
+		log_err("Failed to write %s", filename);
+
+	if (verbose)
+		log_dbgx("Rewrote %llu of %llu bytes in place",
+		    (unsigned long long)(toc_size + fip_size - tail_offset),
+		    (unsigned long long)fip_size);
 
 	free(buf);
-	fclose(fp);
 	return 0;
 }
+#endif
 
 /*
  * This function is shared between the create and update subcommands.
@@ -608,15 +935,14 @@ static void update_fip(void)
 		if (desc->action != DO_PACK)
 			continue;
 
-		image = read_image_from_file(&desc->uuid,
-		    desc->action_arg);
+		image = image_from_file(&desc->uuid, desc->action_arg);
 		if (desc->image != NULL) {
 			if (verbose) {
 				log_dbgx("Replacing %s with %s",
 				    desc->cmdline_name,
 				    desc->action_arg);
 			}
-			free(desc->image);
+			free_image(desc->image);
 			desc->image = image;
 		} else {
 			if (verbose)
@@ -865,6 +1191,13 @@ static int update_cmd(int argc, char *argv[])
 
 	update_fip();
 
+#ifndef _MSC_VER
+	/* Only rewrite what changed when updating the FIP file itself. */
+	if ((fip_buf != NULL) && (strcmp(outfile, argv[0]) == 0) &&
+	    (update_fip_in_place(outfile, toc_flags, align) == 0))
+		return 0;
+#endif
+
 	pack_images(outfile, toc_flags, align);
 	return 0;
 }
@@ -1128,7 +1461,7 @@ static int remove_cmd(int argc, char *argv[])
 			if (verbose)
 				log_dbgx("Removing %s",
 				    desc->cmdline_name);
-			free(desc->image);
+			free_image(desc->image);
 			desc->image = NULL;
 		} else {
 			log_warnx("%s does not exist in %s",
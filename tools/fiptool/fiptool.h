@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2024, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -40,9 +40,18 @@ typedef struct image_desc {
 	struct image_desc *next;
 } image_desc_t;
 
+enum {
+	IMAGE_BUF_NONE,		/* Not loaded, read from filename when needed */
+	IMAGE_BUF_MALLOC,
+	IMAGE_BUF_MMAP,
+	IMAGE_BUF_FIP		/* Points into the parsed FIP file */
+};
+
 typedef struct image {
 	struct fip_toc_entry toc_e;
 	void                *buffer;
+	int                  buffer_type;
+	char                *filename;
 } image_t;
 
 typedef struct cmd {
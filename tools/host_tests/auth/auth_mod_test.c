@@ -0,0 +1,568 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the authentication module, built with AUTH_STATS and with or
+ * without AUTH_KEY_CACHE. A TBBR-like CoT with a ROTPK hash is authenticated
+ * twice, as for a boot followed by the check of another FWU bank, with an
+ * image parser and a crypto module that only count their calls. The counts
+ * printed by the module must match them, and with the key cache the ROT key
+ * must only be checked against the ROTPK hash once.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <common/debug.h>
+#include <common/tbbr/tbbr_img_def.h>
+#include <drivers/auth/auth_mod.h>
+#include <drivers/auth/crypto_mod.h>
+#include <drivers/auth/img_parser_mod.h>
+#include <plat/common/platform.h>
+
+#define KEY_SIZE		64U
+#define DIGEST_SIZE		32U
+#define IMAGE_SIZE		4096U
+#define NR_BOOTS		2U
+
+/* Certificate format understood by the test image parser */
+typedef struct test_cert {
+	uint8_t signer_pk[KEY_SIZE];
+	uint8_t nv_ctr[4];
+	uint8_t keys[2][KEY_SIZE];
+	uint8_t hash[DIGEST_SIZE];
+	uint8_t sig_alg[4];
+	/* Not part of the signed data */
+	uint8_t sig[DIGEST_SIZE];
+} test_cert_t;
+
+#define SIGNED_SIZE		offsetof(test_cert_t, sig)
+
+/* Public keys: 0 is the signer, 1 and 2 are the keys the certificate holds */
+static auth_param_type_desc_t signer_pk = AUTH_PARAM_TYPE_DESC(
+	AUTH_PARAM_PUB_KEY, 0);
+static auth_param_type_desc_t key1_pk = AUTH_PARAM_TYPE_DESC(
+	AUTH_PARAM_PUB_KEY, 1);
+static auth_param_type_desc_t key2_pk = AUTH_PARAM_TYPE_DESC(
+	AUTH_PARAM_PUB_KEY, 2);
+static auth_param_type_desc_t sig = AUTH_PARAM_TYPE_DESC(
+	AUTH_PARAM_SIG, 0);
+static auth_param_type_desc_t sig_alg = AUTH_PARAM_TYPE_DESC(
+	AUTH_PARAM_SIG_ALG, 0);
+static auth_param_type_desc_t raw_data = AUTH_PARAM_TYPE_DESC(
+	AUTH_PARAM_RAW_DATA, 0);
+static auth_param_type_desc_t img_hash = AUTH_PARAM_TYPE_DESC(
+	AUTH_PARAM_HASH, 0);
+static auth_param_type_desc_t nv_ctr = AUTH_PARAM_TYPE_DESC(
+	AUTH_PARAM_NV_CTR, 0);
+
+/* Certificate signed by a key of its parent, or by the ROT key if none */
+#define CERT_DESC(_name, _id, _parent, _pk, _data)			\
+	static const auth_img_desc_t _name = {				\
+		.img_id = _id,						\
+		.img_type = IMG_CERT,					\
+		.parent = _parent,					\
+		.img_auth_methods =					\
+		(const auth_method_desc_t[AUTH_METHOD_NUM]) {		\
+			[0] = {						\
+				.type = AUTH_METHOD_SIG,		\
+				.param.sig = {				\
+					.pk = _pk,			\
+					.sig = &sig,			\
+					.alg = &sig_alg,		\
+					.data = &raw_data		\
+				}					\
+			},						\
+			[1] = {						\
+				.type = AUTH_METHOD_NV_CTR,		\
+				.param.nv_ctr = {			\
+					.cert_nv_ctr = &nv_ctr,		\
+					.plat_nv_ctr = &nv_ctr		\
+				}					\
+			}						\
+		},							\
+		.authenticated_data = _data,				\
+	}
+
+/* Certificate holding the two given keys */
+#define KEY_CERT_DESC(_name, _id, _parent, _pk)				\
+	static uint8_t _name##_key1[KEY_SIZE];				\
+	static uint8_t _name##_key2[KEY_SIZE];				\
+	CERT_DESC(_name, _id, _parent, _pk,				\
+		  ((const auth_param_desc_t[COT_MAX_VERIFIED_PARAMS]) {	\
+			[0] = {						\
+				.type_desc = &key1_pk,			\
+				.data = AUTH_PARAM_DATA_DESC(_name##_key1, \
+							     KEY_SIZE),	\
+			},						\
+			[1] = {						\
+				.type_desc = &key2_pk,			\
+				.data = AUTH_PARAM_DATA_DESC(_name##_key2, \
+							     KEY_SIZE),	\
+			},						\
+		}))
+
+/* Certificate holding the hash of an image */
+#define CONTENT_CERT_DESC(_name, _id, _parent, _pk)			\
+	static uint8_t _name##_hash[DIGEST_SIZE];			\
+	CERT_DESC(_name, _id, _parent, _pk,				\
+		  ((const auth_param_desc_t[COT_MAX_VERIFIED_PARAMS]) {	\
+			[0] = {						\
+				.type_desc = &img_hash,			\
+				.data = AUTH_PARAM_DATA_DESC(_name##_hash, \
+							     DIGEST_SIZE), \
+			},						\
+		}))
+
+#define IMAGE_DESC(_name, _id, _parent)					\
+	static const auth_img_desc_t _name = {				\
+		.img_id = _id,						\
+		.img_type = IMG_RAW,					\
+		.parent = _parent,					\
+		.img_auth_methods =					\
+		(const auth_method_desc_t[AUTH_METHOD_NUM]) {		\
+			[0] = {						\
+				.type = AUTH_METHOD_HASH,		\
+				.param.hash = {				\
+					.data = &raw_data,		\
+					.hash = &img_hash		\
+				}					\
+			}						\
+		}							\
+	}
+
+/* TBBR BL2 CoT, with the FW_CONFIG of the BL2 certificate */
+CONTENT_CERT_DESC(trusted_boot_fw_cert, TRUSTED_BOOT_FW_CERT_ID, NULL,
+		  &signer_pk);
+IMAGE_DESC(fw_config, FW_CONFIG_ID, &trusted_boot_fw_cert);
+KEY_CERT_DESC(trusted_key_cert, TRUSTED_KEY_CERT_ID, NULL, &signer_pk);
+KEY_CERT_DESC(soc_fw_key_cert, SOC_FW_KEY_CERT_ID, &trusted_key_cert,
+	      &key1_pk);
+CONTENT_CERT_DESC(soc_fw_content_cert, SOC_FW_CONTENT_CERT_ID,
+		  &soc_fw_key_cert, &key1_pk);
+IMAGE_DESC(bl31_image, BL31_IMAGE_ID, &soc_fw_content_cert);
+KEY_CERT_DESC(nt_fw_key_cert, NON_TRUSTED_FW_KEY_CERT_ID, &trusted_key_cert,
+	      &key2_pk);
+CONTENT_CERT_DESC(nt_fw_content_cert, NON_TRUSTED_FW_CONTENT_CERT_ID,
+		  &nt_fw_key_cert, &key1_pk);
+IMAGE_DESC(bl33_image, BL33_IMAGE_ID, &nt_fw_content_cert);
+
+static const auth_img_desc_t *const cot_desc[] = {
+	[TRUSTED_BOOT_FW_CERT_ID] = &trusted_boot_fw_cert,
+	[FW_CONFIG_ID] = &fw_config,
+	[TRUSTED_KEY_CERT_ID] = &trusted_key_cert,
+	[SOC_FW_KEY_CERT_ID] = &soc_fw_key_cert,
+	[SOC_FW_CONTENT_CERT_ID] = &soc_fw_content_cert,
+	[BL31_IMAGE_ID] = &bl31_image,
+	[NON_TRUSTED_FW_KEY_CERT_ID] = &nt_fw_key_cert,
+	[NON_TRUSTED_FW_CONTENT_CERT_ID] = &nt_fw_content_cert,
+	[BL33_IMAGE_ID] = &bl33_image,
+};
+
+REGISTER_COT(cot_desc);
+
+/* Images in their load order: each certificate comes before its children */
+static const unsigned int load_order[] = {
+	TRUSTED_BOOT_FW_CERT_ID,
+	FW_CONFIG_ID,
+	TRUSTED_KEY_CERT_ID,
+	SOC_FW_KEY_CERT_ID,
+	SOC_FW_CONTENT_CERT_ID,
+	BL31_IMAGE_ID,
+	NON_TRUSTED_FW_KEY_CERT_ID,
+	NON_TRUSTED_FW_CONTENT_CERT_ID,
+	BL33_IMAGE_ID,
+};
+
+#define NR_IMAGES		ARRAY_SIZE(load_order)
+#define NR_CERTS		6U
+#define NR_ROT_CERTS		2U
+
+static struct {
+	void *ptr;
+	unsigned int len;
+} images[MAX_NUMBER_IDS];
+
+static test_cert_t certs[NR_CERTS];
+static uint8_t raw_images[NR_IMAGES - NR_CERTS][IMAGE_SIZE];
+static uint8_t rot_pk[KEY_SIZE];
+static uint8_t rotpk_hash[DIGEST_SIZE];
+
+/* Calls to the image parser and to the crypto module */
+static struct {
+	unsigned int parsed;
+	unsigned int sig_verified;
+	unsigned int hash_verified;
+	unsigned int rotpk_hash_verified;
+} calls;
+
+/* Counts printed by the authentication module */
+static struct {
+	unsigned int parsed;
+	unsigned int sig_verified;
+	unsigned int hash_verified;
+	unsigned int key_cache_hits;
+} stats;
+
+static uint32_t seed = 1U;
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	fmt++;
+	if (strncmp(fmt, "AUTH: ", 6U) == 0) {
+		stats.parsed = va_arg(args, unsigned int);
+		stats.sig_verified = va_arg(args, unsigned int);
+		stats.hash_verified = va_arg(args, unsigned int);
+		stats.key_cache_hits = va_arg(args, unsigned int);
+	} else {
+		(void)vprintf(fmt, args);
+	}
+	va_end(args);
+}
+
+void __dead2 do_panic(void)
+{
+	printf("PANIC\n");
+	exit(1);
+	__builtin_unreachable();
+}
+
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+
+static uint32_t random_u32(void)
+{
+	/* Numerical Recipes LCG, the upper bits are good enough here */
+	seed = (seed * 1664525U) + 1013904223U;
+
+	return seed >> 8;
+}
+
+static void fill_random(uint8_t *buf, size_t len)
+{
+	size_t i;
+
+	for (i = 0U; i < len; i++) {
+		buf[i] = (uint8_t)random_u32();
+	}
+}
+
+/* Not a hash function, but any change of the data changes the digest */
+static void digest(const void *data, size_t len, uint8_t *md)
+{
+	const uint8_t *p = data;
+	uint64_t h[DIGEST_SIZE / sizeof(uint64_t)];
+	size_t i, j;
+
+	for (j = 0U; j < ARRAY_SIZE(h); j++) {
+		h[j] = 0xcbf29ce484222325ULL + j;
+	}
+
+	for (i = 0U; i < len; i++) {
+		for (j = 0U; j < ARRAY_SIZE(h); j++) {
+			h[j] = (h[j] ^ p[i]) * 0x100000001b3ULL;
+		}
+	}
+
+	memcpy(md, h, DIGEST_SIZE);
+}
+
+/* The signature is the digest of the signed data mixed with the key */
+static void sign(const void *data, size_t len, const uint8_t *pk, uint8_t *s)
+{
+	unsigned int i;
+
+	digest(data, len, s);
+	for (i = 0U; i < DIGEST_SIZE; i++) {
+		s[i] ^= pk[i] ^ pk[i + DIGEST_SIZE];
+	}
+}
+
+void img_parser_init(void)
+{
+}
+
+int img_parser_check_integrity(img_type_t img_type, void *img_ptr,
+			       unsigned int img_len)
+{
+	calls.parsed++;
+
+	if ((img_type == IMG_CERT) && (img_len != sizeof(test_cert_t))) {
+		return 1;
+	}
+
+	return 0;
+}
+
+int img_parser_get_auth_param(img_type_t img_type,
+			      const auth_param_type_desc_t *type_desc,
+			      void *img_ptr, unsigned int img_len,
+			      void **param_ptr, unsigned int *param_len)
+{
+	test_cert_t *cert = img_ptr;
+	uintptr_t cookie = (uintptr_t)type_desc->cookie;
+
+	if (img_type == IMG_RAW) {
+		if (type_desc->type != AUTH_PARAM_RAW_DATA) {
+			return 1;
+		}
+
+		*param_ptr = img_ptr;
+		*param_len = img_len;
+		return 0;
+	}
+
+	switch (type_desc->type) {
+	case AUTH_PARAM_RAW_DATA:
+		*param_ptr = cert;
+		*param_len = SIGNED_SIZE;
+		break;
+	case AUTH_PARAM_SIG:
+		*param_ptr = cert->sig;
+		*param_len = sizeof(cert->sig);
+		break;
+	case AUTH_PARAM_SIG_ALG:
+		*param_ptr = cert->sig_alg;
+		*param_len = sizeof(cert->sig_alg);
+		break;
+	case AUTH_PARAM_HASH:
+		*param_ptr = cert->hash;
+		*param_len = sizeof(cert->hash);
+		break;
+	case AUTH_PARAM_PUB_KEY:
+		*param_ptr = (cookie == 0U) ? cert->signer_pk :
+			     cert->keys[cookie - 1U];
+		*param_len = KEY_SIZE;
+		break;
+	case AUTH_PARAM_NV_CTR:
+		*param_ptr = cert->nv_ctr;
+		*param_len = 3U;
+		break;
+	default:
+		return 1;
+	}
+
+	return 0;
+}
+
+int crypto_mod_verify_signature(void *data_ptr, unsigned int data_len,
+				void *sig_ptr, unsigned int sig_len,
+				void *sig_alg_ptr, unsigned int sig_alg_len,
+				void *pk_ptr, unsigned int pk_len)
+{
+	uint8_t s[DIGEST_SIZE];
+
+	calls.sig_verified++;
+
+	if ((sig_len != DIGEST_SIZE) || (pk_len != KEY_SIZE)) {
+		return 1;
+	}
+
+	sign(data_ptr, data_len, pk_ptr, s);
+
+	return (memcmp(s, sig_ptr, DIGEST_SIZE) == 0) ? 0 : 1;
+}
+
+int crypto_mod_verify_hash(void *data_ptr, unsigned int data_len,
+			   void *digest_info_ptr, unsigned int digest_info_len)
+{
+	uint8_t md[DIGEST_SIZE];
+
+	calls.hash_verified++;
+	if (digest_info_ptr == rotpk_hash) {
+		calls.rotpk_hash_verified++;
+	}
+
+	if (digest_info_len != DIGEST_SIZE) {
+		return 1;
+	}
+
+	digest(data_ptr, data_len, md);
+
+	return (memcmp(md, digest_info_ptr, DIGEST_SIZE) == 0) ? 0 : 1;
+}
+
+int plat_get_rotpk_info(void *cookie, void **key_ptr, unsigned int *key_len,
+			unsigned int *flags)
+{
+	*key_ptr = rotpk_hash;
+	*key_len = sizeof(rotpk_hash);
+	*flags = ROTPK_IS_HASH;
+
+	return 0;
+}
+
+int plat_get_nv_ctr(void *cookie, unsigned int *nv_ctr)
+{
+	*nv_ctr = 0U;
+
+	return 0;
+}
+
+int plat_set_nv_ctr(void *cookie, unsigned int nv_ctr)
+{
+	return 0;
+}
+
+/*
+ * Fill a certificate signed with the given key, holding either two keys or
+ * the hash of an image.
+ */
+static test_cert_t *make_cert(unsigned int img_id, unsigned int idx,
+			      const uint8_t *pk, const void *img,
+			      size_t img_len)
+{
+	test_cert_t *cert = &certs[idx];
+
+	fill_random((uint8_t *)cert, sizeof(*cert));
+	memcpy(cert->signer_pk, pk, KEY_SIZE);
+	cert->nv_ctr[0] = 0x02;
+	cert->nv_ctr[1] = 0x01;
+	cert->nv_ctr[2] = 0x01;
+	if (img != NULL) {
+		digest(img, img_len, cert->hash);
+	}
+	sign(cert, SIGNED_SIZE, pk, cert->sig);
+
+	images[img_id].ptr = cert;
+	images[img_id].len = sizeof(*cert);
+
+	return cert;
+}
+
+static void make_image(unsigned int img_id, unsigned int idx)
+{
+	fill_random(raw_images[idx], IMAGE_SIZE);
+	images[img_id].ptr = raw_images[idx];
+	images[img_id].len = IMAGE_SIZE;
+}
+
+static void make_cot(void)
+{
+	test_cert_t *tkey, *key;
+
+	fill_random(rot_pk, sizeof(rot_pk));
+	digest(rot_pk, sizeof(rot_pk), rotpk_hash);
+
+	make_image(FW_CONFIG_ID, 0U);
+	make_image(BL31_IMAGE_ID, 1U);
+	make_image(BL33_IMAGE_ID, 2U);
+
+	make_cert(TRUSTED_BOOT_FW_CERT_ID, 0U, rot_pk, raw_images[0],
+		  IMAGE_SIZE);
+	tkey = make_cert(TRUSTED_KEY_CERT_ID, 1U, rot_pk, NULL, 0U);
+	key = make_cert(SOC_FW_KEY_CERT_ID, 2U, tkey->keys[0], NULL, 0U);
+	make_cert(SOC_FW_CONTENT_CERT_ID, 3U, key->keys[0], raw_images[1],
+		  IMAGE_SIZE);
+	key = make_cert(NON_TRUSTED_FW_KEY_CERT_ID, 4U, tkey->keys[1],
+			NULL, 0U);
+	make_cert(NON_TRUSTED_FW_CONTENT_CERT_ID, 5U, key->keys[0],
+		  raw_images[2], IMAGE_SIZE);
+}
+
+static int verify(unsigned int img_id)
+{
+	return auth_mod_verify_img(img_id, images[img_id].ptr,
+				   images[img_id].len);
+}
+
+static void test_boots(void)
+{
+	unsigned int boot, i;
+
+	for (boot = 0U; boot < NR_BOOTS; boot++) {
+		for (i = 0U; i < NR_IMAGES; i++) {
+			CHECK(verify(load_order[i]) == 0);
+		}
+	}
+
+	/* One signature per certificate, one hash per image */
+	CHECK(calls.parsed == NR_BOOTS * NR_IMAGES);
+	CHECK(calls.sig_verified == NR_BOOTS * NR_CERTS);
+#if AUTH_KEY_CACHE
+	CHECK(calls.rotpk_hash_verified == 1U);
+#else
+	CHECK(calls.rotpk_hash_verified == NR_BOOTS * NR_ROT_CERTS);
+#endif
+	CHECK(calls.hash_verified == calls.rotpk_hash_verified +
+	      (NR_BOOTS * (NR_IMAGES - NR_CERTS)));
+
+	CHECK(stats.parsed == calls.parsed);
+	CHECK(stats.sig_verified == calls.sig_verified);
+	CHECK(stats.hash_verified == calls.hash_verified);
+	CHECK(stats.key_cache_hits == (NR_BOOTS * NR_ROT_CERTS) -
+	      calls.rotpk_hash_verified);
+
+	printf("  %u boots: %u images parsed, %u signatures, %u hashes (%u of the ROT key), %u cached keys\n",
+	       NR_BOOTS, calls.parsed, calls.sig_verified, calls.hash_verified,
+	       calls.rotpk_hash_verified, stats.key_cache_hits);
+}
+
+/* A cached key must not let a certificate signed by another one through */
+static void test_rejected(void)
+{
+	test_cert_t *cert = &certs[1];
+	test_cert_t saved = *cert;
+	unsigned int rotpk_hashes = calls.rotpk_hash_verified;
+
+	/* Self-signed by another key */
+	fill_random(cert->signer_pk, KEY_SIZE);
+	sign(cert, SIGNED_SIZE, cert->signer_pk, cert->sig);
+	CHECK(verify(TRUSTED_KEY_CERT_ID) != 0);
+	CHECK(calls.rotpk_hash_verified == rotpk_hashes + 1U);
+
+	/* Signature not matching the data */
+	*cert = saved;
+	cert->keys[0][0] ^= 1U;
+	CHECK(verify(TRUSTED_KEY_CERT_ID) != 0);
+	*cert = saved;
+	CHECK(verify(TRUSTED_KEY_CERT_ID) == 0);
+
+	/* Image not matching the hash of its certificate */
+	raw_images[1][IMAGE_SIZE - 1U] ^= 1U;
+	CHECK(verify(BL31_IMAGE_ID) != 0);
+	raw_images[1][IMAGE_SIZE - 1U] ^= 1U;
+	CHECK(verify(BL31_IMAGE_ID) == 0);
+}
+
+int main(void)
+{
+	auth_mod_init();
+	make_cot();
+
+	test_boots();
+	test_rejected();
+
+	if (failures != 0U) {
+		printf("FAIL: auth_mod, %u failures\n", failures);
+		return 1;
+	}
+
+	printf("PASS: auth_mod\n");
+	return 0;
+}
@@ -0,0 +1,83 @@
+#!/bin/sh
+#
+# Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+# Time the generation of a full TBBR CoT by cert_create, serially and with one
+# job per CPU: with new RSA keys (BENCH_KEY_SIZE bits, 3072 by default), then
+# with the saved keys and larger images (BENCH_IMAGE_MB per image, 16 MiB by
+# default). Every certificate must be produced and parsed by OpenSSL.
+#
+# Usage: cert_create_bench.sh [path to cert_create]
+
+CERT_CREATE=$(realpath "${1:-../cert_create/cert_create}")
+BENCH_KEY_SIZE=${BENCH_KEY_SIZE:-3072}
+BENCH_IMAGE_MB=${BENCH_IMAGE_MB:-16}
+NR_CPUS=$(nproc)
+IMAGES="tb-fw tb-fw-config hw-config fw-config scp-fw soc-fw soc-fw-config \
+	tos-fw tos-fw-extra1 tos-fw-extra2 tos-fw-config nt-fw nt-fw-config"
+CERTS="tb-fw-cert trusted-key-cert scp-fw-key-cert scp-fw-cert \
+	soc-fw-key-cert soc-fw-cert tos-fw-key-cert tos-fw-cert \
+	nt-fw-key-cert nt-fw-cert"
+KEYS="rot-key trusted-world-key non-trusted-world-key scp-fw-key \
+	soc-fw-key tos-fw-key nt-fw-key"
+
+TMP_DIR=$(mktemp -d)
+trap 'rm -rf "${TMP_DIR}"' EXIT
+cd "${TMP_DIR}" || exit 1
+
+# $1: size of each image in KiB
+make_images() {
+	for i in ${IMAGES}; do
+		head -c $(($1 * 1024)) /dev/urandom > "$i.bin"
+	done
+}
+
+opts="--tfw-nvctr 31 --ntfw-nvctr 223 -b ${BENCH_KEY_SIZE}"
+for i in ${IMAGES}; do
+	opts="${opts} --$i $i.bin"
+done
+for c in ${CERTS}; do
+	opts="${opts} --$c $c.crt"
+done
+for k in ${KEYS}; do
+	opts="${opts} --$k $k.pem"
+done
+
+now_ms() {
+	echo $(($(date +%s%N) / 1000000))
+}
+
+# $1: label, then the cert_create options
+timed() {
+	label=$1
+	shift
+	rm -f *.crt
+	start=$(now_ms)
+	"${CERT_CREATE}" ${opts} "$@" > /dev/null 2>&1 || {
+		echo "FAIL: ${label}: cert_create failed"
+		exit 1
+	}
+	ms=$(($(now_ms) - start))
+	for c in ${CERTS}; do
+		if ! openssl x509 -inform DER -in "$c.crt" -noout 2> /dev/null; then
+			echo "FAIL: ${label}: no valid $c"
+			exit 1
+		fi
+	done
+	printf '  %-40s %6d ms\n' "${label}" ${ms}
+}
+
+echo "cert_create: TBBR CoT, $(echo ${CERTS} | wc -w) certificates," \
+	"$(echo ${KEYS} | wc -w) RSA-${BENCH_KEY_SIZE} keys, ${NR_CPUS} CPUs"
+
+# The keys saved by the last run are used by the next ones
+make_images 64
+timed "new keys, -j 1" -n -k -j 1
+rm -f *.pem
+timed "new keys, -j ${NR_CPUS}" -n -k -j ${NR_CPUS}
+
+make_images $((BENCH_IMAGE_MB * 1024))
+timed "saved keys, ${BENCH_IMAGE_MB} MiB images, -j 1" -j 1
+timed "saved keys, ${BENCH_IMAGE_MB} MiB images, -j ${NR_CPUS}" -j ${NR_CPUS}
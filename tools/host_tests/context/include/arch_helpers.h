@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef ARCH_HELPERS_H
+#define ARCH_HELPERS_H
+
+/* Host replacement of the barrier used by the STM32MP1 context code */
+void dsb(void);
+
+#endif /* ARCH_HELPERS_H */
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PLATFORM_DEF_H
+#define PLATFORM_DEF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lib/utils_def.h>
+
+/*
+ * Host build of the STM32MP15 context code, the backup SRAM is a buffer of
+ * the test.
+ */
+extern uint8_t backup_ram[];
+
+#define STM32MP_BACKUP_RAM_BASE		((uintptr_t)backup_ram)
+#define STM32MP_BACKUP_RAM_SIZE		U(0x00001000)
+#define STM32MP_DDR_BASE		((uintptr_t)backup_ram)
+
+#define BL_CODE_BASE			U(0x2FFC2500)
+#define BL_CODE_END			U(0x2FFDA000)
+#define BL2_END				U(0x2FFE0000)
+
+#define PLAT_MAX_OPP_NB			U(2)
+#define PLAT_MAX_PLLCFG_NB		U(6)
+
+#define STM32MP_ETZPC_MAX_ID		96
+
+#include <drivers/st/bsec.h>
+#include <stm32mp1_private.h>
+
+#endif /* PLATFORM_DEF_H */
@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the STM32MP15 Standby snapshot, built as in BL2 with
+ * STM32MP1_FAST_RESUME: the snapshot saved at suspend in the emulated backup
+ * SRAM is checked to leave the layout shared with the secure OS untouched, to
+ * replay the clock tree, the ETZPC and the GPIOZ secure configuration, and to
+ * be rejected once corrupted, cleared or when the clock replay fails.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <common/debug.h>
+#include <common/tf_crc32.h>
+#include <drivers/clk.h>
+#include <drivers/st/etzpc.h>
+#include <drivers/st/stm32_gpio.h>
+#include <drivers/st/stm32mp1_clk.h>
+#include <drivers/st/stm32mp1_ddr_helpers.h>
+#include <dt-bindings/clock/stm32mp1-clks.h>
+#include <dt-bindings/gpio/stm32-gpio.h>
+#include <lib/utils.h>
+
+#include <platform_def.h>
+#include <stm32mp1_context.h>
+#include <stm32mp1_critic_power.h>
+
+/* Size of the content shared with the secure OS, up to BL2_END */
+#define BACKUP_DATA_V3_SIZE	168U
+#define NB_TZMA			2U
+
+uint8_t backup_ram[STM32MP_BACKUP_RAM_SIZE] __aligned(8);
+
+/* Emulated peripherals */
+static struct stm32mp1_clk_snapshot rcc_state;
+static struct stm32mp1_clk_snapshot restored_clk;
+static uint8_t etzpc_decprot[STM32MP_ETZPC_MAX_ID];
+static uint16_t etzpc_tzma[NB_TZMA];
+static uint32_t gpioz_secr;
+
+static bool bkpram_access = true;
+static int clk_restore_ret;
+static unsigned int clk_restores;
+static unsigned int etzpc_inits;
+static int bkpsram_enabled;
+static uint64_t prng_state = 0x9E3779B97F4A7C15ULL;
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	(void)vprintf(fmt + 1, args);
+	va_end(args);
+}
+
+/* Called by panic(), exit() flushes the host output */
+void console_flush(void)
+{
+}
+
+void __dead2 do_panic(void)
+{
+	printf("PANIC\n");
+	exit(1);
+	__builtin_unreachable();
+}
+
+#if ENABLE_ASSERTIONS
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+#endif
+
+void zeromem(void *mem, u_register_t length)
+{
+	memset(mem, 0, length);
+}
+
+void dsb(void)
+{
+}
+
+/* Bitwise CRC-32, as computed by the zlib of BL2 and SP_MIN */
+uint32_t tf_crc32(uint32_t crc, const unsigned char *buf, size_t size)
+{
+	uint32_t calc_crc = ~crc;
+	size_t i;
+	unsigned int bit;
+
+	for (i = 0U; i < size; i++) {
+		calc_crc ^= buf[i];
+		for (bit = 0U; bit < 8U; bit++) {
+			calc_crc = (calc_crc >> 1) ^
+				   (0xEDB88320U & (0U - (calc_crc & 1U)));
+		}
+	}
+
+	return ~calc_crc;
+}
+
+void stm32_pwr_down_wfi_wrapper(bool is_cstop, uint32_t mode)
+{
+}
+
+uint32_t ddr_get_io_calibration_val(void)
+{
+	return 0x12345U;
+}
+
+bool stm32mp_bkpram_get_access(void)
+{
+	return bkpram_access;
+}
+
+int clk_enable(unsigned long id)
+{
+	CHECK(id == BKPSRAM);
+	bkpsram_enabled++;
+
+	return 0;
+}
+
+void clk_disable(unsigned long id)
+{
+	CHECK(id == BKPSRAM);
+	bkpsram_enabled--;
+}
+
+void stm32mp1_clk_get_snapshot(struct stm32mp1_clk_snapshot *snap)
+{
+	*snap = rcc_state;
+}
+
+int stm32mp1_clk_restore_snapshot(const struct stm32mp1_clk_snapshot *snap)
+{
+	clk_restores++;
+	restored_clk = *snap;
+
+	return clk_restore_ret;
+}
+
+int etzpc_init(void)
+{
+	etzpc_inits++;
+
+	return 0;
+}
+
+uint8_t etzpc_get_num_per_sec(void)
+{
+	return STM32MP_ETZPC_MAX_ID;
+}
+
+enum etzpc_decprot_attributes etzpc_get_decprot(uint32_t decprot_id)
+{
+	CHECK(decprot_id < STM32MP_ETZPC_MAX_ID);
+
+	return (enum etzpc_decprot_attributes)etzpc_decprot[decprot_id];
+}
+
+void etzpc_configure_decprot(uint32_t decprot_id,
+			     enum etzpc_decprot_attributes decprot_attr)
+{
+	CHECK(decprot_id < STM32MP_ETZPC_MAX_ID);
+	etzpc_decprot[decprot_id] = (uint8_t)decprot_attr;
+}
+
+uint16_t etzpc_get_tzma(uint32_t tzma_id)
+{
+	CHECK(tzma_id < NB_TZMA);
+
+	return etzpc_tzma[tzma_id];
+}
+
+void etzpc_configure_tzma(uint32_t tzma_id, uint16_t tzma_value)
+{
+	CHECK(tzma_id < NB_TZMA);
+	etzpc_tzma[tzma_id] = tzma_value;
+}
+
+uint32_t get_gpio_bank_secure_cfg(uint32_t bank)
+{
+	CHECK(bank == GPIO_BANK_Z);
+
+	return gpioz_secr;
+}
+
+void restore_gpio_bank_secure_cfg(uint32_t bank, uint32_t secure_pins)
+{
+	CHECK(bank == GPIO_BANK_Z);
+	gpioz_secr = secure_pins;
+}
+
+static uint32_t prng(void)
+{
+	prng_state ^= prng_state >> 12;
+	prng_state ^= prng_state << 25;
+	prng_state ^= prng_state >> 27;
+
+	return (uint32_t)((prng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* Random clock tree and firewall configuration, as found at suspend */
+static void random_state(void)
+{
+	uint8_t *raw = (uint8_t *)&rcc_state;
+	unsigned int i;
+
+	for (i = 0U; i < sizeof(rcc_state); i++) {
+		raw[i] = (uint8_t)prng();
+	}
+
+	for (i = 0U; i < STM32MP_ETZPC_MAX_ID; i++) {
+		etzpc_decprot[i] = (uint8_t)(prng() % ETZPC_DECPROT_MAX);
+	}
+
+	for (i = 0U; i < NB_TZMA; i++) {
+		etzpc_tzma[i] = (uint16_t)prng();
+	}
+
+	gpioz_secr = prng() & 0xFFU;
+}
+
+/* Reset values after a wakeup from Standby */
+static void reset_state(void)
+{
+	memset(etzpc_decprot, 0, sizeof(etzpc_decprot));
+	memset(etzpc_tzma, 0, sizeof(etzpc_tzma));
+	gpioz_secr = 0xFFU;
+	memset(&restored_clk, 0, sizeof(restored_clk));
+	clk_restores = 0U;
+	etzpc_inits = 0U;
+}
+
+/* Context of a cold boot followed by a suspend */
+static void cold_boot_and_suspend(uint8_t fill)
+{
+	memset(backup_ram, fill, sizeof(backup_ram));
+	stm32_clean_context();
+	stm32_context_save_bl2_param();
+	stm32_context_save_pm_snapshot();
+}
+
+/*
+ * The snapshot is written after the content shared with the secure OS: the
+ * bytes written whatever the initial content of the backup SRAM are found.
+ */
+static void test_layout(size_t *start, size_t *end)
+{
+	uint8_t shared[BACKUP_DATA_V3_SIZE];
+	uint8_t zeros[STM32MP_BACKUP_RAM_SIZE];
+	size_t i;
+
+	random_state();
+
+	memset(backup_ram, 0x5A, sizeof(backup_ram));
+	stm32_context_save_bl2_param();
+	memcpy(shared, backup_ram, sizeof(shared));
+	stm32_context_save_pm_snapshot();
+	CHECK(memcmp(shared, backup_ram, sizeof(shared)) == 0);
+
+	memset(backup_ram, 0, sizeof(backup_ram));
+	stm32_context_save_pm_snapshot();
+	memcpy(zeros, backup_ram, sizeof(zeros));
+
+	memset(backup_ram, 0xFF, sizeof(backup_ram));
+	stm32_context_save_pm_snapshot();
+
+	*start = 0U;
+	*end = 0U;
+	for (i = 0U; i < sizeof(backup_ram); i++) {
+		if (backup_ram[i] != zeros[i]) {
+			continue;
+		}
+
+		if (*end == 0U) {
+			*start = i;
+		} else {
+			CHECK(*end == i);
+		}
+		*end = i + 1U;
+	}
+
+	CHECK(*start >= BACKUP_DATA_V3_SIZE);
+	CHECK(*end > *start);
+	CHECK(bkpsram_enabled == 0);
+
+	printf("PASS: layout, snapshot at [%zu, %zu) of the backup SRAM\n",
+	       *start, *end);
+}
+
+static void test_round_trip(void)
+{
+	struct stm32mp1_clk_snapshot saved_rcc;
+	uint8_t saved_decprot[STM32MP_ETZPC_MAX_ID];
+	uint16_t saved_tzma[NB_TZMA];
+	uint32_t saved_secr;
+	unsigned int run;
+
+	for (run = 0U; run < 100U; run++) {
+		random_state();
+		saved_rcc = rcc_state;
+		memcpy(saved_decprot, etzpc_decprot, sizeof(saved_decprot));
+		memcpy(saved_tzma, etzpc_tzma, sizeof(saved_tzma));
+		saved_secr = gpioz_secr;
+
+		cold_boot_and_suspend((uint8_t)prng());
+
+		/* Standby: the peripherals are reset */
+		memset(&rcc_state, 0, sizeof(rcc_state));
+		reset_state();
+
+		CHECK(stm32_context_restore_pm_snapshot() == 0);
+		CHECK(clk_restores == 1U);
+		CHECK(memcmp(&restored_clk, &saved_rcc,
+			     sizeof(saved_rcc)) == 0);
+		CHECK(etzpc_inits == 1U);
+		CHECK(memcmp(etzpc_decprot, saved_decprot,
+			     sizeof(saved_decprot)) == 0);
+		CHECK(memcmp(etzpc_tzma, saved_tzma, sizeof(saved_tzma)) == 0);
+		CHECK(gpioz_secr == saved_secr);
+		CHECK(bkpsram_enabled == 0);
+	}
+
+	printf("PASS: round trip\n");
+}
+
+/* Any corrupted byte of the snapshot or of its CRC rejects it */
+static void test_corruption(size_t start, size_t end)
+{
+	size_t i;
+
+	random_state();
+	cold_boot_and_suspend(0U);
+
+	for (i = start; i < end; i++) {
+		uint8_t bit = (uint8_t)BIT(prng() % 8U);
+
+		backup_ram[i] ^= bit;
+		reset_state();
+		CHECK(stm32_context_restore_pm_snapshot() == -ENOENT);
+		CHECK(clk_restores == 0U);
+		CHECK(etzpc_inits == 0U);
+		CHECK(gpioz_secr == 0xFFU);
+		backup_ram[i] ^= bit;
+	}
+
+	/* Bytes past the snapshot are not covered */
+	backup_ram[end] ^= 0xFFU;
+	reset_state();
+	CHECK(stm32_context_restore_pm_snapshot() == 0);
+	CHECK(bkpsram_enabled == 0);
+
+	printf("PASS: corruption, %zu bytes\n", end - start);
+}
+
+static void test_rejected(void)
+{
+	random_state();
+
+	/* Cold boot: the context is cleared */
+	cold_boot_and_suspend(0U);
+	stm32_clean_context();
+	reset_state();
+	CHECK(stm32_context_restore_pm_snapshot() == -ENOENT);
+	CHECK(clk_restores == 0U);
+
+	/* Context of a secure OS using an older layout */
+	cold_boot_and_suspend(0U);
+	backup_ram[2] = 0x02U;
+	reset_state();
+	CHECK(stm32_context_restore_pm_snapshot() == -ENOENT);
+
+	/* Clock tree not replayed: the firewalls are left to the secure OS */
+	cold_boot_and_suspend(0U);
+	reset_state();
+	clk_restore_ret = -ETIMEDOUT;
+	CHECK(stm32_context_restore_pm_snapshot() == -ETIMEDOUT);
+	CHECK(clk_restores == 1U);
+	CHECK(etzpc_inits == 0U);
+	CHECK(gpioz_secr == 0xFFU);
+	clk_restore_ret = 0;
+
+	/* No access to the backup SRAM: nothing saved nor replayed */
+	memset(backup_ram, 0, sizeof(backup_ram));
+	bkpram_access = false;
+	stm32_context_save_pm_snapshot();
+	CHECK(stm32_context_restore_pm_snapshot() == -ENOENT);
+	bkpram_access = true;
+	CHECK(stm32_context_restore_pm_snapshot() == -ENOENT);
+
+	CHECK(bkpsram_enabled == 0);
+
+	printf("PASS: rejected snapshots\n");
+}
+
+int main(void)
+{
+	size_t start;
+	size_t end;
+
+	test_layout(&start, &end);
+	test_round_trip();
+	test_corruption(start, end);
+	test_rejected();
+
+	if (failures != 0U) {
+		printf("FAIL: stm32mp1_context, %u failures\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS: stm32mp1_context\n");
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,499 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Test and benchmark of the encrypt_fw image encryption.
+ *
+ * The images encrypted by encrypt_file() are decrypted here with OpenSSL, in
+ * the single tag and in the chunked formats, for sizes around the chunk
+ * boundaries. Tampered chunks must fail their tag check, and two images whose
+ * nonces only differ in their last bit must not share any chunk keystream.
+ *
+ * With -b, 64 MiB and 256 MiB images are encrypted in both formats, then four
+ * 64 MiB images with one and four threads.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+
+#include <firmware_encrypted.h>
+
+#include "encrypt.h"
+#include "jobs.h"
+
+#define KEY_SIZE		32U
+#define IV_SIZE			12U
+#define TAG_SIZE		16U
+#define CHUNK_SIZE		4096U
+#define MiB			(1024U * 1024U)
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			printf("FAIL: %s:%d: %s\n", __FILE__, __LINE__, \
+			       #cond); \
+			failures++; \
+		} \
+	} while (false)
+
+static const char key_string[] =
+	"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f";
+static const char nonce_string[] = "a0a1a2a3a4a5a6a7a8a9aaab";
+static const char nonce_string2[] = "a0a1a2a3a4a5a6a7a8a9aaaa";
+
+static char tmp_dir[] = "/tmp/encrypt_fw_test.XXXXXX";
+static unsigned int failures;
+static uint32_t seed = 1U;
+
+static uint32_t prng(void)
+{
+	seed = (seed * 1103515245U) + 12345U;
+
+	return seed >> 8;
+}
+
+static void hex_to_bin(const char *str, unsigned char *bin, size_t len)
+{
+	size_t i;
+
+	for (i = 0U; i < len; i++) {
+		sscanf(&str[2U * i], "%02hhx", &bin[i]);
+	}
+}
+
+static void tmp_name(char *buf, size_t len, const char *name)
+{
+	snprintf(buf, len, "%s/%s", tmp_dir, name);
+}
+
+static void write_file(const char *name, const unsigned char *data,
+		       size_t size)
+{
+	char path[128];
+	FILE *f;
+
+	tmp_name(path, sizeof(path), name);
+	f = fopen(path, "wb");
+	if ((f == NULL) || (fwrite(data, 1, size, f) != size) ||
+	    (fclose(f) != 0)) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/* Write a random image to name and return its contents */
+static unsigned char *write_image(const char *name, size_t size)
+{
+	unsigned char *data = malloc(size + 1U);
+	size_t i;
+
+	if (data == NULL) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0U; i < size; i++) {
+		data[i] = prng() & 0xffU;
+	}
+
+	write_file(name, data, size);
+
+	return data;
+}
+
+static unsigned char *read_file(const char *name, size_t *size)
+{
+	unsigned char *data;
+	char path[128];
+	FILE *f;
+	long len;
+
+	tmp_name(path, sizeof(path), name);
+	f = fopen(path, "rb");
+	if ((f == NULL) || (fseek(f, 0, SEEK_END) != 0) ||
+	    ((len = ftell(f)) < 0) || (fseek(f, 0, SEEK_SET) != 0)) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+
+	data = malloc((size_t)len + 1U);
+	if ((data == NULL) || (fread(data, 1, (size_t)len, f) != (size_t)len)) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+	fclose(f);
+	*size = (size_t)len;
+
+	return data;
+}
+
+static int encrypt(unsigned int chunk_size, const char *nonce,
+		   const char *in, const char *out)
+{
+	char ip_name[128], op_name[128];
+
+	tmp_name(ip_name, sizeof(ip_name), in);
+	tmp_name(op_name, sizeof(op_name), out);
+
+	return encrypt_file(FW_ENC_WITH_SSK, KEY_ALG_GCM, chunk_size,
+			    key_string, nonce, ip_name, op_name);
+}
+
+/* Decrypt and check one GCM message, return 0 if its tag matches */
+static int gcm_decrypt(const unsigned char *key, const unsigned char *iv,
+		       const void *aad, int aad_len, const unsigned char *enc,
+		       size_t len, const unsigned char *tag,
+		       unsigned char *out)
+{
+	EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+	int out_len;
+	int ret = -1;
+
+	if ((ctx != NULL) &&
+	    (EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, key, iv) == 1) &&
+	    ((aad_len == 0) ||
+	     (EVP_DecryptUpdate(ctx, NULL, &out_len, aad, aad_len) == 1)) &&
+	    (EVP_DecryptUpdate(ctx, out, &out_len, enc, (int)len) == 1) &&
+	    (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, TAG_SIZE,
+				 (void *)tag) == 1) &&
+	    (EVP_DecryptFinal_ex(ctx, out + out_len, &out_len) == 1)) {
+		ret = 0;
+	}
+
+	EVP_CIPHER_CTX_free(ctx);
+
+	return ret;
+}
+
+/* HKDF-SHA256 with the header IV as salt, see struct fw_enc_chunk_hdr */
+static void chunk_key(const unsigned char *iv, unsigned char *out)
+{
+	unsigned char key[KEY_SIZE];
+	EVP_PKEY_CTX *pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, NULL);
+	size_t len = KEY_SIZE;
+
+	hex_to_bin(key_string, key, KEY_SIZE);
+
+	if ((pctx == NULL) || (EVP_PKEY_derive_init(pctx) != 1) ||
+	    (EVP_PKEY_CTX_set_hkdf_md(pctx, EVP_sha256()) != 1) ||
+	    (EVP_PKEY_CTX_set1_hkdf_salt(pctx, iv, IV_SIZE) != 1) ||
+	    (EVP_PKEY_CTX_set1_hkdf_key(pctx, key, KEY_SIZE) != 1) ||
+	    (EVP_PKEY_CTX_add1_hkdf_info(pctx,
+			(const unsigned char *)ENC_CHUNK_KDF_INFO,
+			strlen(ENC_CHUNK_KDF_INFO)) != 1) ||
+	    (EVP_PKEY_derive(pctx, out, &len) != 1)) {
+		printf("HKDF failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+	EVP_PKEY_CTX_free(pctx);
+}
+
+/* Check the single tag image enc against the plain image data */
+static void check_image(const unsigned char *enc, size_t enc_size,
+			const unsigned char *data, size_t size)
+{
+	const struct fw_enc_hdr *hdr = (const void *)enc;
+	unsigned char key[KEY_SIZE];
+	unsigned char *out = malloc(size + 1U);
+
+	hex_to_bin(key_string, key, KEY_SIZE);
+
+	CHECK(enc_size == sizeof(*hdr) + size);
+	CHECK(hdr->magic == ENC_HEADER_MAGIC);
+	CHECK(hdr->dec_algo == KEY_ALG_GCM);
+	CHECK((hdr->iv_len == IV_SIZE) && (hdr->tag_len == TAG_SIZE));
+	CHECK(gcm_decrypt(key, hdr->iv, NULL, 0, enc + sizeof(*hdr), size,
+			  hdr->tag, out) == 0);
+	CHECK(memcmp(out, data, size) == 0);
+
+	free(out);
+}
+
+/*
+ * Check the chunked image enc against the plain image data. Return the
+ * number of chunks whose tag check failed.
+ */
+static unsigned int check_chunks(const unsigned char *enc, size_t enc_size,
+				 const unsigned char *data, size_t size,
+				 const char *nonce)
+{
+	const struct fw_enc_hdr *hdr = (const void *)enc;
+	const struct fw_enc_chunk_hdr *chunk_hdr = (const void *)(hdr + 1);
+	const unsigned char *p = (const unsigned char *)(chunk_hdr + 1);
+	size_t nr_chunks = (size + CHUNK_SIZE - 1U) / CHUNK_SIZE;
+	unsigned char nonce_bin[IV_SIZE], iv[IV_SIZE] = { 0 };
+	unsigned char key[KEY_SIZE], out[CHUNK_SIZE];
+	unsigned int bad = 0U;
+	size_t n, len;
+
+	hex_to_bin(nonce, nonce_bin, IV_SIZE);
+
+	CHECK(enc_size == sizeof(*hdr) + sizeof(*chunk_hdr) + size +
+			  (nr_chunks * TAG_SIZE));
+	CHECK(hdr->magic == ENC_HEADER_MAGIC);
+	CHECK(hdr->dec_algo == ENC_DEC_ALGO_GCM_CHUNKED);
+	CHECK(memcmp(hdr->iv, nonce_bin, IV_SIZE) == 0);
+	CHECK(chunk_hdr->chunk_size == CHUNK_SIZE);
+	CHECK(chunk_hdr->data_size == size);
+
+	chunk_key(hdr->iv, key);
+
+	for (n = 0U; n < nr_chunks; n++) {
+		len = size - (n * CHUNK_SIZE);
+		if (len > CHUNK_SIZE) {
+			len = CHUNK_SIZE;
+		}
+
+		iv[IV_SIZE - 2U] = (n >> 8) & 0xffU;
+		iv[IV_SIZE - 1U] = n & 0xffU;
+
+		if ((gcm_decrypt(key, iv, chunk_hdr, sizeof(*chunk_hdr), p,
+				 len, p + len, out) != 0) ||
+		    (memcmp(out, data + (n * CHUNK_SIZE), len) != 0)) {
+			bad++;
+		}
+
+		p += len + TAG_SIZE;
+	}
+
+	return bad;
+}
+
+static void test_formats(void)
+{
+	static const size_t sizes[] = {
+		0U, 1U, CHUNK_SIZE - 1U, CHUNK_SIZE, CHUNK_SIZE + 1U,
+		(3U * CHUNK_SIZE) + 17U,
+	};
+	unsigned char *data, *enc;
+	size_t enc_size;
+	unsigned int i;
+
+	for (i = 0U; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		data = write_image("in.bin", sizes[i]);
+
+		CHECK(encrypt(0U, nonce_string, "in.bin", "single.bin") == 0);
+		enc = read_file("single.bin", &enc_size);
+		check_image(enc, enc_size, data, sizes[i]);
+		free(enc);
+
+		CHECK(encrypt(CHUNK_SIZE, nonce_string, "in.bin",
+			      "chunked.bin") == 0);
+		enc = read_file("chunked.bin", &enc_size);
+		CHECK(check_chunks(enc, enc_size, data, sizes[i],
+				   nonce_string) == 0U);
+		free(enc);
+
+		free(data);
+	}
+
+	printf("PASS: single tag and chunked formats, %u sizes\n", i);
+}
+
+static void test_tamper(void)
+{
+	const size_t size = (4U * CHUNK_SIZE) + 100U;
+	const size_t stride = CHUNK_SIZE + TAG_SIZE;
+	unsigned char chunk[CHUNK_SIZE + TAG_SIZE];
+	unsigned char *data, *enc, *p;
+	size_t enc_size;
+
+	data = write_image("in.bin", size);
+	CHECK(encrypt(CHUNK_SIZE, nonce_string, "in.bin", "chunked.bin") == 0);
+	enc = read_file("chunked.bin", &enc_size);
+	p = enc + sizeof(struct fw_enc_hdr) + sizeof(struct fw_enc_chunk_hdr);
+
+	/* One flipped bit in chunk 2 */
+	p[(2U * stride) + 5U] ^= 0x10U;
+	CHECK(check_chunks(enc, enc_size, data, size, nonce_string) == 1U);
+	p[(2U * stride) + 5U] ^= 0x10U;
+
+	/* Chunks 0 and 1 swapped */
+	memcpy(chunk, p, stride);
+	memcpy(p, p + stride, stride);
+	memcpy(p + stride, chunk, stride);
+	CHECK(check_chunks(enc, enc_size, data, size, nonce_string) == 2U);
+	memcpy(p + stride, p, stride);
+	memcpy(p, chunk, stride);
+
+	/* Chunk header changed, every chunk fails */
+	p[-12] ^= 0x01U;
+	CHECK(check_chunks(enc, enc_size, data, size, nonce_string) == 5U);
+
+	free(enc);
+	free(data);
+
+	printf("PASS: tampered chunks\n");
+}
+
+/*
+ * Nonces that only differ in their last bit gave the same IV to chunk 0 of
+ * one image and chunk 1 of the other when the chunk number was XORed into
+ * the nonce. With the same plain text, no two chunks may encrypt the same.
+ */
+static void test_nonce_reuse(void)
+{
+	const size_t size = 8U * CHUNK_SIZE;
+	const size_t stride = CHUNK_SIZE + TAG_SIZE;
+	unsigned char *data, *enc, *enc2, *p, *p2;
+	size_t enc_size, enc2_size;
+	unsigned int i, j;
+
+	data = malloc(size);
+	if (data == NULL) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	memset(data, 0x5a, size);
+	write_file("in.bin", data, size);
+
+	CHECK(encrypt(CHUNK_SIZE, nonce_string, "in.bin", "a.bin") == 0);
+	CHECK(encrypt(CHUNK_SIZE, nonce_string2, "in.bin", "b.bin") == 0);
+	enc = read_file("a.bin", &enc_size);
+	enc2 = read_file("b.bin", &enc2_size);
+	CHECK(enc_size == enc2_size);
+	p = enc + sizeof(struct fw_enc_hdr) + sizeof(struct fw_enc_chunk_hdr);
+	p2 = enc2 + sizeof(struct fw_enc_hdr) + sizeof(struct fw_enc_chunk_hdr);
+
+	for (i = 0U; i < 8U; i++) {
+		for (j = 0U; j < 8U; j++) {
+			CHECK(memcmp(p + (i * stride), p2 + (j * stride),
+				     CHUNK_SIZE) != 0);
+			if (i != j) {
+				CHECK(memcmp(p + (i * stride), p + (j * stride),
+					     CHUNK_SIZE) != 0);
+			}
+		}
+	}
+
+	free(enc);
+	free(enc2);
+	free(data);
+
+	printf("PASS: nonces differing in the last bit\n");
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static unsigned int bench_chunk_size;
+static char bench_in[4][16];
+static char bench_out[4][16];
+
+static void bench_job(int i)
+{
+	if (encrypt(bench_chunk_size, nonce_string, bench_in[i],
+		    bench_out[i]) != 0) {
+		printf("FAIL: cannot encrypt %s\n", bench_in[i]);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void bench_report(const char *what, unsigned int chunk_size,
+			 size_t bytes, uint64_t ns)
+{
+	printf("  %-16s %10u %8zu %10.1f\n", what, chunk_size, bytes / MiB,
+	       ((double)bytes / (double)MiB) / ((double)ns / 1e9));
+}
+
+static void bench(void)
+{
+	static const unsigned int chunk_sizes[] = { 0U, 65536U, MiB };
+	static const size_t image_sizes[] = { 64U * MiB, 256U * MiB };
+	uint64_t start;
+	unsigned int i, j;
+	int nr_jobs;
+
+	printf("\n  %-16s %10s %8s %10s\n", "images", "chunk size", "MiB",
+	       "MiB/s");
+
+	for (i = 0U; i < sizeof(image_sizes) / sizeof(image_sizes[0]); i++) {
+		free(write_image("bench.bin", image_sizes[i]));
+		snprintf(bench_in[0], sizeof(bench_in[0]), "bench.bin");
+		snprintf(bench_out[0], sizeof(bench_out[0]), "bench.enc");
+
+		for (j = 0U; j < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]);
+		     j++) {
+			bench_chunk_size = chunk_sizes[j];
+			start = now_ns();
+			bench_job(0);
+			bench_report("1", chunk_sizes[j], image_sizes[i],
+				     now_ns() - start);
+		}
+	}
+
+	for (i = 0U; i < 4U; i++) {
+		snprintf(bench_in[i], sizeof(bench_in[i]), "bench%u.bin", i);
+		snprintf(bench_out[i], sizeof(bench_out[i]), "bench%u.enc", i);
+		free(write_image(bench_in[i], 64U * MiB));
+	}
+
+	for (nr_jobs = 1; nr_jobs <= 4; nr_jobs += 3) {
+		for (j = 0U; j < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]);
+		     j++) {
+			char what[32];
+
+			bench_chunk_size = chunk_sizes[j];
+			start = now_ns();
+			run_jobs(bench_job, NULL, 4, nr_jobs);
+			snprintf(what, sizeof(what), "4, %d job%s", nr_jobs,
+				 (nr_jobs > 1) ? "s" : "");
+			bench_report(what, chunk_sizes[j], 4U * 64U * MiB,
+				     now_ns() - start);
+		}
+	}
+}
+
+static void cleanup(void)
+{
+	char cmd[64];
+
+	snprintf(cmd, sizeof(cmd), "rm -rf %s", tmp_dir);
+	if (system(cmd) != 0) {
+		printf("Cannot remove %s\n", tmp_dir);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (mkdtemp(tmp_dir) == NULL) {
+		perror("mkdtemp");
+		return EXIT_FAILURE;
+	}
+
+	test_formats();
+	test_tamper();
+	test_nonce_reuse();
+
+	if ((failures == 0U) && (argc > 1) && (strcmp(argv[1], "-b") == 0)) {
+		bench();
+	}
+
+	cleanup();
+
+	if (failures != 0U) {
+		printf("FAIL: encrypt_fw, %u failures\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS: encrypt_fw\n");
+
+	return EXIT_SUCCESS;
+}
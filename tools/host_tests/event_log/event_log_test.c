@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the TCG Event Log with SHA-256, built as in BL2 with or
+ * without TRUSTED_BOARD_BOOT. Images with FIPS 180-2 test vector contents are
+ * measured, the log must match a known log byte for byte, whether digests
+ * are computed or taken from the DigestInfo checked while authenticating.
+ * The known log is then printed by the Event Log parser, its output must
+ * match a known dump.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <common/debug.h>
+#include <drivers/auth/auth_mod.h>
+#include <drivers/auth/crypto_mod.h>
+#include <drivers/console.h>
+#include <drivers/measured_boot/event_log/event_log.h>
+
+/* From OpenSSL, the test has no access to the host headers */
+unsigned char *SHA256(const unsigned char *d, size_t n, unsigned char *md);
+
+#define LE16(_v)	((_v) & 0xFFU), (((_v) >> 8) & 0xFFU)
+#define LE32(_v)	LE16(_v), LE16((_v) >> 16)
+
+#define DIGEST_ABC							\
+	0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,			\
+	0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,			\
+	0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,			\
+	0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+#define DIGEST_EMPTY							\
+	0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14,			\
+	0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,			\
+	0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c,			\
+	0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55
+#define DIGEST_448							\
+	0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8,			\
+	0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,			\
+	0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,			\
+	0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1
+#define DIGEST_MILLION_A						\
+	0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92,			\
+	0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,			\
+	0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e,			\
+	0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+
+/* TCG_PCR_EVENT2 of an image measured into PCR[0] */
+#define IMAGE_EVENT(_digest, _name_len, ...)				\
+	LE32(PCR_0), LE32(EV_POST_CODE), LE32(1U),			\
+	LE16(TPM_ALG_SHA256), _digest,					\
+	LE32(_name_len), __VA_ARGS__
+
+static const uint8_t known_log[] = {
+	/* TCG_EfiSpecIDEvent */
+	LE32(PCR_0), LE32(EV_NO_ACTION),
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	LE32(33U),
+	'S', 'p', 'e', 'c', ' ', 'I', 'D', ' ',
+	'E', 'v', 'e', 'n', 't', '0', '3', 0,
+	LE32(PLATFORM_CLASS_CLIENT), 0, 2, 2, 1, LE32(1U),
+	LE16(TPM_ALG_SHA256), LE16(32U),
+	0,
+
+	/* Startup Locality event */
+	LE32(PCR_0), LE32(EV_NO_ACTION), LE32(1U),
+	LE16(TPM_ALG_SHA256),
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	LE32(17U),
+	'S', 't', 'a', 'r', 't', 'u', 'p', 'L',
+	'o', 'c', 'a', 'l', 'i', 't', 'y', 0,
+	0,
+
+	IMAGE_EVENT(DIGEST_ABC, 5U, 'B', 'L', '_', '2', 0),
+	IMAGE_EVENT(DIGEST_EMPTY, 10U,
+		    'F', 'W', '_', 'C', 'O', 'N', 'F', 'I', 'G', 0),
+	IMAGE_EVENT(DIGEST_448, 14U,
+		    'S', 'E', 'C', 'U', 'R', 'E', '_', 'R', 'T', '_',
+		    'E', 'L', '3', 0),
+	IMAGE_EVENT(DIGEST_MILLION_A, 6U, 'B', 'L', '_', '3', '3', 0),
+};
+
+#define ZERO_DIGEST_DUMP						\
+	"       Digest        : 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00\n" \
+	"\t\t      : 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00\n"
+
+#define IMAGE_EVENT_DUMP(_digest, _event_size, _event)			\
+	"PCR_Event2:\n"							\
+	"  PCRIndex           : 0\n"					\
+	"  EventType          : 1\n"					\
+	"  Digests Count      : 1\n"					\
+	"    #0 AlgorithmId   : SHA256\n"				\
+	_digest								\
+	"  EventSize          : " _event_size "\n"			\
+	"  Event              : " _event "\n"
+
+static const char known_dump[] =
+	"TCG_EfiSpecIDEvent:\n"
+	"  PCRIndex           : 0\n"
+	"  EventType          : 3\n"
+	"  Digest             : 00\n"
+	"\t\t      : 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00\n"
+	"\t\t      : 00 00 00\n"
+	"  EventSize          : 33\n"
+	"  Signature          : Spec ID Event03\n"
+	"  PlatformClass      : 0\n"
+	"  SpecVersion        : 2.0.2\n"
+	"  UintnSize          : 1\n"
+	"  NumberOfAlgorithms : 1\n"
+	"  DigestSizes        :\n"
+	"    #0 AlgorithmId   : SHA256\n"
+	"       DigestSize    : 32\n"
+	"  VendorInfoSize     : 0\n"
+	"PCR_Event2:\n"
+	"  PCRIndex           : 0\n"
+	"  EventType          : 3\n"
+	"  Digests Count      : 1\n"
+	"    #0 AlgorithmId   : SHA256\n"
+	ZERO_DIGEST_DUMP
+	"  EventSize          : 17\n"
+	"  Signature          : StartupLocality\n"
+	"  StartupLocality    : 0\n"
+	IMAGE_EVENT_DUMP(
+	"       Digest        : ba 78 16 bf 8f 01 cf ea 41 41 40 de 5d ae 22 23\n"
+	"\t\t      : b0 03 61 a3 96 17 7a 9c b4 10 ff 61 f2 00 15 ad\n",
+	"5", "BL_2")
+	IMAGE_EVENT_DUMP(
+	"       Digest        : e3 b0 c4 42 98 fc 1c 14 9a fb f4 c8 99 6f b9 24\n"
+	"\t\t      : 27 ae 41 e4 64 9b 93 4c a4 95 99 1b 78 52 b8 55\n",
+	"10", "FW_CONFIG")
+	IMAGE_EVENT_DUMP(
+	"       Digest        : 24 8d 6a 61 d2 06 38 b8 e5 c0 26 93 0c 3e 60 39\n"
+	"\t\t      : a3 3c e4 59 64 ff 21 67 f6 ec ed d4 19 db 06 c1\n",
+	"14", "SECURE_RT_EL3")
+	IMAGE_EVENT_DUMP(
+	"       Digest        : cd c7 6e 5c 99 14 fb 92 81 a1 c7 e2 84 d7 3e 67\n"
+	"\t\t      : f1 80 9a 48 a4 97 20 0e 04 6d 39 cc c7 11 2c d0\n",
+	"6", "BL_33");
+
+static const event_log_metadata_t metadata[] = {
+	{ BL2_IMAGE_ID, EVLOG_BL2_STRING, PCR_0 },
+	{ FW_CONFIG_ID, EVLOG_FW_CONFIG_STRING, PCR_0 },
+	{ BL31_IMAGE_ID, EVLOG_BL31_STRING, PCR_0 },
+	{ BL33_IMAGE_ID, EVLOG_BL33_STRING, PCR_0 },
+	{ EVLOG_INVALID_ID, NULL, (unsigned int)(-1) }
+};
+
+/* DigestInfo headers, the digest follows */
+static const uint8_t sha256_info[] = {
+	0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+	0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20
+};
+static const uint8_t sha256_info_no_params[] = {
+	0x30, 0x2f, 0x30, 0x0b, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+	0x65, 0x03, 0x04, 0x02, 0x01, 0x04, 0x20
+};
+static const uint8_t sha512_info[] = {
+	0x30, 0x51, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+	0x65, 0x03, 0x04, 0x02, 0x03, 0x05, 0x00, 0x04, 0x40
+};
+
+#define MILLION_A_SIZE		1000000U
+
+/* Image, and the DigestInfo authentication checked for it if any */
+static struct {
+	unsigned int id;
+	const uint8_t *data;
+	uint32_t size;
+	const uint8_t *info_header;
+	unsigned int info_header_len;
+	uint8_t digest_info[CRYPTO_MD_MAX_SIZE + 32U];
+	unsigned int digest_info_len;
+} images[] = {
+	/* BL2 is measured by BL1, authenticated without a digest here */
+	{ BL2_IMAGE_ID, (const uint8_t *)"abc", 3U },
+	{ FW_CONFIG_ID, (const uint8_t *)"", 0U,
+	  sha256_info_no_params, sizeof(sha256_info_no_params) },
+	{ BL31_IMAGE_ID,
+	  (const uint8_t *)"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+	  56U, sha256_info, sizeof(sha256_info) },
+	/* A digest of another algorithm, the image must be hashed again */
+	{ BL33_IMAGE_ID, NULL, MILLION_A_SIZE,
+	  sha512_info, sizeof(sha512_info) },
+};
+
+#define NR_IMAGES		ARRAY_SIZE(images)
+
+static uint8_t million_a[MILLION_A_SIZE];
+static uint8_t log_buf[1024];
+static unsigned int hash_calls;
+static unsigned int failures;
+
+/* Output of the Event Log parser */
+static char dump[4096];
+static size_t dump_len;
+static bool capture;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+static void output(const char *fmt, va_list args)
+{
+	int len;
+
+	if (!capture) {
+		(void)vprintf(fmt, args);
+		return;
+	}
+
+	len = vsnprintf(&dump[dump_len], sizeof(dump) - dump_len, fmt, args);
+	if ((len < 0) || ((size_t)len >= (sizeof(dump) - dump_len))) {
+		printf("FAIL: parser output too large\n");
+		exit(1);
+	}
+	dump_len += (size_t)len;
+}
+
+/* The parser prints the digests with printf(), the host one is replaced */
+int printf(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	output(fmt, args);
+	va_end(args);
+
+	return 0;
+}
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	output(fmt + 1, args);
+	va_end(args);
+}
+
+void console_flush(void)
+{
+}
+
+void __dead2 do_panic(void)
+{
+	capture = false;
+	printf("PANIC\n");
+	exit(1);
+	__builtin_unreachable();
+}
+
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	capture = false;
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+
+const event_log_metadata_t *plat_event_log_get_metadata(void)
+{
+	return metadata;
+}
+
+int crypto_mod_calc_hash(enum crypto_md_algo alg, void *data_ptr,
+			 unsigned int data_len,
+			 unsigned char output[CRYPTO_MD_MAX_SIZE])
+{
+	if (alg != CRYPTO_MD_SHA256) {
+		return -1;
+	}
+
+	hash_calls++;
+	(void)SHA256(data_ptr, data_len, output);
+
+	return 0;
+}
+
+#if TRUSTED_BOARD_BOOT
+/* As auth_mod_verify_img() keeps it, the DigestInfo can only be taken once */
+int auth_mod_get_img_digest(const void *img_ptr, unsigned int img_len,
+			    const void **digest_info,
+			    unsigned int *digest_info_len)
+{
+	unsigned int i;
+
+	for (i = 0U; i < NR_IMAGES; i++) {
+		if ((images[i].data == img_ptr) &&
+		    (images[i].size == img_len) &&
+		    (images[i].digest_info_len != 0U)) {
+			*digest_info = images[i].digest_info;
+			*digest_info_len = images[i].digest_info_len;
+			images[i].digest_info_len = 0U;
+			return 0;
+		}
+	}
+
+	return 1;
+}
+#endif
+
+static void make_images(void)
+{
+	unsigned int i;
+
+	memset(million_a, 'a', sizeof(million_a));
+	images[NR_IMAGES - 1U].data = million_a;
+
+	for (i = 0U; i < NR_IMAGES; i++) {
+		unsigned int len = images[i].info_header_len;
+
+		if (len == 0U) {
+			continue;
+		}
+
+		/* The last byte of the header is the size of the digest */
+		memcpy(images[i].digest_info, images[i].info_header, len);
+		memset(&images[i].digest_info[len], 0,
+		       images[i].info_header[len - 1U]);
+		SHA256(images[i].data, images[i].size,
+		       &images[i].digest_info[len]);
+		images[i].digest_info_len = len + images[i].info_header[len - 1U];
+	}
+}
+
+/* Measure the images, the log must match the known one */
+static void test_record(void)
+{
+	unsigned int before = failures;
+	unsigned int i;
+	size_t size;
+
+	event_log_init(log_buf, log_buf + sizeof(log_buf));
+	event_log_write_header();
+
+	for (i = 0U; i < NR_IMAGES; i++) {
+		CHECK(event_log_measure_and_record((uintptr_t)images[i].data,
+						   images[i].size,
+						   images[i].id) == 0);
+	}
+
+	size = event_log_get_cur_size(log_buf);
+	CHECK(size == sizeof(known_log));
+	CHECK(memcmp(log_buf, known_log, sizeof(known_log)) == 0);
+
+	/* Only BL2 and BL33 have no suitable digest from authentication */
+#if TRUSTED_BOARD_BOOT
+	CHECK(hash_calls == 2U);
+#else
+	CHECK(hash_calls == NR_IMAGES);
+#endif
+
+	if (failures == before) {
+		printf("PASS: record\n");
+	}
+}
+
+/* Print the known log, the parser output must match the known dump */
+static void test_parse(void)
+{
+	unsigned int before = failures;
+	uint8_t log[sizeof(known_log)];
+
+	memcpy(log, known_log, sizeof(log));
+
+	capture = true;
+	dump_event_log(log, sizeof(log));
+	capture = false;
+
+	CHECK(dump_len == strlen(known_dump));
+	CHECK(strcmp(dump, known_dump) == 0);
+	CHECK(memcmp(log, known_log, sizeof(log)) == 0);
+
+	if (failures == before) {
+		printf("PASS: parse\n");
+	}
+}
+
+int main(void)
+{
+	make_images();
+
+	test_record();
+	test_parse();
+
+	if (failures != 0U) {
+		printf("FAIL: event_log, %u failures\n", failures);
+		return 1;
+	}
+
+	printf("PASS: event_log\n");
+	return 0;
+}
@@ -0,0 +1,153 @@
+#!/bin/sh
+#
+# Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+# Check fiptool on synthetic images: unpack gives back the packed images,
+# info --verbose prints their SHA-256, and an update in place gives the same
+# FIP as an update written to another file. With -b, time the commands on a
+# large FIP instead (BENCH_IMAGE_MB per image, 64 MiB by default).
+#
+# Usage: fiptool_test.sh [-b] [path to fiptool]
+
+BENCH=0
+if [ "$1" = "-b" ]; then
+	BENCH=1
+	shift
+fi
+
+FIPTOOL=$(realpath "${1:-../fiptool/fiptool}")
+BENCH_IMAGE_MB=${BENCH_IMAGE_MB:-64}
+IMAGES="tb-fw soc-fw tos-fw tos-fw-extra1 tos-fw-extra2 nt-fw fw-config \
+	hw-config nt-fw-config"
+
+TMP_DIR=$(mktemp -d)
+trap 'rm -rf "${TMP_DIR}"' EXIT
+cd "${TMP_DIR}" || exit 1
+failures=0
+
+fail() {
+	echo "FAIL: $1"
+	failures=$((failures + 1))
+}
+
+# $1: test name, $2: failures before the test
+pass() {
+	[ ${failures} -eq $2 ] && echo "PASS: $1"
+}
+
+# $1: file, $2: size in KiB
+make_image() {
+	head -c $(($2 * 1024)) /dev/urandom > "$1"
+}
+
+# $1: size of the first image in KiB, the next ones are smaller
+make_images() {
+	size=$1
+	opts=
+	for i in ${IMAGES}; do
+		make_image "$i.bin" ${size}
+		opts="${opts} --$i $i.bin"
+		size=$((size * 3 / 4 + 1))
+	done
+	echo "${opts}"
+}
+
+now_ms() {
+	echo $(($(date +%s%N) / 1000000))
+}
+
+# $1: label, $2: FIP size, then the command
+timed() {
+	label=$1
+	bytes=$2
+	shift 2
+	start=$(now_ms)
+	"$@" > /dev/null 2>&1 || exit 1
+	ms=$(($(now_ms) - start))
+	printf '  %-32s %6d ms  %6d MiB/s\n' "${label}" ${ms} \
+		$((bytes * 1000 / 1048576 / (ms + 1)))
+}
+
+if [ ${BENCH} -eq 1 ]; then
+	opts=$(make_images $((BENCH_IMAGE_MB * 1024)))
+	"${FIPTOOL}" create ${opts} fip.bin > /dev/null || exit 1
+	size=$(stat -c %s fip.bin)
+	make_image new.bin 64
+
+	echo "fiptool: $(echo ${IMAGES} | wc -w) images, $((size / 1048576)) MiB FIP"
+	sync
+	timed "create" ${size} "${FIPTOOL}" create ${opts} fip.bin
+	timed "info --verbose (SHA-256)" ${size} \
+		"${FIPTOOL}" --verbose info fip.bin
+	timed "update, last image, in place" ${size} \
+		"${FIPTOOL}" update --nt-fw-config new.bin fip.bin
+	timed "update, first image, in place" ${size} \
+		"${FIPTOOL}" update --tb-fw new.bin fip.bin
+	timed "update, last image, --out" ${size} \
+		"${FIPTOOL}" update --nt-fw-config tb-fw.bin --out out.bin fip.bin
+	mkdir unpack
+	timed "unpack" ${size} "${FIPTOOL}" unpack --out unpack fip.bin
+	exit 0
+fi
+
+# Pack and unpack
+opts=$(make_images 300)
+"${FIPTOOL}" create ${opts} fip.bin > /dev/null || exit 1
+mkdir unpack
+"${FIPTOOL}" unpack --out unpack fip.bin > /dev/null || exit 1
+for i in ${IMAGES}; do
+	if ! cmp -s "$i.bin" "unpack/$i.bin"; then
+		fail "unpack: $i differs"
+	fi
+done
+pass "create and unpack" 0
+
+# Image digests
+before=${failures}
+"${FIPTOOL}" --verbose info fip.bin 2> /dev/null > info.txt
+for i in ${IMAGES}; do
+	sum=$(sha256sum "$i.bin" | cut -d ' ' -f 1)
+	if ! grep -q "cmdline=\"--$i\", sha256=${sum}\$" info.txt; then
+		fail "info: wrong SHA-256 for $i"
+	fi
+done
+pass "info --verbose" ${before}
+
+# $1: test name, then the update options
+check_update() {
+	name=$1
+	shift
+	cp fip.bin in_place.bin
+	"${FIPTOOL}" update "$@" --out repacked.bin fip.bin > /dev/null &&
+	"${FIPTOOL}" update "$@" in_place.bin > /dev/null || {
+		fail "${name}: update failed"
+		return
+	}
+	if cmp -s in_place.bin repacked.bin; then
+		echo "PASS: ${name}"
+	else
+		fail "${name}: in place and repacked FIPs differ"
+	fi
+}
+
+make_image small.bin 1
+make_image large.bin 400
+cp nt-fw-config.bin same.bin
+
+check_update "update, same image" --nt-fw-config same.bin
+check_update "update, last image smaller" --nt-fw-config small.bin
+check_update "update, last image larger" --nt-fw-config large.bin
+check_update "update, first image smaller" --tb-fw small.bin
+check_update "update, first image larger" --tb-fw large.bin
+check_update "update, middle image, aligned" --align 4096 --nt-fw large.bin
+check_update "update, new image" --tos-fw-config small.bin
+check_update "update, two images" --soc-fw small.bin --hw-config large.bin
+
+if [ ${failures} -ne 0 ]; then
+	echo "FAIL: fiptool, ${failures} failures"
+	exit 1
+fi
+
+echo "PASS: fiptool"
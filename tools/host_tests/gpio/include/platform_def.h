@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PLATFORM_DEF_H
+#define PLATFORM_DEF_H
+
+#include <dt-bindings/gpio/stm32-gpio.h>
+#include <lib/utils_def.h>
+
+/* Host build of the GPIO driver, with the STM32MP15 platform interface */
+typedef struct boot_api_context boot_api_context_t;
+
+#include <stm32mp_common.h>
+#include <stm32mp_dt.h>
+#include <stm32mp_shared_resources.h>
+
+#endif /* PLATFORM_DEF_H */
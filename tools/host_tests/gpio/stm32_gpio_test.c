@@ -0,0 +1,747 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the GPIO driver pin control, built as in BL32 on STM32MP15
+ * against emulated GPIO banks. Random pinctrl DTs are applied and the bank
+ * registers are compared with a reference model setting the pins one by one,
+ * as the driver did before the bank batches. The number of register writes,
+ * the clock balance and the secure registration of the pins are checked too.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <common/debug.h>
+#include <drivers/clk.h>
+#include <drivers/st/stm32_gpio.h>
+#include <drivers/st/stm32mp_clkfunc.h>
+#include <lib/utils.h>
+#include <libfdt.h>
+
+#include <platform_def.h>
+
+#define NB_BANKS		11U
+#define NB_PINS			(GPIO_PIN_MAX + 1U)
+#define BANK_NB_REGS		16U
+#define BANK_SIZE		0x400U
+#define BANK_CLOCK(_bank)	(100U + (_bank))
+#define SECR_REG		(GPIO_SECR_OFFSET / sizeof(uint32_t))
+
+#define DT_SIZE			0x4000U
+#define DT_MAX_PINS		128U
+#define RANDOM_RUNS		500U
+
+/* Writes to a bank register by the driver configuring its pins */
+#define PIN_WRITES		6U
+
+#define DT_PINMUX(_bank, _pin, _mode)	(((_bank) << 12) | ((_pin) << 8) | \
+					 (_mode))
+#define DT_MODE_AF(_n)		((_n) + 1U)
+#define DT_MODE_ANALOG		17U
+#define DT_MODE_OUTPUT		18U
+
+/* Pin configuration of a pinctrl node, as written in the test DT */
+struct pin_ref {
+	uint32_t pinmux;
+	int slew_rate;
+	uint32_t pull;
+	bool open_drain;
+	bool output_high;
+	bool output_low;
+};
+
+static uint32_t gpio_regs[NB_BANKS][BANK_NB_REGS];
+static uint32_t expected_regs[NB_BANKS][BANK_NB_REGS];
+static unsigned int reg_writes[NB_BANKS][BANK_NB_REGS];
+static int clk_count[NB_BANKS];
+static uint32_t secure_pins[NB_BANKS];
+static uint32_t non_secure_pins[NB_BANKS];
+
+static uint8_t dt_buf[DT_SIZE];
+static struct pin_ref pin_refs[DT_MAX_PINS];
+static unsigned int nb_pin_refs;
+
+static uint64_t prng_state = 0x2545F4914F6CDD1DULL;
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+#define DT_CHECK(_call)							\
+	do {								\
+		if ((_call) != 0) {					\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_call);					\
+			exit(EXIT_FAILURE);				\
+		}							\
+	} while (false)
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	(void)vprintf(fmt + 1, args);
+	va_end(args);
+}
+
+/* Called by panic(), exit() flushes the host output */
+void console_flush(void)
+{
+}
+
+void __dead2 do_panic(void)
+{
+	printf("PANIC\n");
+	exit(1);
+	__builtin_unreachable();
+}
+
+#if ENABLE_ASSERTIONS
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+#endif
+
+void zeromem(void *mem, u_register_t length)
+{
+	memset(mem, 0, length);
+}
+
+/* Platform interface of the driver */
+uintptr_t stm32_get_gpio_bank_base(unsigned int bank)
+{
+	CHECK(bank < NB_BANKS);
+
+	return (uintptr_t)gpio_regs[bank];
+}
+
+unsigned long stm32_get_gpio_bank_clock(unsigned int bank)
+{
+	return BANK_CLOCK(bank);
+}
+
+uint32_t stm32_get_gpio_bank_offset(unsigned int bank)
+{
+	return bank * BANK_SIZE;
+}
+
+bool stm32_gpio_is_secure_at_reset(unsigned int bank)
+{
+	return (bank % 2U) != 0U;
+}
+
+int fdt_get_address(void **fdt_addr)
+{
+	*fdt_addr = dt_buf;
+
+	return 1;
+}
+
+/* Same as the platform, from the node status and secure-status */
+uint8_t fdt_get_status(int node)
+{
+	uint8_t status = DT_DISABLED;
+	const char *cchar;
+
+	cchar = fdt_getprop(dt_buf, node, "status", NULL);
+	if ((cchar == NULL) || (strcmp(cchar, "okay") == 0)) {
+		status |= DT_NON_SECURE;
+	}
+
+	cchar = fdt_getprop(dt_buf, node, "secure-status", NULL);
+	if (((cchar == NULL) && (status == DT_NON_SECURE)) ||
+	    ((cchar != NULL) && (strcmp(cchar, "okay") == 0))) {
+		status |= DT_SECURE;
+	}
+
+	return status;
+}
+
+int fdt_get_clock_id(int node)
+{
+	const fdt32_t *cuint;
+
+	cuint = fdt_getprop(dt_buf, node, "clocks", NULL);
+	if (cuint == NULL) {
+		return -FDT_ERR_NOTFOUND;
+	}
+
+	return (int)fdt32_to_cpu(cuint[1]);
+}
+
+int clk_enable(unsigned long id)
+{
+	CHECK((id >= BANK_CLOCK(0U)) && (id < BANK_CLOCK(NB_BANKS)));
+	clk_count[id - BANK_CLOCK(0U)]++;
+
+	return 0;
+}
+
+void clk_disable(unsigned long id)
+{
+	CHECK((id >= BANK_CLOCK(0U)) && (id < BANK_CLOCK(NB_BANKS)));
+	clk_count[id - BANK_CLOCK(0U)]--;
+}
+
+void stm32mp_register_secure_gpio(unsigned int bank, unsigned int pin)
+{
+	secure_pins[bank] |= BIT(pin);
+}
+
+void stm32mp_register_non_secure_gpio(unsigned int bank, unsigned int pin)
+{
+	non_secure_pins[bank] |= BIT(pin);
+}
+
+void mmio_write_hook(uintptr_t addr, uint32_t value)
+{
+	uintptr_t offset = addr - (uintptr_t)gpio_regs;
+
+	CHECK(offset < sizeof(gpio_regs));
+	reg_writes[offset / sizeof(gpio_regs[0])]
+		  [(offset % sizeof(gpio_regs[0])) / sizeof(uint32_t)]++;
+}
+
+static uint32_t prng(void)
+{
+	prng_state ^= prng_state >> 12;
+	prng_state ^= prng_state << 25;
+	prng_state ^= prng_state >> 27;
+
+	return (uint32_t)((prng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* Banks start from random values, the model starts from the same ones */
+static void reset_banks(void)
+{
+	unsigned int b;
+	unsigned int r;
+
+	for (b = 0U; b < NB_BANKS; b++) {
+		for (r = 0U; r < BANK_NB_REGS; r++) {
+			gpio_regs[b][r] = prng();
+		}
+	}
+
+	memcpy(expected_regs, gpio_regs, sizeof(gpio_regs));
+	memset(reg_writes, 0, sizeof(reg_writes));
+	memset(clk_count, 0, sizeof(clk_count));
+	memset(secure_pins, 0, sizeof(secure_pins));
+	memset(non_secure_pins, 0, sizeof(non_secure_pins));
+	nb_pin_refs = 0U;
+}
+
+static unsigned int total_writes(unsigned int reg_min, unsigned int reg_max)
+{
+	unsigned int count = 0U;
+	unsigned int b;
+	unsigned int r;
+
+	for (b = 0U; b < NB_BANKS; b++) {
+		for (r = reg_min; r <= reg_max; r++) {
+			count += reg_writes[b][r];
+		}
+	}
+
+	return count;
+}
+
+static void model_field(uint32_t *regs, uint32_t offset, uint32_t mask,
+			uint32_t shift, uint32_t value)
+{
+	uint32_t *reg = &regs[offset / sizeof(uint32_t)];
+
+	*reg = (*reg & ~(mask << shift)) | ((value & mask) << shift);
+}
+
+/* Reference: the pin set alone, as by the per-pin driver */
+static void model_set_pin(uint32_t bank, uint32_t pin, uint32_t mode,
+			  uint32_t type, uint32_t speed, uint32_t pull,
+			  uint32_t od, uint32_t alternate, uint8_t status)
+{
+	uint32_t *regs = expected_regs[bank];
+
+	model_field(regs, GPIO_MODE_OFFSET, GPIO_MODE_MASK, pin << 1, mode);
+	model_field(regs, GPIO_TYPE_OFFSET, GPIO_TYPE_MASK, pin, type);
+	model_field(regs, GPIO_SPEED_OFFSET, GPIO_SPEED_MASK, pin << 1, speed);
+	model_field(regs, GPIO_PUPD_OFFSET, GPIO_PULL_MASK, pin << 1, pull);
+	if (pin < GPIO_ALT_LOWER_LIMIT) {
+		model_field(regs, GPIO_AFRL_OFFSET, GPIO_ALTERNATE_MASK,
+			    pin << 2, alternate);
+	} else {
+		model_field(regs, GPIO_AFRH_OFFSET, GPIO_ALTERNATE_MASK,
+			    (pin - GPIO_ALT_LOWER_LIMIT) << 2, alternate);
+	}
+	model_field(regs, GPIO_OD_OFFSET, GPIO_OD_MASK, pin, od);
+	model_field(regs, GPIO_SECR_OFFSET, 1U, pin,
+		    (status == DT_SECURE) ? 1U : 0U);
+}
+
+/* Reference: the pinctrl DT bindings of the pins of a group */
+static void model_pin_ref(const struct pin_ref *ref, uint8_t status)
+{
+	uint32_t bank = (ref->pinmux >> 12) & 0x1FU;
+	uint32_t pin = (ref->pinmux >> 8) & 0xFU;
+	uint32_t dt_mode = ref->pinmux & 0xFFU;
+	uint32_t mode = GPIO_MODE_OUTPUT;
+	uint32_t alternate = 0U;
+	uint32_t od = GPIO_OD_OUTPUT_LOW;
+
+	if (dt_mode == 0U) {
+		mode = GPIO_MODE_INPUT;
+	} else if (dt_mode <= 16U) {
+		mode = GPIO_MODE_ALTERNATE;
+		alternate = dt_mode - 1U;
+	} else if (dt_mode == DT_MODE_ANALOG) {
+		mode = GPIO_MODE_ANALOG;
+	}
+
+	if (ref->output_high && (mode == GPIO_MODE_INPUT)) {
+		mode = GPIO_MODE_OUTPUT;
+		od = GPIO_OD_OUTPUT_HIGH;
+	}
+
+	if (ref->output_low && (mode == GPIO_MODE_INPUT)) {
+		mode = GPIO_MODE_OUTPUT;
+		od = GPIO_OD_OUTPUT_LOW;
+	}
+
+	model_set_pin(bank, pin, mode,
+		      ref->open_drain ? GPIO_TYPE_OPEN_DRAIN :
+					GPIO_TYPE_PUSH_PULL,
+		      (ref->slew_rate < 0) ? GPIO_SPEED_LOW :
+					     (uint32_t)ref->slew_rate,
+		      ref->pull, od, alternate, status);
+}
+
+static void dt_begin(void)
+{
+	unsigned int b;
+
+	DT_CHECK(fdt_create(dt_buf, sizeof(dt_buf)));
+	DT_CHECK(fdt_finish_reservemap(dt_buf));
+	DT_CHECK(fdt_begin_node(dt_buf, ""));
+	DT_CHECK(fdt_begin_node(dt_buf, "pinctrl@50002000"));
+
+	for (b = 0U; b < NB_BANKS; b++) {
+		char name[16];
+		fdt32_t clocks[2] = {
+			cpu_to_fdt32(1U), cpu_to_fdt32(BANK_CLOCK(b))
+		};
+
+		snprintf(name, sizeof(name), "gpio@%x",
+			 stm32_get_gpio_bank_offset(b));
+		DT_CHECK(fdt_begin_node(dt_buf, name));
+		DT_CHECK(fdt_property(dt_buf, "gpio-controller", NULL, 0));
+		DT_CHECK(fdt_property_u32(dt_buf, "reg",
+					  stm32_get_gpio_bank_offset(b)));
+		DT_CHECK(fdt_property(dt_buf, "clocks", clocks,
+				      sizeof(clocks)));
+		DT_CHECK(fdt_property_string(dt_buf, "status", "okay"));
+		DT_CHECK(fdt_end_node(dt_buf));
+	}
+}
+
+/* Group of pins, with a phandle equal to its index plus one */
+static void dt_begin_group(unsigned int index)
+{
+	char name[16];
+
+	snprintf(name, sizeof(name), "group%u", index);
+	DT_CHECK(fdt_begin_node(dt_buf, name));
+	DT_CHECK(fdt_property_u32(dt_buf, "phandle", index + 1U));
+}
+
+static void dt_add_pins(unsigned int index, const struct pin_ref *refs,
+			unsigned int nb_refs)
+{
+	fdt32_t pinmux[DT_MAX_PINS];
+	char name[16];
+	unsigned int i;
+
+	for (i = 0U; i < nb_refs; i++) {
+		pinmux[i] = cpu_to_fdt32(refs[i].pinmux);
+	}
+
+	snprintf(name, sizeof(name), "pins%u", index);
+	DT_CHECK(fdt_begin_node(dt_buf, name));
+	DT_CHECK(fdt_property(dt_buf, "pinmux", pinmux,
+			      nb_refs * sizeof(fdt32_t)));
+
+	if (refs[0].slew_rate >= 0) {
+		DT_CHECK(fdt_property_u32(dt_buf, "slew-rate",
+					  (uint32_t)refs[0].slew_rate));
+	}
+
+	if (refs[0].pull == GPIO_PULL_UP) {
+		DT_CHECK(fdt_property(dt_buf, "bias-pull-up", NULL, 0));
+	} else if (refs[0].pull == GPIO_PULL_DOWN) {
+		DT_CHECK(fdt_property(dt_buf, "bias-pull-down", NULL, 0));
+	} else {
+		DT_CHECK(fdt_property(dt_buf, "bias-disable", NULL, 0));
+	}
+
+	if (refs[0].open_drain) {
+		DT_CHECK(fdt_property(dt_buf, "drive-open-drain", NULL, 0));
+	}
+
+	if (refs[0].output_high) {
+		DT_CHECK(fdt_property(dt_buf, "output-high", NULL, 0));
+	}
+
+	if (refs[0].output_low) {
+		DT_CHECK(fdt_property(dt_buf, "output-low", NULL, 0));
+	}
+
+	DT_CHECK(fdt_end_node(dt_buf));
+}
+
+/* Ends the pinctrl node and adds the device using the given phandles */
+static int dt_end(const uint32_t *phandles, unsigned int nb_phandles,
+		  bool secure)
+{
+	fdt32_t pinctrl[8];
+	unsigned int i;
+	int node;
+
+	for (i = 0U; i < nb_phandles; i++) {
+		pinctrl[i] = cpu_to_fdt32(phandles[i]);
+	}
+
+	DT_CHECK(fdt_end_node(dt_buf));
+	DT_CHECK(fdt_begin_node(dt_buf, "device@40000000"));
+	DT_CHECK(fdt_property(dt_buf, "pinctrl-0", pinctrl,
+			      nb_phandles * sizeof(fdt32_t)));
+	if (secure) {
+		DT_CHECK(fdt_property_string(dt_buf, "status", "disabled"));
+		DT_CHECK(fdt_property_string(dt_buf, "secure-status", "okay"));
+	} else {
+		DT_CHECK(fdt_property_string(dt_buf, "status", "okay"));
+	}
+	DT_CHECK(fdt_end_node(dt_buf));
+	DT_CHECK(fdt_end_node(dt_buf));
+	DT_CHECK(fdt_finish(dt_buf));
+
+	node = fdt_path_offset(dt_buf, "/device@40000000");
+	CHECK(node >= 0);
+
+	return node;
+}
+
+static void set_node_properties(struct pin_ref *refs, unsigned int nb_refs)
+{
+	struct pin_ref node_cfg = {
+		.slew_rate = (int)(prng() % 5U) - 1,
+		.pull = prng() % 3U,
+		.open_drain = (prng() % 4U) == 0U,
+		.output_high = (prng() % 4U) == 0U,
+		.output_low = (prng() % 8U) == 0U,
+	};
+	unsigned int i;
+
+	for (i = 0U; i < nb_refs; i++) {
+		node_cfg.pinmux = refs[i].pinmux;
+		refs[i] = node_cfg;
+	}
+}
+
+static bool check_banks(const char *name)
+{
+	unsigned int b;
+	bool ok = true;
+
+	for (b = 0U; b < NB_BANKS; b++) {
+		unsigned int r;
+
+		for (r = 0U; r < BANK_NB_REGS; r++) {
+			if (gpio_regs[b][r] != expected_regs[b][r]) {
+				printf("FAIL: %s: bank %u reg 0x%x: 0x%x, 0x%x expected\n",
+				       name, b, r * 4U, gpio_regs[b][r],
+				       expected_regs[b][r]);
+				ok = false;
+			}
+		}
+
+		if (clk_count[b] != 0) {
+			printf("FAIL: %s: bank %u clock left at %d\n",
+			       name, b, clk_count[b]);
+			ok = false;
+		}
+	}
+
+	if (!ok) {
+		failures++;
+	}
+
+	return ok;
+}
+
+/* Pins used by the DT, per bank */
+static void dt_pins(uint32_t *pins)
+{
+	unsigned int i;
+
+	memset(pins, 0, NB_BANKS * sizeof(uint32_t));
+
+	for (i = 0U; i < nb_pin_refs; i++) {
+		pins[(pin_refs[i].pinmux >> 12) & 0x1FU] |=
+			BIT((pin_refs[i].pinmux >> 8) & 0xFU);
+	}
+}
+
+/* A full bank in one node: each register is written once */
+static void test_full_bank(void)
+{
+	uint32_t phandle = 1U;
+	unsigned int i;
+	int node;
+
+	reset_banks();
+
+	dt_begin();
+	dt_begin_group(0U);
+	for (i = 0U; i < NB_PINS; i++) {
+		pin_refs[i].pinmux = DT_PINMUX(2U, i, DT_MODE_AF(i));
+	}
+	nb_pin_refs = NB_PINS;
+	set_node_properties(pin_refs, nb_pin_refs);
+	dt_add_pins(0U, pin_refs, nb_pin_refs);
+	DT_CHECK(fdt_end_node(dt_buf));
+	node = dt_end(&phandle, 1U, false);
+
+	for (i = 0U; i < nb_pin_refs; i++) {
+		model_pin_ref(&pin_refs[i], DT_SHARED);
+	}
+
+	CHECK(dt_set_pinctrl_config(node) == 0);
+	check_banks(__func__);
+
+	/* MODE, TYPE, SPEED, PUPD, OD, AFRL and AFRH, then SECR */
+	CHECK(total_writes(0U, BANK_NB_REGS - 1U) == 8U);
+	CHECK(reg_writes[2][SECR_REG] == 1U);
+	CHECK(non_secure_pins[2] == 0xFFFFU);
+	CHECK(secure_pins[2] == 0U);
+
+	printf("PASS: full bank, %u writes, %u pin by pin\n",
+	       total_writes(0U, BANK_NB_REGS - 1U),
+	       NB_PINS * (PIN_WRITES + 1U));
+}
+
+/* More banks than a batch holds: the first ones are written first */
+static void test_batch_flush(void)
+{
+	uint32_t phandles[2] = { 1U, 2U };
+	unsigned int b;
+	unsigned int i;
+	int node;
+
+	reset_banks();
+
+	dt_begin();
+	dt_begin_group(0U);
+	for (b = 0U; b < 5U; b++) {
+		pin_refs[b].pinmux = DT_PINMUX(b, 3U, DT_MODE_OUTPUT);
+	}
+	set_node_properties(pin_refs, 5U);
+	dt_add_pins(0U, pin_refs, 5U);
+	DT_CHECK(fdt_end_node(dt_buf));
+
+	/* Bank 0 again, pin 3 is set a second time */
+	dt_begin_group(1U);
+	pin_refs[5].pinmux = DT_PINMUX(0U, 3U, 0U);
+	pin_refs[6].pinmux = DT_PINMUX(0U, 4U, DT_MODE_ANALOG);
+	set_node_properties(&pin_refs[5], 2U);
+	dt_add_pins(0U, &pin_refs[5], 2U);
+	DT_CHECK(fdt_end_node(dt_buf));
+	nb_pin_refs = 7U;
+	node = dt_end(phandles, 2U, true);
+
+	for (i = 0U; i < nb_pin_refs; i++) {
+		model_pin_ref(&pin_refs[i], DT_SECURE);
+	}
+
+	CHECK(dt_set_pinctrl_config(node) == 0);
+	check_banks(__func__);
+
+	/* Banks 0 to 3, then banks 4 and 0, with pins using AFRL only */
+	CHECK(total_writes(0U, SECR_REG - 1U) == 6U * PIN_WRITES);
+	CHECK(total_writes(SECR_REG, SECR_REG) == 6U);
+	CHECK(reg_writes[0][SECR_REG] == 2U);
+	CHECK(secure_pins[0] == (BIT(3) | BIT(4)));
+	for (b = 1U; b < 5U; b++) {
+		CHECK(secure_pins[b] == BIT(3));
+	}
+	CHECK(non_secure_pins[0] == 0U);
+
+	printf("PASS: batch flush\n");
+}
+
+/* Pins of the groups before an error are set */
+static void test_bad_phandle(void)
+{
+	uint32_t phandles[2] = { 1U, 99U };
+	int node;
+
+	reset_banks();
+
+	dt_begin();
+	dt_begin_group(0U);
+	pin_refs[0].pinmux = DT_PINMUX(7U, 12U, DT_MODE_AF(5U));
+	set_node_properties(pin_refs, 1U);
+	dt_add_pins(0U, pin_refs, 1U);
+	DT_CHECK(fdt_end_node(dt_buf));
+	nb_pin_refs = 1U;
+	node = dt_end(phandles, 2U, false);
+
+	model_pin_ref(&pin_refs[0], DT_SHARED);
+
+	CHECK(dt_set_pinctrl_config(node) == -FDT_ERR_NOTFOUND);
+	check_banks(__func__);
+
+	printf("PASS: bad phandle\n");
+}
+
+static void test_random(void)
+{
+	unsigned int run;
+	unsigned int batched = 0U;
+	unsigned int pin_by_pin = 0U;
+
+	for (run = 0U; run < RANDOM_RUNS; run++) {
+		uint32_t phandles[4];
+		uint32_t pins[NB_BANKS];
+		unsigned int nb_groups = 1U + (prng() % 4U);
+		unsigned int nb_banks = 1U + (prng() % NB_BANKS);
+		bool secure = (prng() % 2U) == 0U;
+		unsigned int g;
+		unsigned int i;
+		unsigned int b;
+		int node;
+
+		reset_banks();
+		dt_begin();
+
+		for (g = 0U; g < nb_groups; g++) {
+			unsigned int nb_nodes = 1U + (prng() % 3U);
+			unsigned int n;
+
+			dt_begin_group(g);
+			phandles[g] = g + 1U;
+
+			for (n = 0U; n < nb_nodes; n++) {
+				struct pin_ref *refs = &pin_refs[nb_pin_refs];
+				unsigned int nb_refs = 1U + (prng() % 10U);
+
+				for (i = 0U; i < nb_refs; i++) {
+					refs[i].pinmux =
+						DT_PINMUX(prng() % nb_banks,
+							  prng() % NB_PINS,
+							  prng() % 19U);
+				}
+
+				set_node_properties(refs, nb_refs);
+				dt_add_pins(n, refs, nb_refs);
+				nb_pin_refs += nb_refs;
+			}
+
+			DT_CHECK(fdt_end_node(dt_buf));
+		}
+
+		node = dt_end(phandles, nb_groups, secure);
+
+		for (i = 0U; i < nb_pin_refs; i++) {
+			model_pin_ref(&pin_refs[i],
+				      secure ? DT_SECURE : DT_SHARED);
+		}
+
+		CHECK(dt_set_pinctrl_config(node) == 0);
+		if (!check_banks(__func__)) {
+			break;
+		}
+
+		/* Each bank of a batch is written at most once per register */
+		CHECK(total_writes(0U, SECR_REG - 1U) <=
+		      (total_writes(SECR_REG, SECR_REG) * (PIN_WRITES + 1U)));
+		CHECK(total_writes(0U, BANK_NB_REGS - 1U) <=
+		      (nb_pin_refs * (PIN_WRITES + 1U)));
+
+		dt_pins(pins);
+		for (b = 0U; b < NB_BANKS; b++) {
+			CHECK((secure ? secure_pins[b] : non_secure_pins[b]) ==
+			      pins[b]);
+			CHECK((secure ? non_secure_pins[b] : secure_pins[b]) ==
+			      0U);
+		}
+
+		batched += total_writes(0U, BANK_NB_REGS - 1U);
+		pin_by_pin += nb_pin_refs * (PIN_WRITES + 1U);
+	}
+
+	if (run == RANDOM_RUNS) {
+		printf("PASS: %u random DTs, %u writes, %u pin by pin\n", run,
+		       batched, pin_by_pin);
+	}
+}
+
+static void test_single_pin(void)
+{
+	reset_banks();
+
+	set_gpio_config(4U, 9U, GPIOF_OUT_INIT_HIGH | GPIOF_PULL_UP,
+			DT_SECURE);
+	model_set_pin(4U, 9U, GPIO_MODE_OUTPUT, GPIO_TYPE_PUSH_PULL,
+		      GPIO_SPEED_LOW, GPIO_PULL_UP, 1U, 0U, DT_SECURE);
+	CHECK(total_writes(0U, BANK_NB_REGS - 1U) == PIN_WRITES + 1U);
+
+	/* Bank 5 is secure at reset */
+	set_gpio_reset_cfg(5U, 1U);
+	model_set_pin(5U, 1U, GPIO_MODE_ANALOG, GPIO_TYPE_PUSH_PULL,
+		      GPIO_SPEED_LOW, GPIO_NO_PULL, GPIO_OD_OUTPUT_LOW, 0U,
+		      DT_SECURE);
+
+	set_gpio_level(4U, 2U, GPIO_LEVEL_LOW);
+	expected_regs[4][GPIO_BSRR_OFFSET / sizeof(uint32_t)] = BIT(18);
+
+	check_banks(__func__);
+	CHECK(secure_pins[4] == BIT(9));
+	CHECK(non_secure_pins[5] == BIT(1));
+
+	printf("PASS: single pin\n");
+}
+
+int main(void)
+{
+	test_full_bank();
+	test_batch_flush();
+	test_bad_phandle();
+	test_single_pin();
+	test_random();
+
+	if (failures != 0U) {
+		printf("FAIL: stm32_gpio, %u failures\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS: stm32_gpio\n");
+
+	return EXIT_SUCCESS;
+}
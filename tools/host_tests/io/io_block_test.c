@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the block device, with and without direct_read as set on the
+ * STM32MP MMC device: random writes at any offset and length must reach the
+ * device, and read back the same, whatever the user buffer alignment.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <common/debug.h>
+#include <drivers/io/io_block.h>
+#include <drivers/io/io_driver.h>
+#include <drivers/io/io_storage.h>
+#include <lib/utils.h>
+
+#define BLOCK_SIZE		512U
+#define DISK_SIZE		(128U * 1024U)
+#define REGION_OFFSET		(4U * BLOCK_SIZE)
+#define REGION_SIZE		(DISK_SIZE - (8U * BLOCK_SIZE))
+#define RANDOM_OPS		20000U
+
+static uint8_t disk[DISK_SIZE];
+static uint8_t model[DISK_SIZE];
+static uint8_t block_buffer[BLOCK_SIZE] __aligned(BLOCK_SIZE);
+static uint8_t user_buffer[REGION_SIZE + BLOCK_SIZE] __aligned(BLOCK_SIZE);
+static uint8_t read_buffer[REGION_SIZE + BLOCK_SIZE] __aligned(BLOCK_SIZE);
+static uint8_t write_data[REGION_SIZE];
+
+static unsigned long dev_reads;
+static unsigned long dev_writes;
+static uint32_t seed = 1U;
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+void zeromem(void *mem, u_register_t length)
+{
+	memset(mem, 0, length);
+}
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	(void)vprintf(fmt + 1, args);
+	va_end(args);
+}
+
+void __dead2 do_panic(void)
+{
+	printf("PANIC\n");
+	exit(1);
+	__builtin_unreachable();
+}
+
+#if ENABLE_ASSERTIONS
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+#endif
+
+static size_t disk_read(int lba, uintptr_t buf, size_t size)
+{
+	size_t offset = (size_t)lba * BLOCK_SIZE;
+
+	if (((size % BLOCK_SIZE) != 0U) || (offset > DISK_SIZE) ||
+	    (size > (DISK_SIZE - offset))) {
+		return 0U;
+	}
+
+	memcpy((void *)buf, &disk[offset], size);
+	dev_reads++;
+
+	return size;
+}
+
+static size_t disk_write(int lba, const uintptr_t buf, size_t size)
+{
+	size_t offset = (size_t)lba * BLOCK_SIZE;
+
+	if (((size % BLOCK_SIZE) != 0U) || (offset > DISK_SIZE) ||
+	    (size > (DISK_SIZE - offset))) {
+		return 0U;
+	}
+
+	memcpy(&disk[offset], (const void *)buf, size);
+	dev_writes++;
+
+	return size;
+}
+
+static io_block_dev_spec_t block_dev_spec[] = {
+	{
+		.buffer = {
+			.offset = (uintptr_t)block_buffer,
+			.length = BLOCK_SIZE,
+		},
+		.ops = {
+			.read = disk_read,
+			.write = disk_write,
+		},
+		.block_size = BLOCK_SIZE,
+	},
+	{
+		.buffer = {
+			.offset = (uintptr_t)block_buffer,
+			.length = BLOCK_SIZE,
+		},
+		.ops = {
+			.read = disk_read,
+			.write = disk_write,
+		},
+		.block_size = BLOCK_SIZE,
+		.direct_read = true,
+	},
+};
+
+static const io_block_spec_t region = {
+	.offset = REGION_OFFSET,
+	.length = REGION_SIZE,
+};
+
+static uint32_t random_u32(void)
+{
+	/* Numerical Recipes LCG, the upper bits are good enough here */
+	seed = (seed * 1664525U) + 1013904223U;
+
+	return seed >> 8;
+}
+
+/* Write or read length bytes at offset of the region, from or to buf */
+static int transfer(uintptr_t dev_handle, bool write, size_t offset,
+		    size_t length, uint8_t *buf)
+{
+	uintptr_t handle;
+	size_t done = 0U;
+	int ret;
+
+	ret = io_open(dev_handle, (uintptr_t)&region, &handle);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = io_seek(handle, IO_SEEK_SET, (signed long long)offset);
+	if (ret == 0) {
+		if (write) {
+			ret = io_write(handle, (uintptr_t)buf, length, &done);
+		} else {
+			ret = io_read(handle, (uintptr_t)buf, length, &done);
+		}
+	}
+
+	if ((ret == 0) && (done != length)) {
+		ret = -EIO;
+	}
+
+	io_close(handle);
+
+	return ret;
+}
+
+/* Random offsets, lengths and buffer alignments, whole blocks included */
+static size_t random_length(size_t offset)
+{
+	size_t length = (random_u32() % (REGION_SIZE - offset)) + 1U;
+
+	switch (random_u32() % 4U) {
+	case 0U:
+		return length;
+	case 1U:
+		length = round_down(length, BLOCK_SIZE);
+		return (length != 0U) ? length : 1U;
+	default:
+		return MIN(length, (size_t)(3U * BLOCK_SIZE));
+	}
+}
+
+static void test_write_read(uintptr_t dev_handle)
+{
+	unsigned int i;
+	size_t j;
+
+	for (i = 0U; i < RANDOM_OPS; i++) {
+		size_t offset = random_u32() % REGION_SIZE;
+		size_t length;
+		size_t shift;
+
+		if ((random_u32() % 2U) == 0U) {
+			offset = round_down(offset, BLOCK_SIZE);
+		}
+
+		length = random_length(offset);
+		shift = ((random_u32() % 2U) == 0U) ? 0U :
+			(random_u32() % BLOCK_SIZE);
+
+		for (j = 0U; j < length; j++) {
+			write_data[j] = (uint8_t)random_u32();
+		}
+		memcpy(&user_buffer[shift], write_data, length);
+
+		if (transfer(dev_handle, true, offset, length,
+			     &user_buffer[shift]) != 0) {
+			CHECK(false);
+			break;
+		}
+
+		memcpy(&model[REGION_OFFSET + offset], write_data, length);
+
+		/* The source buffer is left untouched by a write */
+		if (memcmp(&user_buffer[shift], write_data, length) != 0) {
+			printf("FAIL: write of %zu bytes at 0x%zx changed the source\n",
+			       length, offset);
+			failures++;
+			break;
+		}
+
+		if (memcmp(disk, model, DISK_SIZE) != 0) {
+			printf("FAIL: write of %zu bytes at 0x%zx\n", length,
+			       offset);
+			failures++;
+			break;
+		}
+
+		offset = random_u32() % REGION_SIZE;
+		length = random_length(offset);
+		shift = ((random_u32() % 2U) == 0U) ? 0U :
+			(random_u32() % BLOCK_SIZE);
+
+		if ((transfer(dev_handle, false, offset, length,
+			      &read_buffer[shift]) != 0) ||
+		    (memcmp(&read_buffer[shift],
+			    &model[REGION_OFFSET + offset], length) != 0)) {
+			printf("FAIL: read of %zu bytes at 0x%zx\n", length,
+			       offset);
+			failures++;
+			break;
+		}
+	}
+}
+
+/* A region written in whole blocks is read back with a single command */
+static void test_direct_read(uintptr_t dev_handle, bool direct_read)
+{
+	unsigned long reads, writes;
+	size_t j;
+
+	for (j = 0U; j < (16U * BLOCK_SIZE); j++) {
+		write_data[j] = (uint8_t)random_u32();
+	}
+	memcpy(user_buffer, write_data, 16U * BLOCK_SIZE);
+
+	reads = dev_reads;
+	writes = dev_writes;
+	CHECK(transfer(dev_handle, true, BLOCK_SIZE, 16U * BLOCK_SIZE,
+		       user_buffer) == 0);
+	CHECK((dev_writes - writes) == 16U);
+	CHECK(dev_reads == reads);
+
+	CHECK(transfer(dev_handle, false, BLOCK_SIZE, 16U * BLOCK_SIZE,
+		       read_buffer) == 0);
+	CHECK(memcmp(read_buffer, write_data, 16U * BLOCK_SIZE) == 0);
+	CHECK((dev_reads - reads) == (direct_read ? 1U : 16U));
+	memcpy(&model[REGION_OFFSET + BLOCK_SIZE], write_data,
+	       16U * BLOCK_SIZE);
+}
+
+int main(void)
+{
+	const io_dev_connector_t *dev_con;
+	uintptr_t dev_handle;
+	unsigned int i;
+	size_t j;
+
+	if (register_io_dev_block(&dev_con) != 0) {
+		printf("FAIL: cannot register the block device\n");
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0U; i < ARRAY_SIZE(block_dev_spec); i++) {
+		unsigned int before = failures;
+		bool direct_read = block_dev_spec[i].direct_read;
+
+		for (j = 0U; j < DISK_SIZE; j++) {
+			disk[j] = (uint8_t)random_u32();
+		}
+		memcpy(model, disk, DISK_SIZE);
+
+		if (io_dev_open(dev_con, (uintptr_t)&block_dev_spec[i],
+				&dev_handle) != 0) {
+			printf("FAIL: cannot open the block device\n");
+			return EXIT_FAILURE;
+		}
+
+		test_write_read(dev_handle);
+		test_direct_read(dev_handle, direct_read);
+
+		io_dev_close(dev_handle);
+
+		if (failures == before) {
+			printf("PASS: write and read back, direct_read %s\n",
+			       direct_read ? "on" : "off");
+		}
+	}
+
+	if (failures != 0U) {
+		printf("FAIL: io_block, %u failures\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS: io_block\n");
+
+	return EXIT_SUCCESS;
+}
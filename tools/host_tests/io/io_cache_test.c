@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the memory-mapped IO device, and of the read cache stacked on
+ * it as on the STM32MP BL2 MMC path: data read through the cache must match
+ * the backend, and sequential or repeated small reads must only issue a few
+ * backend commands.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <common/debug.h>
+#include <drivers/io/io_cache.h>
+#include <drivers/io/io_driver.h>
+#include <drivers/io/io_memmap.h>
+#include <drivers/io/io_storage.h>
+#include <lib/utils.h>
+
+#define BACKEND_SIZE		(256U * 1024U)
+#define LINE_SIZE		512U
+#define NR_LINES		16U
+#define READAHEAD		8U
+#define RANDOM_READS		20000U
+#define SEQ_READ_SIZE		40U
+#define SEQ_LENGTH		(64U * 1024U)
+
+static uint8_t backend[BACKEND_SIZE] __aligned(LINE_SIZE);
+static uint8_t cache_buffer[NR_LINES * LINE_SIZE] __aligned(LINE_SIZE);
+static uint8_t data[BACKEND_SIZE];
+
+static io_cache_dev_spec_t cache_dev_spec = {
+	.buffer = {
+		.length = sizeof(cache_buffer),
+	},
+	.line_size = LINE_SIZE,
+	.readahead = READAHEAD,
+};
+
+static uintptr_t memmap_dev_handle;
+static uintptr_t cache_dev_handle;
+static uint32_t seed = 1U;
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+void zeromem(void *mem, u_register_t length)
+{
+	memset(mem, 0, length);
+}
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	(void)vprintf(fmt + 1, args);
+	va_end(args);
+}
+
+void __dead2 do_panic(void)
+{
+	printf("PANIC\n");
+	exit(1);
+	__builtin_unreachable();
+}
+
+#if ENABLE_ASSERTIONS
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+#endif
+
+static uint32_t random_u32(void)
+{
+	/* Numerical Recipes LCG, the upper bits are good enough here */
+	seed = (seed * 1664525U) + 1013904223U;
+
+	return seed >> 8;
+}
+
+static void fill_backend(void)
+{
+	unsigned int i;
+
+	for (i = 0U; i < BACKEND_SIZE; i++) {
+		backend[i] = (uint8_t)random_u32();
+	}
+}
+
+/* Read length bytes at offset of a region of the backend array */
+static int read_region(uintptr_t dev_handle, size_t base, size_t size,
+		       size_t offset, size_t length, void *buf)
+{
+	io_block_spec_t region = {
+		.offset = (uintptr_t)backend + base,
+		.length = size,
+	};
+	uintptr_t handle;
+	size_t length_read = 0U;
+	int ret;
+
+	ret = io_open(dev_handle, (uintptr_t)&region, &handle);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = io_seek(handle, IO_SEEK_SET, (signed long long)offset);
+	if (ret == 0) {
+		ret = io_read(handle, (uintptr_t)buf, length, &length_read);
+	}
+
+	if ((ret == 0) && (length_read != length)) {
+		ret = -EIO;
+	}
+
+	io_close(handle);
+
+	return ret;
+}
+
+static unsigned long dev_reads(void)
+{
+	io_cache_stats_t stats;
+
+	io_cache_get_stats(&stats);
+
+	return stats.dev_reads;
+}
+
+static void test_memmap(void)
+{
+	io_block_spec_t region = {
+		.offset = (uintptr_t)backend + 1000U,
+		.length = 5000U,
+	};
+	uintptr_t handle, other;
+	size_t length, length_read;
+
+	CHECK(io_open(memmap_dev_handle, (uintptr_t)&region, &handle) == 0);
+	CHECK((io_size(handle, &length) == 0) && (length == region.length));
+
+	CHECK(io_read(handle, (uintptr_t)data, 100U, &length_read) == 0);
+	CHECK((length_read == 100U) &&
+	      (memcmp(data, backend + 1000U, 100U) == 0));
+
+	/* Reads go on from the current position */
+	CHECK(io_read(handle, (uintptr_t)data, 100U, &length_read) == 0);
+	CHECK(memcmp(data, backend + 1100U, 100U) == 0);
+
+	CHECK(io_seek(handle, IO_SEEK_SET, 4990) == 0);
+	CHECK(io_read(handle, (uintptr_t)data, 10U, &length_read) == 0);
+	CHECK(memcmp(data, backend + 5990U, 10U) == 0);
+
+	/* Only IO_SEEK_SET is supported */
+	CHECK(io_seek(handle, IO_SEEK_CUR, 0) != 0);
+
+	/* A single file can be open */
+	CHECK(io_open(memmap_dev_handle, (uintptr_t)&region, &other) != 0);
+	CHECK(io_close(handle) == 0);
+	CHECK(io_open(memmap_dev_handle, (uintptr_t)&region, &other) == 0);
+	CHECK(io_close(other) == 0);
+}
+
+static void test_cache_random(void)
+{
+	unsigned int i;
+
+	for (i = 0U; i < RANDOM_READS; i++) {
+		size_t base = random_u32() % BACKEND_SIZE;
+		size_t size = (random_u32() % (BACKEND_SIZE - base)) + 1U;
+		size_t offset = random_u32() % size;
+		size_t length = random_u32() % (size - offset + 1U);
+
+		/* Mostly small reads, as for headers and tables */
+		if ((random_u32() % 4U) != 0U) {
+			length %= 3U * LINE_SIZE;
+		}
+
+		if (read_region(cache_dev_handle, base, size, offset, length,
+				data) != 0) {
+			CHECK(false);
+			break;
+		}
+
+		if (memcmp(data, backend + base + offset, length) != 0) {
+			printf("FAIL: read %zu bytes at 0x%zx\n", length,
+			       base + offset);
+			failures++;
+			break;
+		}
+	}
+}
+
+static void test_cache_sequential(void)
+{
+	io_block_spec_t region = {
+		.offset = (uintptr_t)backend + (3U * LINE_SIZE),
+		.length = SEQ_LENGTH,
+	};
+	uintptr_t handle;
+	size_t length_read, pos;
+	unsigned long reads;
+	bool match = true;
+
+	io_cache_invalidate();
+	reads = dev_reads();
+
+	CHECK(io_open(cache_dev_handle, (uintptr_t)&region, &handle) == 0);
+	for (pos = 0U; (pos + SEQ_READ_SIZE) <= SEQ_LENGTH;
+	     pos += SEQ_READ_SIZE) {
+		if ((io_read(handle, (uintptr_t)data, SEQ_READ_SIZE,
+			     &length_read) != 0) ||
+		    (memcmp(data, backend + (3U * LINE_SIZE) + pos,
+			    SEQ_READ_SIZE) != 0)) {
+			match = false;
+			break;
+		}
+	}
+	CHECK(io_close(handle) == 0);
+	CHECK(match);
+
+	/* One line for the first miss, then READAHEAD lines per command */
+	reads = dev_reads() - reads;
+	CHECK(reads <= (2U + (SEQ_LENGTH / (READAHEAD * LINE_SIZE))));
+	printf("  sequential: %zu reads of %u bytes, %lu backend commands\n",
+	       (size_t)(SEQ_LENGTH / SEQ_READ_SIZE), SEQ_READ_SIZE, reads);
+}
+
+/* Whole-line reads bypass the cache and do not evict the metadata */
+static void test_cache_bypass(void)
+{
+	unsigned long reads;
+
+	io_cache_invalidate();
+
+	CHECK(read_region(cache_dev_handle, 0U, BACKEND_SIZE, 8U, 92U,
+			  data) == 0);
+	CHECK(read_region(cache_dev_handle, 0U, BACKEND_SIZE, 64U * 1024U,
+			  NR_LINES * 4U * LINE_SIZE, data) == 0);
+	CHECK(memcmp(data, backend + (64U * 1024U),
+		     NR_LINES * 4U * LINE_SIZE) == 0);
+
+	reads = dev_reads();
+	CHECK(read_region(cache_dev_handle, 0U, BACKEND_SIZE, 100U, 28U,
+			  data) == 0);
+	CHECK(memcmp(data, backend + 100U, 28U) == 0);
+	CHECK(dev_reads() == reads);
+}
+
+static void test_cache_bounds(void)
+{
+	io_block_spec_t region = {
+		.offset = (uintptr_t)backend + BACKEND_SIZE - 1000U,
+		.length = 1000U,
+	};
+	uintptr_t handle;
+	size_t length_read;
+
+	CHECK(io_open(cache_dev_handle, (uintptr_t)&region, &handle) == 0);
+	CHECK(io_seek(handle, IO_SEEK_SET, 1001) == -EINVAL);
+	CHECK(io_seek(handle, IO_SEEK_SET, 900) == 0);
+	CHECK(io_read(handle, (uintptr_t)data, 101U, &length_read) == -EINVAL);
+
+	/* The last line is shorter than the others */
+	CHECK(io_read(handle, (uintptr_t)data, 100U, &length_read) == 0);
+	CHECK(memcmp(data, backend + BACKEND_SIZE - 100U, 100U) == 0);
+	CHECK(io_close(handle) == 0);
+}
+
+static void test_cache_invalidate(void)
+{
+	uint8_t val;
+
+	CHECK(read_region(cache_dev_handle, 0U, BACKEND_SIZE, 10U, 1U,
+			  &val) == 0);
+	backend[10] = ~val;
+
+	/* Stale until invalidated, as the device is read-only */
+	CHECK(read_region(cache_dev_handle, 0U, BACKEND_SIZE, 10U, 1U,
+			  &val) == 0);
+	CHECK(val != backend[10]);
+
+	io_cache_invalidate();
+	CHECK(read_region(cache_dev_handle, 0U, BACKEND_SIZE, 10U, 1U,
+			  &val) == 0);
+	CHECK(val == backend[10]);
+}
+
+int main(void)
+{
+	const io_dev_connector_t *memmap_dev_con;
+	const io_dev_connector_t *cache_dev_con;
+
+	fill_backend();
+
+	if ((register_io_dev_memmap(&memmap_dev_con) != 0) ||
+	    (io_dev_open(memmap_dev_con, (uintptr_t)NULL,
+			 &memmap_dev_handle) != 0)) {
+		printf("FAIL: cannot open the memmap device\n");
+		return EXIT_FAILURE;
+	}
+
+	test_memmap();
+
+	/*
+	 * io_memmap takes addresses as offsets: the cache device covers the
+	 * address space up to the end of the backend array.
+	 */
+	cache_dev_spec.backend_dev_handle = memmap_dev_handle;
+	cache_dev_spec.backend_size = (uintptr_t)backend + BACKEND_SIZE;
+	cache_dev_spec.buffer.offset = (uintptr_t)cache_buffer;
+
+	if ((register_io_dev_cache(&cache_dev_con) != 0) ||
+	    (io_dev_open(cache_dev_con, (uintptr_t)&cache_dev_spec,
+			 &cache_dev_handle) != 0)) {
+		printf("FAIL: cannot open the cache device\n");
+		return EXIT_FAILURE;
+	}
+
+	test_cache_random();
+	test_cache_sequential();
+	test_cache_bypass();
+	test_cache_bounds();
+	test_cache_invalidate();
+
+	io_dev_close(cache_dev_handle);
+	io_dev_close(memmap_dev_handle);
+
+	if (failures != 0U) {
+		printf("FAIL: io_cache, %u failures\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS: io_cache\n");
+
+	return EXIT_SUCCESS;
+}
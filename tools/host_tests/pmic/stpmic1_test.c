@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the STPMIC1 driver, built as in BL2 against an emulated PMIC:
+ * the register shadow, the batched writes and the regulator IDs are checked
+ * with the I2C transfers and the register values seen on the emulated bus.
+ * The driver state is not reset between the tests, they run in BL2 order.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <common/debug.h>
+#include <drivers/console.h>
+#include <drivers/st/stpmic1.h>
+
+#define PMIC_NB_REGS		256U
+
+/* With assertions, the driver reads back each write */
+#if ENABLE_ASSERTIONS
+#define READBACKS(_n)		(_n)
+#else
+#define READBACKS(_n)		0U
+#endif
+
+struct regul_ref {
+	uint8_t id;
+	uint8_t control_reg;
+	uint8_t enable_mask;
+};
+
+/* Expected control register of each ID, from the STPMIC1 datasheet */
+static const struct regul_ref regul_refs[] = {
+	{ STPMIC1_BUCK1, BUCK1_CONTROL_REG, LDO_BUCK_ENABLE_MASK },
+	{ STPMIC1_BUCK2, BUCK2_CONTROL_REG, LDO_BUCK_ENABLE_MASK },
+	{ STPMIC1_BUCK3, BUCK3_CONTROL_REG, LDO_BUCK_ENABLE_MASK },
+	{ STPMIC1_BUCK4, BUCK4_CONTROL_REG, LDO_BUCK_ENABLE_MASK },
+	{ STPMIC1_LDO1, LDO1_CONTROL_REG, LDO_BUCK_ENABLE_MASK },
+	{ STPMIC1_LDO2, LDO2_CONTROL_REG, LDO_BUCK_ENABLE_MASK },
+	{ STPMIC1_LDO3, LDO3_CONTROL_REG, LDO_BUCK_ENABLE_MASK },
+	{ STPMIC1_LDO4, LDO4_CONTROL_REG, LDO_BUCK_ENABLE_MASK },
+	{ STPMIC1_LDO5, LDO5_CONTROL_REG, LDO_BUCK_ENABLE_MASK },
+	{ STPMIC1_LDO6, LDO6_CONTROL_REG, LDO_BUCK_ENABLE_MASK },
+	{ STPMIC1_VREF_DDR, VREF_DDR_CONTROL_REG, LDO_BUCK_ENABLE_MASK },
+	{ STPMIC1_BOOST, USB_CONTROL_REG, BOOST_ENABLED },
+	{ STPMIC1_VBUS_OTG, USB_CONTROL_REG, USBSW_OTG_SWITCH_ENABLED },
+	{ STPMIC1_SW_OUT, USB_CONTROL_REG, SWIN_SWOUT_ENABLED },
+};
+
+static struct i2c_handle_s i2c_handle;
+static uint8_t pmic_regs[PMIC_NB_REGS];
+static unsigned int nb_reads;
+static unsigned int nb_writes;
+static unsigned int bytes_written;
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	(void)vprintf(fmt + 1, args);
+	va_end(args);
+}
+
+/* Called by panic(), exit() flushes the host output */
+void console_flush(void)
+{
+}
+
+void __dead2 do_panic(void)
+{
+	printf("PANIC\n");
+	exit(1);
+	__builtin_unreachable();
+}
+
+#if ENABLE_ASSERTIONS
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+#endif
+
+/* Emulated PMIC, auto-incrementing the register address */
+int stm32_i2c_mem_read(struct i2c_handle_s *hi2c, uint16_t dev_addr,
+		       uint16_t mem_addr, uint16_t mem_add_size,
+		       uint8_t *p_data, uint16_t size, uint32_t timeout_ms)
+{
+	if ((hi2c != &i2c_handle) || ((mem_addr + size) > PMIC_NB_REGS)) {
+		return -1;
+	}
+
+	memcpy(p_data, &pmic_regs[mem_addr], size);
+	nb_reads++;
+
+	return 0;
+}
+
+int stm32_i2c_mem_write(struct i2c_handle_s *hi2c, uint16_t dev_addr,
+			uint16_t mem_addr, uint16_t mem_add_size,
+			uint8_t *p_data, uint16_t size, uint32_t timeout_ms)
+{
+	if ((hi2c != &i2c_handle) || ((mem_addr + size) > PMIC_NB_REGS)) {
+		return -1;
+	}
+
+	memcpy(&pmic_regs[mem_addr], p_data, size);
+	nb_writes++;
+	bytes_written += size;
+
+	return 0;
+}
+
+static void reset_counters(void)
+{
+	nb_reads = 0U;
+	nb_writes = 0U;
+	bytes_written = 0U;
+}
+
+/* Before any batch, updates are written through */
+static void test_write_through(void)
+{
+	reset_counters();
+	CHECK(stpmic1_regulator_enable(STPMIC1_BUCK1) == 0);
+	CHECK((pmic_regs[BUCK1_CONTROL_REG] & LDO_BUCK_ENABLE_MASK) != 0U);
+	CHECK(nb_reads == 1U + READBACKS(1U));
+	CHECK(nb_writes == 1U);
+
+	/* Served from the shadow, and nothing to change */
+	reset_counters();
+	CHECK(stpmic1_is_regulator_enabled(STPMIC1_BUCK1));
+	CHECK(stpmic1_regulator_enable(STPMIC1_BUCK1) == 0);
+	CHECK((nb_reads == 0U) && (nb_writes == 0U));
+
+	/* MAIN_CONTROL holds self-clearing bits and is never shadowed */
+	reset_counters();
+	CHECK(stpmic1_powerctrl_on() == 0);
+	CHECK(stpmic1_powerctrl_on() == 0);
+	CHECK((pmic_regs[MAIN_CONTROL_REG] & PWRCTRL_PIN_VALID) != 0U);
+	CHECK(nb_reads == 2U + READBACKS(2U));
+	CHECK(nb_writes == 2U);
+
+	printf("PASS: write-through\n");
+}
+
+/* DT configuration of the regulators, as in initialize_pmic() */
+static void test_batch(void)
+{
+	uint8_t before[PMIC_NB_REGS];
+
+	/*
+	 * BUCK1_CONTROL is already shadowed and WATCHDOG_CONTROL is not
+	 * shadowed: PADS_PULL..MASK_RESET_LDO, WATCHDOG_TIMER..BUCK_APM and
+	 * BUCK2_CONTROL..USB_CONTROL are read.
+	 */
+	reset_counters();
+	CHECK(stpmic1_batch_start() == 0);
+	CHECK(nb_reads == 3U);
+	CHECK(nb_writes == 0U);
+
+	memcpy(before, pmic_regs, sizeof(before));
+	reset_counters();
+	CHECK(stpmic1_regulator_mask_reset_set(STPMIC1_BUCK3) == 0);
+	CHECK(stpmic1_regulator_icc_set(STPMIC1_BUCK1) == 0);
+	CHECK(stpmic1_regulator_icc_set(STPMIC1_LDO1) == 0);
+	CHECK(stpmic1_regulator_pull_down_set(STPMIC1_BUCK2) == 0);
+	CHECK(stpmic1_regulator_voltage_set(STPMIC1_BUCK2, 1350U) == 0);
+	CHECK((nb_reads == 0U) && (nb_writes == 0U));
+	CHECK(memcmp(before, pmic_regs, sizeof(before)) == 0);
+
+	/*
+	 * Runs: BUCK_PULL_DOWN, MASK_RESET_BUCK, BUCK_ICC_TURNOFF with
+	 * LDO_ICC_TURNOFF, BUCK2_CONTROL.
+	 */
+	CHECK(stpmic1_batch_flush() == 0);
+	CHECK(nb_writes == 4U);
+	CHECK(bytes_written == 5U);
+	CHECK(nb_reads == READBACKS(4U));
+	CHECK((pmic_regs[MASK_RESET_BUCK_REG] & BIT(BUCK3_MASK_RESET)) != 0U);
+	CHECK((pmic_regs[BUCK_ICC_TURNOFF_REG] & BIT(BUCK1_ICC_SHIFT)) != 0U);
+	CHECK((pmic_regs[LDO_ICC_TURNOFF_REG] & BIT(LDO1_ICC_SHIFT)) != 0U);
+	CHECK((pmic_regs[BUCK_PULL_DOWN_REG] & BIT(BUCK2_PULL_DOWN_SHIFT)) !=
+	      0U);
+	CHECK(stpmic1_regulator_voltage_get(STPMIC1_BUCK2) == 1350);
+
+	/* Flushed: nothing left to write */
+	reset_counters();
+	CHECK(stpmic1_batch_flush() == 0);
+	CHECK(stpmic1_regulator_mask_reset_set(STPMIC1_BUCK3) == 0);
+	CHECK((nb_reads == 0U) && (nb_writes == 0U));
+
+	printf("PASS: batch\n");
+}
+
+/* Regulator IDs index the driver table */
+static void test_ids(void)
+{
+	const uint16_t *levels;
+	size_t count;
+	unsigned int i;
+
+	for (i = 0U; i < ARRAY_SIZE(regul_refs); i++) {
+		const struct regul_ref *ref = &regul_refs[i];
+
+		CHECK(stpmic1_regulator_enable(ref->id) == 0);
+		CHECK((pmic_regs[ref->control_reg] & ref->enable_mask) ==
+		      ref->enable_mask);
+		CHECK(stpmic1_is_regulator_enabled(ref->id));
+
+		CHECK(stpmic1_regulator_disable(ref->id) == 0);
+		CHECK((pmic_regs[ref->control_reg] & ref->enable_mask) == 0U);
+		CHECK(!stpmic1_is_regulator_enabled(ref->id));
+
+		CHECK(stpmic1_regulator_levels_mv(ref->id, &levels,
+						  &count) == 0);
+		CHECK(count != 0U);
+	}
+
+	/* Fixed voltage regulators */
+	reset_counters();
+	CHECK(stpmic1_regulator_voltage_set(STPMIC1_LDO4, 3300U) == 0);
+	CHECK(stpmic1_regulator_voltage_get(STPMIC1_LDO4) == 0);
+	CHECK(stpmic1_regulator_voltage_get(STPMIC1_BOOST) == 0);
+	CHECK((nb_reads == 0U) && (nb_writes == 0U));
+
+	CHECK(stpmic1_regulator_voltage_set(STPMIC1_LDO1, 1800U) == 0);
+	CHECK(stpmic1_regulator_voltage_get(STPMIC1_LDO1) == 1800);
+
+	/* Modes only supported by some regulators */
+	CHECK(stpmic1_regulator_sink_mode_set(STPMIC1_LDO2) < 0);
+	CHECK(stpmic1_active_discharge_mode_set(STPMIC1_BUCK1) < 0);
+	CHECK(stpmic1_active_discharge_mode_set(STPMIC1_VBUS_OTG) == 0);
+	CHECK((pmic_regs[USB_CONTROL_REG] & VBUS_OTG_DISCHARGE) != 0U);
+
+	printf("PASS: regulator IDs\n");
+}
+
+/* DDR3 supplies, as in pmic_ddr_power_init(): only the writes remain */
+static void test_ddr_supplies(void)
+{
+	const uint16_t *levels;
+	size_t count;
+
+	reset_counters();
+	CHECK(stpmic1_regulator_sink_mode_set(STPMIC1_LDO3) == 0);
+	CHECK(stpmic1_regulator_voltage_set(STPMIC1_BUCK2, 1350U) == 0);
+	CHECK(stpmic1_regulator_enable(STPMIC1_BUCK2) == 0);
+	CHECK(stpmic1_regulator_enable(STPMIC1_VREF_DDR) == 0);
+	CHECK(stpmic1_regulator_enable(STPMIC1_LDO3) == 0);
+	CHECK(nb_writes == 4U);
+	CHECK(nb_reads == READBACKS(4U));
+
+	CHECK((pmic_regs[LDO3_CONTROL_REG] &
+	       (LDO3_BYPASS | LDO_VOLTAGE_MASK)) ==
+	      (LDO3_DDR_SEL << LDO_BUCK_VOLTAGE_SHIFT));
+	CHECK(stpmic1_regulator_levels_mv(STPMIC1_LDO3, &levels, &count) == 0);
+	CHECK((count == 1U) && (levels[0] == 0U));
+	CHECK(stpmic1_regulator_voltage_get(STPMIC1_BUCK2) == 1350);
+
+	printf("PASS: DDR supplies\n");
+}
+
+int main(void)
+{
+	stpmic1_bind_i2c(&i2c_handle, 0x66U);
+
+	test_write_through();
+	test_batch();
+	test_ids();
+	test_ddr_supplies();
+
+	if (failures != 0U) {
+		printf("FAIL: stpmic1, %u failures\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS: stpmic1\n");
+
+	return EXIT_SUCCESS;
+}
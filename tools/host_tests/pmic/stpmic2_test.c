@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the STPMIC2 driver, built as in BL2 against an emulated PMIC:
+ * the register shadow, its preload, the batched writes and the recovery from
+ * I2C errors are checked with the I2C transfers and the register values seen
+ * on the emulated bus. The driver state is not reset between the tests, they
+ * run in BL2 order.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <common/debug.h>
+#include <drivers/console.h>
+#include <drivers/st/stpmic2.h>
+
+#define PMIC_NB_REGS		256U
+
+/* BUCK2 output at reset, index 50 of its voltage table */
+#define BUCK2_RESET_MV		1000U
+#define BUCK2_RESET_CR1		50U
+
+static struct i2c_handle_s i2c_handle;
+static struct pmic_handle_s pmic = {
+	.i2c_handle = &i2c_handle,
+	.i2c_addr = 0x66U,
+};
+static uint8_t pmic_regs[PMIC_NB_REGS];
+static bool i2c_fail;
+static unsigned int nb_reads;
+static unsigned int bytes_read;
+static unsigned int nb_writes;
+static unsigned int bytes_written;
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+void zeromem(void *mem, u_register_t length)
+{
+	memset(mem, 0, length);
+}
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	(void)vprintf(fmt + 1, args);
+	va_end(args);
+}
+
+/* Called by panic(), exit() flushes the host output */
+void console_flush(void)
+{
+}
+
+void __dead2 do_panic(void)
+{
+	printf("PANIC\n");
+	exit(1);
+	__builtin_unreachable();
+}
+
+#if ENABLE_ASSERTIONS
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+#endif
+
+/* Emulated PMIC, auto-incrementing the register address */
+int stm32_i2c_mem_read(struct i2c_handle_s *hi2c, uint16_t dev_addr,
+		       uint16_t mem_addr, uint16_t mem_add_size,
+		       uint8_t *p_data, uint16_t size, uint32_t timeout_ms)
+{
+	if (i2c_fail || (hi2c != &i2c_handle) ||
+	    ((mem_addr + size) > PMIC_NB_REGS)) {
+		return -1;
+	}
+
+	memcpy(p_data, &pmic_regs[mem_addr], size);
+	nb_reads++;
+	bytes_read += size;
+
+	return 0;
+}
+
+int stm32_i2c_mem_write(struct i2c_handle_s *hi2c, uint16_t dev_addr,
+			uint16_t mem_addr, uint16_t mem_add_size,
+			uint8_t *p_data, uint16_t size, uint32_t timeout_ms)
+{
+	if (i2c_fail || (hi2c != &i2c_handle) ||
+	    ((mem_addr + size) > PMIC_NB_REGS)) {
+		return -1;
+	}
+
+	memcpy(&pmic_regs[mem_addr], p_data, size);
+	nb_writes++;
+	bytes_written += size;
+
+	return 0;
+}
+
+static void reset_counters(void)
+{
+	nb_reads = 0U;
+	bytes_read = 0U;
+	nb_writes = 0U;
+	bytes_written = 0U;
+}
+
+/* Before any batch, updates are written through */
+static void test_write_through(void)
+{
+	bool enabled;
+
+	reset_counters();
+	CHECK(stpmic2_regulator_set_state(&pmic, STPMIC2_BUCK1, true) == 0);
+	CHECK((pmic_regs[BUCK1_MAIN_CR2] & 1U) != 0U);
+	CHECK((nb_reads == 1U) && (nb_writes == 1U));
+
+	/* Served from the shadow, and nothing to change */
+	reset_counters();
+	CHECK(stpmic2_regulator_get_state(&pmic, STPMIC2_BUCK1,
+					  &enabled) == 0);
+	CHECK(enabled);
+	CHECK(stpmic2_regulator_set_state(&pmic, STPMIC2_BUCK1, true) == 0);
+	CHECK((nb_reads == 0U) && (nb_writes == 0U));
+
+	/* Status registers and WDG_CR (self-clearing bits) are not shadowed */
+	reset_counters();
+	CHECK(stpmic2_register_update(&pmic, WDG_CR, BIT(0), BIT(0)) == 0);
+	CHECK(stpmic2_register_update(&pmic, WDG_CR, BIT(0), BIT(0)) == 0);
+	CHECK((pmic_regs[WDG_CR] & BIT(0)) != 0U);
+	CHECK((nb_reads == 2U) && (nb_writes == 2U));
+
+	reset_counters();
+	CHECK(stpmic2_register_update(&pmic, MAIN_CR, BIT(1), BIT(1)) == 0);
+	CHECK((nb_reads == 1U) && (nb_writes == 1U));
+
+	printf("PASS: write-through\n");
+}
+
+/* DT configuration of the regulators, as in initialize_pmic2() */
+static void test_batch(void)
+{
+	uint8_t before[PMIC_NB_REGS];
+	uint16_t mv;
+
+	/*
+	 * BUCK1_MAIN_CR2 is already shadowed, WDG_CR and WDG_TMR_SR are not
+	 * shadowed: VINLOW_CR..PKEY_LKP_CR, WDG_TMR_CR, FS_OCP_CR1..
+	 * BUCK1_MAIN_CR1 and BUCK1_ALT_CR1..REFDDR_PWRCTRL_CR are read.
+	 */
+	reset_counters();
+	CHECK(stpmic2_batch_start(&pmic) == 0);
+	CHECK(nb_reads == 4U);
+	CHECK(bytes_read == (REFDDR_PWRCTRL_CR - VINLOW_CR + 1U) - 3U);
+	CHECK(nb_writes == 0U);
+
+	/* Preloaded: reads and updates do not access the PMIC */
+	memcpy(before, pmic_regs, sizeof(before));
+	reset_counters();
+	CHECK(stpmic2_regulator_get_voltage(&pmic, STPMIC2_BUCK2, &mv) == 0);
+	CHECK(mv == BUCK2_RESET_MV);
+	CHECK(stpmic2_regulator_set_prop(&pmic, STPMIC2_BUCK3,
+					 STPMIC2_MASK_RESET, 0U) == 0);
+	CHECK(stpmic2_regulator_set_prop(&pmic, STPMIC2_BUCK1,
+					 STPMIC2_OCP, 0U) == 0);
+	CHECK(stpmic2_regulator_set_prop(&pmic, STPMIC2_LDO1,
+					 STPMIC2_OCP, 0U) == 0);
+	CHECK(stpmic2_regulator_set_prop(&pmic, STPMIC2_BUCK2,
+					 STPMIC2_PULL_DOWN, 0U) == 0);
+	CHECK(stpmic2_regulator_set_voltage(&pmic, STPMIC2_BUCK2, 1350U) == 0);
+	CHECK((nb_reads == 0U) && (nb_writes == 0U));
+	CHECK(memcmp(before, pmic_regs, sizeof(before)) == 0);
+
+	/*
+	 * Runs: FS_OCP_CR1 with FS_OCP_CR2, BUCKS_PD_CR1, BUCKS_MRST_CR,
+	 * BUCK2_MAIN_CR1.
+	 */
+	CHECK(stpmic2_batch_flush(&pmic) == 0);
+	CHECK(nb_writes == 4U);
+	CHECK(bytes_written == 5U);
+	CHECK(nb_reads == 0U);
+	CHECK((pmic_regs[BUCKS_MRST_CR] & BUCK3_MRST) != 0U);
+	CHECK((pmic_regs[FS_OCP_CR1] & FS_OCP_BUCK1) != 0U);
+	CHECK((pmic_regs[FS_OCP_CR2] & FS_OCP_LDO1) != 0U);
+	CHECK((pmic_regs[BUCKS_PD_CR1] & BUCK2_PD_FAST) != 0U);
+	CHECK(stpmic2_regulator_get_voltage(&pmic, STPMIC2_BUCK2, &mv) == 0);
+	CHECK(mv == 1350U);
+
+	/* Flushed: nothing left to write, nothing left to read */
+	reset_counters();
+	CHECK(stpmic2_batch_flush(&pmic) == 0);
+	CHECK(stpmic2_regulator_set_prop(&pmic, STPMIC2_BUCK3,
+					 STPMIC2_MASK_RESET, 0U) == 0);
+	CHECK(stpmic2_batch_start(&pmic) == 0);
+	CHECK(stpmic2_batch_flush(&pmic) == 0);
+	CHECK((nb_reads == 0U) && (nb_writes == 0U));
+
+	printf("PASS: batch\n");
+}
+
+/* An I2C error drops the shadow, the registers are read again */
+static void test_errors(void)
+{
+	uint16_t mv;
+
+	CHECK(stpmic2_batch_start(&pmic) == 0);
+	CHECK(stpmic2_regulator_set_voltage(&pmic, STPMIC2_BUCK2, 1200U) == 0);
+
+	i2c_fail = true;
+	CHECK(stpmic2_batch_flush(&pmic) != 0);
+	i2c_fail = false;
+
+	reset_counters();
+	CHECK(stpmic2_regulator_get_voltage(&pmic, STPMIC2_BUCK2, &mv) == 0);
+	CHECK(mv == 1350U);
+	CHECK(nb_reads == 1U);
+
+	/* The preload fails: no batch, updates are written through */
+	i2c_fail = true;
+	CHECK(stpmic2_batch_start(&pmic) != 0);
+	i2c_fail = false;
+
+	reset_counters();
+	CHECK(stpmic2_regulator_set_voltage(&pmic, STPMIC2_BUCK2, 1200U) == 0);
+	CHECK((nb_reads == 0U) && (nb_writes == 1U));
+	CHECK(stpmic2_regulator_get_voltage(&pmic, STPMIC2_BUCK2, &mv) == 0);
+	CHECK(mv == 1200U);
+
+	/* The remaining registers are preloaded by the next batch */
+	reset_counters();
+	CHECK(stpmic2_batch_start(&pmic) == 0);
+	CHECK(nb_reads == 4U);
+	CHECK(stpmic2_batch_flush(&pmic) == 0);
+	CHECK(nb_writes == 0U);
+
+	printf("PASS: errors\n");
+}
+
+int main(void)
+{
+	pmic_regs[BUCK2_MAIN_CR1] = BUCK2_RESET_CR1;
+
+	test_write_through();
+	test_batch();
+	test_errors();
+
+	if (failures != 0U) {
+		printf("FAIL: stpmic2, %u failures\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS: stpmic2\n");
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+#
+# SPDX-License-Identifier: BSD-3-Clause
+
+"""
+    Check tools/stm32_risaf_table/stm32_risaf_table.py on synthetic FW_CONFIG
+    DTBs: the register writes generated for the regions of the STM32MP257F-DK
+    FW_CONFIG, the size and CRC32 of the DTB, the errors on invalid regions,
+    and the region limits read from the platform definitions.
+"""
+
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+
+TF_ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..',
+                       '..')
+SCRIPT = os.path.join(TF_ROOT, 'tools', 'stm32_risaf_table',
+                      'stm32_risaf_table.py')
+DEFS = os.path.join(TF_ROOT, 'plat', 'st', 'stm32mp2', 'stm32mp2_def.h')
+
+# As in plat/st/stm32mp2/platform.mk: RISAF2 on OSPI, RISAF4 on DDR
+INSTANCES = ['1:0x60000000:0x10000000:0x1000', '3:0x80000000:0x100000000:0x1000']
+
+RIF_CID0_BF = 1 << 0
+RIF_CID1_BF = 1 << 1
+
+failures = 0
+
+
+def risafprot(region, read, write, priv, sec, enc, enabled):
+    """ RISAFPROT() of include/dt-bindings/soc/rif.h """
+    return ((write << 24) | (read << 16) | (priv << 8) | (enc << 6) |
+            (sec << 5) | (enabled << 4) | region)
+
+
+def fdt(regions):
+    """ DTB with a firewall node holding the (name, addr, len, protreg) """
+    strings = b''
+    string_offsets = {}
+
+    def string(name):
+        nonlocal strings
+        if name not in string_offsets:
+            string_offsets[name] = len(strings)
+            strings += name.encode() + b'\0'
+        return string_offsets[name]
+
+    def begin_node(name):
+        data = name.encode() + b'\0'
+        data += b'\0' * (-len(data) % 4)
+        return struct.pack('>I', 1) + data
+
+    def prop(name, value):
+        value += b'\0' * (-len(value) % 4)
+        return struct.pack('>III', 3, len(value), string(name)) + value
+
+    dt = begin_node('')
+    dt += begin_node('st-mem-firewall')
+    dt += prop('compatible', b'st,stm32mp2-mem-firewall\0')
+    dt += prop('#address-cells', struct.pack('>I', 2))
+    dt += prop('#size-cells', struct.pack('>I', 2))
+    for name, addr, length, protreg in regions:
+        dt += begin_node('{}@{:x}'.format(name, addr))
+        dt += prop('reg', struct.pack('>QQ', addr, length))
+        dt += prop('st,protreg', struct.pack('>I', protreg))
+        dt += struct.pack('>I', 2)
+    dt += struct.pack('>II', 2, 2) + struct.pack('>I', 9)
+
+    off_struct = 40 + 16
+    off_strings = off_struct + len(dt)
+    size = off_strings + len(strings)
+    header = struct.pack('>10I', 0xd00dfeed, size, off_struct, off_strings, 40,
+                         17, 16, 0, len(strings), len(dt))
+
+    return header + struct.pack('>QQ', 0, 0) + dt + strings
+
+
+def run(regions, instances=INSTANCES, defs=DEFS):
+    """ Return the exit code, output and errors of the script """
+    with tempfile.TemporaryDirectory() as tmp:
+        dtb = os.path.join(tmp, 'fw-config.dtb')
+        with open(dtb, 'wb') as f:
+            f.write(fdt(regions))
+
+        cmd = [sys.executable, SCRIPT, dtb, '-d', defs]
+        for inst in instances:
+            cmd += ['-i', inst]
+        p = subprocess.run(cmd, capture_output=True, text=True)
+
+    return p.returncode, p.stdout, p.stderr
+
+
+def check(name, cond, msg):
+    global failures
+
+    if not cond:
+        print('FAIL: {}: {}'.format(name, msg))
+        failures += 1
+
+
+def table_entries(text, table):
+    """ Entries of a table of the generated header, as lists of strings """
+    body = re.search(r'\b' + table + r'\[\] = \{\n(.*?)\};', text, re.S)
+    if body is None:
+        return None
+
+    return [re.findall(r'[\w]+', line)
+            for line in body.group(1).splitlines()]
+
+
+# Regions of fdts/stm32mp257f-dk-ca35tdcid-fw-config.dtsi, and one on OSPI
+DK_REGIONS = [
+    ('bl31-context', 0x81fc0000, 0x40000,
+     risafprot(7, RIF_CID0_BF | RIF_CID1_BF, RIF_CID0_BF | RIF_CID1_BF,
+               RIF_CID1_BF, 1, 2, 1)),
+    ('op-tee', 0x82000000, 0x2000000,
+     risafprot(8, RIF_CID0_BF | RIF_CID1_BF, RIF_CID0_BF | RIF_CID1_BF, 0,
+               1, 2, 1)),
+    ('ospi', 0x60100000, 0x100000,
+     risafprot(1, RIF_CID1_BF, 0, 0, 0, 0, 1)),
+]
+
+
+def test_table():
+    before = failures
+    ret, out, err = run(DK_REGIONS)
+    check('table', ret == 0, 'script failed: ' + err.strip())
+    if ret != 0:
+        return
+
+    blob = fdt(DK_REGIONS)
+    check('table', 'STM32MP2_RISAF_TABLE_FDT_SIZE\t0x{:x}U'.format(len(blob))
+          in out, 'wrong DTB size')
+    check('table', 'STM32MP2_RISAF_TABLE_FDT_CRC\t0x{:08x}U'.format(
+          zlib.crc32(blob)) in out, 'wrong DTB CRC32')
+
+    # RISAF2 then RISAF4, in the order of the -i options
+    check('table', table_entries(out, 'stm32mp2_risaf_table_instances') == [
+        ['1', '0x1000U', '1U', '0x1fffffULL', 'false', '0U', '5U'],
+        ['3', '0x1000U', '8U', '0x3ffffffULL', 'true', '5U', '10U'],
+    ], 'wrong instances')
+
+    # Region disabled, start, end, CID filtering, then configuration
+    check('table', table_entries(out, 'stm32mp2_risaf_table_writes') == [
+        ['0x040U', '0x00000000U'],
+        ['0x044U', '0x00100000U'],
+        ['0x048U', '0x001ff000U'],
+        ['0x04cU', '0x00000002U'],
+        ['0x040U', '0x00000001U'],
+        ['0x1c0U', '0x00000000U'],
+        ['0x1c4U', '0x01fc0000U'],
+        ['0x1c8U', '0x01fff000U'],
+        ['0x1ccU', '0x00030003U'],
+        ['0x1c0U', '0x00028101U'],
+        ['0x200U', '0x00000000U'],
+        ['0x204U', '0x02000000U'],
+        ['0x208U', '0x03fff000U'],
+        ['0x20cU', '0x00030003U'],
+        ['0x200U', '0x00008101U'],
+    ], 'wrong register writes')
+
+    check('table', table_entries(out, 'stm32mp2_risaf_table_enc_regions') == [
+        ['3', '0x81fc0000ULL', '0x40000ULL'],
+        ['3', '0x82000000ULL', '0x2000000ULL'],
+    ], 'wrong encrypted regions')
+
+    if failures == before:
+        print('PASS: table')
+
+
+def secure(region_id, enc=0):
+    return risafprot(region_id, RIF_CID1_BF, RIF_CID1_BF, 0, 1, enc, 1)
+
+
+# Name, regions and the expected error
+REJECTED = [
+    ('region ID 0', [('r', 0x80000000, 0x1000, secure(0))],
+     'region ID 0 not in 1-15 of RISAF4'),
+    ('region ID above the region count', [('r', 0x60000000, 0x1000, secure(5))],
+     'region ID 5 not in 1-4 of RISAF2'),
+    ('region ID used twice', [('a', 0x80000000, 0x1000, secure(1)),
+                              ('b', 0x80001000, 0x1000, secure(1))],
+     'RISAF4: region ID used twice'),
+    ('too many regions', [('r{}'.format(i), 0x80000000 + i * 0x1000, 0x1000,
+                           secure(i + 1)) for i in range(5)],
+     'RISAF4: too many regions'),
+    ('overlap', [('a', 0x80000000, 0x2000, secure(1)),
+                 ('b', 0x80001000, 0x1000, secure(2))],
+     'RISAF4: regions a@80000000 and b@80001000 overlap'),
+    ('unaligned', [('r', 0x80000800, 0x1000, secure(1))],
+     'not aligned on 0x1000'),
+    ('empty', [('r', 0x80000000, 0, secure(1))], 'not aligned on 0x1000'),
+    ('outside the instances', [('r', 0x70000000, 0x1000, secure(1))],
+     'no RISAF instance for 0x70000000-0x70001000'),
+    ('across the instance end', [('r', 0x6ffff000, 0x2000, secure(1))],
+     'no RISAF instance for 0x6ffff000-0x70001000'),
+    ('encryption on non secure area',
+     [('r', 0x80000000, 0x1000, risafprot(1, 2, 2, 0, 0, 2, 1))],
+     'encryption on non secure area'),
+]
+
+
+def test_rejected():
+    before = failures
+    for name, regions, error in REJECTED:
+        ret, _, err = run(regions)
+        check('rejected', ret != 0, '{}: accepted'.format(name))
+        check('rejected', error in err,
+              '{}: unexpected error "{}"'.format(name, err.strip()))
+
+    if failures == before:
+        print('PASS: rejected')
+
+
+def test_defs():
+    before = failures
+    region = [('r', 0x80000000, 0x1000, secure(1))]
+
+    # RISAF1 has no base address, BL2 cannot register its regions
+    ret, _, err = run([('r', 0x0e000000, 0x1000, secure(1))],
+                      INSTANCES + ['0:0x0e000000:0x10000:0x1000'])
+    check('defs', ret != 0 and 'RISAF1: too many regions' in err,
+          'RISAF1 region accepted')
+
+    # There is no RISAF3 in the platform definitions
+    ret, _, err = run(region, INSTANCES + ['2:0x10000000:0x10000:0x1000'])
+    check('defs', ret != 0 and 'RISAF3: no RISAF3_MAX_REGION' in err,
+          'RISAF3 accepted')
+
+    with tempfile.TemporaryDirectory() as tmp:
+        defs = os.path.join(tmp, 'defs.h')
+
+        # #ifdef, #else and #ifndef are evaluated, values may be U()
+        with open(defs, 'w') as f:
+            f.write('#ifndef DEFS_H\n#define DEFS_H\n'
+                    '#define RISAF2_BASE U(0x420B0000)\n'
+                    '#ifdef RISAF2_BASE\n#define RISAF2_MAX_REGION U(2)\n'
+                    '#else\n#define RISAF2_MAX_REGION 0\n#endif\n'
+                    '#define RISAF2_NB_REGIONS 3 /* comment */\n'
+                    '#ifdef RISAF4_BASE\n#define RISAF4_MAX_REGION 4\n'
+                    '#else\n#define RISAF4_MAX_REGION 0\n#endif\n'
+                    '#define RISAF4_NB_REGIONS \\\n\t15\n'
+                    '#endif\n')
+        ret, _, err = run([('r', 0x60000000, 0x1000, secure(3))],
+                          INSTANCES[:1], defs)
+        check('defs', ret == 0, 'RISAF2 region 3 rejected: ' + err.strip())
+        ret, _, err = run([('r', 0x60000000, 0x1000, secure(4))],
+                          INSTANCES[:1], defs)
+        check('defs', ret != 0 and 'region ID 4 not in 1-3' in err,
+              'RISAF2 region 4 accepted')
+        ret, _, err = run(region, INSTANCES[1:], defs)
+        check('defs', ret != 0 and 'RISAF4: too many regions' in err,
+              'RISAF4 region accepted without RISAF4_BASE')
+
+        # Macros under other conditions are not used
+        with open(defs, 'w') as f:
+            f.write('#if STM32MP25\n#define RISAF4_MAX_REGION 4\n#endif\n'
+                    '#define RISAF4_NB_REGIONS 15\n')
+        ret, _, err = run(region, INSTANCES[1:], defs)
+        check('defs', ret != 0 and 'RISAF4: no RISAF4_MAX_REGION' in err,
+              'RISAF4_MAX_REGION used under #if')
+
+    if failures == before:
+        print('PASS: defs')
+
+
+def main():
+    test_table()
+    test_rejected()
+    test_defs()
+
+    if failures != 0:
+        print('FAIL: stm32_risaf_table, {} failures'.format(failures))
+        sys.exit(1)
+
+    print('PASS: stm32_risaf_table')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,198 @@
+#!/bin/sh
+#
+# Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+# Check stm32image on synthetic payloads: the header v1 and v2 fields, the
+# checksum against a byte sum computed here, the payload following the
+# header, the batch mode and the -O offset in an existing file.
+#
+# Usage: stm32image_test.sh [path to stm32image]
+
+STM32IMAGE=$(realpath "${1:-../stm32image/stm32image}")
+LOAD=0x2ffc2500
+ENTRY=0x2ffc2800
+VERSION=0x12
+BINARY_TYPE=0x10
+# Around the 8-byte words and the 1 KiB folds of the checksum
+SIZES="0 1 7 8 9 1023 1024 1025 70001"
+
+TMP_DIR=$(mktemp -d)
+trap 'rm -rf "${TMP_DIR}"' EXIT
+cd "${TMP_DIR}" || exit 1
+failures=0
+
+fail() {
+	echo "FAIL: $1"
+	failures=$((failures + 1))
+}
+
+# $1: test name, $2: failures before the test
+pass() {
+	[ ${failures} -eq $2 ] && echo "PASS: $1"
+}
+
+# $1: file, $2: offset
+u8() {
+	od -An -v -tu1 -j $2 -N 1 "$1" | tr -d ' '
+}
+
+# $1: file, $2: offset
+u32() {
+	od -An -v -tu4 --endian=little -j $2 -N 4 "$1" | tr -d ' '
+}
+
+# $1: file, $2: offset, $3: length; sum of the bytes, modulo 2^32
+byte_sum() {
+	tail -c +$(($2 + 1)) "$1" | head -c $3 | od -An -v -tu1 |
+		awk '{ for (i = 1; i <= NF; i++) s += $i } END { print s % 4294967296 }'
+}
+
+# $1: test name, $2: field, $3: file, $4: value read, $5: value expected
+check_field() {
+	if [ "$4" != "$(($5))" ]; then
+		fail "$1: $2 of $3 is $4, not $(($5))"
+	fi
+}
+
+# $1: test name, $2: image, $3: header offset in the image, $4: payload,
+# $5: header version
+check_image() {
+	name=$1
+	img=$2
+	off=$3
+	size=$(stat -c %s "$4")
+
+	if [ "$5" -eq 1 ]; then
+		hdr_size=256
+	else
+		hdr_size=512
+	fi
+
+	check_field "${name}" magic "${img}" "$(u32 "${img}" ${off})" 0x324d5453
+	check_field "${name}" checksum "${img}" "$(u32 "${img}" $((off + 68)))" \
+		$(byte_sum "$4" 0 ${size})
+	check_field "${name}" "minor version" "${img}" \
+		"$(u8 "${img}" $((off + 73)))" 0
+	check_field "${name}" "major version" "${img}" \
+		"$(u8 "${img}" $((off + 74)))" $5
+	check_field "${name}" length "${img}" "$(u32 "${img}" $((off + 76)))" \
+		${size}
+	check_field "${name}" "entry point" "${img}" \
+		"$(u32 "${img}" $((off + 80)))" ${ENTRY}
+	check_field "${name}" "load address" "${img}" \
+		"$(u32 "${img}" $((off + 88)))" ${LOAD}
+	check_field "${name}" version "${img}" "$(u32 "${img}" $((off + 96)))" \
+		${VERSION}
+
+	if [ "$5" -eq 1 ]; then
+		check_field "${name}" "option flags" "${img}" \
+			"$(u32 "${img}" $((off + 100)))" 1
+		check_field "${name}" "ECDSA algorithm" "${img}" \
+			"$(u32 "${img}" $((off + 104)))" 1
+		check_field "${name}" "binary type" "${img}" \
+			"$(u8 "${img}" $((off + 255)))" ${BINARY_TYPE}
+	else
+		check_field "${name}" "extension flags" "${img}" \
+			"$(u32 "${img}" $((off + 100)))" 0x80000000
+		check_field "${name}" "extension headers length" "${img}" \
+			"$(u32 "${img}" $((off + 104)))" 0x180
+		check_field "${name}" "binary type" "${img}" \
+			"$(u32 "${img}" $((off + 108)))" ${BINARY_TYPE}
+		check_field "${name}" "padding header magic" "${img}" \
+			"$(u32 "${img}" $((off + 128)))" 0xffff5453
+		check_field "${name}" "padding header length" "${img}" \
+			"$(u32 "${img}" $((off + 132)))" 0x180
+	fi
+
+	if ! tail -c +$((off + hdr_size + 1)) "${img}" | head -c ${size} |
+	     cmp -s - "$4"; then
+		fail "${name}: payload of ${img} differs"
+	fi
+}
+
+# $1: header version, then the stm32image options
+stm32image() {
+	major=$1
+	shift
+	"${STM32IMAGE}" -l ${LOAD} -e ${ENTRY} -v ${VERSION} -b ${BINARY_TYPE} \
+		-m ${major} "$@" > /dev/null
+}
+
+for s in ${SIZES}; do
+	head -c $s /dev/urandom > "rand$s.bin"
+done
+# All bytes 0xFF, the largest lane increments of the checksum
+head -c 300000 /dev/zero | tr '\0' '\377' > ff.bin
+
+# Headers v1 and v2, one image per run
+for v in 1 2; do
+	before=${failures}
+	for p in rand*.bin ff.bin; do
+		if ! stm32image $v -s $p -d $p.v$v.stm32; then
+			fail "header v$v: stm32image failed on $p"
+			continue
+		fi
+		if [ $(stat -c %s $p.v$v.stm32) -ne \
+		     $(($(stat -c %s $p) + 256 * v)) ]; then
+			fail "header v$v: wrong size of $p.v$v.stm32"
+		fi
+		check_image "header v$v" $p.v$v.stm32 0 $p $v
+	done
+	pass "header v$v" ${before}
+done
+
+# Batch mode, the images must be the same as one per run
+before=${failures}
+opts=
+for p in rand*.bin; do
+	opts="${opts} -s $p -d $p.batch.stm32"
+done
+stm32image 2 ${opts} || fail "batch: stm32image failed"
+for p in rand*.bin; do
+	if ! cmp -s $p.batch.stm32 $p.v2.stm32; then
+		fail "batch: $p.batch.stm32 differs"
+	fi
+done
+pass "batch" ${before}
+
+# Images written at offsets of a disk image, the other bytes are kept
+before=${failures}
+head -c 262144 /dev/urandom > disk.img
+cp disk.img disk.orig
+stm32image 2 -s rand1025.bin -d disk.img -O 0x4000 \
+	-s rand70001.bin -d disk.img -O 0x10000 ||
+	fail "offset: stm32image failed"
+check_image "offset" disk.img 16384 rand1025.bin 2
+check_image "offset" disk.img 65536 rand70001.bin 2
+if [ $(stat -c %s disk.img) -ne 262144 ]; then
+	fail "offset: disk image size changed"
+fi
+if ! cmp -s -n 16384 disk.img disk.orig ||
+   [ "$(tail -c +$((16384 + 512 + 1025 + 1)) disk.img | head -c 30000 | md5sum)" != \
+     "$(tail -c +$((16384 + 512 + 1025 + 1)) disk.orig | head -c 30000 | md5sum)" ] ||
+   [ "$(tail -c +$((65536 + 512 + 70001 + 1)) disk.img | md5sum)" != \
+     "$(tail -c +$((65536 + 512 + 70001 + 1)) disk.orig | md5sum)" ]; then
+	fail "offset: bytes outside the images changed"
+fi
+pass "offset" ${before}
+
+# Malformed offsets and unsupported header versions are rejected
+before=${failures}
+for o in -1 0x abc 1k 99999999999999999999; do
+	if stm32image 2 -s rand8.bin -d bad.stm32 -O $o 2> /dev/null; then
+		fail "rejected: offset $o accepted"
+	fi
+done
+if stm32image 3 -s rand8.bin -d bad.stm32 2> /dev/null; then
+	fail "rejected: header v3 accepted"
+fi
+pass "rejected" ${before}
+
+if [ ${failures} -ne 0 ]; then
+	echo "FAIL: stm32image, ${failures} failures"
+	exit 1
+fi
+
+echo "PASS: stm32image"
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * C11 model of lib/locks/bakery/bakery_lock_coherent.c, the reference for the
+ * ticket lock benchmark. On the target, the lock data lives in Device memory,
+ * so every access to it is sequentially consistent here. The calling thread
+ * gives the CPU position.
+ */
+
+#include <sched.h>
+#include <stdatomic.h>
+
+#include <lib/bakery_lock.h>
+
+#include "bakery_lock_model.h"
+
+static _Thread_local unsigned int core_pos;
+
+static _Atomic uint16_t *lock_data(bakery_lock_t *bakery, unsigned int pos)
+{
+	return (_Atomic uint16_t *)(void *)&bakery->lock_data[pos];
+}
+
+void bakery_model_set_core_pos(unsigned int pos)
+{
+	core_pos = pos;
+}
+
+static unsigned int bakery_get_ticket(bakery_lock_t *bakery, unsigned int me)
+{
+	unsigned int my_ticket = 0U;
+	unsigned int their_ticket;
+	unsigned int they;
+
+	atomic_store(lock_data(bakery, me),
+		     make_bakery_data(CHOOSING_TICKET, my_ticket));
+	for (they = 0U; they < BAKERY_LOCK_MAX_CPUS; they++) {
+		their_ticket = bakery_ticket_number(
+					atomic_load(lock_data(bakery, they)));
+		if (their_ticket > my_ticket) {
+			my_ticket = their_ticket;
+		}
+	}
+
+	++my_ticket;
+	atomic_store(lock_data(bakery, me),
+		     make_bakery_data(CHOSEN_TICKET, my_ticket));
+
+	return my_ticket;
+}
+
+void bakery_lock_get(bakery_lock_t *bakery)
+{
+	unsigned int me = core_pos;
+	unsigned int my_ticket, my_prio, their_ticket;
+	unsigned int their_bakery_data;
+	unsigned int they;
+
+	my_ticket = bakery_get_ticket(bakery, me);
+	my_prio = bakery_get_priority(my_ticket, me);
+
+	for (they = 0U; they < BAKERY_LOCK_MAX_CPUS; they++) {
+		if (me == they) {
+			continue;
+		}
+
+		do {
+			their_bakery_data = atomic_load(lock_data(bakery, they));
+		} while (bakery_is_choosing(their_bakery_data));
+
+		their_ticket = bakery_ticket_number(their_bakery_data);
+		if ((their_ticket != 0U) &&
+		    (bakery_get_priority(their_ticket, they) < my_prio)) {
+			do {
+				/* Stands for WFE */
+				sched_yield();
+			} while (their_ticket == bakery_ticket_number(
+					atomic_load(lock_data(bakery, they))));
+		}
+	}
+}
+
+void bakery_lock_release(bakery_lock_t *bakery)
+{
+	atomic_store(lock_data(bakery, core_pos), 0U);
+}
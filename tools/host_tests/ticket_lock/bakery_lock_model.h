@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef BAKERY_LOCK_MODEL_H
+#define BAKERY_LOCK_MODEL_H
+
+/* Set the CPU position of the calling thread, below BAKERY_LOCK_MAX_CPUS */
+void bakery_model_set_core_pos(unsigned int pos);
+
+#endif /* BAKERY_LOCK_MODEL_H */
@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PLATFORM_DEF_H
+#define PLATFORM_DEF_H
+
+#include <lib/utils_def.h>
+
+/* Host build of the locks, sized for the benchmark threads */
+#define PLATFORM_CORE_COUNT		U(8)
+#define CACHE_WRITEBACK_GRANULE		U(64)
+
+#endif /* PLATFORM_DEF_H */
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * C11 model of lib/locks/ticket/aarch64/ticket_lock.S, used when the host
+ * cannot run the AArch64 implementation. The ticket is taken on `next` and
+ * the wait is on `owner`, whatever the layout of the lock.
+ */
+
+#include <sched.h>
+#include <stdatomic.h>
+
+#include <lib/ticket_lock.h>
+
+static _Atomic uint16_t *lock_next(ticket_lock_t *lock)
+{
+	return (_Atomic uint16_t *)(void *)&lock->next;
+}
+
+static _Atomic uint16_t *lock_owner(ticket_lock_t *lock)
+{
+	return (_Atomic uint16_t *)(void *)&lock->owner;
+}
+
+void ticket_lock_get(ticket_lock_t *lock)
+{
+	uint16_t ticket;
+
+	ticket = atomic_fetch_add_explicit(lock_next(lock), 1U,
+					   memory_order_acquire);
+
+	while (atomic_load_explicit(lock_owner(lock), memory_order_acquire) !=
+	       ticket) {
+		/* Stands for WFE, and keeps oversubscribed hosts moving */
+		sched_yield();
+	}
+}
+
+void ticket_lock_release(ticket_lock_t *lock)
+{
+	uint16_t owner;
+
+	owner = atomic_load_explicit(lock_owner(lock), memory_order_relaxed);
+	atomic_store_explicit(lock_owner(lock), (uint16_t)(owner + 1U),
+			      memory_order_release);
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Stress test and contention benchmark of the PSCI ticket lock.
+ *
+ * The stress test checks mutual exclusion and that no acquisition is lost,
+ * with enough iterations for the 16-bit `owner` and `next` halves to wrap.
+ * The benchmark compares the ticket lock with the bakery lock it replaces in
+ * PSCI for an increasing number of threads, reporting the cost of an
+ * acquisition and the longest wait for the lock. The number of acquisitions
+ * per run stays below the 15-bit ticket range of the bakery lock, which only
+ * goes back to 1 once nobody holds or waits for the lock.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <lib/bakery_lock.h>
+#include <lib/ticket_lock.h>
+
+#include "bakery_lock_model.h"
+
+#define MAX_THREADS		8U
+#define STRESS_ITERATIONS	50000U
+#define BENCH_ACQUISITIONS	32000U
+
+struct lock_ops {
+	const char *name;
+	void (*get)(void *lock);
+	void (*release)(void *lock);
+};
+
+struct test_ctx {
+	const struct lock_ops *ops;
+	void *lock;
+	unsigned int iterations;
+	atomic_bool start;
+	atomic_uint in_cs;
+	unsigned long counter;
+	bool failed;
+};
+
+struct thread_arg {
+	struct test_ctx *ctx;
+	unsigned int cpu;
+	unsigned long count;
+	uint64_t max_wait;
+};
+
+static void ticket_get(void *lock)
+{
+	ticket_lock_get(lock);
+}
+
+static void ticket_release(void *lock)
+{
+	ticket_lock_release(lock);
+}
+
+static void bakery_get(void *lock)
+{
+	bakery_lock_get(lock);
+}
+
+static void bakery_release(void *lock)
+{
+	bakery_lock_release(lock);
+}
+
+static const struct lock_ops ticket_ops = {
+	.name = "ticket",
+	.get = ticket_get,
+	.release = ticket_release,
+};
+
+static const struct lock_ops bakery_ops = {
+	.name = "bakery",
+	.get = bakery_get,
+	.release = bakery_release,
+};
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void critical_section(struct test_ctx *ctx)
+{
+	if (atomic_fetch_add(&ctx->in_cs, 1U) != 0U) {
+		ctx->failed = true;
+	}
+
+	ctx->counter++;
+
+	atomic_fetch_sub(&ctx->in_cs, 1U);
+}
+
+static void *worker(void *data)
+{
+	struct thread_arg *arg = data;
+	struct test_ctx *ctx = arg->ctx;
+	uint64_t start;
+	uint64_t wait;
+
+	bakery_model_set_core_pos(arg->cpu);
+
+	while (!atomic_load(&ctx->start)) {
+		sched_yield();
+	}
+
+	while (arg->count < ctx->iterations) {
+		start = now_ns();
+		ctx->ops->get(ctx->lock);
+		wait = now_ns() - start;
+		if (wait > arg->max_wait) {
+			arg->max_wait = wait;
+		}
+		critical_section(ctx);
+		ctx->ops->release(ctx->lock);
+		arg->count++;
+	}
+
+	return NULL;
+}
+
+static int run_threads(struct test_ctx *ctx, unsigned int nthreads,
+		       struct thread_arg *args, uint64_t *elapsed)
+{
+	pthread_t threads[MAX_THREADS];
+	uint64_t start;
+	unsigned int i;
+
+	for (i = 0U; i < nthreads; i++) {
+		args[i].ctx = ctx;
+		args[i].cpu = i;
+		args[i].count = 0UL;
+		args[i].max_wait = 0U;
+		if (pthread_create(&threads[i], NULL, worker, &args[i]) != 0) {
+			fprintf(stderr, "Cannot create thread %u\n", i);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	start = now_ns();
+	atomic_store(&ctx->start, true);
+
+	for (i = 0U; i < nthreads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	*elapsed = now_ns() - start;
+
+	return ctx->failed ? -1 : 0;
+}
+
+static int stress(unsigned int nthreads)
+{
+	struct thread_arg args[MAX_THREADS];
+	ticket_lock_t lock = { 0 };
+	struct test_ctx ctx = {
+		.ops = &ticket_ops,
+		.lock = &lock,
+		.iterations = STRESS_ITERATIONS,
+	};
+	unsigned long expected = (unsigned long)nthreads * STRESS_ITERATIONS;
+	uint64_t elapsed;
+
+	if (run_threads(&ctx, nthreads, args, &elapsed) != 0) {
+		printf("FAIL: %u threads entered the critical section together\n",
+		       nthreads);
+		return -1;
+	}
+
+	if (ctx.counter != expected) {
+		printf("FAIL: %lu acquisitions, %lu expected\n",
+		       ctx.counter, expected);
+		return -1;
+	}
+
+	if ((lock.owner != lock.next) ||
+	    (lock.owner != (uint16_t)expected)) {
+		printf("FAIL: lock left at owner %u next %u\n",
+		       lock.owner, lock.next);
+		return -1;
+	}
+
+	printf("PASS: stress, %u threads, %lu acquisitions\n",
+	       nthreads, expected);
+
+	return 0;
+}
+
+static void bench(const struct lock_ops *ops, unsigned int nthreads)
+{
+	struct thread_arg args[MAX_THREADS];
+	ticket_lock_t ticket = { 0 };
+	bakery_lock_t bakery = { 0 };
+	struct test_ctx ctx = {
+		.ops = ops,
+		.lock = (ops == &ticket_ops) ? (void *)&ticket : (void *)&bakery,
+		.iterations = BENCH_ACQUISITIONS / nthreads,
+	};
+	uint64_t max_wait = 0U;
+	uint64_t elapsed;
+	unsigned int i;
+
+	if (run_threads(&ctx, nthreads, args, &elapsed) != 0) {
+		printf("FAIL: %s lost mutual exclusion\n", ops->name);
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0U; i < nthreads; i++) {
+		if (args[i].max_wait > max_wait) {
+			max_wait = args[i].max_wait;
+		}
+	}
+
+	printf("  %-8s %7u %12lu %10llu %12llu\n", ops->name, nthreads,
+	       ctx.counter, (unsigned long long)(elapsed / ctx.counter),
+	       (unsigned long long)(max_wait / 1000U));
+}
+
+int main(int argc, char *argv[])
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int nthreads;
+	unsigned int n;
+	int ret = EXIT_SUCCESS;
+
+	/* Use at least two threads, even on a single CPU host */
+	nthreads = (cpus > 2L) ? (unsigned int)cpus : 2U;
+	if (nthreads > MAX_THREADS) {
+		nthreads = MAX_THREADS;
+	}
+
+	for (n = 2U; n <= nthreads; n++) {
+		if (stress(n) != 0) {
+			ret = EXIT_FAILURE;
+		}
+	}
+
+	if ((argc > 1) && (argv[1][0] == '-') && (argv[1][1] == 'b')) {
+		printf("\n  %-8s %7s %12s %10s %12s\n", "lock", "threads",
+		       "acquired", "ns/acq", "max wait us");
+		for (n = 1U; n <= nthreads; n++) {
+			bench(&ticket_ops, n);
+			bench(&bakery_ops, n);
+		}
+	}
+
+	return ret;
+}
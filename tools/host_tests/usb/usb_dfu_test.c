@@ -0,0 +1,670 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the DFU class over the USB device core. The controller driver
+ * is a simulated gadget: control transfers from a simulated DFU host are
+ * delivered through its interrupt handler, one max-packet per EP0 transfer
+ * as on the STM32MP1 OTG controller, or in a single transfer with
+ * USB_CORE_AVOID_PACKET_SPLIT_MPS as on the STM32MP2 DWC3 controller.
+ *
+ * The DFU state machine is checked for download, upload, errors and detach,
+ * and the number of transfers needed per MiB is reported for host blocks of
+ * 1024 bytes and of wTransferSize.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <common/debug.h>
+#include <drivers/usb_device.h>
+
+#include <usb_dfu.h>
+
+#define EP0_MPS			USB_MAX_EP0_SIZE
+#define IMAGE_SIZE		(1024U * 1024U)
+#define SMALL_IMAGE_SIZE	(3U * 1024U + 100U)
+#define MAX_IT			100000U
+
+/* DFU requests and states, as seen by the host */
+#define DFU_DETACH		0U
+#define DFU_DNLOAD		1U
+#define DFU_UPLOAD		2U
+#define DFU_GETSTATUS		3U
+#define DFU_CLRSTATUS		4U
+#define DFU_GETSTATE		5U
+#define DFU_ABORT		6U
+
+#define DFU_IDLE		2U
+#define DFU_DNLOAD_SYNC		3U
+#define DFU_DNLOAD_IDLE		5U
+#define DFU_MANIFEST		7U
+#define DFU_UPLOAD_IDLE		9U
+#define DFU_ERROR		10U
+
+#define DFU_STATUS_OK		0x00U
+#define DFU_STATUS_STALLEDPKT	0x0FU
+#define DFU_STATUS_UNKNOWN	0x0EU
+
+#define REQ_OUT_CLASS		(USB_REQ_TYPE_CLASS | USB_REQ_RECIPIENT_INTERFACE)
+#define REQ_IN_CLASS		(USB_REQ_DIRECTION | REQ_OUT_CLASS)
+
+/* Alternate setting whose upload callback fails */
+#define ALT_UPLOAD_ERROR	2U
+
+#define USB_DFU_CONFIG_DESC_SIZ	USB_DFU_DESC_SIZ(3U)
+
+static const uint8_t device_desc[USB_LEN_DEV_DESC] = {
+	USB_LEN_DEV_DESC,
+	USB_DESC_TYPE_DEVICE,
+	0x00, 0x02,		/* bcdUSB */
+	0x00, 0x00, 0x00,	/* Class, subclass, protocol */
+	EP0_MPS,
+	0x83, 0x04,		/* idVendor */
+	0x11, 0xDF,		/* idProduct */
+	0x00, 0x02,		/* bcdDevice */
+	USBD_IDX_MFC_STR,
+	USBD_IDX_PRODUCT_STR,
+	USBD_IDX_SERIAL_STR,
+	USBD_MAX_NUM_CONFIGURATION
+};
+
+/* Same layout as on STM32MP */
+static const uint8_t config_desc[USB_DFU_CONFIG_DESC_SIZ] = {
+	0x09,
+	USB_DESC_TYPE_CONFIGURATION,
+	USB_DFU_CONFIG_DESC_SIZ,
+	0x00,
+	0x01,
+	0x01,
+	0x02,
+	0xC0,
+	0x32,
+	USBD_DFU_IF_DESC(0),
+	USBD_DFU_IF_DESC(1),
+	USBD_DFU_IF_DESC(2),
+	0x09,
+	DFU_DESCRIPTOR_TYPE,
+	DFU_BM_ATTRIBUTE,
+	0xFF,
+	0x00,
+	TRANSFER_SIZE_BYTES(USBD_DFU_XFER_SIZE),
+	((USB_DFU_VERSION >> 0) & 0xFF),
+	((USB_DFU_VERSION >> 8) & 0xFF)
+};
+
+static uint8_t *get_device_desc(uint16_t *length)
+{
+	*length = sizeof(device_desc);
+	return (uint8_t *)device_desc;
+}
+
+static uint8_t *get_config_desc(uint16_t *length)
+{
+	*length = sizeof(config_desc);
+	return (uint8_t *)config_desc;
+}
+
+static const struct usb_desc usb_desc = {
+	.get_device_desc = get_device_desc,
+	.get_config_desc = get_config_desc,
+};
+
+/* Simulated controller, and the control transfer the host is doing */
+static struct {
+	uint8_t *data;
+	uint32_t len;
+	uint32_t count;
+	bool in_dir;
+	bool setup_pending;
+	bool in_pending;
+	bool out_pending;
+	bool in_complete;
+	bool out_status_armed;
+	bool stalled;
+	bool done;
+	bool inject_detach;
+} host;
+
+static struct {
+	unsigned long control;
+	unsigned long ep0_xfers;
+} counts;
+
+static struct usb_handle usb_dev;
+static struct pcd_handle pcd;
+static struct usb_dfu_handle dfu_handle;
+static uint8_t controller;
+
+static uint8_t image[IMAGE_SIZE];
+static uint8_t target[IMAGE_SIZE];
+static uint32_t dnload_offset;
+static uint32_t upload_offset;
+static uint32_t upload_size;
+static unsigned int manifested;
+
+static uint32_t seed = 1U;
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	(void)vprintf(fmt + 1, args);
+	va_end(args);
+}
+
+#if ENABLE_ASSERTIONS
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+#endif
+
+static uint32_t random_u32(void)
+{
+	/* Numerical Recipes LCG, the upper bits are good enough here */
+	seed = (seed * 1664525U) + 1013904223U;
+
+	return seed >> 8;
+}
+
+static enum usb_status sim_ep0_out_start(void *handle)
+{
+	return USBD_OK;
+}
+
+/*
+ * The OTG controller of STM32MP1 moves one max-packet per EP0 transfer, the
+ * core splits the data stage. With USB_CORE_AVOID_PACKET_SPLIT_MPS, the whole
+ * data stage is a single transfer.
+ */
+static enum usb_status sim_ep0_start_xfer(void *handle, struct usbd_ep *ep)
+{
+	uint32_t len = ep->xfer_len;
+	uint32_t n;
+
+#ifndef USB_CORE_AVOID_PACKET_SPLIT_MPS
+	len = MIN(len, EP0_MPS);
+#endif
+
+	counts.ep0_xfers++;
+	ep->xfer_count = len;
+
+	if (ep->is_in) {
+		if (host.in_dir) {
+			n = MIN(len, host.len - host.count);
+			memcpy(host.data + host.count, ep->xfer_buff, n);
+			host.count += n;
+			/* Short packet or all the data the host asked for */
+			host.in_complete = ((len % EP0_MPS) != 0U) ||
+					   (len == 0U) ||
+					   (host.count == host.len);
+		}
+		if (ep->xfer_buff != NULL) {
+			ep->xfer_buff += len;
+		}
+		host.in_pending = true;
+		return USBD_OK;
+	}
+
+	if (len == 0U) {
+		/* Status stage of an IN transfer */
+		host.out_status_armed = true;
+		return USBD_OK;
+	}
+
+	if (!host.in_dir) {
+		n = MIN(len, host.len - host.count);
+		memcpy(ep->xfer_buff, host.data + host.count, n);
+		host.count += n;
+		ep->xfer_buff += n;
+	}
+	host.out_pending = true;
+
+	return USBD_OK;
+}
+
+static enum usb_status sim_ep_set_stall(void *handle, struct usbd_ep *ep)
+{
+	host.stalled = true;
+
+	return USBD_OK;
+}
+
+static enum usb_status sim_set_address(void *handle, uint8_t address)
+{
+	return USBD_OK;
+}
+
+static void sim_setup(uint8_t bm, uint8_t req, uint16_t value,
+		      uint16_t index, uint16_t length)
+{
+	uint8_t *setup = (uint8_t *)pcd.setup;
+
+	setup[0] = bm;
+	setup[1] = req;
+	setup[2] = LOBYTE(value);
+	setup[3] = HIBYTE(value);
+	setup[4] = LOBYTE(index);
+	setup[5] = HIBYTE(index);
+	setup[6] = LOBYTE(length);
+	setup[7] = HIBYTE(length);
+	host.setup_pending = true;
+}
+
+static enum usb_action sim_it_handler(void *handle, uint32_t *param)
+{
+	*param = 0U;
+
+	if (host.stalled) {
+		return USB_NOTHING;
+	}
+
+	if (host.setup_pending) {
+		host.setup_pending = false;
+		return USB_SETUP;
+	}
+
+	if (host.in_pending) {
+		host.in_pending = false;
+		if (!host.in_dir) {
+			/* Status stage of an OUT transfer */
+			host.done = true;
+		}
+		return USB_DATA_IN;
+	}
+
+	if (host.out_pending) {
+		host.out_pending = false;
+		return USB_DATA_OUT;
+	}
+
+	if (host.out_status_armed && host.in_dir && host.in_complete) {
+		host.out_status_armed = false;
+		host.done = true;
+		return USB_DATA_OUT;
+	}
+
+	/* Detach request sent while in usb_dfu_loop() */
+	if (host.inject_detach) {
+		memset(&host, 0, sizeof(host));
+		sim_setup(REQ_OUT_CLASS, DFU_DETACH, 1000U, 0U, 0U);
+		host.setup_pending = false;
+		return USB_SETUP;
+	}
+
+	return USB_NOTHING;
+}
+
+static const struct usb_driver sim_driver = {
+	.ep0_out_start = sim_ep0_out_start,
+	.ep0_start_xfer = sim_ep0_start_xfer,
+	.ep_set_stall = sim_ep_set_stall,
+	.set_address = sim_set_address,
+	.it_handler = sim_it_handler,
+};
+
+/*
+ * Run a control transfer from the simulated host.
+ *
+ * Return: the number of bytes of the data stage, or -EPIPE if the device
+ * stalled the transfer
+ */
+static int control(uint8_t bm, uint8_t req, uint16_t value, uint16_t index,
+		   void *data, uint16_t length)
+{
+	unsigned int i;
+
+	memset(&host, 0, sizeof(host));
+	host.data = data;
+	host.len = length;
+	host.in_dir = (bm & USB_REQ_DIRECTION) != 0U;
+	sim_setup(bm, req, value, index, length);
+
+	counts.control++;
+
+	for (i = 0U; (i < MAX_IT) && !host.done && !host.stalled; i++) {
+		if (usb_core_handle_it(&usb_dev) != USBD_OK) {
+			return -EIO;
+		}
+	}
+
+	if (host.stalled) {
+		return -EPIPE;
+	}
+
+	if (!host.done) {
+		return -ETIMEDOUT;
+	}
+
+	return (int)host.count;
+}
+
+static int get_status(uint8_t *status)
+{
+	uint8_t buf[DFU_STATUS_SIZE];
+	int ret;
+
+	ret = control(REQ_IN_CLASS, DFU_GETSTATUS, 0U, 0U, buf, sizeof(buf));
+	if (ret != (int)sizeof(buf)) {
+		return -EIO;
+	}
+
+	*status = buf[0];
+
+	return buf[4];
+}
+
+static int get_state(void)
+{
+	uint8_t state;
+
+	if (control(REQ_IN_CLASS, DFU_GETSTATE, 0U, 0U, &state, 1U) != 1) {
+		return -EIO;
+	}
+
+	return state;
+}
+
+static int dfu_media_download(uint8_t alt, uintptr_t *buffer, uint32_t *len,
+			      void *user_data)
+{
+	if (*len > (sizeof(target) - dnload_offset)) {
+		return -ENOMEM;
+	}
+
+	/* Straight to the load address */
+	*buffer = (uintptr_t)target + dnload_offset;
+	dnload_offset += *len;
+
+	return 0;
+}
+
+static int dfu_media_upload(uint8_t alt, uintptr_t *buffer, uint32_t *len,
+			    void *user_data)
+{
+	if (alt == ALT_UPLOAD_ERROR) {
+		return -EIO;
+	}
+
+	*len = MIN(*len, upload_size - upload_offset);
+	*buffer = (uintptr_t)image + upload_offset;
+	upload_offset += *len;
+
+	return 0;
+}
+
+static int dfu_media_manifestation(uint8_t alt, void *user_data)
+{
+	manifested++;
+
+	return 0;
+}
+
+static const struct usb_dfu_media dfu_media = {
+	.upload = dfu_media_upload,
+	.download = dfu_media_download,
+	.manifestation = dfu_media_manifestation,
+};
+
+static void usb_init(void)
+{
+	unsigned int i;
+
+	for (i = 0U; i < USBD_EP_NB; i++) {
+		pcd.in_ep[i].maxpacket = EP0_MPS;
+		pcd.out_ep[i].maxpacket = EP0_MPS;
+	}
+
+	CHECK(register_usb_driver(&usb_dev, &pcd, &sim_driver,
+				  &controller) == USBD_OK);
+	CHECK(register_platform(&usb_dev, &usb_desc) == USBD_OK);
+	usb_dfu_register(&usb_dev, &dfu_handle);
+	dfu_handle.callback = &dfu_media;
+
+	for (i = 0U; i < IMAGE_SIZE; i++) {
+		image[i] = (uint8_t)random_u32();
+	}
+}
+
+static void test_enumeration(void)
+{
+	uint8_t buf[256];
+	uint16_t xfer_size;
+
+	CHECK(control(USB_REQ_DIRECTION, USB_REQ_GET_DESCRIPTOR,
+		      USB_DESC_TYPE_DEVICE << 8, 0U, buf,
+		      sizeof(buf)) == USB_LEN_DEV_DESC);
+	CHECK(control(0U, USB_REQ_SET_ADDRESS, 5U, 0U, NULL, 0U) == 0);
+	CHECK(control(USB_REQ_DIRECTION, USB_REQ_GET_DESCRIPTOR,
+		      USB_DESC_TYPE_CONFIGURATION << 8, 0U, buf,
+		      sizeof(buf)) == USB_DFU_CONFIG_DESC_SIZ);
+	CHECK(memcmp(buf, config_desc, sizeof(config_desc)) == 0);
+	CHECK(control(0U, USB_REQ_SET_CONFIGURATION, 1U, 0U, NULL, 0U) == 0);
+	CHECK(usb_dev.dev_state == USBD_STATE_CONFIGURED);
+
+	/* Class requests are only accepted once configured */
+	CHECK(control(USB_REQ_RECIPIENT_INTERFACE, USB_REQ_SET_INTERFACE, 1U,
+		      0U, NULL, 0U) == 0);
+	CHECK(dfu_handle.alt_setting == 1U);
+
+	/* DFU functional descriptor */
+	CHECK(control(USB_REQ_DIRECTION | USB_REQ_RECIPIENT_INTERFACE,
+		      USB_REQ_GET_DESCRIPTOR, DFU_DESCRIPTOR_TYPE << 8, 0U,
+		      buf, 9U) == 9);
+	xfer_size = buf[5] | (buf[6] << 8);
+	CHECK(buf[1] == DFU_DESCRIPTOR_TYPE);
+	CHECK(xfer_size == USBD_DFU_XFER_SIZE);
+}
+
+/*
+ * Download an image as dfu-util does: DNLOAD then GETSTATUS for each block,
+ * an empty DNLOAD and the GETSTATUS of the manifestation.
+ */
+static void download(uint32_t size, uint16_t block_size)
+{
+	uint16_t block = 0U;
+	uint32_t pos;
+	uint8_t status;
+	int len;
+
+	dnload_offset = 0U;
+	manifested = 0U;
+	memset(target, 0, size);
+
+	for (pos = 0U; pos < size; pos += (uint32_t)len) {
+		len = (int)MIN((uint32_t)block_size, size - pos);
+		if (control(REQ_OUT_CLASS, DFU_DNLOAD, block++, 0U,
+			    image + pos, (uint16_t)len) != len) {
+			CHECK(false);
+			return;
+		}
+
+		if ((get_status(&status) != DFU_DNLOAD_SYNC) ||
+		    (status != DFU_STATUS_OK)) {
+			CHECK(false);
+			return;
+		}
+	}
+
+	CHECK(get_state() == DFU_DNLOAD_IDLE);
+	CHECK(control(REQ_OUT_CLASS, DFU_DNLOAD, block, 0U, NULL, 0U) == 0);
+	CHECK(get_status(&status) == DFU_MANIFEST);
+	CHECK(get_state() == DFU_IDLE);
+	CHECK(manifested == 1U);
+	CHECK(memcmp(target, image, size) == 0);
+}
+
+static void test_download(void)
+{
+	uint16_t block_size;
+
+	download(SMALL_IMAGE_SIZE, USBD_DFU_XFER_SIZE);
+	download(SMALL_IMAGE_SIZE, 1024U);
+
+	/* Blocks a host may pick: wTransferSize at most */
+	for (block_size = EP0_MPS; block_size <= USBD_DFU_XFER_SIZE;
+	     block_size *= 2U) {
+		download(SMALL_IMAGE_SIZE, block_size);
+		download(SMALL_IMAGE_SIZE, block_size - 1U);
+	}
+
+	/* Block not fitting at the load address */
+	dnload_offset = sizeof(target) - 100U;
+	CHECK(control(REQ_OUT_CLASS, DFU_DNLOAD, 0U, 0U, image, 200U) ==
+	      -EPIPE);
+	CHECK(get_state() == DFU_IDLE);
+}
+
+static void bench_download(uint16_t block_size)
+{
+	unsigned long control_before = counts.control;
+	unsigned long xfers_before = counts.ep0_xfers;
+
+	download(IMAGE_SIZE, block_size);
+
+	printf("  1 MiB download, %u-byte blocks: %lu control transfers, %lu EP0 transfers\n",
+	       block_size, counts.control - control_before,
+	       counts.ep0_xfers - xfers_before);
+}
+
+static void test_upload(void)
+{
+	uint8_t buf[USBD_DFU_XFER_SIZE];
+	uint8_t status;
+	uint16_t block = 0U;
+	uint32_t pos = 0U;
+	int len;
+
+	upload_offset = 0U;
+	upload_size = SMALL_IMAGE_SIZE;
+
+	do {
+		len = control(REQ_IN_CLASS, DFU_UPLOAD, block++, 0U, buf,
+			      sizeof(buf));
+		if ((len < 0) || (memcmp(buf, image + pos, len) != 0)) {
+			CHECK(false);
+			return;
+		}
+		pos += (uint32_t)len;
+		if (len == (int)sizeof(buf)) {
+			CHECK(get_state() == DFU_UPLOAD_IDLE);
+		}
+	} while (len == (int)sizeof(buf));
+
+	/* The short frame ends the upload */
+	CHECK(pos == SMALL_IMAGE_SIZE);
+	CHECK(get_status(&status) == DFU_IDLE);
+	CHECK(status == DFU_STATUS_OK);
+
+	/* Upload of a multiple of the max packet size, ended by a ZLP */
+	upload_offset = 0U;
+	upload_size = 3U * EP0_MPS;
+	CHECK(control(REQ_IN_CLASS, DFU_UPLOAD, 0U, 0U, buf, sizeof(buf)) ==
+	      (int)(3U * EP0_MPS));
+	CHECK(memcmp(buf, image, 3U * EP0_MPS) == 0);
+	CHECK(get_state() == DFU_IDLE);
+}
+
+static void test_errors(void)
+{
+	uint8_t buf[EP0_MPS];
+	uint8_t status;
+
+	/* Empty DNLOAD without a download in progress */
+	CHECK(control(REQ_OUT_CLASS, DFU_DNLOAD, 0U, 0U, NULL, 0U) == -EPIPE);
+	CHECK(get_state() == DFU_IDLE);
+
+	/* DNLOAD while uploading */
+	upload_offset = 0U;
+	upload_size = SMALL_IMAGE_SIZE;
+	CHECK(control(REQ_IN_CLASS, DFU_UPLOAD, 0U, 0U, buf,
+		      sizeof(buf)) == (int)sizeof(buf));
+	CHECK(get_state() == DFU_UPLOAD_IDLE);
+	dnload_offset = 0U;
+	CHECK(control(REQ_OUT_CLASS, DFU_DNLOAD, 0U, 0U, image, 16U) ==
+	      -EPIPE);
+
+	/* ABORT goes back to idle */
+	CHECK(control(REQ_OUT_CLASS, DFU_ABORT, 0U, 0U, NULL, 0U) == 0);
+	CHECK(get_state() == DFU_IDLE);
+
+	/* Failing upload, then CLRSTATUS */
+	CHECK(control(USB_REQ_RECIPIENT_INTERFACE, USB_REQ_SET_INTERFACE,
+		      ALT_UPLOAD_ERROR, 0U, NULL, 0U) == 0);
+	CHECK(control(REQ_IN_CLASS, DFU_UPLOAD, 0U, 0U, buf, sizeof(buf)) ==
+	      -EPIPE);
+	CHECK(get_status(&status) == DFU_ERROR);
+	CHECK(status == DFU_STATUS_STALLEDPKT);
+	CHECK(control(REQ_OUT_CLASS, DFU_CLRSTATUS, 0U, 0U, NULL, 0U) == 0);
+	CHECK(get_status(&status) == DFU_IDLE);
+	CHECK(status == DFU_STATUS_OK);
+
+	/* CLRSTATUS without an error */
+	CHECK(control(REQ_OUT_CLASS, DFU_CLRSTATUS, 0U, 0U, NULL, 0U) == 0);
+	CHECK(get_status(&status) == DFU_ERROR);
+	CHECK(status == DFU_STATUS_UNKNOWN);
+	CHECK(control(REQ_OUT_CLASS, DFU_CLRSTATUS, 0U, 0U, NULL, 0U) == 0);
+	CHECK(get_state() == DFU_IDLE);
+
+	/* Unknown class request */
+	CHECK(control(REQ_IN_CLASS, 0x42U, 0U, 0U, buf, 1U) == -EPIPE);
+
+	CHECK(control(USB_REQ_RECIPIENT_INTERFACE, USB_REQ_SET_INTERFACE, 1U,
+		      0U, NULL, 0U) == 0);
+}
+
+/* DETACH ends the DFU loop */
+static void test_detach(void)
+{
+	host.inject_detach = true;
+	CHECK(usb_dfu_loop(&usb_dev, &dfu_media) == 0);
+	CHECK(!host.stalled);
+	CHECK(get_state() == DFU_IDLE);
+}
+
+int main(void)
+{
+	usb_init();
+
+	test_enumeration();
+	test_download();
+	test_upload();
+	test_errors();
+	test_detach();
+
+	bench_download(1024U);
+	if (USBD_DFU_XFER_SIZE != 1024U) {
+		bench_download(USBD_DFU_XFER_SIZE);
+	}
+
+	if (failures != 0U) {
+		printf("FAIL: usb_dfu, %u failures\n", failures);
+		return 1;
+	}
+
+	printf("PASS: usb_dfu\n");
+	return 0;
+}
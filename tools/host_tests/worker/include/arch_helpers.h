@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef ARCH_HELPERS_H
+#define ARCH_HELPERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Host replacement of the architecture helpers used by the BL2 worker: the
+ * cores are host threads, the barriers are full fences, WFE yields and the
+ * generic counter is the host monotonic clock.
+ */
+void wfe(void);
+void sev(void);
+void dsbish(void);
+void dmbish(void);
+void flush_dcache_range(uintptr_t addr, size_t size);
+void inv_dcache_range(uintptr_t addr, size_t size);
+uint64_t read_cntpct_el0(void);
+uint64_t read_cntfrq_el0(void);
+
+#endif /* ARCH_HELPERS_H */
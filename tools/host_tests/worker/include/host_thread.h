@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef HOST_THREAD_H
+#define HOST_THREAD_H
+
+#include <cdefs.h>
+
+/*
+ * Host libc functions used to run the secondary core as a thread. The test is
+ * built with the TF-A libc headers, which have no threads nor clocks.
+ */
+typedef unsigned long pthread_t;
+
+struct host_timespec {
+	long tv_sec;
+	long tv_nsec;
+};
+
+#define HOST_CLOCK_MONOTONIC	1
+
+int pthread_create(pthread_t *thread, const void *attr,
+		   void *(*start_routine)(void *), void *arg);
+int pthread_join(pthread_t thread, void **retval);
+void pthread_exit(void *retval) __dead2;
+pthread_t pthread_self(void);
+int sched_yield(void);
+int clock_gettime(int clk_id, struct host_timespec *tp);
+
+#endif /* HOST_THREAD_H */
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PLATFORM_DEF_H
+#define PLATFORM_DEF_H
+
+#include <stdint.h>
+
+#include <lib/utils_def.h>
+
+/*
+ * Host build of the BL2 worker and of the DDR scrub, with the STM32MP25
+ * values. The DDR is a buffer of the test.
+ */
+extern uint8_t test_ddr[];
+
+#define PLATFORM_STACK_SIZE		0xC00
+#define CACHE_WRITEBACK_GRANULE		64
+
+#define STM32MP_DDR_BASE		((uintptr_t)test_ddr)
+
+#include <stm32mp_dt.h>
+
+#endif /* PLATFORM_DEF_H */
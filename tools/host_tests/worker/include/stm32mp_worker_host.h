@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef STM32MP_WORKER_HOST_H
+#define STM32MP_WORKER_HOST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <host_thread.h>
+
+/*
+ * Host platform of the BL2 worker: stm32mp_plat_worker_cpu_on() releases the
+ * secondary core as a thread, the park and reset functions end and join it.
+ */
+enum cpu_on_mode {
+	CPU_ON_OK,
+	CPU_ON_ERROR,		/* Release request refused */
+	CPU_ON_STALL,		/* Core released, never reaches the entry */
+};
+
+extern pthread_t main_thread;
+extern pthread_t worker_thread;
+extern unsigned int cpu_on_calls;
+extern unsigned int cpu_off_calls;
+extern uint32_t stm32mp_worker_parked[];
+
+/* Called on each flush_dcache_range(), from any core */
+extern void (*flush_dcache_hook)(uintptr_t addr, size_t size);
+
+void worker_host_init(void);
+void worker_host_reset(enum cpu_on_mode mode);
+
+#endif /* STM32MP_WORKER_HOST_H */
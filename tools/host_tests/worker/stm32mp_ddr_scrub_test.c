@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the DDR scrub, built as on STM32MP25 with the BL2 worker, the
+ * secondary core being a host thread. Each scrub is checked to zero exactly
+ * the region, with cache maintenance on chunks that tile it, and to hand the
+ * upper half of the regions of two chunks or more to the worker. The same
+ * regions are scrubbed by the primary core alone when the worker is stopped
+ * or cannot start, as on STM32MP251. Regions out of the DDR are rejected.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <drivers/st/stm32mp_ddr_scrub.h>
+#include <lib/utils.h>
+
+#include <platform_def.h>
+#include <stm32mp_worker.h>
+#include <stm32mp_worker_host.h>
+
+#define DDR_SIZE		U(0x400000)
+#define CHUNK_SIZE		U(0x10000)
+#define PATTERN			0xA5U
+#define MAX_FLUSHES		256U
+#define RANDOM_RUNS		300U
+
+struct flush_entry {
+	uintptr_t addr;
+	size_t size;
+	pthread_t thread;
+};
+
+uint8_t test_ddr[DDR_SIZE] __aligned(CHUNK_SIZE);
+
+static struct flush_entry flushes[MAX_FLUSHES];
+static volatile unsigned int nb_flushes;
+static uint64_t prng_state = 0x9E3779B97F4A7C15ULL;
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+static uint64_t prng(void)
+{
+	prng_state ^= prng_state << 13;
+	prng_state ^= prng_state >> 7;
+	prng_state ^= prng_state << 17;
+
+	return prng_state;
+}
+
+size_t dt_get_ddr_size(void)
+{
+	return DDR_SIZE;
+}
+
+void zero_normalmem(void *mem, u_register_t length)
+{
+	memset(mem, 0, length);
+}
+
+static void record_flush(uintptr_t addr, size_t size)
+{
+	unsigned int i;
+
+	if ((addr < STM32MP_DDR_BASE) || (addr >= (STM32MP_DDR_BASE + DDR_SIZE))) {
+		return;
+	}
+
+	i = __atomic_fetch_add(&nb_flushes, 1U, __ATOMIC_SEQ_CST);
+	if (i >= MAX_FLUSHES) {
+		printf("FAIL: too many flushes\n");
+		exit(EXIT_FAILURE);
+	}
+
+	flushes[i].addr = addr;
+	flushes[i].size = size;
+	flushes[i].thread = pthread_self();
+}
+
+/* The two cores flush their chunks concurrently */
+static void sort_flushes(void)
+{
+	struct flush_entry entry;
+	unsigned int i;
+	unsigned int j;
+
+	for (i = 1U; i < nb_flushes; i++) {
+		entry = flushes[i];
+		for (j = i; (j > 0U) && (flushes[j - 1U].addr > entry.addr); j--) {
+			flushes[j] = flushes[j - 1U];
+		}
+		flushes[j] = entry;
+	}
+}
+
+/* Scrub [offset, offset + size) of the DDR and check the result */
+static void check_scrub(size_t offset, size_t size, bool on_worker)
+{
+	uintptr_t base = STM32MP_DDR_BASE + offset;
+	size_t high = 0U;
+	uintptr_t next;
+	unsigned int i;
+	size_t pos;
+
+	memset(test_ddr, PATTERN, DDR_SIZE);
+	nb_flushes = 0U;
+
+	CHECK(stm32mp_ddr_scrub(base, size) == 0);
+
+	for (pos = 0U; pos < DDR_SIZE; pos++) {
+		bool inside = (pos >= offset) && (pos < (offset + size));
+
+		if (test_ddr[pos] != (inside ? 0U : PATTERN)) {
+			printf("FAIL: byte 0x%zx for [0x%zx, +0x%zx)\n",
+			       pos, offset, size);
+			failures++;
+			return;
+		}
+	}
+
+	if (on_worker && (size >= (2U * CHUNK_SIZE))) {
+		high = round_down(size / 2U, (size_t)CHUNK_SIZE);
+	}
+
+	/* Cache maintenance on chunks tiling the region */
+	sort_flushes();
+	next = base;
+	for (i = 0U; i < nb_flushes; i++) {
+		bool upper = flushes[i].addr >= (base + size - high);
+
+		CHECK(flushes[i].addr == next);
+		CHECK((flushes[i].size != 0U) && (flushes[i].size <= CHUNK_SIZE));
+		CHECK(flushes[i].thread == (upper ? worker_thread : main_thread));
+		next = flushes[i].addr + flushes[i].size;
+	}
+
+	CHECK(next == (base + size));
+}
+
+static void test_bounds(void)
+{
+	unsigned int before = failures;
+
+	memset(test_ddr, PATTERN, DDR_SIZE);
+
+	CHECK(stm32mp_ddr_scrub(STM32MP_DDR_BASE - CHUNK_SIZE, 2U * CHUNK_SIZE) == -EINVAL);
+	CHECK(stm32mp_ddr_scrub(STM32MP_DDR_BASE, 0U) == -EINVAL);
+	CHECK(stm32mp_ddr_scrub(STM32MP_DDR_BASE + DDR_SIZE, 1U) == -EINVAL);
+	CHECK(stm32mp_ddr_scrub(STM32MP_DDR_BASE, DDR_SIZE + 1U) == -EINVAL);
+	CHECK(stm32mp_ddr_scrub(STM32MP_DDR_BASE + 1U, DDR_SIZE) == -EINVAL);
+	CHECK(stm32mp_ddr_scrub(STM32MP_DDR_BASE + CHUNK_SIZE, SIZE_MAX) == -EINVAL);
+
+	CHECK((test_ddr[0] == PATTERN) && (test_ddr[DDR_SIZE - 1U] == PATTERN));
+
+	if (failures == before) {
+		printf("PASS: bounds\n");
+	}
+}
+
+/* Region sizes around the split threshold, then random regions */
+static void test_regions(const char *name, bool on_worker)
+{
+	static const size_t sizes[] = {
+		1U, CHUNK_SIZE - 1U, CHUNK_SIZE, CHUNK_SIZE + 1U,
+		(2U * CHUNK_SIZE) - 1U, 2U * CHUNK_SIZE, (3U * CHUNK_SIZE) + 64U,
+		DDR_SIZE,
+	};
+	unsigned int before = failures;
+	unsigned int run;
+	unsigned int i;
+
+	for (i = 0U; i < ARRAY_SIZE(sizes); i++) {
+		check_scrub(0U, sizes[i], on_worker);
+	}
+
+	for (run = 0U; (run < RANDOM_RUNS) && (failures == before); run++) {
+		size_t offset = (size_t)(prng() % DDR_SIZE);
+		size_t size = 1U + (size_t)(prng() % (DDR_SIZE - offset));
+
+		/* Mostly RISAF granule aligned regions */
+		if ((run % 4U) != 0U) {
+			offset = round_down(offset, (size_t)U(0x1000));
+			size = round_up(size, (size_t)U(0x1000));
+			if (size > (DDR_SIZE - offset)) {
+				size = DDR_SIZE - offset;
+			}
+		}
+
+		check_scrub(offset, size, on_worker);
+	}
+
+	if (failures == before) {
+		printf("PASS: %s, %u random regions\n", name, RANDOM_RUNS);
+	}
+}
+
+int main(void)
+{
+	worker_host_init();
+	flush_dcache_hook = record_flush;
+
+	test_bounds();
+
+	test_regions("primary core only", false);
+
+	worker_host_reset(CPU_ON_OK);
+	CHECK(stm32mp_worker_start() == 0);
+	test_regions("split with the worker", true);
+	stm32mp_worker_stop();
+	CHECK(!stm32mp_worker_is_running());
+
+	/* Single core part: the release is refused */
+	worker_host_reset(CPU_ON_ERROR);
+	CHECK(stm32mp_worker_start() != 0);
+	test_regions("worker not started", false);
+
+	if (failures != 0U) {
+		printf("FAIL: stm32mp_ddr_scrub, %u failures\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS: stm32mp_ddr_scrub\n");
+
+	return EXIT_SUCCESS;
+}
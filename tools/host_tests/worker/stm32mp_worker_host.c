@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host platform of the BL2 worker tests: the libc and architecture helpers,
+ * and the secondary core as a host thread.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <common/debug.h>
+#include <lib/xlat_tables/xlat_mmu_helpers.h>
+
+#include <stm32mp_worker.h>
+#include <stm32mp_worker_host.h>
+
+uint64_t mmu_cfg_params[MMU_CFG_PARAM_MAX];
+extern uintptr_t stm32mp_worker_sp;
+
+pthread_t main_thread;
+pthread_t worker_thread;
+unsigned int cpu_on_calls;
+unsigned int cpu_off_calls;
+void (*flush_dcache_hook)(uintptr_t addr, size_t size);
+
+static enum cpu_on_mode cpu_on_mode;
+static bool worker_thread_created;
+static bool sp_flushed;
+static bool mmu_cfg_flushed;
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	(void)vprintf(fmt + 1, args);
+	va_end(args);
+}
+
+/* Called by panic(), exit() flushes the host output */
+void console_flush(void)
+{
+}
+
+void __dead2 do_panic(void)
+{
+	printf("PANIC\n");
+	exit(1);
+	__builtin_unreachable();
+}
+
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+
+void wfe(void)
+{
+	(void)sched_yield();
+}
+
+void sev(void)
+{
+}
+
+void dsbish(void)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void dmbish(void)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/* The secondary core reads these with its MMU and caches disabled */
+void flush_dcache_range(uintptr_t addr, size_t size)
+{
+	if ((addr == (uintptr_t)&stm32mp_worker_sp) &&
+	    (size == sizeof(stm32mp_worker_sp))) {
+		sp_flushed = true;
+	}
+
+	if ((addr == (uintptr_t)mmu_cfg_params) &&
+	    (size == sizeof(mmu_cfg_params))) {
+		mmu_cfg_flushed = true;
+	}
+
+	if (flush_dcache_hook != NULL) {
+		flush_dcache_hook(addr, size);
+	}
+
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void inv_dcache_range(uintptr_t addr, size_t size)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+uint64_t read_cntpct_el0(void)
+{
+	struct host_timespec ts;
+
+	(void)clock_gettime(HOST_CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t read_cntfrq_el0(void)
+{
+	return 1000000000ULL;
+}
+
+static void *worker_thread_entry(void *arg)
+{
+	if (cpu_on_mode == CPU_ON_STALL) {
+		return NULL;
+	}
+
+	/* Entry code: stack from the flushed stm32mp_worker_sp */
+	if (!sp_flushed || !mmu_cfg_flushed || (stm32mp_worker_sp == 0U)) {
+		printf("FAIL: worker entered with stale parameters\n");
+		exit(EXIT_FAILURE);
+	}
+
+	stm32mp_worker_main();
+}
+
+int stm32mp_plat_worker_cpu_on(void)
+{
+	cpu_on_calls++;
+
+	if (cpu_on_mode == CPU_ON_ERROR) {
+		return -ENODEV;
+	}
+
+	if (pthread_create(&worker_thread, NULL, worker_thread_entry, NULL) != 0) {
+		printf("FAIL: pthread_create\n");
+		exit(EXIT_FAILURE);
+	}
+
+	worker_thread_created = true;
+
+	return 0;
+}
+
+void stm32mp_plat_worker_cpu_park(void)
+{
+	stm32mp_worker_parked[0] = 1U;
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	pthread_exit(NULL);
+}
+
+/* Core reset: the thread is gone once parked */
+void stm32mp_plat_worker_cpu_off(void)
+{
+	cpu_off_calls++;
+
+	if (worker_thread_created) {
+		(void)pthread_join(worker_thread, NULL);
+		worker_thread_created = false;
+	}
+}
+
+void worker_host_init(void)
+{
+	main_thread = pthread_self();
+}
+
+void worker_host_reset(enum cpu_on_mode mode)
+{
+	cpu_on_mode = mode;
+	cpu_on_calls = 0U;
+	cpu_off_calls = 0U;
+	sp_flushed = false;
+	mmu_cfg_flushed = false;
+}
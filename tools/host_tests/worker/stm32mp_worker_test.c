@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the BL2 worker, with the secondary core emulated by a thread
+ * released by stm32mp_plat_worker_cpu_on(). The jobs are checked to run on the
+ * worker in submission order, on the caller when the worker is not running or
+ * when the queue is full, and to be drained before the worker is parked and
+ * reset. A worker that fails to start leaves the jobs to the caller.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <stm32mp_worker.h>
+#include <stm32mp_worker_host.h>
+
+/* WORKER_QUEUE_SIZE of stm32mp_worker.c */
+#define QUEUE_SIZE		8U
+#define NB_JOBS			64U
+#define RESTARTS		20U
+
+struct test_job {
+	struct stm32mp_worker_job job;
+	unsigned int index;
+	pthread_t thread;
+	unsigned int order;
+	volatile bool *gate;
+};
+
+static volatile unsigned int run_order;
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+static int job_func(void *arg)
+{
+	struct test_job *tjob = arg;
+
+	if (tjob->gate != NULL) {
+		while (!*tjob->gate) {
+			(void)sched_yield();
+		}
+	}
+
+	tjob->thread = pthread_self();
+	tjob->order = __atomic_fetch_add(&run_order, 1U, __ATOMIC_SEQ_CST);
+
+	/* Odd jobs fail, the status is given back to the caller */
+	return ((tjob->index % 2U) != 0U) ? -(int)tjob->index : (int)tjob->index;
+}
+
+static void init_jobs(struct test_job *jobs, unsigned int nb, volatile bool *gate)
+{
+	unsigned int i;
+
+	memset(jobs, 0, nb * sizeof(*jobs));
+
+	for (i = 0U; i < nb; i++) {
+		jobs[i].job.func = job_func;
+		jobs[i].job.arg = &jobs[i];
+		jobs[i].index = i;
+		jobs[i].gate = gate;
+	}
+}
+
+static int expected_status(unsigned int index)
+{
+	return ((index % 2U) != 0U) ? -(int)index : (int)index;
+}
+
+/* Without the worker, the job is done when stm32mp_worker_submit() returns */
+static void test_not_started(void)
+{
+	struct test_job jobs[4];
+	unsigned int i;
+
+	init_jobs(jobs, 4U, NULL);
+	CHECK(!stm32mp_worker_is_running());
+
+	for (i = 0U; i < 4U; i++) {
+		stm32mp_worker_submit(&jobs[i].job);
+		CHECK(jobs[i].job.done);
+		CHECK(jobs[i].thread == main_thread);
+		CHECK(stm32mp_worker_wait(&jobs[i].job) == expected_status(i));
+	}
+
+	/* Nothing to stop */
+	stm32mp_worker_stop();
+	CHECK(cpu_off_calls == 0U);
+
+	if (failures == 0U) {
+		printf("PASS: not started\n");
+	}
+}
+
+static void test_start_failure(void)
+{
+	unsigned int before = failures;
+	struct test_job job;
+
+	worker_host_reset(CPU_ON_ERROR);
+	CHECK(stm32mp_worker_start() == -ENODEV);
+	CHECK(!stm32mp_worker_is_running());
+
+	worker_host_reset(CPU_ON_STALL);
+	CHECK(stm32mp_worker_start() == -ETIMEDOUT);
+	CHECK(!stm32mp_worker_is_running());
+	/* The released core is reset */
+	CHECK(cpu_off_calls == 1U);
+
+	init_jobs(&job, 1U, NULL);
+	stm32mp_worker_submit(&job.job);
+	CHECK(job.job.done && (job.thread == main_thread));
+
+	if (failures == before) {
+		printf("PASS: start failure\n");
+	}
+}
+
+/*
+ * A job blocked on the worker holds its queue entry: the queue takes
+ * QUEUE_SIZE jobs, the next one is run by the caller.
+ */
+static void test_queue_full(void)
+{
+	unsigned int before = failures;
+	struct test_job jobs[QUEUE_SIZE + 2U];
+	volatile bool gate = false;
+	unsigned int i;
+
+	worker_host_reset(CPU_ON_OK);
+	CHECK(stm32mp_worker_start() == 0);
+	CHECK(stm32mp_worker_is_running());
+	CHECK(cpu_on_calls == 1U);
+
+	init_jobs(jobs, QUEUE_SIZE + 2U, &gate);
+	run_order = 0U;
+
+	for (i = 0U; i < QUEUE_SIZE; i++) {
+		stm32mp_worker_submit(&jobs[i].job);
+	}
+
+	for (i = 0U; i < QUEUE_SIZE; i++) {
+		CHECK(!jobs[i].job.done);
+	}
+
+	/* Run by the caller: it must not wait for the gate */
+	jobs[QUEUE_SIZE].gate = NULL;
+	stm32mp_worker_submit(&jobs[QUEUE_SIZE].job);
+	CHECK(jobs[QUEUE_SIZE].job.done);
+	CHECK(jobs[QUEUE_SIZE].thread == main_thread);
+	CHECK(jobs[QUEUE_SIZE].order == 0U);
+
+	gate = true;
+
+	for (i = 0U; i < QUEUE_SIZE; i++) {
+		CHECK(stm32mp_worker_wait(&jobs[i].job) == expected_status(i));
+		CHECK(jobs[i].thread == worker_thread);
+		CHECK(jobs[i].order == (i + 1U));
+	}
+
+	/* An entry is free again */
+	stm32mp_worker_submit(&jobs[QUEUE_SIZE + 1U].job);
+	CHECK(stm32mp_worker_wait(&jobs[QUEUE_SIZE + 1U].job) ==
+	      expected_status(QUEUE_SIZE + 1U));
+	CHECK(jobs[QUEUE_SIZE + 1U].thread == worker_thread);
+
+	stm32mp_worker_stop();
+	CHECK(!stm32mp_worker_is_running());
+	CHECK(cpu_off_calls == 1U);
+
+	if (failures == before) {
+		printf("PASS: queue full\n");
+	}
+}
+
+/*
+ * Jobs are submitted in batches while the worker runs the previous ones, the
+ * queue left at stop is drained, and the worker restarts each time.
+ */
+static void test_restart(void)
+{
+	unsigned int before = failures;
+	struct test_job jobs[NB_JOBS];
+	unsigned int on_worker;
+	unsigned int run;
+	unsigned int i;
+
+	for (run = 0U; run < RESTARTS; run++) {
+		worker_host_reset(CPU_ON_OK);
+		CHECK(stm32mp_worker_start() == 0);
+		CHECK(stm32mp_worker_parked[0] == 0U);
+
+		init_jobs(jobs, NB_JOBS, NULL);
+		run_order = 0U;
+
+		for (i = 0U; i < NB_JOBS; i++) {
+			stm32mp_worker_submit(&jobs[i].job);
+			if ((i % 4U) == 3U) {
+				CHECK(stm32mp_worker_wait(&jobs[i - 2U].job) ==
+				      expected_status(i - 2U));
+			}
+		}
+
+		/* Jobs may still be queued */
+		stm32mp_worker_stop();
+		CHECK(!stm32mp_worker_is_running());
+		CHECK(stm32mp_worker_parked[0] == 1U);
+		CHECK(cpu_off_calls == 1U);
+
+		on_worker = 0U;
+		for (i = 0U; i < NB_JOBS; i++) {
+			CHECK(jobs[i].job.done);
+			CHECK(jobs[i].job.status == expected_status(i));
+			if (jobs[i].thread == worker_thread) {
+				on_worker++;
+			} else {
+				CHECK(jobs[i].thread == main_thread);
+			}
+		}
+
+		CHECK(on_worker != 0U);
+		CHECK(run_order == NB_JOBS);
+	}
+
+	if (failures == before) {
+		printf("PASS: restart\n");
+	}
+}
+
+int main(void)
+{
+	worker_host_init();
+
+	test_not_started();
+	test_start_failure();
+	test_queue_full();
+	test_restart();
+
+	if (failures != 0U) {
+		printf("FAIL: stm32mp_worker, %u failures\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS: stm32mp_worker\n");
+
+	return EXIT_SUCCESS;
+}
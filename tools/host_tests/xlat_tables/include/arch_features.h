@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef ARCH_FEATURES_H
+#define ARCH_FEATURES_H
+
+#include <stdbool.h>
+
+/* Host replacement of the CPU feature detection */
+static inline bool is_armv8_5_bti_present(void)
+{
+	return false;
+}
+
+#endif /* ARCH_FEATURES_H */
@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef ARCH_HELPERS_H
+#define ARCH_HELPERS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Host replacement of the architecture helpers used by the translation table
+ * library: the barriers and cache operations are recorded by the test.
+ */
+bool is_dcache_enabled(void);
+void clean_dcache_range(uintptr_t addr, size_t size);
+void dsbishst(void);
+void dsbish(void);
+void dccvac(uintptr_t addr);
+
+#endif /* ARCH_HELPERS_H */
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PLATFORM_DEF_H
+#define PLATFORM_DEF_H
+
+#include <lib/utils_def.h>
+
+/* Host build of the translation table library, sized as on STM32MP2 */
+#define PLAT_VIRT_ADDR_SPACE_SIZE	(ULL(1) << 33)
+#define PLAT_PHY_ADDR_SPACE_SIZE	(ULL(1) << 33)
+#define MAX_XLAT_TABLES			U(12)
+#define MAX_MMAP_REGIONS		U(16)
+
+#endif /* PLATFORM_DEF_H */
@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the translation table library: the descriptors written by
+ * xlat_tables_core.c are checked by walking the tables, and the cache and TLB
+ * maintenance it requests is recorded to check the dynamic region updates.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <arch_helpers.h>
+#include <common/debug.h>
+#include <drivers/console.h>
+#include <lib/xlat_tables/xlat_tables_v2.h>
+
+#include "../../../lib/xlat_tables_v2/xlat_tables_private.h"
+
+REGISTER_XLAT_CONTEXT2(test, MAX_MMAP_REGIONS, MAX_XLAT_TABLES,
+		       PLAT_VIRT_ADDR_SPACE_SIZE, PLAT_PHY_ADDR_SPACE_SIZE,
+		       EL3_REGIME, "xlat_table", "base_xlat_table");
+
+#define PAGE		PAGE_SIZE
+#define BLOCK_2M	XLAT_BLOCK_SIZE(2U)
+
+/* Static regions: a 2MB block, and a page keeping a level 3 table alive */
+#define STATIC_BLOCK_VA	ULL(0x80000000)
+#define STATIC_PAGE_VA	ULL(0x20000000)
+
+/*
+ * Static regions for the promotion: a 64KB run of pages, two 1MB regions
+ * forming a uniform 2MB block, and a 32MB run of blocks.
+ */
+#define CONT_PAGES_VA	ULL(0xC0000000)
+#define COLLAPSE_VA	ULL(0xC0200000)
+#define CONT_BLOCKS_VA	ULL(0xC2000000)
+#define CONT_RUN(_lvl)	(XLAT_BLOCK_SIZE(_lvl) * XLAT_CONT_ENTRIES)
+
+/* Maintenance requested by the library */
+static struct {
+	unsigned int tlbi_va;
+	unsigned int sync;
+	unsigned int clean;
+	unsigned int dsb;
+} ops;
+
+static unsigned int failures;
+static bool mmu_enabled;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+bool is_dcache_enabled(void)
+{
+	return true;
+}
+
+void clean_dcache_range(uintptr_t addr, size_t size)
+{
+	ops.clean++;
+}
+
+void dsbishst(void)
+{
+	ops.dsb++;
+}
+
+void dsbish(void)
+{
+	ops.dsb++;
+}
+
+void dccvac(uintptr_t addr)
+{
+	ops.clean++;
+}
+
+void xlat_arch_tlbi_va(uintptr_t va, int xlat_regime)
+{
+	ops.tlbi_va++;
+}
+
+void xlat_arch_tlbi_va_sync(void)
+{
+	ops.sync++;
+}
+
+uint32_t xlat_arch_get_pas(uint32_t attr)
+{
+	return (MT_PAS(attr) == MT_NS) ? LOWER_ATTRS(NS) : 0U;
+}
+
+uint64_t xlat_arch_regime_get_xn_desc(int xlat_regime)
+{
+	return UPPER_ATTRS(XN);
+}
+
+unsigned int xlat_arch_current_el(void)
+{
+	return 3U;
+}
+
+unsigned long long xlat_arch_get_max_supported_pa(void)
+{
+	return (ULL(1) << 40) - 1U;
+}
+
+bool is_mmu_enabled_ctx(const xlat_ctx_t *ctx)
+{
+	return mmu_enabled;
+}
+
+uintptr_t xlat_get_min_virt_addr_space_size(void)
+{
+	return MIN_VIRT_ADDR_SPACE_SIZE;
+}
+
+void console_flush(void)
+{
+}
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	(void)vprintf(fmt + 1, args);
+	va_end(args);
+}
+
+void __dead2 do_panic(void)
+{
+	printf("PANIC\n");
+	exit(1);
+	__builtin_unreachable();
+}
+
+#if ENABLE_ASSERTIONS
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+#endif
+
+static void ops_reset(void)
+{
+	ops.tlbi_va = 0U;
+	ops.sync = 0U;
+	ops.clean = 0U;
+	ops.dsb = 0U;
+}
+
+/* Return the descriptor translating va and its level, 0 if none */
+static uint64_t lookup(uintptr_t va, unsigned int *level)
+{
+	const uint64_t *table = test_xlat_ctx.base_table;
+	unsigned int lvl = test_xlat_ctx.base_level;
+	uint64_t desc;
+
+	for (;;) {
+		desc = table[XLAT_TABLE_IDX(va, lvl)];
+		if ((desc & DESC_MASK) != TABLE_DESC || lvl == XLAT_TABLE_LEVEL_MAX) {
+			break;
+		}
+		table = (const uint64_t *)(uintptr_t)(desc & TABLE_ADDR_MASK);
+		lvl++;
+	}
+
+	*level = lvl;
+
+	if ((desc & DESC_MASK) == INVALID_DESC) {
+		return 0ULL;
+	}
+
+	return desc;
+}
+
+#if XLAT_TABLES_PROMOTION
+static bool is_cont(uintptr_t va)
+{
+	unsigned int level;
+
+	return (lookup(va, &level) & UPPER_ATTRS(CONT_HINT)) != 0ULL;
+}
+#endif
+
+static bool is_mapped(uintptr_t va, unsigned long long pa)
+{
+	unsigned int level;
+	uint64_t desc = lookup(va, &level);
+
+	if (desc == 0ULL) {
+		return false;
+	}
+
+	return (desc & TABLE_ADDR_MASK & ~(XLAT_BLOCK_SIZE(level) - 1U)) ==
+	       (pa & ~(XLAT_BLOCK_SIZE(level) - 1U));
+}
+
+static unsigned int free_tables(void)
+{
+	unsigned int n = 0U;
+	int i;
+
+	for (i = 0; i < test_xlat_ctx.tables_num; i++) {
+		if (test_xlat_ctx.tables_mapped_regions[i] == 0) {
+			n++;
+		}
+	}
+
+	return n;
+}
+
+static int add(uintptr_t va, size_t size)
+{
+	return mmap_add_dynamic_region_ctx(&test_xlat_ctx,
+		&(mmap_region_t)MAP_REGION_FLAT(va, size, MT_MEMORY | MT_RW));
+}
+
+static int del(uintptr_t va, size_t size)
+{
+	return mmap_remove_dynamic_region_ctx(&test_xlat_ctx, va, size);
+}
+
+static void test_init(void)
+{
+	mmap_add_region_ctx(&test_xlat_ctx,
+		&(mmap_region_t)MAP_REGION_FLAT(STATIC_BLOCK_VA, BLOCK_2M,
+						MT_MEMORY | MT_RW));
+	mmap_add_region_ctx(&test_xlat_ctx,
+		&(mmap_region_t)MAP_REGION_FLAT(STATIC_PAGE_VA, PAGE,
+						MT_DEVICE | MT_RW));
+#if XLAT_TABLES_PROMOTION
+	mmap_add_region_ctx(&test_xlat_ctx,
+		&(mmap_region_t)MAP_REGION_FLAT(CONT_PAGES_VA, CONT_RUN(3U),
+						MT_MEMORY | MT_RW));
+	mmap_add_region_ctx(&test_xlat_ctx,
+		&(mmap_region_t)MAP_REGION_FLAT(COLLAPSE_VA, BLOCK_2M / 2U,
+						MT_MEMORY | MT_RW));
+	mmap_add_region_ctx(&test_xlat_ctx,
+		&(mmap_region_t)MAP_REGION_FLAT(COLLAPSE_VA + (BLOCK_2M / 2U),
+						BLOCK_2M / 2U,
+						MT_MEMORY | MT_RW));
+	mmap_add_region_ctx(&test_xlat_ctx,
+		&(mmap_region_t)MAP_REGION_FLAT(CONT_BLOCKS_VA, CONT_RUN(2U),
+						MT_MEMORY | MT_RW));
+#endif
+	init_xlat_tables_ctx(&test_xlat_ctx);
+
+	CHECK(is_mapped(STATIC_BLOCK_VA, STATIC_BLOCK_VA));
+	CHECK(is_mapped(STATIC_PAGE_VA, STATIC_PAGE_VA));
+}
+
+/* Each removal is invalidated and synchronized */
+static void test_dynamic(void)
+{
+	CHECK(add(STATIC_PAGE_VA + PAGE, PAGE) == 0);
+	CHECK(is_mapped(STATIC_PAGE_VA + PAGE, STATIC_PAGE_VA + PAGE));
+
+	ops_reset();
+	CHECK(del(STATIC_PAGE_VA + PAGE, PAGE) == 0);
+	CHECK(!is_mapped(STATIC_PAGE_VA + PAGE, STATIC_PAGE_VA + PAGE));
+	CHECK(ops.tlbi_va == 1U);
+	CHECK(ops.sync == 1U);
+}
+
+/* Tables freed by a removal are reused by a region mapped at another VA */
+static void test_table_reuse(void)
+{
+	const uintptr_t va_a = ULL(0x40000000);
+	const uintptr_t va_b = ULL(0x10000000);
+	unsigned int nfree = free_tables();
+
+	CHECK(add(va_a, PAGE) == 0);
+	CHECK(free_tables() == (nfree - 2U));
+
+	ops_reset();
+	CHECK(del(va_a, PAGE) == 0);
+	CHECK(free_tables() == nfree);
+	CHECK(ops.tlbi_va != 0U);
+	CHECK(ops.sync == 1U);
+
+	CHECK(add(va_b, PAGE) == 0);
+	CHECK(free_tables() < nfree);
+	CHECK(is_mapped(va_b, va_b));
+	CHECK(!is_mapped(va_a, va_a));
+
+	CHECK(del(va_b, PAGE) == 0);
+	CHECK(free_tables() == nfree);
+}
+
+#if XLAT_TABLES_PROMOTION
+/* Descriptor layout after the promotion done at initialization */
+static void test_promotion_init(void)
+{
+	unsigned int level;
+	unsigned int i;
+
+	for (i = 0U; i < XLAT_CONT_ENTRIES; i++) {
+		CHECK(is_cont(CONT_PAGES_VA + (i * PAGE)));
+		CHECK(is_cont(CONT_BLOCKS_VA + (i * BLOCK_2M)));
+		CHECK(is_mapped(CONT_BLOCKS_VA + (i * BLOCK_2M),
+				CONT_BLOCKS_VA + (i * BLOCK_2M)));
+	}
+	CHECK(!is_cont(CONT_PAGES_VA + CONT_RUN(3U)));
+	CHECK(!is_cont(STATIC_PAGE_VA));
+	CHECK(!is_cont(STATIC_BLOCK_VA));
+
+	/* Two adjacent 1MB regions are merged into one block */
+	(void)lookup(COLLAPSE_VA, &level);
+	CHECK(level == 2U);
+	CHECK(is_mapped(COLLAPSE_VA + (BLOCK_2M / 2U),
+			COLLAPSE_VA + (BLOCK_2M / 2U)));
+}
+
+/*
+ * The hint of a dynamic region is set when its descriptors are created: the
+ * live tables are not modified afterwards, so no invalidation is issued.
+ */
+static void test_promotion_dynamic(void)
+{
+	const uintptr_t va = ULL(0x100000000);
+	const size_t size = CONT_RUN(2U) + BLOCK_2M;
+	mmap_region_t shifted = MAP_REGION(ULL(0x140000000), ULL(0x140200000),
+					   CONT_RUN(2U), MT_MEMORY | MT_RW);
+	mmap_region_t pages = MAP_REGION2(ULL(0x180000000), ULL(0x180000000),
+					  CONT_RUN(3U), MT_MEMORY | MT_RW,
+					  PAGE_SIZE);
+	unsigned int i;
+
+	ops_reset();
+	CHECK(add(va, size) == 0);
+	CHECK(ops.tlbi_va == 0U);
+	CHECK(ops.sync == 0U);
+	for (i = 0U; i < XLAT_CONT_ENTRIES; i++) {
+		CHECK(is_cont(va + (i * BLOCK_2M)));
+	}
+	CHECK(!is_cont(va + CONT_RUN(2U)));
+	CHECK(is_mapped(va + CONT_RUN(2U), va + CONT_RUN(2U)));
+
+	/* Output range not aligned on the run size */
+	CHECK(mmap_add_dynamic_region_ctx(&test_xlat_ctx, &shifted) == 0);
+	CHECK(!is_cont(shifted.base_va));
+	CHECK(is_mapped(shifted.base_va, shifted.base_pa));
+
+	/* Finer granularity requested */
+	CHECK(mmap_add_dynamic_region_ctx(&test_xlat_ctx, &pages) == 0);
+	CHECK(!is_cont(pages.base_va));
+
+	/* Removal leaves neither the region nor any of its hints behind */
+	CHECK(del(va, size) == 0);
+	for (i = 0U; i < XLAT_CONT_ENTRIES; i++) {
+		CHECK(!is_cont(va + (i * BLOCK_2M)));
+	}
+	CHECK(!is_mapped(va, va));
+	CHECK(del(shifted.base_va, shifted.size) == 0);
+	CHECK(del(pages.base_va, pages.size) == 0);
+	CHECK(is_cont(CONT_BLOCKS_VA));
+}
+
+/*
+ * Changing the attributes of a page of a contiguous run removes the hint of
+ * the whole run, which is only possible with the MMU disabled. A failed
+ * change leaves the tables untouched.
+ */
+static void test_promotion_change_attr(void)
+{
+	const uintptr_t last = CONT_PAGES_VA + CONT_RUN(3U) - PAGE;
+	uint32_t attr;
+	unsigned int i;
+
+	/* The page after the run is not mapped */
+	CHECK(xlat_change_mem_attributes_ctx(&test_xlat_ctx, last, 2U * PAGE,
+				MT_RO | MT_EXECUTE_NEVER) == -EINVAL);
+	CHECK(is_cont(CONT_PAGES_VA) && is_cont(last));
+
+	mmu_enabled = true;
+	CHECK(xlat_change_mem_attributes_ctx(&test_xlat_ctx, last, PAGE,
+				MT_RO | MT_EXECUTE_NEVER) == -EINVAL);
+	CHECK(is_cont(CONT_PAGES_VA) && is_cont(last));
+	mmu_enabled = false;
+
+	CHECK(xlat_change_mem_attributes_ctx(&test_xlat_ctx, last, PAGE,
+				MT_RO | MT_EXECUTE_NEVER) == 0);
+	for (i = 0U; i < XLAT_CONT_ENTRIES; i++) {
+		CHECK(!is_cont(CONT_PAGES_VA + (i * PAGE)));
+		CHECK(is_mapped(CONT_PAGES_VA + (i * PAGE),
+				CONT_PAGES_VA + (i * PAGE)));
+	}
+	CHECK(xlat_get_mem_attributes_ctx(&test_xlat_ctx, last, &attr) == 0);
+	CHECK((attr & MT_RW) == 0U);
+	CHECK(xlat_get_mem_attributes_ctx(&test_xlat_ctx, CONT_PAGES_VA,
+					  &attr) == 0);
+	CHECK((attr & MT_RW) != 0U);
+}
+#endif /* XLAT_TABLES_PROMOTION */
+
+int main(void)
+{
+	test_init();
+	test_dynamic();
+	test_table_reuse();
+#if XLAT_TABLES_PROMOTION
+	test_promotion_init();
+	test_promotion_dynamic();
+	test_promotion_change_attr();
+#endif
+
+	if (failures != 0U) {
+		printf("FAIL: xlat_tables, %u failures\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS: xlat_tables\n");
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,1326 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host benchmark of the BL2 load path from an SD card or eMMC: the GPT is
+ * parsed by drivers/partition, then the FIP images are loaded with
+ * load_auth_image() through io_fip over io_block. The block device is
+ * simulated in RAM: it counts the read commands and blocks, and models the
+ * time of each command as a fixed cost plus a cost per block, so that the
+ * result of a given tree and command line does not change from one run to
+ * another. The bytes copied by the IO stack are counted with the memcpy()
+ * wrapper.
+ *
+ * With -T, the GPT parsing is tested instead: primary and backup GPT, entries
+ * larger than gpt_entry_t, out of bounds headers, then random corruptions of
+ * the disk. With -i, the GPT of a disk image file, such as one made by sgdisk,
+ * is parsed and its partitions are listed.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <common/bl_common.h>
+#include <common/debug.h>
+#include <common/tf_crc32.h>
+#include <drivers/io/io_block.h>
+#include <drivers/io/io_driver.h>
+#include <drivers/io/io_fip.h>
+#include <drivers/io/io_storage.h>
+#include <drivers/partition/efi.h>
+#include <drivers/partition/gpt.h>
+#include <drivers/partition/mbr.h>
+#include <drivers/partition/partition.h>
+#include <plat/common/platform.h>
+#include <tools_share/firmware_image_package.h>
+
+#include <host_file.h>
+#include <platform_def.h>
+#include <stm32mp_fwu_bank.h>
+
+#define BLOCK_SIZE		PLAT_PARTITION_BLOCK_SIZE
+#define DISK_SIZE		U(0x01000000)
+#define DISK_BLOCKS		(DISK_SIZE / BLOCK_SIZE)
+#define LOAD_AREA_SIZE		U(0x00400000)
+
+#define GPT_ENTRIES_NUM		U(128)
+#define GPT_ENTRIES_BLOCKS	(GPT_ENTRIES_NUM * sizeof(gpt_entry_t) / BLOCK_SIZE)
+#define GPT_LAST_LBA		(DISK_BLOCKS - GPT_ENTRIES_BLOCKS - 2U)
+
+#define FSBL_BLOCKS		U(512)
+#define FIP_FIRST_LBA		U(2048)
+#define FIP_NAME		"fip"
+#define FIP_SERIAL_NUMBER	U(0x12345678)
+
+/* Default model: SD card in high speed mode */
+#define DEFAULT_CMD_NS		U(100000)
+#define DEFAULT_BLOCK_NS	U(20000)
+
+#define NSEC_PER_USEC		U(1000)
+
+#define FUZZ_RUNS		U(2000)
+
+struct bench_stats {
+	unsigned long long commands;
+	unsigned long long blocks;
+	unsigned long long copied;
+	unsigned long long time_ns;
+};
+
+struct bench_image {
+	const char *name;
+	unsigned int image_id;
+	io_uuid_spec_t uuid_spec;
+	size_t size;
+};
+
+/* In the FIP order, which is also the BL2 load order */
+static struct bench_image images[] = {
+	{ "BL31", BL31_IMAGE_ID, { UUID_EL3_RUNTIME_FIRMWARE_BL31 }, 0x20000U },
+	{ "BL32", BL32_IMAGE_ID, { UUID_SECURE_PAYLOAD_BL32 }, 0x80000U },
+	{ "BL33", BL33_IMAGE_ID, { UUID_NON_TRUSTED_FIRMWARE_BL33 }, 0x100000U },
+	{ "HW_CONFIG", HW_CONFIG_ID, { UUID_HW_CONFIG }, 0x10000U },
+};
+
+#define IMAGES_NB		ARRAY_SIZE(images)
+
+static uint8_t disk[DISK_SIZE] __aligned(BLOCK_SIZE);
+static uint8_t load_area[LOAD_AREA_SIZE] __aligned(BLOCK_SIZE);
+static uint8_t block_buffer[BLOCK_SIZE] __aligned(BLOCK_SIZE);
+
+static struct bench_stats stats;
+static unsigned long cmd_ns = DEFAULT_CMD_NS;
+static unsigned long block_ns = DEFAULT_BLOCK_NS;
+static unsigned long fip_align = 1UL;
+static bool single_block_buffer;
+static bool run_tests;
+static const char *disk_image;
+static bool quiet;
+static uint64_t prng_state = 0x9E3779B97F4A7C15ULL;
+static unsigned int failures;
+
+static uintptr_t storage_dev_handle;
+static uintptr_t fip_dev_handle;
+
+/* Up to the backup GPT, as set by STM32MP BL2 */
+static io_block_spec_t gpt_block_spec = {
+	.offset = 0U,
+	.length = DISK_SIZE,
+};
+
+static io_block_spec_t fip_block_spec;
+
+static size_t bench_read_blocks(int lba, uintptr_t buf, size_t size);
+
+static io_block_dev_spec_t bench_block_dev_spec = {
+	/* It's used as temp buffer in block driver */
+	.buffer = {
+		.offset = (size_t)&block_buffer,
+		.length = BLOCK_SIZE,
+	},
+	.ops = {
+		.read = bench_read_blocks,
+		.write = NULL,
+	},
+	.block_size = BLOCK_SIZE,
+	.direct_read = true,
+};
+
+void *__real_memcpy(void *dst, const void *src, size_t len);
+void *__wrap_memcpy(void *dst, const void *src, size_t len);
+
+/*
+ * The block driver can copy inside its buffer when it is the load area, as
+ * the STM32MP BL2 does, so the copy is done with memmove().
+ */
+void *__wrap_memcpy(void *dst, const void *src, size_t len)
+{
+	stats.copied += len;
+
+	return memmove(dst, src, len);
+}
+
+static size_t bench_read_blocks(int lba, uintptr_t buf, size_t size)
+{
+	size_t offset = (size_t)lba * BLOCK_SIZE;
+
+	assert((size % BLOCK_SIZE) == 0U);
+
+	if ((offset > DISK_SIZE) || (size > (DISK_SIZE - offset))) {
+		return 0U;
+	}
+
+	/* Data is moved by the device DMA, not counted as a copy */
+	__real_memcpy((void *)buf, &disk[offset], size);
+
+	stats.commands++;
+	stats.blocks += size / BLOCK_SIZE;
+	stats.time_ns += cmd_ns + (size / BLOCK_SIZE) * block_ns;
+
+	return size;
+}
+
+/* CRC32 of the GPT, as computed by the Arm CRC instructions in BL2 */
+uint32_t tf_crc32(uint32_t crc, const unsigned char *buf, size_t size)
+{
+	uint32_t calc_crc = ~crc;
+	size_t i;
+	unsigned int bit;
+
+	for (i = 0U; i < size; i++) {
+		calc_crc ^= buf[i];
+		for (bit = 0U; bit < 8U; bit++) {
+			calc_crc = (calc_crc >> 1) ^
+				   (U(0xEDB88320) & (0U - (calc_crc & 1U)));
+		}
+	}
+
+	return ~calc_crc;
+}
+
+/* Platform and library functions used by the BL2 IO stack */
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	if (quiet) {
+		return;
+	}
+
+	va_start(args, fmt);
+	/* Skip the log level marker */
+	(void)vprintf(fmt + 1, args);
+	va_end(args);
+}
+
+void __dead2 do_panic(void)
+{
+	printf("PANIC\n");
+	exit(1);
+	__builtin_unreachable();
+}
+
+#if ENABLE_ASSERTIONS
+void __dead2 __assert(const char *file, unsigned int line)
+{
+	printf("ASSERT: %s:%u\n", file, line);
+	exit(1);
+	__builtin_unreachable();
+}
+#endif
+
+void flush_dcache_range(uintptr_t addr, size_t size)
+{
+}
+
+void zeromem(void *mem, u_register_t length)
+{
+	(void)memset(mem, 0, length);
+}
+
+int plat_try_next_boot_source(void)
+{
+	return 0;
+}
+
+int plat_try_backup_partitions(unsigned int image_id)
+{
+	return 0;
+}
+
+const char version[] = "stm32_bl2_bench";
+
+static int open_storage(void)
+{
+	return io_dev_init(storage_dev_handle, 0);
+}
+
+static int open_fip(void)
+{
+	return io_dev_init(fip_dev_handle, (uintptr_t)FIP_IMAGE_ID);
+}
+
+int plat_get_image_source(unsigned int image_id, uintptr_t *dev_handle,
+			  uintptr_t *image_spec)
+{
+	unsigned int i;
+	int rc;
+
+	switch (image_id) {
+	case GPT_IMAGE_ID:
+		*image_spec = (uintptr_t)&gpt_block_spec;
+		*dev_handle = storage_dev_handle;
+		return open_storage();
+	case FIP_IMAGE_ID:
+		*image_spec = (uintptr_t)&fip_block_spec;
+		*dev_handle = storage_dev_handle;
+		return open_storage();
+	default:
+		break;
+	}
+
+	for (i = 0U; i < IMAGES_NB; i++) {
+		if (images[i].image_id != image_id) {
+			continue;
+		}
+
+		rc = open_fip();
+		if (rc == 0) {
+			*image_spec = (uintptr_t)&images[i].uuid_spec;
+			*dev_handle = fip_dev_handle;
+		}
+
+		return rc;
+	}
+
+	return -ENOENT;
+}
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+	put_le16(p, (uint16_t)v);
+	put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void set_gpt_entry(gpt_entry_t *entry, const char *name,
+			  unsigned long long first_lba,
+			  unsigned long long last_lba, uint8_t id)
+{
+	const struct efi_guid type_guid =
+		EFI_GUID(0x0fc63dafU, 0x8483U, 0x4772U, 0x8eU, 0x79U,
+			 0x3dU, 0x69U, 0xd8U, 0x47U, 0x7dU, 0xe4U);
+	unsigned int i;
+
+	entry->type_uuid = type_guid;
+	entry->unique_uuid = type_guid;
+	entry->unique_uuid.clock_seq_and_node[7] = id;
+	entry->first_lba = first_lba;
+	entry->last_lba = last_lba;
+
+	for (i = 0U; (name[i] != '\0') && (i < (EFI_NAMELEN - 1U)); i++) {
+		entry->name[i] = (unsigned short)name[i];
+	}
+}
+
+static void set_gpt_header(unsigned long long lba, unsigned long long alt_lba,
+			   unsigned long long part_lba,
+			   unsigned long long first_lba,
+			   unsigned long long last_lba, unsigned int entries_num,
+			   unsigned int part_size, uint32_t part_crc)
+{
+	gpt_header_t *header = (gpt_header_t *)&disk[lba * BLOCK_SIZE];
+
+	(void)memcpy(header->signature, GPT_SIGNATURE,
+		     sizeof(header->signature));
+	header->revision = U(0x00010000);
+	header->size = DEFAULT_GPT_HEADER_SIZE;
+	header->current_lba = lba;
+	header->backup_lba = alt_lba;
+	header->first_lba = first_lba;
+	header->last_lba = last_lba;
+	header->part_lba = part_lba;
+	header->list_num = entries_num;
+	header->part_size = part_size;
+	header->part_crc = part_crc;
+	header->header_crc = 0U;
+	header->header_crc = tf_crc32(0U, (uint8_t *)header,
+				      DEFAULT_GPT_HEADER_SIZE);
+}
+
+/*
+ * Protective MBR, then primary and backup GPT laid out as sgdisk does, the
+ * partitions starting at the first usable LBA. Return that LBA.
+ */
+static unsigned long long write_gpt(unsigned long long fip_last_lba,
+				    unsigned int entries_num,
+				    unsigned int part_size)
+{
+	size_t array_size = (size_t)entries_num * part_size;
+	unsigned long long array_blocks = array_size / BLOCK_SIZE;
+	unsigned long long first_lba = 2U + array_blocks;
+	unsigned long long last_lba = DISK_BLOCKS - 2U - array_blocks;
+	uint8_t *array = &disk[2U * BLOCK_SIZE];
+	uint8_t *mbr = &disk[MBR_PRIMARY_ENTRY_OFFSET];
+	uint32_t part_crc;
+
+	(void)memset(disk, 0, first_lba * BLOCK_SIZE);
+	(void)memset(&disk[(last_lba + 1U) * BLOCK_SIZE], 0,
+		     DISK_SIZE - ((last_lba + 1U) * BLOCK_SIZE));
+
+	/* Protective MBR */
+	mbr[4] = PARTITION_TYPE_GPT;
+	put_le32(&mbr[8], 1U);
+	put_le32(&mbr[12], DISK_BLOCKS - 1U);
+	disk[LEGACY_PARTITION_BLOCK_SIZE - 2U] = MBR_SIGNATURE_FIRST;
+	disk[LEGACY_PARTITION_BLOCK_SIZE - 1U] = MBR_SIGNATURE_SECOND;
+
+	set_gpt_entry((gpt_entry_t *)&array[0], "fsbl1", first_lba,
+		      first_lba + FSBL_BLOCKS - 1U, 1U);
+	set_gpt_entry((gpt_entry_t *)&array[part_size], "fsbl2",
+		      first_lba + FSBL_BLOCKS,
+		      first_lba + (2U * FSBL_BLOCKS) - 1U, 2U);
+	set_gpt_entry((gpt_entry_t *)&array[2U * part_size], FIP_NAME,
+		      FIP_FIRST_LBA, fip_last_lba, 3U);
+
+	part_crc = tf_crc32(0U, array, array_size);
+	(void)memmove(&disk[(last_lba + 1U) * BLOCK_SIZE], array, array_size);
+
+	set_gpt_header(1U, DISK_BLOCKS - 1U, 2U, first_lba, last_lba,
+		       entries_num, part_size, part_crc);
+	set_gpt_header(DISK_BLOCKS - 1U, 1U, last_lba + 1U, first_lba, last_lba,
+		       entries_num, part_size, part_crc);
+
+	return first_lba;
+}
+
+static uint8_t image_pattern(unsigned int image, size_t offset)
+{
+	return (uint8_t)((offset * 7U) + image + (offset >> 9));
+}
+
+/* Return the FIP size, 0 if it does not fit in max_size */
+static size_t build_fip(unsigned long long first_lba, size_t max_size)
+{
+	uint8_t *fip = &disk[first_lba * BLOCK_SIZE];
+	fip_toc_header_t *header = (fip_toc_header_t *)fip;
+	fip_toc_entry_t *entry = (fip_toc_entry_t *)(header + 1);
+	size_t offset;
+	unsigned int i;
+	size_t j;
+
+	header->name = TOC_HEADER_NAME;
+	header->serial_number = FIP_SERIAL_NUMBER;
+
+	offset = sizeof(*header) + ((IMAGES_NB + 1U) * sizeof(*entry));
+
+	for (i = 0U; i < IMAGES_NB; i++) {
+		offset = round_up(offset, fip_align);
+		if ((images[i].size > max_size) ||
+		    (offset > (max_size - images[i].size))) {
+			return 0U;
+		}
+
+		entry[i].uuid = images[i].uuid_spec.uuid;
+		entry[i].offset_address = offset;
+		entry[i].size = images[i].size;
+
+		for (j = 0U; j < images[i].size; j++) {
+			fip[offset + j] = image_pattern(i, j);
+		}
+
+		offset += images[i].size;
+	}
+
+	/* ToC terminator, with the FIP size */
+	entry[i].offset_address = offset;
+
+	return offset;
+}
+
+static void print_stats(const char *name, size_t size,
+			const struct bench_stats *s)
+{
+	if (quiet) {
+		return;
+	}
+
+	printf("%-10s %10zu %9llu %9llu %10llu %10llu\n", name, size,
+	       s->commands, s->blocks, s->copied, s->time_ns / NSEC_PER_USEC);
+}
+
+static int load_images(struct bench_stats *total)
+{
+	image_info_t image_info;
+	unsigned int i;
+	size_t j;
+	int rc;
+
+	for (i = 0U; i < IMAGES_NB; i++) {
+		zeromem(&image_info, sizeof(image_info));
+		SET_PARAM_HEAD(&image_info, PARAM_IMAGE_BINARY, VERSION_2, 0);
+		image_info.image_base = (uintptr_t)load_area;
+		image_info.image_max_size = LOAD_AREA_SIZE;
+
+		/* STM32MP BL2 reads the images through their load area */
+		if (!single_block_buffer) {
+			bench_block_dev_spec.buffer.offset = image_info.image_base;
+			bench_block_dev_spec.buffer.length = image_info.image_max_size;
+		}
+
+		zeromem(&stats, sizeof(stats));
+		rc = load_auth_image(images[i].image_id, &image_info);
+		if (rc != 0) {
+			printf("Failed to load %s (%d)\n", images[i].name, rc);
+			return rc;
+		}
+
+		for (j = 0U; j < images[i].size; j++) {
+			if (load_area[j] != image_pattern(i, j)) {
+				printf("%s corrupted at 0x%zx\n", images[i].name, j);
+				return -EIO;
+			}
+		}
+
+		print_stats(images[i].name, image_info.image_size, &stats);
+
+		total->commands += stats.commands;
+		total->blocks += stats.blocks;
+		total->copied += stats.copied;
+		total->time_ns += stats.time_ns;
+	}
+
+	return 0;
+}
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAIL: %s:%d: %s\n", __func__, __LINE__,	\
+			       #_cond);					\
+			failures++;					\
+		}							\
+	} while (false)
+
+#define TEST_FIP_LAST_LBA	(FIP_FIRST_LBA + U(1023))
+
+enum gpt_field {
+	GPT_CURRENT_LBA,
+	GPT_BACKUP_LBA,
+	GPT_FIRST_USABLE_LBA,
+	GPT_LAST_USABLE_LBA,
+	GPT_PART_LBA,
+	GPT_LIST_NUM,
+	GPT_PART_SIZE,
+	GPT_FIELDS_NB
+};
+
+struct gpt_mutation {
+	enum gpt_field field;
+	unsigned long long value;
+};
+
+static uint64_t prng(void)
+{
+	prng_state ^= prng_state << 13;
+	prng_state ^= prng_state >> 7;
+	prng_state ^= prng_state << 17;
+
+	return prng_state;
+}
+
+static gpt_header_t *gpt_header_at(unsigned long long lba)
+{
+	return (gpt_header_t *)&disk[lba * BLOCK_SIZE];
+}
+
+static unsigned long long gpt_backup_array(unsigned int entries_num,
+					   unsigned int part_size)
+{
+	return DISK_BLOCKS - 1U - (((size_t)entries_num * part_size) / BLOCK_SIZE);
+}
+
+/* Change a header field, and its CRC so that only the field is wrong */
+static void mutate_gpt_header(gpt_header_t *header,
+			      const struct gpt_mutation *mutation)
+{
+	switch (mutation->field) {
+	case GPT_CURRENT_LBA:
+		header->current_lba = mutation->value;
+		break;
+	case GPT_BACKUP_LBA:
+		header->backup_lba = mutation->value;
+		break;
+	case GPT_FIRST_USABLE_LBA:
+		header->first_lba = mutation->value;
+		break;
+	case GPT_LAST_USABLE_LBA:
+		header->last_lba = mutation->value;
+		break;
+	case GPT_PART_LBA:
+		header->part_lba = mutation->value;
+		break;
+	case GPT_LIST_NUM:
+		header->list_num = (unsigned int)mutation->value;
+		break;
+	default:
+		header->part_size = (unsigned int)mutation->value;
+		break;
+	}
+
+	header->header_crc = 0U;
+	header->header_crc = tf_crc32(0U, (uint8_t *)header,
+				      DEFAULT_GPT_HEADER_SIZE);
+}
+
+static void flip_bytes(size_t offset, size_t size, unsigned int nb)
+{
+	unsigned int i;
+
+	for (i = 0U; i < nb; i++) {
+		disk[offset + (prng() % size)] ^= (uint8_t)(1U + (prng() % 255U));
+	}
+}
+
+/* The list holds the partitions of write_gpt() */
+static bool gpt_list_ok(unsigned long long first_lba)
+{
+	const partition_entry_t *fsbl1 = get_partition_entry("fsbl1");
+	const partition_entry_t *fsbl2 = get_partition_entry("fsbl2");
+	const partition_entry_t *fip = get_partition_entry(FIP_NAME);
+
+	return (get_partition_entry_list()->entry_count == 3) &&
+	       (fsbl1 != NULL) && (fsbl2 != NULL) && (fip != NULL) &&
+	       (fsbl1->start == (first_lba * BLOCK_SIZE)) &&
+	       (fsbl1->length == (FSBL_BLOCKS * BLOCK_SIZE)) &&
+	       (fsbl2->start == ((first_lba + FSBL_BLOCKS) * BLOCK_SIZE)) &&
+	       (fip->start == (FIP_FIRST_LBA * BLOCK_SIZE)) &&
+	       (fip->length ==
+		((TEST_FIP_LAST_LBA - FIP_FIRST_LBA + 1U) * BLOCK_SIZE));
+}
+
+static bool gpt_load_ok(unsigned long long first_lba)
+{
+	return (load_partition_table(GPT_IMAGE_ID) == 0) &&
+	       gpt_list_ok(first_lba);
+}
+
+static bool gpt_load_fails(void)
+{
+	return (load_partition_table(GPT_IMAGE_ID) != 0) &&
+	       (get_partition_entry_list()->entry_count == 0) &&
+	       (get_partition_entry(FIP_NAME) == NULL);
+}
+
+/*
+ * The entry array is read with requests of PLAT_PARTITION_BUFFER_SIZE, after
+ * the MBR and header reads, including entries larger than gpt_entry_t.
+ */
+static void test_gpt_layouts(void)
+{
+	static const unsigned int layouts[][2] = {
+		{ GPT_ENTRIES_NUM, sizeof(gpt_entry_t) },
+		{ 4U * GPT_ENTRIES_NUM, sizeof(gpt_entry_t) },
+		{ 4U, sizeof(gpt_entry_t) },
+		{ GPT_ENTRIES_NUM, 2U * sizeof(gpt_entry_t) },
+		{ 64U, 4U * sizeof(gpt_entry_t) },
+		{ 16U, 8U * sizeof(gpt_entry_t) },
+	};
+	unsigned int before = failures;
+	unsigned long long first_lba;
+	size_t array_size;
+	unsigned int i;
+
+	for (i = 0U; i < ARRAY_SIZE(layouts); i++) {
+		first_lba = write_gpt(TEST_FIP_LAST_LBA, layouts[i][0],
+				      layouts[i][1]);
+		array_size = (size_t)layouts[i][0] * layouts[i][1];
+
+		zeromem(&stats, sizeof(stats));
+		CHECK(gpt_load_ok(first_lba));
+		CHECK(stats.commands ==
+		      (2U + div_round_up(array_size,
+					 (size_t)PLAT_PARTITION_BUFFER_SIZE)));
+		CHECK(stats.blocks == (2U + (array_size / BLOCK_SIZE)));
+	}
+
+	if (failures == before) {
+		printf("PASS: GPT layouts\n");
+	}
+}
+
+static void test_gpt_backup(void)
+{
+	unsigned long long backup_lba = DISK_BLOCKS - 1U;
+	unsigned long long first_lba;
+	unsigned int before = failures;
+
+	/* Primary header, then primary array corrupted */
+	first_lba = write_gpt(TEST_FIP_LAST_LBA, GPT_ENTRIES_NUM,
+			      sizeof(gpt_entry_t));
+	gpt_header_at(1U)->header_crc ^= 1U;
+	CHECK(gpt_load_ok(first_lba));
+
+	(void)write_gpt(TEST_FIP_LAST_LBA, GPT_ENTRIES_NUM, sizeof(gpt_entry_t));
+	disk[(2U * BLOCK_SIZE) + (5U * sizeof(gpt_entry_t))] ^= 1U;
+	CHECK(gpt_load_ok(first_lba));
+
+	/* Unused primary signature, larger backup entries */
+	first_lba = write_gpt(TEST_FIP_LAST_LBA, 64U, 4U * sizeof(gpt_entry_t));
+	gpt_header_at(1U)->signature[0] = 0U;
+	CHECK(gpt_load_ok(first_lba));
+
+	/* Backup corrupted, the primary is used */
+	first_lba = write_gpt(TEST_FIP_LAST_LBA, GPT_ENTRIES_NUM,
+			      sizeof(gpt_entry_t));
+	gpt_header_at(backup_lba)->header_crc ^= 1U;
+	disk[gpt_backup_array(GPT_ENTRIES_NUM, sizeof(gpt_entry_t)) *
+	     BLOCK_SIZE] ^= 1U;
+	CHECK(gpt_load_ok(first_lba));
+
+	/* Both corrupted */
+	gpt_header_at(1U)->part_crc ^= 1U;
+	CHECK(gpt_load_fails());
+
+	(void)write_gpt(TEST_FIP_LAST_LBA, GPT_ENTRIES_NUM, sizeof(gpt_entry_t));
+	disk[(2U * BLOCK_SIZE) + 40U] ^= 1U;
+	disk[gpt_backup_array(GPT_ENTRIES_NUM, sizeof(gpt_entry_t)) *
+	     BLOCK_SIZE + 40U] ^= 1U;
+	CHECK(gpt_load_fails());
+
+	if (failures == before) {
+		printf("PASS: GPT backup\n");
+	}
+}
+
+/*
+ * GPT region smaller than the device, as on 32-bit BL2 when the device size
+ * does not fit in a size_t, or as the 34 blocks of the primary GPT set by
+ * other platforms: the primary GPT is checked against the device given by
+ * the protective MBR, and a backup GPT out of the region is not read.
+ */
+static void test_gpt_region(void)
+{
+	static const size_t lengths[] = {
+		DISK_SIZE / 2U,
+		34U * BLOCK_SIZE,
+	};
+	unsigned long long first_lba;
+	unsigned int before = failures;
+	unsigned int i;
+
+	for (i = 0U; i < ARRAY_SIZE(lengths); i++) {
+		gpt_block_spec.length = lengths[i];
+
+		first_lba = write_gpt(TEST_FIP_LAST_LBA, GPT_ENTRIES_NUM,
+				      sizeof(gpt_entry_t));
+		CHECK(gpt_load_ok(first_lba));
+
+		gpt_header_at(1U)->header_crc ^= 1U;
+		CHECK(gpt_load_fails());
+
+		(void)write_gpt(TEST_FIP_LAST_LBA, GPT_ENTRIES_NUM,
+				sizeof(gpt_entry_t));
+		disk[(2U * BLOCK_SIZE) + 40U] ^= 1U;
+		CHECK(gpt_load_fails());
+	}
+
+	gpt_block_spec.length = DISK_SIZE;
+
+	/* Protective MBR of a device too large for its size field */
+	first_lba = write_gpt(TEST_FIP_LAST_LBA, GPT_ENTRIES_NUM,
+			      sizeof(gpt_entry_t));
+	put_le32(&disk[MBR_PRIMARY_ENTRY_OFFSET + 12U], UINT32_MAX);
+	CHECK(gpt_load_ok(first_lba));
+
+	gpt_header_at(1U)->header_crc ^= 1U;
+	CHECK(gpt_load_ok(first_lba));
+
+	if (failures == before) {
+		printf("PASS: GPT region\n");
+	}
+}
+
+/* Headers with a valid CRC but out of bounds fields */
+static const struct gpt_mutation bad_headers[] = {
+	{ GPT_CURRENT_LBA, 2U },
+	{ GPT_CURRENT_LBA, DISK_BLOCKS },
+	{ GPT_BACKUP_LBA, DISK_BLOCKS },
+	{ GPT_BACKUP_LBA, ~0ULL },
+	{ GPT_FIRST_USABLE_LBA, GPT_LAST_LBA + 1U },
+	{ GPT_FIRST_USABLE_LBA, 2U },
+	{ GPT_LAST_USABLE_LBA, DISK_BLOCKS - 1U },
+	{ GPT_LAST_USABLE_LBA, ~0ULL },
+	{ GPT_PART_LBA, 0U },
+	{ GPT_PART_LBA, 1U },
+	{ GPT_PART_LBA, 3U },
+	{ GPT_PART_LBA, DISK_BLOCKS - 1U },
+	{ GPT_PART_LBA, ~0ULL / BLOCK_SIZE },
+	{ GPT_PART_LBA, ~0ULL },
+	{ GPT_LIST_NUM, 0U },
+	{ GPT_LIST_NUM, GPT_ENTRIES_NUM + 1U },
+	{ GPT_LIST_NUM, UINT32_MAX },
+	{ GPT_PART_SIZE, 0U },
+	{ GPT_PART_SIZE, sizeof(gpt_entry_t) / 2U },
+	{ GPT_PART_SIZE, sizeof(gpt_entry_t) + 8U },
+	{ GPT_PART_SIZE, 3U * sizeof(gpt_entry_t) },
+	{ GPT_PART_SIZE, 2U * sizeof(gpt_entry_t) },
+	{ GPT_PART_SIZE, U(0x80000000) },
+};
+
+static void test_gpt_bounds(void)
+{
+	unsigned long long backup_lba = DISK_BLOCKS - 1U;
+	unsigned long long first_lba;
+	unsigned int before = failures;
+	unsigned int i;
+
+	for (i = 0U; i < ARRAY_SIZE(bad_headers); i++) {
+		first_lba = write_gpt(TEST_FIP_LAST_LBA, GPT_ENTRIES_NUM,
+				      sizeof(gpt_entry_t));
+		mutate_gpt_header(gpt_header_at(1U), &bad_headers[i]);
+		CHECK(gpt_load_ok(first_lba));
+
+		mutate_gpt_header(gpt_header_at(backup_lba), &bad_headers[i]);
+		CHECK(gpt_load_fails());
+	}
+
+	if (failures == before) {
+		printf("PASS: GPT bounds, %zu headers\n", ARRAY_SIZE(bad_headers));
+	}
+}
+
+static unsigned long long fuzz_value(void)
+{
+	switch (prng() % 4U) {
+	case 0U:
+		return prng();
+	case 1U:
+		return prng() % (2U * DISK_BLOCKS);
+	case 2U:
+		return (prng() % 2U) != 0U ? ~0ULL - (prng() % 4U) : prng() % 4U;
+	default:
+		return U(1) << (prng() % 32U);
+	}
+}
+
+/* Random corruption of one GPT copy, both or the MBR */
+static void fuzz_gpt(unsigned int kind, unsigned int entries_num,
+		     unsigned int part_size)
+{
+	size_t array_size = (size_t)entries_num * part_size;
+	unsigned long long lba[2] = {
+		1U, DISK_BLOCKS - 1U,
+	};
+	unsigned long long array[2] = {
+		2U, gpt_backup_array(entries_num, part_size),
+	};
+	struct gpt_mutation mutation;
+	unsigned int copy;
+
+	for (copy = 0U; copy < 2U; copy++) {
+		if ((kind != 2U) && (copy != (kind & 1U))) {
+			continue;
+		}
+
+		switch (prng() % 3U) {
+		case 0U:
+			flip_bytes(lba[copy] * BLOCK_SIZE, DEFAULT_GPT_HEADER_SIZE,
+				   1U + (prng() % 4U));
+			break;
+		case 1U:
+			flip_bytes(array[copy] * BLOCK_SIZE, array_size,
+				   1U + (prng() % 4U));
+			break;
+		default:
+			mutation.field = (enum gpt_field)(prng() % GPT_FIELDS_NB);
+			mutation.value = fuzz_value();
+			mutate_gpt_header(gpt_header_at(lba[copy]), &mutation);
+			break;
+		}
+	}
+}
+
+/*
+ * With one copy corrupted, the partitions are always found. With both, the
+ * load may fail but never gives other partitions. Corrupting the MBR must
+ * not crash.
+ */
+static void test_gpt_fuzz(void)
+{
+	static const unsigned int layouts[][2] = {
+		{ GPT_ENTRIES_NUM, sizeof(gpt_entry_t) },
+		{ GPT_ENTRIES_NUM, 2U * sizeof(gpt_entry_t) },
+		{ 8U, sizeof(gpt_entry_t) },
+	};
+	unsigned long long first_lba;
+	unsigned int before = failures;
+	unsigned int layout;
+	unsigned int kind;
+	unsigned int run;
+	int rc;
+
+	for (run = 0U; (run < FUZZ_RUNS) && (failures == before); run++) {
+		layout = (unsigned int)(prng() % ARRAY_SIZE(layouts));
+		first_lba = write_gpt(TEST_FIP_LAST_LBA, layouts[layout][0],
+				      layouts[layout][1]);
+		kind = (unsigned int)(prng() % 4U);
+
+		if (kind == 3U) {
+			flip_bytes(0U, BLOCK_SIZE, 1U + (prng() % 4U));
+			(void)load_partition_table(GPT_IMAGE_ID);
+			continue;
+		}
+
+		fuzz_gpt(kind, layouts[layout][0], layouts[layout][1]);
+
+		rc = load_partition_table(GPT_IMAGE_ID);
+		if (kind != 2U) {
+			CHECK((rc == 0) && gpt_list_ok(first_lba));
+		} else {
+			CHECK((rc != 0) || gpt_list_ok(first_lba));
+		}
+	}
+
+	if (failures == before) {
+		printf("PASS: GPT fuzz, %u runs\n", FUZZ_RUNS);
+	}
+}
+
+#define FWU_BANK_BLOCKS		U(8192)
+#define FWU_TOC_SIZE		(sizeof(fip_toc_header_t) + \
+				 ((IMAGES_NB + 1U) * sizeof(fip_toc_entry_t)))
+
+static const io_block_spec_t fwu_banks[NR_OF_FW_BANKS] = {
+	{
+		.offset = FIP_FIRST_LBA * BLOCK_SIZE,
+		.length = FWU_BANK_BLOCKS * BLOCK_SIZE,
+	},
+	{
+		.offset = (FIP_FIRST_LBA + FWU_BANK_BLOCKS) * BLOCK_SIZE,
+		.length = FWU_BANK_BLOCKS * BLOCK_SIZE,
+	},
+};
+
+enum fwu_corruption {
+	FWU_TOC_NAME,
+	FWU_TOC_SERIAL,
+	FWU_TOC_OFFSET,
+	FWU_TOC_END,
+	FWU_TOC_SIZE_OVERFLOW,
+	FWU_TOC_NO_END,
+	FWU_CORRUPTIONS_NB
+};
+
+static fip_toc_header_t *fwu_toc(unsigned int bank)
+{
+	return (fip_toc_header_t *)&disk[fwu_banks[bank].offset];
+}
+
+static fip_toc_entry_t *fwu_toc_entry(unsigned int bank, unsigned int i)
+{
+	return &((fip_toc_entry_t *)(fwu_toc(bank) + 1))[i];
+}
+
+/* Both banks hold the same images, bank 0 being the active one */
+static void fwu_write_banks(void)
+{
+	unsigned int bank;
+
+	for (bank = 0U; bank < NR_OF_FW_BANKS; bank++) {
+		(void)memset(&disk[fwu_banks[bank].offset], 0,
+			     fwu_banks[bank].length);
+		(void)build_fip(fwu_banks[bank].offset / BLOCK_SIZE,
+				fwu_banks[bank].length);
+	}
+}
+
+/*
+ * Corrupt the ToC of a bank, and its images so that loading any of them from
+ * it is detected.
+ */
+static void fwu_corrupt_bank(unsigned int bank, enum fwu_corruption kind)
+{
+	fip_toc_header_t *header = fwu_toc(bank);
+	fip_toc_entry_t *entry = fwu_toc_entry(bank, IMAGES_NB - 1U);
+	unsigned int i;
+
+	(void)memset(&disk[fwu_banks[bank].offset + FWU_TOC_SIZE], 0xFF,
+		     fwu_banks[bank].length - FWU_TOC_SIZE);
+
+	switch (kind) {
+	case FWU_TOC_NAME:
+		header->name ^= 1U;
+		break;
+	case FWU_TOC_SERIAL:
+		header->serial_number = 0U;
+		break;
+	case FWU_TOC_OFFSET:
+		entry->offset_address = fwu_banks[bank].length + 1U;
+		break;
+	case FWU_TOC_END:
+		entry->offset_address = fwu_banks[bank].length -
+					entry->size + 1U;
+		break;
+	case FWU_TOC_SIZE_OVERFLOW:
+		entry->size = ~0ULL;
+		break;
+	case FWU_TOC_NO_END:
+		for (i = 0U; i < FWU_FIP_MAX_ENTRIES; i++) {
+			entry = fwu_toc_entry(bank, i);
+			entry->uuid = images[i % IMAGES_NB].uuid_spec.uuid;
+			entry->offset_address = FWU_TOC_SIZE;
+			entry->size = 0U;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/* As stm32_fwu_verify_boot_idx() for the active bank 0 */
+static unsigned int fwu_boot_bank(void)
+{
+	if ((stm32_fwu_check_fip(storage_dev_handle, &fwu_banks[0]) == 0) ||
+	    (stm32_fwu_check_fip(storage_dev_handle, &fwu_banks[1]) != 0)) {
+		return 0U;
+	}
+
+	return 1U;
+}
+
+/* All images are loaded intact from the bank selected */
+static bool fwu_boot_ok(unsigned int bank)
+{
+	struct bench_stats total = { 0 };
+
+	if (fwu_boot_bank() != bank) {
+		return false;
+	}
+
+	fip_block_spec = fwu_banks[bank];
+
+	return load_images(&total) == 0;
+}
+
+/* A ToC accepted by the check has all its entries in the bank */
+static bool fwu_toc_in_bank(unsigned int bank)
+{
+	static const uuid_t uuid_null;
+	const fip_toc_entry_t *entry;
+	uint64_t length = fwu_banks[bank].length;
+	unsigned int i;
+
+	for (i = 0U; i < FWU_FIP_MAX_ENTRIES; i++) {
+		entry = fwu_toc_entry(bank, i);
+		if (memcmp(&entry->uuid, &uuid_null, sizeof(uuid_t)) == 0) {
+			return true;
+		}
+
+		if ((entry->offset_address > length) ||
+		    (entry->size > (length - entry->offset_address))) {
+			return false;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Corrupted active bank: the alternate bank is booted. The alternate bank is
+ * never booted while the active one is valid, or when it is corrupted too.
+ */
+static void test_fwu_banks(void)
+{
+	unsigned int before = failures;
+	unsigned int kind;
+
+	fwu_write_banks();
+	CHECK(fwu_boot_ok(0U));
+
+	for (kind = 0U; kind < FWU_CORRUPTIONS_NB; kind++) {
+		fwu_write_banks();
+		fwu_corrupt_bank(0U, kind);
+		CHECK(stm32_fwu_check_fip(storage_dev_handle,
+					  &fwu_banks[0]) != 0);
+		CHECK(fwu_boot_ok(1U));
+
+		fwu_write_banks();
+		fwu_corrupt_bank(1U, kind);
+		CHECK(fwu_boot_ok(0U));
+
+		fwu_corrupt_bank(0U, kind);
+		CHECK(fwu_boot_bank() == 0U);
+	}
+
+	/* Erased alternate bank */
+	fwu_write_banks();
+	(void)memset(&disk[fwu_banks[1].offset], 0, fwu_banks[1].length);
+	CHECK(fwu_boot_ok(0U));
+
+	/* Image contents are left to the authentication at load time */
+	fwu_write_banks();
+	disk[fwu_banks[0].offset + FWU_TOC_SIZE] ^= 1U;
+	CHECK(fwu_boot_bank() == 0U);
+
+	if (failures == before) {
+		printf("PASS: FWU bank fallback\n");
+	}
+}
+
+static void test_fwu_fuzz(void)
+{
+	unsigned int before = failures;
+	unsigned int run;
+	bool valid;
+
+	for (run = 0U; (run < FUZZ_RUNS) && (failures == before); run++) {
+		fwu_write_banks();
+		flip_bytes(fwu_banks[0].offset, FWU_TOC_SIZE,
+			   1U + (prng() % 4U));
+
+		valid = stm32_fwu_check_fip(storage_dev_handle,
+					    &fwu_banks[0]) == 0;
+		CHECK(!valid || fwu_toc_in_bank(0U));
+		CHECK(fwu_boot_bank() == (valid ? 0U : 1U));
+	}
+
+	if (failures == before) {
+		printf("PASS: FWU ToC fuzz, %u runs\n", FUZZ_RUNS);
+	}
+}
+
+static int run_all_tests(void)
+{
+	quiet = true;
+
+	test_gpt_layouts();
+	test_gpt_backup();
+	test_gpt_region();
+	test_gpt_bounds();
+	test_gpt_fuzz();
+	test_fwu_banks();
+	test_fwu_fuzz();
+
+	quiet = false;
+
+	if (failures != 0U) {
+		printf("FAIL: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("PASS: all tests\n");
+
+	return 0;
+}
+
+/* Parse the GPT of a disk image file and list its partitions */
+static int list_disk_image(const char *path)
+{
+	const partition_entry_list_t *list;
+	long size = 0L;
+	long len;
+	int fd;
+	int rc;
+	int i;
+
+	fd = open(path, HOST_O_RDONLY);
+	if (fd < 0) {
+		printf("Cannot open %s\n", path);
+		return 1;
+	}
+
+	(void)memset(disk, 0, DISK_SIZE);
+	do {
+		len = read(fd, &disk[size], DISK_SIZE - (size_t)size);
+		size += (len > 0L) ? len : 0L;
+	} while ((len > 0L) && ((size_t)size < DISK_SIZE));
+
+	(void)close(fd);
+
+	if ((len < 0L) || (size == 0L) || ((size % BLOCK_SIZE) != 0L)) {
+		printf("%s is not a disk image of at most %u bytes\n", path,
+		       DISK_SIZE);
+		return 1;
+	}
+
+	gpt_block_spec.length = (size_t)size;
+
+	/* Only the partitions are printed, to be compared with sgdisk */
+	quiet = true;
+	rc = load_partition_table(GPT_IMAGE_ID);
+	quiet = false;
+	if (rc != 0) {
+		printf("Failed to load the GPT (%d)\n", rc);
+		return 1;
+	}
+
+	list = get_partition_entry_list();
+	for (i = 0; i < list->entry_count; i++) {
+		printf("%s %llu %llu\n", list->list[i].name,
+		       (unsigned long long)(list->list[i].start / BLOCK_SIZE),
+		       (unsigned long long)((list->list[i].start +
+					     list->list[i].length) /
+					    BLOCK_SIZE) - 1U);
+	}
+
+	return 0;
+}
+
+static void usage(const char *prog)
+{
+	printf("Usage: %s [-c NS] [-t NS] [-a ALIGN] [-b] [-s IMAGE:SIZE]...\n"
+	       "       %s -T\n"
+	       "       %s -i DISK_IMAGE\n"
+	       "  -c NS          time of a read command (default: %u)\n"
+	       "  -t NS          time of a %u bytes block transfer (default: %u)\n"
+	       "  -a ALIGN       alignment of the images in the FIP (default: 1)\n"
+	       "  -b             single block bounce buffer in the block driver,\n"
+	       "                 instead of the image load area\n"
+	       "  -s IMAGE:SIZE  size of BL31, BL32, BL33 or HW_CONFIG\n"
+	       "  -T             run the GPT tests\n"
+	       "  -i DISK_IMAGE  list the GPT partitions of a disk image of at\n"
+	       "                 most %u bytes\n",
+	       prog, prog, prog, DEFAULT_CMD_NS, BLOCK_SIZE, DEFAULT_BLOCK_NS,
+	       DISK_SIZE);
+}
+
+static int set_image_size(const char *arg)
+{
+	unsigned int i;
+	size_t len;
+
+	for (i = 0U; i < IMAGES_NB; i++) {
+		len = strlen(images[i].name);
+		if ((strncmp(arg, images[i].name, len) == 0) &&
+		    (arg[len] == ':')) {
+			images[i].size = strtoul(&arg[len + 1U], NULL, 0);
+
+			return ((images[i].size != 0U) &&
+				(images[i].size <= LOAD_AREA_SIZE)) ? 0 : -EINVAL;
+		}
+	}
+
+	return -EINVAL;
+}
+
+static int parse_args(int argc, char *argv[])
+{
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		const char *opt = argv[i];
+
+		if (strcmp(opt, "-b") == 0) {
+			single_block_buffer = true;
+			continue;
+		}
+
+		if (strcmp(opt, "-T") == 0) {
+			run_tests = true;
+			continue;
+		}
+
+		if (((i + 1) == argc) || (opt[0] != '-') || (opt[2] != '\0')) {
+			return -EINVAL;
+		}
+
+		i++;
+		switch (opt[1]) {
+		case 'c':
+			cmd_ns = strtoul(argv[i], NULL, 0);
+			break;
+		case 't':
+			block_ns = strtoul(argv[i], NULL, 0);
+			break;
+		case 'a':
+			fip_align = strtoul(argv[i], NULL, 0);
+			if ((fip_align == 0UL) || !IS_POWER_OF_TWO(fip_align)) {
+				return -EINVAL;
+			}
+			break;
+		case 's':
+			if (set_image_size(argv[i]) != 0) {
+				return -EINVAL;
+			}
+			break;
+		case 'i':
+			disk_image = argv[i];
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const io_dev_connector_t *dev_con;
+	const partition_entry_t *entry;
+	struct bench_stats total = { 0 };
+	size_t fip_size;
+	int rc;
+
+	if (parse_args(argc, argv) != 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	rc = register_io_dev_block(&dev_con);
+	assert(rc == 0);
+	rc = io_dev_open(dev_con, (uintptr_t)&bench_block_dev_spec,
+			 &storage_dev_handle);
+	assert(rc == 0);
+	rc = register_io_dev_fip(&dev_con);
+	assert(rc == 0);
+	rc = io_dev_open(dev_con, (uintptr_t)NULL, &fip_dev_handle);
+	assert(rc == 0);
+
+	if (run_tests) {
+		return run_all_tests();
+	}
+
+	if (disk_image != NULL) {
+		return list_disk_image(disk_image);
+	}
+
+	fip_size = build_fip(FIP_FIRST_LBA,
+			     (GPT_LAST_LBA - FIP_FIRST_LBA + 1U) * BLOCK_SIZE);
+	if (fip_size == 0U) {
+		printf("Images do not fit in the disk\n");
+		return 1;
+	}
+
+	(void)write_gpt(FIP_FIRST_LBA +
+			(round_up(fip_size, BLOCK_SIZE) / BLOCK_SIZE) - 1U,
+			GPT_ENTRIES_NUM, sizeof(gpt_entry_t));
+
+	printf("%lu ns/command, %lu ns/block of %u bytes, FIP alignment %lu, %s buffer\n",
+	       cmd_ns, block_ns, BLOCK_SIZE, fip_align,
+	       single_block_buffer ? "block" : "load area");
+	printf("%-10s %10s %9s %9s %10s %10s\n", "step", "bytes", "commands",
+	       "blocks", "copied", "time (us)");
+
+	zeromem(&stats, sizeof(stats));
+	rc = load_partition_table(GPT_IMAGE_ID);
+	if (rc != 0) {
+		printf("Failed to load the GPT (%d)\n", rc);
+		return 1;
+	}
+
+	entry = get_partition_entry(FIP_NAME);
+	if (entry == NULL) {
+		printf("No %s partition\n", FIP_NAME);
+		return 1;
+	}
+
+	fip_block_spec.offset = entry->start;
+	fip_block_spec.length = entry->length;
+
+	print_stats("GPT", stats.blocks * BLOCK_SIZE, &stats);
+	total = stats;
+
+	if (load_images(&total) != 0) {
+		return 1;
+	}
+
+	print_stats("total", fip_size, &total);
+
+	return 0;
+}
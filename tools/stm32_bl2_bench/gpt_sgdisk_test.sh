@@ -0,0 +1,116 @@
+#!/bin/sh
+#
+# Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+# Check the GPT parsing of BL2 on disk images made by sgdisk: the partitions
+# listed by "stm32_bl2_bench -i" must be the ones reported by sgdisk, with the
+# primary or the backup GPT corrupted, and the parsing must fail when both are.
+#
+# Usage: gpt_sgdisk_test.sh [path to stm32_bl2_bench]
+
+BENCH=${1:-./stm32_bl2_bench}
+DISK_SIZE=16M
+BLOCK_SIZE=512
+
+if ! command -v sgdisk > /dev/null 2>&1; then
+	echo "SKIP: sgdisk not found"
+	exit 0
+fi
+
+TMP_DIR=$(mktemp -d)
+trap 'rm -rf "${TMP_DIR}"' EXIT
+IMAGE=${TMP_DIR}/disk.img
+failures=0
+
+fail() {
+	echo "FAIL: $1"
+	failures=$((failures + 1))
+}
+
+# $@: sgdisk table options
+make_image() {
+	rm -f "${IMAGE}"
+	truncate -s ${DISK_SIZE} "${IMAGE}"
+	sgdisk -q -o "$@" \
+		-n 1:0:+256K -c 1:fsbl1 \
+		-n 2:0:+256K -c 2:fsbl2 \
+		-n 3:0:+1M -c 3:metadata1 \
+		-n 4:0:+4M -c 4:fip \
+		-n 5:0:0 -c 5:rootfs \
+		"${IMAGE}" > /dev/null || exit 1
+	sgdisk -v "${IMAGE}" > /dev/null || exit 1
+}
+
+# Partitions as listed by the benchmark: name, first and last LBA
+sgdisk_list() {
+	i=1
+	while [ $i -le 5 ]; do
+		sgdisk -i $i "${IMAGE}" | awk '
+			/^First sector:/ { first = $3 }
+			/^Last sector:/ { last = $3 }
+			/^Partition name:/ {
+				sub(/^Partition name: \x27/, ""); sub(/\x27$/, "");
+				name = $0
+			}
+			END { print name, first, last }'
+		i=$((i + 1))
+	done
+}
+
+# $1: LBA, $2: byte offset in the block
+corrupt() {
+	printf '\377' | dd of="${IMAGE}" bs=1 \
+		seek=$(($1 * BLOCK_SIZE + $2)) conv=notrunc 2> /dev/null
+}
+
+last_lba() {
+	echo $(($(stat -c %s "${IMAGE}") / BLOCK_SIZE - 1))
+}
+
+# $1: test name
+check_list() {
+	if ! "${BENCH}" -i "${IMAGE}" > "${TMP_DIR}/bench.txt"; then
+		fail "$1: GPT not loaded"
+	elif ! cmp -s "${TMP_DIR}/expected.txt" "${TMP_DIR}/bench.txt"; then
+		fail "$1: partitions differ"
+		diff "${TMP_DIR}/expected.txt" "${TMP_DIR}/bench.txt"
+	else
+		echo "PASS: $1"
+	fi
+}
+
+for table in 128 256; do
+	make_image -S ${table}
+	sgdisk_list > "${TMP_DIR}/expected.txt"
+	backup=$(last_lba)
+
+	check_list "sgdisk, ${table} entries"
+
+	# Header CRC, then first entry of the array
+	corrupt 1 16
+	check_list "sgdisk, ${table} entries, primary header corrupted"
+
+	make_image -S ${table}
+	corrupt 2 32
+	check_list "sgdisk, ${table} entries, primary entries corrupted"
+
+	make_image -S ${table}
+	corrupt ${backup} 16
+	check_list "sgdisk, ${table} entries, backup header corrupted"
+
+	corrupt 1 16
+	if "${BENCH}" -i "${IMAGE}" > /dev/null; then
+		fail "sgdisk, ${table} entries, both headers corrupted: GPT loaded"
+	else
+		echo "PASS: sgdisk, ${table} entries, both headers corrupted"
+	fi
+done
+
+if [ ${failures} -ne 0 ]; then
+	echo "FAIL: sgdisk images, ${failures} failures"
+	exit 1
+fi
+
+echo "PASS: sgdisk images"
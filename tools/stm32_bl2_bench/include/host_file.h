@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef HOST_FILE_H
+#define HOST_FILE_H
+
+#include <stddef.h>
+
+/*
+ * Host libc functions used to read a disk image file. The benchmark is built
+ * with the TF-A libc headers, which have no files.
+ */
+#define HOST_O_RDONLY		0
+
+int open(const char *pathname, int flags, ...);
+long read(int fd, void *buf, size_t count);
+int close(int fd);
+
+#endif /* HOST_FILE_H */
@@ -0,0 +1,354 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+#
+# SPDX-License-Identifier: BSD-3-Clause
+
+"""
+    Generate the table of I2C TIMINGR values used by the STM32 I2C driver
+    (stm32_i2c_timings.h, included by drivers/st/i2c/stm32_i2c.c).
+
+    The solver is the same as i2c_compute_timing() in
+    drivers/st/i2c/stm32_i2c.c. With a DTB, it is run for the bus rate and
+    rise/fall times of each enabled I2C node, as read by
+    stm32_i2c_get_setup_from_fdt(), and for the rates of the fixed clocks of
+    the DT. Several DTBs can be given when one BL2 serves several boards.
+    Kernel clock rates, bus rates and rise/fall times given on the
+    command line are added. The driver falls back to its own solver for a
+    setup that is not in the table.
+"""
+
+import argparse
+import itertools
+import struct
+import sys
+
+FDT_MAGIC = 0xd00dfeed
+FDT_BEGIN_NODE = 1
+FDT_END_NODE = 2
+FDT_PROP = 3
+FDT_NOP = 4
+FDT_END = 9
+
+I2C_COMPATS = ('st,stm32mp15-i2c', 'st,stm32mp13-i2c', 'st,stm32mp25-i2c')
+
+# Driver defaults, see include/drivers/st/stm32_i2c.h
+STANDARD_RATE = 100000
+RISE_TIME_DEFAULT = 25
+FALL_TIME_DEFAULT = 10
+
+NSEC_PER_SEC = 1000000000
+
+PRESC_MAX = 16
+SCLDEL_MAX = 16
+SDADEL_MAX = 16
+SCLH_MAX = 256
+SCLL_MAX = 256
+
+DIGITAL_FILTER_MAX = 16
+ANALOG_FILTER_DELAY_MIN = 50
+ANALOG_FILTER_DELAY_MAX = 260
+
+# rate, fall_max, rise_max, hddat_min, vddat_max, sudat_min, l_min, h_min
+I2C_SPECS = [
+    (100000, 300, 1000, 0, 3450, 250, 4700, 4000),
+    (400000, 300, 300, 0, 900, 100, 1300, 600),
+    (1000000, 100, 120, 0, 450, 50, 500, 260),
+]
+
+HEADER = """/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Generated by tools/stm32_i2c_timings/stm32_i2c_timings.py, do not edit.
+ * {args}
+ */
+
+#ifndef STM32_I2C_TIMINGS_H
+#define STM32_I2C_TIMINGS_H
+
+#include <stdint.h>
+
+struct stm32_i2c_timing_entry {{
+	uint32_t clock_src;
+	uint32_t bus_rate;
+	uint16_t rise_time;
+	uint16_t fall_time;
+	uint8_t analog_filter;
+	uint8_t digital_filter_coef;
+	uint32_t timing;
+}};
+
+static const struct stm32_i2c_timing_entry stm32_i2c_timings[] = {{
+"""
+
+FOOTER = """}};
+
+#endif /* STM32_I2C_TIMINGS_H */
+"""
+
+
+def get_specs(rate):
+    for specs in I2C_SPECS:
+        if rate <= specs[0]:
+            return specs
+
+    return None
+
+
+def compute_timing(clock_src, bus_rate, rise, fall, analog_filter, dnf):
+    """ Return the TIMINGR value, or None if there is no solution """
+    specs = get_specs(bus_rate)
+    if specs is None:
+        return None
+
+    rate, fall_max, rise_max, hddat_min, vddat_max, sudat_min, l_min, \
+        h_min = specs
+
+    if rise > rise_max or fall > fall_max or dnf > DIGITAL_FILTER_MAX:
+        return None
+
+    i2cclk = (NSEC_PER_SEC + clock_src // 2) // clock_src
+    i2cbus = (NSEC_PER_SEC + rate // 2) // rate
+
+    af_delay_min = ANALOG_FILTER_DELAY_MIN if analog_filter else 0
+    af_delay_max = ANALOG_FILTER_DELAY_MAX if analog_filter else 0
+    dnf_delay = dnf * i2cclk
+
+    sdadel_min = max(hddat_min + fall - af_delay_min - (dnf + 3) * i2cclk, 0)
+    sdadel_max = max(vddat_max - rise - af_delay_max - (dnf + 4) * i2cclk, 0)
+    scldel_min = rise + sudat_min
+
+    # Possible values for PRESC, SCLDEL and SDADEL
+    solutions = {}
+    for p in range(PRESC_MAX):
+        for l in range(SCLDEL_MAX):
+            if (l + 1) * (p + 1) * i2cclk < scldel_min:
+                continue
+
+            for a in range(SDADEL_MAX):
+                sdadel = (a * (p + 1) + 1) * i2cclk
+                if sdadel_min <= sdadel <= sdadel_max:
+                    solutions[p] = [l, a, 0, 0]
+                    break
+
+            if p in solutions:
+                break
+
+    if not solutions:
+        return None
+
+    tsync = af_delay_min + dnf_delay + 2 * i2cclk
+    clk_max = NSEC_PER_SEC // ((rate // 100) * 80)
+    clk_min = NSEC_PER_SEC // rate
+    clk_error_prev = None
+    s = None
+
+    # SCL low and high periods, closest to the bus rate
+    for p in sorted(solutions):
+        prescaler = (p + 1) * i2cclk
+
+        for l in range(SCLL_MAX):
+            tscl_l = (l + 1) * prescaler + tsync
+            if (tscl_l < l_min or
+                    i2cclk >= (tscl_l - af_delay_min - dnf_delay) // 4):
+                continue
+
+            for h in range(SCLH_MAX):
+                tscl_h = (h + 1) * prescaler + tsync
+                tscl = tscl_l + tscl_h + rise + fall
+
+                if (clk_min <= tscl <= clk_max and tscl_h >= h_min and
+                        i2cclk < tscl_h):
+                    clk_error = abs(tscl - i2cbus)
+                    if clk_error_prev is None or clk_error < clk_error_prev:
+                        clk_error_prev = clk_error
+                        solutions[p][2] = h
+                        solutions[p][3] = l
+                        s = p
+
+    if s is None:
+        return None
+
+    scldel, sdadel, sclh, scll = solutions[s]
+
+    return (s << 28) | (scldel << 20) | (sdadel << 16) | (sclh << 8) | scll
+
+
+class FdtError(Exception):
+    pass
+
+
+def fdt_parse(blob):
+    """ Return the tree as nested (name, props, children) tuples """
+    magic, totalsize, off_struct, off_strings = \
+        struct.unpack_from('>IIII', blob, 0)
+    if magic != FDT_MAGIC or totalsize > len(blob):
+        raise FdtError('not a valid DTB')
+
+    def get_string(offset):
+        start = off_strings + offset
+        return blob[start:blob.index(b'\0', start)].decode()
+
+    pos = off_struct
+    stack = []
+    root = None
+
+    while True:
+        token, = struct.unpack_from('>I', blob, pos)
+        pos += 4
+
+        if token == FDT_BEGIN_NODE:
+            end = blob.index(b'\0', pos)
+            node = (blob[pos:end].decode(), {}, [])
+            pos = (end + 4) & ~3
+            if stack:
+                stack[-1][2].append(node)
+            else:
+                root = node
+            stack.append(node)
+        elif token == FDT_END_NODE:
+            stack.pop()
+        elif token == FDT_PROP:
+            length, nameoff = struct.unpack_from('>II', blob, pos)
+            pos += 8
+            stack[-1][1][get_string(nameoff)] = blob[pos:pos + length]
+            pos = (pos + length + 3) & ~3
+        elif token == FDT_NOP:
+            continue
+        elif token == FDT_END:
+            break
+        else:
+            raise FdtError('bad token 0x{:x}'.format(token))
+
+    return root
+
+
+def fdt_nodes(node):
+    yield node
+
+    for child in node[2]:
+        yield from fdt_nodes(child)
+
+
+def has_compatible(node, compats):
+    return any(c.decode() in compats
+               for c in node[1].get('compatible', b'').split(b'\0') if c)
+
+
+def read_u32(node, prop, default):
+    value = node[1].get(prop)
+    if value is None:
+        return default
+
+    return struct.unpack_from('>I', value, 0)[0]
+
+
+def dt_setups(root):
+    """ Return the kernel clock rates and the (rate, rise, fall) of the DT """
+    clocks = []
+    buses = []
+
+    for node in fdt_nodes(root):
+        if node[1].get('status', b'okay').rstrip(b'\0') not in (b'okay',
+                                                                 b'ok'):
+            continue
+
+        if has_compatible(node, ('fixed-clock',)):
+            clocks.append(read_u32(node, 'clock-frequency', 0))
+        elif has_compatible(node, I2C_COMPATS):
+            buses.append((read_u32(node, 'clock-frequency', STANDARD_RATE),
+                          read_u32(node, 'i2c-scl-rising-time-ns',
+                                   RISE_TIME_DEFAULT),
+                          read_u32(node, 'i2c-scl-falling-time-ns',
+                                   FALL_TIME_DEFAULT)))
+
+    return [c for c in clocks if c != 0], buses
+
+
+def rise_fall(arg):
+    rise, fall = arg.split(':')
+
+    return int(rise, 0), int(fall, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().split('\n')[0])
+    parser.add_argument('dtb', nargs='*',
+                        help='DTB to take the I2C buses and clocks from')
+    parser.add_argument('-c', '--clock', type=lambda x: int(x, 0),
+                        action='append', default=[],
+                        help='I2C kernel clock rate (Hz)')
+    parser.add_argument('-r', '--rate', type=lambda x: int(x, 0),
+                        action='append', default=[],
+                        help='I2C bus rate (Hz)')
+    parser.add_argument('-t', '--rise-fall', type=rise_fall,
+                        action='append', default=[], metavar='RISE:FALL',
+                        help='SCL rising and falling times (ns)')
+    parser.add_argument('-d', '--dnf', type=int, action='append',
+                        help='digital filter coefficient (default: 0)')
+    parser.add_argument('--no-analog-filter', action='store_true',
+                        help='analog filter disabled')
+    parser.add_argument('-o', '--output', help='output file (default: stdout)')
+    args = parser.parse_args()
+
+    clocks = list(args.clock)
+    buses = [(rate, rise, fall) for rate, (rise, fall) in
+             itertools.product(args.rate, args.rise_fall)]
+
+    for dtb in args.dtb:
+        try:
+            with open(dtb, 'rb') as f:
+                dt_clocks, dt_buses = dt_setups(fdt_parse(f.read()))
+        except (OSError, FdtError, struct.error, ValueError) as e:
+            print('{}: {}'.format(dtb, e), file=sys.stderr)
+            sys.exit(1)
+
+        clocks += dt_clocks
+        buses += dt_buses
+
+    if not clocks or not buses:
+        parser.error('no kernel clock rate or no I2C bus')
+
+    analog_filter = 0 if args.no_analog_filter else 1
+    lines = []
+
+    # Sorted and without duplicates, for a stable header
+    buses = sorted(set(buses))
+    for (rate, rise, fall), dnf in itertools.product(buses, args.dnf or [0]):
+        found = False
+
+        for clock in sorted(set(clocks)):
+            timing = compute_timing(clock, rate, rise, fall, analog_filter,
+                                    dnf)
+            if timing is None:
+                continue
+
+            found = True
+            lines.append('\t{{ {}U, {}U, {}U, {}U, {}U, {}U, 0x{:08x}U }},\n'
+                         .format(clock, rate, rise, fall, analog_filter, dnf,
+                                 timing))
+
+        if not found:
+            print('No timing for {}Hz, rise {}ns, fall {}ns, dnf {}'
+                  .format(rate, rise, fall, dnf), file=sys.stderr)
+
+    # Command line to regenerate the table, without the output file
+    cmd = sys.argv[1:]
+    for opt in ('-o', '--output'):
+        if opt in cmd:
+            del cmd[cmd.index(opt):cmd.index(opt) + 2]
+
+    text = HEADER.format(args=' '.join(cmd)) + ''.join(lines) + \
+        FOOTER.format()
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,441 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+#
+# SPDX-License-Identifier: BSD-3-Clause
+
+"""
+    Generate the table of RISAF register writes for the regions of a
+    STM32MP2 FW_CONFIG device tree (drivers/st/rif/stm32mp2_risaf.c).
+
+    The regions of the "st,stm32mp2-mem-firewall" node are checked as done
+    by risaf_register_region(): instance, boundaries, granularity, number of
+    regions, region IDs and overlaps. The number of regions BL2 can register
+    and the number of regions of each instance are read from the platform
+    definitions (RISAFn_MAX_REGION and RISAFn_NB_REGIONS). Any error fails
+    the build. BL2 applies the table only if the FW_CONFIG it loads has the
+    size and CRC32 recorded in the header, it parses the FW_CONFIG otherwise.
+"""
+
+import argparse
+import re
+import struct
+import sys
+import zlib
+
+FDT_MAGIC = 0xd00dfeed
+FDT_BEGIN_NODE = 1
+FDT_END_NODE = 2
+FDT_PROP = 3
+FDT_NOP = 4
+FDT_END = 9
+
+FIREWALL_COMPAT = 'st,stm32mp2-mem-firewall'
+
+# DT st,protreg fields, see include/dt-bindings/soc/rif.h
+DT_RISAF_REG_ID_MASK = 0xf
+DT_RISAF_EN_SHIFT = 4
+DT_RISAF_SEC_SHIFT = 5
+DT_RISAF_ENC_SHIFT = 7
+DT_RISAF_PRIV_SHIFT = 8
+DT_RISAF_READ_SHIFT = 16
+DT_RISAF_WRITE_SHIFT = 24
+
+# RISAF region registers
+RISAF_REG_BASE = 0x40
+RISAF_REG_SIZE = 0x40
+RISAF_REG_CFGR = 0x0
+RISAF_REG_STARTR = 0x4
+RISAF_REG_ENDR = 0x8
+RISAF_REG_CIDCFGR = 0xc
+
+RISAF_REG_CFGR_BREN_SHIFT = 0
+RISAF_REG_CFGR_SEC_SHIFT = 8
+RISAF_REG_CFGR_ENC_SHIFT = 15
+RISAF_REG_CFGR_PRIVC_SHIFT = 16
+RISAF_REG_CIDCFGR_RDENC_SHIFT = 0
+RISAF_REG_CIDCFGR_WRENC_SHIFT = 16
+
+HEADER = """/*
+ * Copyright (c) 2024, STMicroelectronics - All Rights Reserved
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Generated by tools/stm32_risaf_table/stm32_risaf_table.py, do not edit.
+ * {args}
+ */
+
+#ifndef STM32MP2_RISAF_TABLE_H
+#define STM32MP2_RISAF_TABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define STM32MP2_RISAF_TABLE_FDT_SIZE	0x{size:x}U
+#define STM32MP2_RISAF_TABLE_FDT_CRC	0x{crc:08x}U
+
+struct stm32mp2_risaf_table_instance {{
+	int instance;
+	uint32_t granularity;
+	uint32_t max_id;	/* Highest region ID */
+	uint64_t end;		/* Highest offset in the memory */
+	bool enc;		/* At least one encrypted region */
+	unsigned int first;	/* First write of the instance */
+	unsigned int nwrites;
+}};
+
+struct stm32mp2_risaf_table_write {{
+	uint32_t offset;
+	uint32_t value;
+}};
+
+struct stm32mp2_risaf_table_enc {{
+	int instance;
+	uint64_t base;
+	uint64_t size;
+}};
+
+"""
+
+FOOTER = """
+#endif /* STM32MP2_RISAF_TABLE_H */
+"""
+
+
+class FdtError(Exception):
+    pass
+
+
+def fdt_parse(blob):
+    """ Return the tree as nested (name, props, children) tuples """
+    magic, totalsize, off_struct, off_strings = \
+        struct.unpack_from('>IIII', blob, 0)
+    if magic != FDT_MAGIC or totalsize > len(blob):
+        raise FdtError('not a valid DTB')
+
+    def get_string(offset):
+        start = off_strings + offset
+        return blob[start:blob.index(b'\0', start)].decode()
+
+    pos = off_struct
+    stack = []
+    root = None
+
+    while True:
+        token, = struct.unpack_from('>I', blob, pos)
+        pos += 4
+
+        if token == FDT_BEGIN_NODE:
+            end = blob.index(b'\0', pos)
+            node = (blob[pos:end].decode(), {}, [])
+            pos = (end + 4) & ~3
+            if stack:
+                stack[-1][2].append(node)
+            else:
+                root = node
+            stack.append(node)
+        elif token == FDT_END_NODE:
+            stack.pop()
+        elif token == FDT_PROP:
+            length, nameoff = struct.unpack_from('>II', blob, pos)
+            pos += 8
+            stack[-1][1][get_string(nameoff)] = blob[pos:pos + length]
+            pos = (pos + length + 3) & ~3
+        elif token == FDT_NOP:
+            continue
+        elif token == FDT_END:
+            break
+        else:
+            raise FdtError('bad token 0x{:x}'.format(token))
+
+    return root, totalsize
+
+
+def find_compatible(node, compat):
+    if compat.encode() in node[1].get('compatible', b'').split(b'\0'):
+        return node
+
+    for child in node[2]:
+        found = find_compatible(child, compat)
+        if found is not None:
+            return found
+
+    return None
+
+
+def cells(prop):
+    return list(struct.unpack('>{}I'.format(len(prop) // 4), prop))
+
+
+def to_int(cell_list):
+    value = 0
+    for cell in cell_list:
+        value = (value << 32) | cell
+
+    return value
+
+
+def instance_arg(arg):
+    fields = [int(x, 0) for x in arg.split(':')]
+    if len(fields) != 4:
+        raise argparse.ArgumentTypeError(
+            'expected INDEX:MEM_BASE:MEM_SIZE:GRANULARITY')
+
+    return dict(zip(('index', 'base', 'size', 'granularity'), fields))
+
+
+def parse_defs(text):
+    """
+    Return the integer macros of a platform definition header. Only #ifdef
+    and #ifndef are evaluated, macros defined under other conditions are
+    left out, as are the ones an #ifdef cannot be evaluated without.
+    """
+    defs = {}
+    maybe = set()
+    # For each conditional: state of its current branch (True, False or
+    # None when it cannot be evaluated), and whether a branch was taken
+    stack = []
+
+    for line in re.sub(r'\\\n', ' ', text).splitlines():
+        m = re.match(r'\s*#\s*(\w+)\s*(.*)', line)
+        if m is None:
+            continue
+
+        directive, rest = m.groups()
+        active = all(state is True for state, _ in stack)
+        known = all(state is not None for state, _ in stack)
+
+        if directive in ('ifdef', 'ifndef'):
+            name = rest.split()[0]
+            if name in maybe:
+                state = None
+            else:
+                state = (name in defs) == (directive == 'ifdef')
+            stack.append([state, state])
+        elif directive == 'if':
+            stack.append([None, None])
+        elif directive == 'elif':
+            stack[-1] = [None, None]
+        elif directive == 'else':
+            state, taken = stack[-1]
+            if state is None or taken is None:
+                stack[-1] = [None, None]
+            else:
+                stack[-1] = [not taken, True]
+        elif directive == 'endif':
+            stack.pop()
+        elif directive == 'define' and (active or not known):
+            fields = rest.split(None, 1)
+            name = fields[0]
+            if not active:
+                maybe.add(name)
+                defs.pop(name, None)
+                continue
+            value = fields[1] if len(fields) > 1 else ''
+            m = re.fullmatch(r'(?:U\()?(0x[0-9a-fA-F]+|\d+)U?\)?',
+                             re.sub(r'/\*.*\*/', '', value).strip())
+            defs[name] = int(m.group(1), 0) if m else value
+
+    return defs
+
+
+def get_instance_limits(instances, defs):
+    """ Set the RISAF region limits of each instance """
+    for inst in instances:
+        name = 'RISAF{}'.format(inst['index'] + 1)
+        for key, macro in (('max_regions', name + '_MAX_REGION'),
+                           ('nb_regions', name + '_NB_REGIONS')):
+            value = defs.get(macro)
+            if not isinstance(value, int):
+                raise FdtError('{}: no {} in the platform definitions'.format(
+                    name, macro))
+            inst[key] = value
+
+
+def get_regions(firewall):
+    address_cells = to_int(cells(firewall[1].get('#address-cells',
+                                                 b'\0\0\0\2')))
+    size_cells = to_int(cells(firewall[1].get('#size-cells', b'\0\0\0\2')))
+    regions = []
+
+    for name, props, _ in firewall[2]:
+        reg = props.get('reg')
+        if reg is None or len(reg) != 4 * (address_cells + size_cells):
+            raise FdtError('{}: no or bad reg entry'.format(name))
+
+        protreg = props.get('st,protreg')
+        if protreg is None or len(protreg) != 4:
+            raise FdtError('{}: no or bad st,protreg entry'.format(name))
+
+        reg = cells(reg)
+        regions.append({
+            'name': name,
+            'addr': to_int(reg[:address_cells]),
+            'len': to_int(reg[address_cells:]),
+            'protreg': cells(protreg)[0],
+        })
+
+    return regions
+
+
+def check_regions(regions, instances):
+    """ Assign each region to an instance, and run the driver checks """
+    for r in regions:
+        for inst in instances:
+            end = inst['base'] + inst['size']
+            if inst['base'] <= r['addr'] < end and r['addr'] + r['len'] <= end:
+                r['inst'] = inst
+                break
+        else:
+            raise FdtError('{}: no RISAF instance for 0x{:x}-0x{:x}'.format(
+                r['name'], r['addr'], r['addr'] + r['len']))
+
+        gran = r['inst']['granularity']
+        if r['len'] == 0 or r['addr'] % gran != 0 or r['len'] % gran != 0:
+            raise FdtError('{}: not aligned on 0x{:x}'.format(r['name'], gran))
+
+        enc = (r['protreg'] >> DT_RISAF_ENC_SHIFT) & 1
+        sec = (r['protreg'] >> DT_RISAF_SEC_SHIFT) & 1
+        if enc and not sec:
+            raise FdtError('{}: encryption on non secure area'.format(
+                r['name']))
+
+    for inst in instances:
+        regs = sorted((r for r in regions if r['inst'] is inst),
+                      key=lambda r: r['addr'])
+        name = 'RISAF{}'.format(inst['index'] + 1)
+
+        if len(regs) > inst['max_regions']:
+            raise FdtError('{}: too many regions'.format(name))
+
+        ids = [r['protreg'] & DT_RISAF_REG_ID_MASK for r in regs]
+        if len(set(ids)) != len(ids):
+            raise FdtError('{}: region ID used twice'.format(name))
+
+        for prev, cur in zip(regs, regs[1:]):
+            if cur['addr'] < prev['addr'] + prev['len']:
+                raise FdtError('{}: regions {} and {} overlap'.format(
+                    name, prev['name'], cur['name']))
+
+
+def region_writes(r):
+    value = r['protreg']
+    region_id = value & DT_RISAF_REG_ID_MASK
+    if not 1 <= region_id <= r['inst']['nb_regions']:
+        raise FdtError('{}: region ID {} not in 1-{} of RISAF{}'.format(
+            r['name'], region_id, r['inst']['nb_regions'],
+            r['inst']['index'] + 1))
+
+    reg = RISAF_REG_BASE + (region_id - 1) * RISAF_REG_SIZE
+    start = r['addr'] - r['inst']['base']
+    end = (start + r['len'] - 1) & ~(r['inst']['granularity'] - 1)
+
+    cfg = ((((value >> DT_RISAF_EN_SHIFT) & 1) << RISAF_REG_CFGR_BREN_SHIFT) |
+           (((value >> DT_RISAF_SEC_SHIFT) & 1) << RISAF_REG_CFGR_SEC_SHIFT) |
+           (((value >> DT_RISAF_ENC_SHIFT) & 1) << RISAF_REG_CFGR_ENC_SHIFT) |
+           (((value >> DT_RISAF_PRIV_SHIFT) & 0xff) <<
+            RISAF_REG_CFGR_PRIVC_SHIFT))
+    cid_cfg = ((((value >> DT_RISAF_WRITE_SHIFT) & 0xff) <<
+                RISAF_REG_CIDCFGR_WRENC_SHIFT) |
+               (((value >> DT_RISAF_READ_SHIFT) & 0xff) <<
+                RISAF_REG_CIDCFGR_RDENC_SHIFT))
+
+    # Same sequence as risaf_configure_region(), region disabled first
+    return [
+        (reg + RISAF_REG_CFGR, 0),
+        (reg + RISAF_REG_STARTR, start),
+        (reg + RISAF_REG_ENDR, end),
+        (reg + RISAF_REG_CIDCFGR, cid_cfg),
+        (reg + RISAF_REG_CFGR, cfg),
+    ]
+
+
+def build_table(regions, instances_arg):
+    """ Return the instance, write and encrypted region table entries """
+    instances = []
+    writes = []
+    enc_regions = []
+    for inst in instances_arg:
+        regs = [r for r in regions if r['inst'] is inst]
+        if not regs:
+            continue
+
+        first = len(writes)
+        for r in regs:
+            writes.extend(region_writes(r))
+            if (r['protreg'] >> DT_RISAF_ENC_SHIFT) & 1:
+                enc_regions.append('\t{{ {}, 0x{:x}ULL, 0x{:x}ULL }},\n'
+                                   .format(inst['index'], r['addr'], r['len']))
+
+        instances.append('\t{{ {}, 0x{:x}U, {}U, 0x{:x}ULL, {}, {}U, {}U }},\n'
+                         .format(inst['index'], inst['granularity'],
+                                 max(r['protreg'] & DT_RISAF_REG_ID_MASK
+                                     for r in regs),
+                                 max(r['addr'] + r['len'] - 1 for r in regs) -
+                                 inst['base'],
+                                 'true' if any((r['protreg'] >>
+                                                DT_RISAF_ENC_SHIFT) & 1
+                                               for r in regs) else 'false',
+                                 first, len(writes) - first))
+
+    return instances, writes, enc_regions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().split('\n')[0])
+    parser.add_argument('fw_config', help='FW_CONFIG DTB')
+    parser.add_argument('-i', '--instance', type=instance_arg,
+                        action='append', required=True,
+                        metavar='INDEX:MEM_BASE:MEM_SIZE:GRANULARITY',
+                        help='RISAF instance and the memory it filters')
+    parser.add_argument('-d', '--defs', required=True,
+                        help='platform definitions with the RISAF limits')
+    parser.add_argument('-o', '--output', help='output file (default: stdout)')
+    args = parser.parse_args()
+
+    with open(args.fw_config, 'rb') as f:
+        blob = f.read()
+
+    with open(args.defs) as f:
+        defs = parse_defs(f.read())
+
+    try:
+        get_instance_limits(args.instance, defs)
+        root, size = fdt_parse(blob)
+        firewall = find_compatible(root, FIREWALL_COMPAT)
+        regions = get_regions(firewall) if firewall is not None else []
+        check_regions(regions, args.instance)
+        instances, writes, enc_regions = build_table(regions, args.instance)
+    except (FdtError, struct.error, ValueError) as e:
+        print('{}: {}'.format(args.fw_config, e), file=sys.stderr)
+        sys.exit(1)
+
+    # Command line to regenerate the table, without the output file
+    cmd = sys.argv[1:]
+    for opt in ('-o', '--output'):
+        if opt in cmd:
+            del cmd[cmd.index(opt):cmd.index(opt) + 2]
+
+    text = HEADER.format(args=' '.join(cmd), size=size,
+                         crc=zlib.crc32(blob[:size]) & 0xffffffff)
+    text += ('static const struct stm32mp2_risaf_table_instance '
+             'stm32mp2_risaf_table_instances[] = {\n')
+    text += ''.join(instances) + '};\n\n'
+    text += ('static const struct stm32mp2_risaf_table_write '
+             'stm32mp2_risaf_table_writes[] = {\n')
+    text += ''.join('\t{{ 0x{:03x}U, 0x{:08x}U }},\n'.format(o, v)
+                    for o, v in writes) + '};\n\n'
+    text += ('static const struct stm32mp2_risaf_table_enc '
+             'stm32mp2_risaf_table_enc_regions[] = {\n')
+    text += ''.join(enc_regions) + '};\n'
+    text += FOOTER
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == '__main__':
+    main()
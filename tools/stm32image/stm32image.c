@@ -26,6 +26,7 @@
 #define PADDING_HEADER_MAGIC	__be32_to_cpu(0x5354FFFF)
 #define PADDING_HEADER_FLAG	(1 << 31)
 #define PADDING_HEADER_LENGTH	0x180
+#define MAX_IMAGES		64
 
 struct stm32_header_v1 {
 	uint32_t magic_number;
@@ -77,20 +78,38 @@ static void stm32image_default_header(void *ptr)
 	header->version_number = __cpu_to_le32(0);
 }
 
-static uint32_t stm32image_checksum(void *start, uint32_t len,
-				    uint32_t header_size)
+/*
+ * Sum of the payload bytes. Eight bytes are loaded at once and added in the
+ * four 16-bit lanes of a 64-bit accumulator, which is folded before a lane
+ * can overflow (each word adds at most 2 * 0xFF to a lane).
+ */
+#define CSUM_LANES_MASK		0x00FF00FF00FF00FFULL
+#define CSUM_FOLD_WORDS		128U
+
+static uint32_t stm32image_checksum(const void *start, size_t len)
 {
-	uint32_t csum = 0;
-	uint8_t *p;
+	const uint8_t *p = start;
+	uint32_t csum = 0U;
+	uint64_t acc, w;
+	unsigned int i;
+
+	while (len >= sizeof(w)) {
+		acc = 0U;
+		for (i = 0U; (i < CSUM_FOLD_WORDS) && (len >= sizeof(w)); i++) {
+			memcpy(&w, p, sizeof(w));
+			acc += (w & CSUM_LANES_MASK) +
+			       ((w >> 8) & CSUM_LANES_MASK);
+			p += sizeof(w);
+			len -= sizeof(w);
+		}
 
-	if (len < header_size) {
-		return 0;
+		csum += (uint32_t)(acc & 0xFFFFU) +
+			(uint32_t)((acc >> 16) & 0xFFFFU) +
+			(uint32_t)((acc >> 32) & 0xFFFFU) +
+			(uint32_t)(acc >> 48);
 	}
 
-	p = (unsigned char *)start + header_size;
-	len -= header_size;
-
-	while (len > 0) {
+	while (len > 0U) {
 		csum += *p;
 		p++;
 		len--;
@@ -135,10 +154,10 @@ static void stm32image_print_header(const void *ptr)
 	       __le32_to_cpu(stm32hdr->version_number));
 }
 
-static int stm32image_set_header(void *ptr, struct stat *sbuf, int ifd,
+static int stm32image_set_header(void *ptr, uint32_t length, uint32_t csum,
 				 uint32_t loadaddr, uint32_t ep, uint32_t ver,
 				 uint32_t major, uint32_t minor,
-				 uint32_t binary_type, uint32_t header_size)
+				 uint32_t binary_type)
 {
 	struct stm32_header_v1 *stm32hdr = (struct stm32_header_v1 *)ptr;
 	struct stm32_header_v2 *stm32hdr_v2 = (struct stm32_header_v2 *)ptr;
@@ -151,11 +170,8 @@ static int stm32image_set_header(void *ptr, struct stat *sbuf, int ifd,
 	stm32hdr->header_version[VER_MINOR] = minor;
 	stm32hdr->load_address = __cpu_to_le32(loadaddr);
 	stm32hdr->image_entry_point = __cpu_to_le32(ep);
-	stm32hdr->image_length = __cpu_to_le32((uint32_t)sbuf->st_size -
-					       header_size);
-	stm32hdr->image_checksum =
-		__cpu_to_le32(stm32image_checksum(ptr, sbuf->st_size,
-						  header_size));
+	stm32hdr->image_length = __cpu_to_le32(length);
+	stm32hdr->image_checksum = __cpu_to_le32(csum);
 
 	switch (stm32hdr->header_version[VER_MAJOR]) {
 	case HEADER_VERSION_V1:
@@ -187,20 +203,60 @@ static int stm32image_set_header(void *ptr, struct stat *sbuf, int ifd,
 	return 0;
 }
 
+static int stm32image_write(int fd, const void *buf, size_t len, off_t off)
+{
+	const uint8_t *p = buf;
+	ssize_t ret;
+
+	while (len > 0U) {
+		ret = pwrite(fd, p, len, off);
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+
+		p += ret;
+		len -= ret;
+		off += ret;
+	}
+
+	return 0;
+}
+
+/*
+ * The header is built in memory from the mapped source, then the header and
+ * the payload are written to the destination. With offset >= 0, they are
+ * written at that offset of the destination, e.g. a partition of a disk
+ * image, whose other contents are kept.
+ */
 static int stm32image_create_header_file(char *srcname, char *destname,
-					 uint32_t loadaddr, uint32_t entry,
-					 uint32_t version, uint32_t major,
-					 uint32_t minor, uint32_t binary_type)
+					 off_t offset, uint32_t loadaddr,
+					 uint32_t entry, uint32_t version,
+					 uint32_t major, uint32_t minor,
+					 uint32_t binary_type)
 {
-	int src_fd, dest_fd, header_size;
+	int src_fd, dest_fd, header_size, flags;
+	int ret = -1;
 	struct stat sbuf;
-	unsigned char *ptr;
-	void *stm32image_header;
+	unsigned char *ptr = NULL;
+	union {
+		struct stm32_header_v1 v1;
+		struct stm32_header_v2 v2;
+	} stm32image_header;
 
-	dest_fd = open(destname, O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0666);
-	if (dest_fd == -1) {
-		fprintf(stderr, "Can't open %s: %s\n", destname,
-			strerror(errno));
+	switch (major) {
+	case HEADER_VERSION_V1:
+		header_size = sizeof(struct stm32_header_v1);
+		break;
+
+	case HEADER_VERSION_V2:
+		header_size = sizeof(struct stm32_header_v2);
+		break;
+
+	default:
+		fprintf(stderr, "Unsupported header version %u\n", major);
 		return -1;
 	}
 
@@ -212,78 +268,77 @@ static int stm32image_create_header_file(char *srcname, char *destname,
 	}
 
 	if (fstat(src_fd, &sbuf) < 0) {
-		return -1;
+		goto out_src;
 	}
 
-	ptr = mmap(NULL, sbuf.st_size, PROT_READ, MAP_SHARED, src_fd, 0);
-	if (ptr == MAP_FAILED) {
-		fprintf(stderr, "Can't read %s\n", srcname);
-		return -1;
+	if ((uint64_t)sbuf.st_size > UINT32_MAX) {
+		fprintf(stderr, "%s is too big\n", srcname);
+		goto out_src;
 	}
 
-	switch (major) {
-	case HEADER_VERSION_V1:
-		stm32image_header = malloc(sizeof(struct stm32_header_v1));
-		header_size = sizeof(struct stm32_header_v1);
-		break;
+	if (sbuf.st_size != 0) {
+		ptr = mmap(NULL, sbuf.st_size, PROT_READ, MAP_SHARED, src_fd,
+			   0);
+		if (ptr == MAP_FAILED) {
+			fprintf(stderr, "Can't read %s\n", srcname);
+			goto out_src;
+		}
+	}
 
-	case HEADER_VERSION_V2:
-		stm32image_header = malloc(sizeof(struct stm32_header_v2));
-		header_size = sizeof(struct stm32_header_v2);
-		break;
+	memset(&stm32image_header, 0, header_size);
+	if (stm32image_set_header(&stm32image_header, sbuf.st_size,
+				  stm32image_checksum(ptr, sbuf.st_size),
+				  loadaddr, entry, version, major, minor,
+				  binary_type) != 0) {
+		goto out_map;
+	}
 
-	default:
-		return -1;
+	flags = O_WRONLY | O_CREAT;
+	if (offset < 0) {
+		flags |= O_TRUNC;
+		offset = 0;
 	}
 
-	memset(stm32image_header, 0, header_size);
-	if (write(dest_fd, stm32image_header, header_size) !=
-	    header_size) {
-		fprintf(stderr, "Write error %s: %s\n", destname,
+	dest_fd = open(destname, flags, 0666);
+	if (dest_fd == -1) {
+		fprintf(stderr, "Can't open %s: %s\n", destname,
 			strerror(errno));
-		free(stm32image_header);
-		return -1;
+		goto out_map;
 	}
 
-	free(stm32image_header);
-
-	if (write(dest_fd, ptr, sbuf.st_size) != sbuf.st_size) {
+	if ((stm32image_write(dest_fd, &stm32image_header, header_size,
+			      offset) != 0) ||
+	    (stm32image_write(dest_fd, ptr, sbuf.st_size,
+			      offset + header_size) != 0)) {
 		fprintf(stderr, "Write error on %s: %s\n", destname,
 			strerror(errno));
-		return -1;
+		close(dest_fd);
+		goto out_map;
 	}
 
-	munmap((void *)ptr, sbuf.st_size);
-	close(src_fd);
-
-	if (fstat(dest_fd, &sbuf) < 0) {
-		return -1;
+	if (close(dest_fd) != 0) {
+		fprintf(stderr, "Write error on %s: %s\n", destname,
+			strerror(errno));
+		goto out_map;
 	}
 
-	ptr = mmap(0, sbuf.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
-		   dest_fd, 0);
+	stm32image_print_header(&stm32image_header);
+	ret = 0;
 
-	if (ptr == MAP_FAILED) {
-		fprintf(stderr, "Can't write %s\n", destname);
-		return -1;
-	}
-
-	if (stm32image_set_header(ptr, &sbuf, dest_fd, loadaddr,
-				  entry, version, major, minor,
-				  binary_type, header_size) != 0) {
-		return -1;
+out_map:
+	if (ptr != NULL) {
+		munmap((void *)ptr, sbuf.st_size);
 	}
 
-	stm32image_print_header(ptr);
+out_src:
+	close(src_fd);
 
-	munmap((void *)ptr, sbuf.st_size);
-	close(dest_fd);
-	return 0;
+	return ret;
 }
 
 int main(int argc, char *argv[])
 {
-	int opt;
+	int opt, i;
 	int loadaddr = -1;
 	int entry = -1;
 	int err = 0;
@@ -291,19 +346,48 @@ int main(int argc, char *argv[])
 	int binary_type = -1;
 	int major = HEADER_VERSION_V2;
 	int minor = 0;
-	char *dest = NULL;
-	char *src = NULL;
-
-	while ((opt = getopt(argc, argv, ":b:s:d:l:e:v:m:n:")) != -1) {
+	char *dest[MAX_IMAGES];
+	char *src[MAX_IMAGES];
+	off_t offset[MAX_IMAGES];
+	int nr_dest = 0;
+	int nr_src = 0;
+	int nr_offset = 0;
+	long long off;
+	char *endptr;
+
+	while ((opt = getopt(argc, argv, ":b:s:d:l:e:v:m:n:O:")) != -1) {
 		switch (opt) {
 		case 'b':
 			binary_type = strtol(optarg, NULL, 0);
 			break;
 		case 's':
-			src = optarg;
+			if (nr_src == MAX_IMAGES) {
+				fprintf(stderr, "Too many -s options\n");
+				return -1;
+			}
+			src[nr_src++] = optarg;
 			break;
 		case 'd':
-			dest = optarg;
+			if (nr_dest == MAX_IMAGES) {
+				fprintf(stderr, "Too many -d options\n");
+				return -1;
+			}
+			dest[nr_dest++] = optarg;
+			break;
+		case 'O':
+			if (nr_offset == MAX_IMAGES) {
+				fprintf(stderr, "Too many -O options\n");
+				return -1;
+			}
+			errno = 0;
+			off = strtoll(optarg, &endptr, 0);
+			if ((errno != 0) || (endptr == optarg) ||
+			    (*endptr != '\0') || (off < 0) ||
+			    ((long long)(off_t)off != off)) {
+				fprintf(stderr, "Invalid offset %s\n", optarg);
+				return -1;
+			}
+			offset[nr_offset++] = off;
 			break;
 		case 'l':
 			loadaddr = strtol(optarg, NULL, 0);
@@ -322,22 +406,27 @@ int main(int argc, char *argv[])
 			break;
 		default:
 			fprintf(stderr,
-				"Usage : %s [-s srcfile] [-d destfile] [-l loadaddr] [-e entry_point] [-m major] [-n minor] [-b binary_type]\n",
+				"Usage : %s [-s srcfile] [-d destfile] [-O dest_offset] [-l loadaddr] [-e entry_point] [-m major] [-n minor] [-b binary_type]\n",
 					argv[0]);
 			return -1;
 		}
 	}
 
-	if (!src) {
+	if (nr_src == 0) {
 		fprintf(stderr, "Missing -s option\n");
 		return -1;
 	}
 
-	if (!dest) {
+	if (nr_dest != nr_src) {
 		fprintf(stderr, "Missing -d option\n");
 		return -1;
 	}
 
+	if ((nr_offset != 0) && (nr_offset != nr_src)) {
+		fprintf(stderr, "Missing -O option\n");
+		return -1;
+	}
+
 	if (loadaddr == -1) {
 		fprintf(stderr, "Missing -l option\n");
 		return -1;
@@ -353,9 +442,14 @@ int main(int argc, char *argv[])
 		return -1;
 	}
 
-	err = stm32image_create_header_file(src, dest, loadaddr,
-					    entry, version, major, minor,
-					    binary_type);
+	/* Images given by several -s/-d pairs share the header options */
+	for (i = 0; (i < nr_src) && (err == 0); i++) {
+		err = stm32image_create_header_file(src[i], dest[i],
+						    (nr_offset != 0) ?
+						    offset[i] : -1,
+						    loadaddr, entry, version,
+						    major, minor, binary_type);
+	}
 
 	return err;
 }